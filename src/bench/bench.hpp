@@ -0,0 +1,26 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+// the benchmarks are plain executables printing one line per case. a case reports the best of its runs so a run
+// that got descheduled does not skew it
+template <typename F>
+double benchMs(int runs, F &&f) {
+    double best = std::numeric_limits<double>::max();
+    for (int i = 0; i < runs; i++) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+// folds a result into a volatile so the measured work cannot be optimized away
+inline void benchKeep(uint64_t value) {
+    static volatile uint64_t sink = 0;
+    sink = sink + value;
+}
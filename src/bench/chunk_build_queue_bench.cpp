@@ -0,0 +1,149 @@
+#include "bench/bench.hpp"
+#include "core/render/chunk_queues.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+struct Section {
+    glm::vec3 pos;
+    Clock::time_point lastUpdate;
+};
+
+// same shape and constants as Chunk1::buildFactor
+static float buildFactor(const Section &section, Clock::time_point currentTime, glm::vec3 cameraPos) {
+    double tDiff = std::chrono::duration<double, std::milli>(currentTime - section.lastUpdate).count();
+    double dDiff = glm::distance(cameraPos, section.pos);
+
+    double tScore = 1 - exp(-tDiff / 200.0);
+    double dScore = 1 / (1 + pow(dDiff / 96.0, 1.5));
+    return pow(tScore, 1.0) * pow(dScore, 1.2);
+}
+
+// the frames replay the same events for both queues: every section popped into a batch is dirtied again right
+// away so the queue keeps its size, a few queued sections get updated, and the camera moves one block per frame
+struct Scenario {
+    uint32_t queued;
+    uint32_t batchSize;
+    uint32_t frames;
+    std::vector<Section> sections;
+    std::vector<std::vector<int64_t>> updates; // per frame
+
+    Scenario(uint32_t queued, uint32_t batchSize) : queued(queued), batchSize(batchSize) {
+        frames = std::clamp<uint32_t>(500'000 / queued, 5, 500);
+
+        std::mt19937 rng(queued);
+        std::uniform_real_distribution<float> horizontal(-512.0f, 512.0f);
+        std::uniform_real_distribution<float> vertical(-64.0f, 320.0f);
+        auto now = Clock::now();
+        for (uint32_t i = 0; i < queued; i++) {
+            auto age = std::chrono::milliseconds(rng() % 2000);
+            sections.push_back({glm::vec3(horizontal(rng), vertical(rng), horizontal(rng)), now - age});
+        }
+        updates.resize(frames);
+        for (auto &frameUpdates : updates) {
+            for (int i = 0; i < 16; i++) { frameUpdates.push_back(rng() % queued); }
+        }
+    }
+
+    glm::vec3 cameraPos(uint32_t frame) {
+        return glm::vec3(static_cast<float>(frame), 64.0f, 0.0f);
+    }
+};
+
+// the scheduler before the heap: copy the queued set and sort it by a freshly computed buildFactor every batch
+static double runSort(Scenario scenario) {
+    std::set<int64_t> queuedIndexSet;
+    for (uint32_t i = 0; i < scenario.queued; i++) { queuedIndexSet.insert(i); }
+
+    uint64_t picked = 0;
+    double ms = benchMs(1, [&] {
+        for (uint32_t frame = 0; frame < scenario.frames; frame++) {
+            auto currentTime = Clock::now();
+            glm::vec3 cameraPos = scenario.cameraPos(frame);
+            for (int64_t id : scenario.updates[frame]) {
+                scenario.sections[id].lastUpdate = currentTime;
+                queuedIndexSet.insert(id);
+            }
+
+            std::vector<int64_t> queuedIndices;
+            std::copy(queuedIndexSet.begin(), queuedIndexSet.end(), std::back_inserter(queuedIndices));
+            std::sort(queuedIndices.begin(), queuedIndices.end(), [&](int64_t a, int64_t b) -> bool {
+                return buildFactor(scenario.sections[a], currentTime, cameraPos) >
+                       buildFactor(scenario.sections[b], currentTime, cameraPos);
+            });
+
+            for (uint32_t i = 0; i < std::min<size_t>(scenario.batchSize, queuedIndices.size()); i++) {
+                queuedIndexSet.erase(queuedIndices[i]);
+                picked += queuedIndices[i];
+            }
+            for (uint32_t i = 0; i < std::min<size_t>(scenario.batchSize, queuedIndices.size()); i++) {
+                scenario.sections[queuedIndices[i]].lastUpdate = currentTime;
+                queuedIndexSet.insert(queuedIndices[i]);
+            }
+        }
+    });
+    benchKeep(picked);
+    return ms / scenario.frames;
+}
+
+static double runHeap(Scenario scenario) {
+    ChunkBuildQueue queue;
+    queue.reset(scenario.queued);
+    auto startTime = Clock::now();
+    for (uint32_t i = 0; i < scenario.queued; i++) {
+        queue.push(i, buildFactor(scenario.sections[i], startTime, scenario.cameraPos(0)));
+    }
+
+    uint64_t picked = 0;
+    std::vector<int64_t> batch;
+    double ms = benchMs(1, [&] {
+        for (uint32_t frame = 0; frame < scenario.frames; frame++) {
+            auto currentTime = Clock::now();
+            glm::vec3 cameraPos = scenario.cameraPos(frame);
+            for (int64_t id : scenario.updates[frame]) {
+                scenario.sections[id].lastUpdate = currentTime;
+                queue.push(id, buildFactor(scenario.sections[id], currentTime, cameraPos));
+            }
+
+            queue.tryRescore(cameraPos, [&](int64_t id, Clock::time_point rescoreTime) {
+                return buildFactor(scenario.sections[id], rescoreTime, cameraPos);
+            });
+
+            batch.clear();
+            for (uint32_t i = 0; i < scenario.batchSize && !queue.empty(); i++) { batch.push_back(queue.pop()); }
+            for (int64_t id : batch) {
+                picked += id;
+                scenario.sections[id].lastUpdate = currentTime;
+                queue.push(id, buildFactor(scenario.sections[id], currentTime, cameraPos));
+            }
+        }
+    });
+    benchKeep(picked);
+    return ms / scenario.frames;
+}
+
+// per frame cost of picking the next build batch, the sorted copy against the indexed heap
+int main() {
+    std::cout << std::setw(10) << "queued" << std::setw(8) << "batch" << std::setw(10) << "frames" << std::setw(14)
+              << "sort ms/f" << std::setw(14) << "heap ms/f" << std::setw(10) << "speedup" << std::endl;
+    std::cout << std::fixed << std::setprecision(4);
+    for (uint32_t queued : {1'000u, 10'000u, 100'000u}) {
+        for (uint32_t batchSize : {2u, 32u}) {
+            Scenario scenario(queued, batchSize);
+            double sortMs = runSort(scenario);
+            double heapMs = runHeap(scenario);
+            std::cout << std::setw(10) << queued << std::setw(8) << batchSize << std::setw(10) << scenario.frames
+                      << std::setw(14) << sortMs << std::setw(14) << heapMs << std::setw(9) << std::setprecision(1)
+                      << sortMs / heapMs << "x" << std::setprecision(4) << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include "bench/bench.hpp"
+#include "core/render/chunk_queues.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// synthetic stand-in for ChunkBuildData, the payload is copied from the task like queueChunkBuild copies the vertices
+struct SyntheticBuild {
+    int64_t id;
+    uint32_t producer;
+    uint32_t seq;
+    std::vector<uint8_t> payload;
+    int64_t version = -1;
+};
+
+constexpr uint32_t TASKS_PER_PRODUCER = 2000;
+constexpr uint32_t IDS_PER_PRODUCER = 64;
+constexpr size_t PAYLOAD_BYTES = 512 * 128; // 512 PBRTriangle vertices
+constexpr auto FRAME_WORK = std::chrono::microseconds(400);
+constexpr auto FRAME_IDLE = std::chrono::microseconds(600);
+
+// what the scheduler does for every build that reaches it, under the chunks mutex
+struct Scheduler {
+    std::mutex mutex;
+    ChunkBuildQueue queuedIndex;
+    std::vector<int64_t> latestVersions;
+    std::vector<std::shared_ptr<SyntheticBuild>> builds; // the latest per chunk, older payloads are released
+    std::vector<std::tuple<uint32_t, uint32_t, int64_t>> accepted; // producer, seq, version
+
+    explicit Scheduler(uint32_t numChunks) : latestVersions(numChunks, 0), builds(numChunks) {
+        queuedIndex.reset(numChunks);
+    }
+
+    void accept(std::shared_ptr<SyntheticBuild> build) {
+        build->version = latestVersions[build->id]++;
+        queuedIndex.push(build->id, static_cast<float>(build->seq));
+        accepted.emplace_back(build->producer, build->seq, build->version);
+        builds[build->id] = std::move(build);
+    }
+};
+
+struct Result {
+    double handoffUs; // per task, after the copy
+    double totalMs;   // until the scheduler accepted everything
+    bool ok;
+};
+
+// every build was accepted exactly once, in push order per producer, with the version its order implies
+static bool verify(Scheduler &scheduler, uint32_t producers) {
+    if (scheduler.accepted.size() != producers * TASKS_PER_PRODUCER) return false;
+
+    std::vector<int64_t> lastSeq(producers, -1);
+    for (auto [producer, seq, version] : scheduler.accepted) {
+        if (static_cast<int64_t>(seq) <= lastSeq[producer]) return false;
+        lastSeq[producer] = seq;
+        if (version != seq / IDS_PER_PRODUCER) return false;
+    }
+    return true;
+}
+
+// the render thread holds the mutex for a slice of every frame, the ingest mode drains the queue while it has it
+static Result run(uint32_t producers, bool ingest) {
+    Scheduler scheduler(producers * IDS_PER_PRODUCER);
+    IngestQueue<std::shared_ptr<SyntheticBuild>> ingestQueue;
+    std::vector<uint8_t> source(PAYLOAD_BYTES, 0x5A);
+    std::vector<double> handoffUs(producers, 0.0);
+
+    auto start = Clock::now();
+    std::atomic<uint32_t> finishedProducers = 0;
+    std::thread render([&] {
+        while (true) {
+            bool producersDone = finishedProducers.load() == producers;
+            {
+                std::unique_lock<std::mutex> lock(scheduler.mutex);
+                if (ingest) {
+                    for (auto &build : ingestQueue.popAll()) { scheduler.accept(std::move(build)); }
+                }
+                auto frameEnd = Clock::now() + FRAME_WORK;
+                while (Clock::now() < frameEnd) {}
+            }
+            if (producersDone) break;
+            std::this_thread::sleep_for(FRAME_IDLE);
+        }
+    });
+
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producers; p++) {
+        threads.emplace_back([&, p] {
+            for (uint32_t seq = 0; seq < TASKS_PER_PRODUCER; seq++) {
+                auto build = std::make_shared<SyntheticBuild>();
+                build->id = p * IDS_PER_PRODUCER + seq % IDS_PER_PRODUCER;
+                build->producer = p;
+                build->seq = seq;
+                build->payload.resize(PAYLOAD_BYTES);
+                std::memcpy(build->payload.data(), source.data(), PAYLOAD_BYTES);
+
+                auto handoffStart = Clock::now();
+                if (ingest) {
+                    ingestQueue.push(std::move(build));
+                } else {
+                    std::unique_lock<std::mutex> lock(scheduler.mutex);
+                    scheduler.accept(std::move(build));
+                }
+                handoffUs[p] += std::chrono::duration<double, std::micro>(Clock::now() - handoffStart).count();
+            }
+            finishedProducers++;
+        });
+    }
+    for (auto &thread : threads) { thread.join(); }
+    render.join();
+
+    Result result;
+    result.totalMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    result.handoffUs = 0.0;
+    for (double us : handoffUs) { result.handoffUs += us; }
+    result.handoffUs /= producers * TASKS_PER_PRODUCER;
+    result.ok = verify(scheduler, producers);
+    benchKeep(scheduler.queuedIndex.size());
+    return result;
+}
+
+// replays synthetic chunk builds from several producer threads, the mutex-serialized handoff against the ingest queue.
+// us/task is what a producer thread spends handing a build over, ms is the wall time until the scheduler accepted
+// everything, which for the ingest queue includes waiting for the next frame to drain it
+int main() {
+    std::cout << std::setw(10) << "producers" << std::setw(18) << "locked us/task" << std::setw(18)
+              << "ingest us/task" << std::setw(14) << "locked ms" << std::setw(14) << "ingest ms" << std::setw(8)
+              << "order" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+
+    bool ok = true;
+    for (uint32_t producers : {1u, 2u, 4u, 8u}) {
+        Result locked = run(producers, false);
+        Result ingest = run(producers, true);
+        ok = ok && locked.ok && ingest.ok;
+        std::cout << std::setw(10) << producers << std::setw(18) << locked.handoffUs << std::setw(18)
+                  << ingest.handoffUs << std::setw(14) << locked.totalMs << std::setw(14) << ingest.totalMs
+                  << std::setw(8) << (locked.ok && ingest.ok ? "ok" : "FAILED") << std::endl;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+#include "bench/bench.hpp"
+#include "core/render/vertex_convert.hpp"
+#include "tests/vertex_convert_reference.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using vk::VertexFormat::PBRTriangle;
+
+static const char *formatName(World::VertexFormats format) {
+    switch (format) {
+        case World::POSITION_COLOR_TEXTURE_LIGHT_NORMAL: return "POSITION_COLOR_TEXTURE_LIGHT_NORMAL";
+        case World::POSITION_COLOR_TEXTURE_OVERLAY_LIGHT_NORMAL: return "POSITION_COLOR_TEXTURE_OVERLAY_LIGHT_NORMAL";
+        case World::POSITION_TEXTURE_COLOR_LIGHT: return "POSITION_TEXTURE_COLOR_LIGHT";
+        case World::POSITION: return "POSITION";
+        case World::POSITION_COLOR: return "POSITION_COLOR";
+        case World::LINES: return "LINES";
+        case World::POSITION_COLOR_LIGHT: return "POSITION_COLOR_LIGHT";
+        case World::POSITION_TEXTURE: return "POSITION_TEXTURE";
+        case World::POSITION_TEXTURE_COLOR: return "POSITION_TEXTURE_COLOR";
+        case World::POSITION_COLOR_TEXTURE_LIGHT: return "POSITION_COLOR_TEXTURE_LIGHT";
+        case World::POSITION_TEXTURE_LIGHT_COLOR: return "POSITION_TEXTURE_LIGHT_COLOR";
+        case World::POSITION_TEXTURE_COLOR_NORMAL: return "POSITION_TEXTURE_COLOR_NORMAL";
+        case World::PBR_TRIANGLE: return "PBR_TRIANGLE";
+        default: return "UNKNOWN";
+    }
+}
+
+static uint64_t checksum(const std::vector<PBRTriangle> &vertices) {
+    uint64_t sum = 0;
+    for (auto &v : vertices) {
+        uint32_t bits;
+        std::memcpy(&bits, &v.colorLayer.x, sizeof(bits));
+        sum += bits + v.textureID + v.lightUV.x;
+    }
+    return sum;
+}
+
+static const char *isaName(VertexConvert::Isa isa) {
+    switch (isa) {
+        case VertexConvert::Isa::Scalar: return "scalar";
+        case VertexConvert::Isa::SSE41: return "sse4.1";
+        case VertexConvert::Isa::AVX2: return "avx2";
+        default: return "unknown";
+    }
+}
+
+// converts one entity sized batch over and over, the old per-vertex switch next to every batch converter path the cpu
+// can run. the speedup is the one of the path toPBRTriangles picks
+int main() {
+    constexpr uint32_t VERTEX_COUNT = 1 << 16;
+    constexpr int RUNS = 30;
+
+    std::mt19937 rng(17);
+    std::vector<uint8_t> src(VERTEX_COUNT * sizeof(PBRTriangle));
+    for (auto &byte : src) { byte = static_cast<uint8_t>(rng()); }
+    std::vector<PBRTriangle> dst(VERTEX_COUNT);
+
+    std::vector<VertexConvert::Isa> isas;
+    for (auto isa : {VertexConvert::Isa::Scalar, VertexConvert::Isa::SSE41, VertexConvert::Isa::AVX2}) {
+        if (isa <= VertexConvert::bestIsa()) isas.push_back(isa);
+    }
+
+    std::cout << std::left << std::setw(46) << "format" << std::right << std::setw(14) << "switch ns/v";
+    for (auto isa : isas) { std::cout << std::setw(14) << (std::string(isaName(isa)) + " ns/v"); }
+    std::cout << std::setw(10) << "speedup" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    for (int i = 0; i < World::NUM_VERTEX_FORMATS; i++) {
+        auto format = static_cast<World::VertexFormats>(i);
+
+        double switchMs = benchMs(RUNS, [&] {
+            for (uint32_t j = 0; j < VERTEX_COUNT; j++) {
+                dst[j] = VertexConvertReference::convertVertex(format, src.data(), j, 3);
+            }
+        });
+        benchKeep(checksum(dst));
+
+        std::vector<double> batchMs;
+        for (auto isa : isas) {
+            batchMs.push_back(benchMs(RUNS, [&] {
+                // the converters expect zero-initialized entries, entities.cpp resizes a fresh vector the same way
+                std::fill(dst.begin(), dst.end(), PBRTriangle{});
+                VertexConvert::toPBRTriangles(isa, format, src.data(), VERTEX_COUNT, 3, dst.data());
+            }));
+            benchKeep(checksum(dst));
+        }
+
+        std::cout << std::left << std::setw(46) << formatName(format) << std::right << std::setw(14)
+                  << switchMs * 1e6 / VERTEX_COUNT;
+        for (double ms : batchMs) { std::cout << std::setw(14) << ms * 1e6 / VERTEX_COUNT; }
+        std::cout << std::setw(9) << switchMs / batchMs.back() << "x" << std::endl;
+    }
+    return 0;
+}
@@ -143,6 +143,32 @@ namespace VertexFormat {
         T_VEC3 postBase;
         T_UINT pad1;
     };
+
+    // per-geometry constants of compact terrain geometry, stored right in front of its TerrainVertex entries
+    struct TerrainGeometryHeader {
+        T_UINT useNorm;
+        T_UINT useColorLayer;
+        T_UINT useTexture;
+        T_UINT useOverlay;
+
+        T_IVEC2 overlayUV;
+        T_UINT useGlint;
+        T_UINT glintTexture;
+
+        T_UINT coordinate;
+        T_UINT pad0;
+        T_UINT pad1;
+        T_UINT pad2;
+    };
+
+    struct TerrainVertex {
+        T_VEC3 pos;
+        T_UINT colorLayer; // rgba8 unorm
+
+        T_VEC2 textureUV;
+        T_UINT textureID;
+        T_UINT normEmission; // octahedral normal as snorm8x2, albedoEmission as half in the upper 16 bits
+    };
 #ifdef __cplusplus
 }; // namespace VertexFormat
 #endif
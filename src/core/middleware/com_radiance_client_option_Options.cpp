@@ -1,6 +1,8 @@
 #include "com_radiance_client_option_Options.h"
 
 #include "core/all_extern.hpp"
+#include "core/middleware/jni_exports.hpp"
+#include "core/middleware/jni_trace.hpp"
 #include "core/render/buffers.hpp"
 #include "core/render/chunks.hpp"
 #include "core/render/render_framework.hpp"
@@ -12,6 +14,7 @@ JNIEXPORT void JNICALL Java_com_radiance_client_option_Options_nativeSetMaxFps(J
                                                                                jclass,
                                                                                jint maxFps,
                                                                                jboolean write) {
+    JniTrace::record(JniTrace::Call::OptionsSetMaxFps, maxFps, write);
     Renderer::options.maxFps = maxFps;
 }
 
@@ -19,6 +22,7 @@ JNIEXPORT void JNICALL Java_com_radiance_client_option_Options_nativeSetInactivi
                                                                                            jclass,
                                                                                            jint inactivityFpsLimit,
                                                                                            jboolean write) {
+    JniTrace::record(JniTrace::Call::OptionsSetInactivityFpsLimit, inactivityFpsLimit, write);
     Renderer::options.inactivityFpsLimit = inactivityFpsLimit;
 }
 
@@ -26,18 +30,41 @@ JNIEXPORT void JNICALL Java_com_radiance_client_option_Options_nativeSetVsync(JN
                                                                               jclass,
                                                                               jboolean vsync,
                                                                               jboolean write) {
+    JniTrace::record(JniTrace::Call::OptionsSetVsync, vsync, write);
     Renderer::options.vsync = vsync;
     if (write) Renderer::options.needRecreate = true;
 }
 
 JNIEXPORT void JNICALL Java_com_radiance_client_option_Options_nativeSetChunkBuildingBatchSize(
     JNIEnv *, jclass, jint chunkBuildingBatchSize, jboolean write) {
+    JniTrace::record(JniTrace::Call::OptionsSetChunkBuildingBatchSize, chunkBuildingBatchSize, write);
     Renderer::options.chunkBuildingBatchSize = chunkBuildingBatchSize;
     if (write) Renderer::instance().world()->chunks()->resetScheduler();
 }
 
 JNIEXPORT void JNICALL Java_com_radiance_client_option_Options_nativeSetChunkBuildingTotalBatches(
     JNIEnv *, jclass, jint chunkBuildingTotalBatches, jboolean write) {
+    JniTrace::record(JniTrace::Call::OptionsSetChunkBuildingTotalBatches, chunkBuildingTotalBatches, write);
     Renderer::options.chunkBuildingTotalBatches = chunkBuildingTotalBatches;
     if (write) Renderer::instance().world()->chunks()->resetScheduler();
 }
+
+extern "C" {
+JNIEXPORT void JNICALL Java_com_radiance_client_option_Options_nativeSetGpuProfiler(JNIEnv *,
+                                                                                    jclass,
+                                                                                    jboolean gpuProfiler,
+                                                                                    jboolean write) {
+    JniTrace::record(JniTrace::Call::OptionsSetGpuProfiler, gpuProfiler, write);
+    Renderer::options.gpuProfiler = gpuProfiler;
+    if (write && !gpuProfiler) Renderer::instance().framework()->gpuProfiler()->clear();
+}
+
+JNIEXPORT void JNICALL Java_com_radiance_client_option_Options_nativeSetChunkGeometrySpill(JNIEnv *,
+                                                                                           jclass,
+                                                                                           jboolean chunkGeometrySpill,
+                                                                                           jboolean write) {
+    JniTrace::record(JniTrace::Call::OptionsSetChunkGeometrySpill, chunkGeometrySpill, write);
+    // chunks keep the spill they were built with until they are rebuilt
+    Renderer::options.chunkGeometrySpill = chunkGeometrySpill;
+}
+}
@@ -1,18 +1,53 @@
 #include "com_radiance_client_pipeline_Pipeline.h"
 
+#include "core/middleware/jni_trace.hpp"
 #include "core/render/pipeline.hpp"
 #include "core/render/render_framework.hpp"
 #include "core/render/renderer.hpp"
 
+#include <algorithm>
 #include <iostream>
 
+// flattened as the module count, then per module its name, attributes, input and output indices, then the formats
+// of the images the indices refer to
+static void traceBuildParams(WorldPipelineBuildParams *params) {
+    JniTrace::Record record(JniTrace::Call::PipelineBuildNative);
+    record << params->moduleCount;
+
+    int imageCount = 0;
+    for (int i = 0; i < params->moduleCount; i++) {
+        std::string moduleName = params->moduleNames[i];
+        record << moduleName << params->attributeCounts[i];
+        for (int j = 0; j < 2 * params->attributeCounts[i]; j++) {
+            record << std::string{params->attributeKVs[i][j]};
+        }
+
+        auto [inputImageNum, outputImageNum] = Pipeline::worldModuleInOutImageNums[moduleName];
+        record << inputImageNum;
+        for (int j = 0; j < inputImageNum; j++) {
+            record << params->inputIndices[i][j];
+            imageCount = std::max(imageCount, params->inputIndices[i][j] + 1);
+        }
+        record << outputImageNum;
+        for (int j = 0; j < outputImageNum; j++) {
+            record << params->outputIndices[i][j];
+            imageCount = std::max(imageCount, params->outputIndices[i][j] + 1);
+        }
+    }
+
+    record << imageCount;
+    for (int i = 0; i < imageCount; i++) record << params->imageFormats[i];
+}
+
 JNIEXPORT void JNICALL Java_com_radiance_client_pipeline_Pipeline_buildNative(JNIEnv *, jclass, jlong paramsLongPtr) {
     WorldPipelineBuildParams *params = reinterpret_cast<WorldPipelineBuildParams *>(paramsLongPtr);
+    if (JniTrace::capturing()) traceBuildParams(params);
     auto pipeline = Renderer::instance().framework()->pipeline();
     if (pipeline != nullptr) Renderer::instance().framework()->pipeline()->buildWorldPipelineBlueprint(params);
 }
 
 JNIEXPORT void JNICALL Java_com_radiance_client_pipeline_Pipeline_collectNativeModules(JNIEnv *, jclass) {
+    JniTrace::record(JniTrace::Call::PipelineCollectNativeModules);
     Pipeline::collectWorldModules();
 }
 
@@ -1,10 +1,12 @@
 #include "com_radiance_client_proxy_vulkan_BufferProxy.h"
 
+#include "core/middleware/jni_trace.hpp"
 #include "core/render/buffers.hpp"
 #include "core/render/render_framework.hpp"
 #include "core/render/renderer.hpp"
 
 JNIEXPORT jint JNICALL Java_com_radiance_client_proxy_vulkan_BufferProxy_allocateBuffer(JNIEnv *, jclass) {
+    JniTrace::record(JniTrace::Call::BufferAllocate);
     auto buffers = Renderer::instance().buffers();
     if (buffers == nullptr)
         return 0;
@@ -14,6 +16,7 @@ JNIEXPORT jint JNICALL Java_com_radiance_client_proxy_vulkan_BufferProxy_allocat
 
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_BufferProxy_initializeBuffer(
     JNIEnv *, jclass, jint id, jint size, jint usageFlags) {
+    JniTrace::record(JniTrace::Call::BufferInitialize, id, size, usageFlags);
     auto buffers = Renderer::instance().buffers();
     if (buffers == nullptr) return;
     buffers->initializeBuffer(id, size, usageFlags);
@@ -21,6 +24,7 @@ JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_BufferProxy_initial
 
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_BufferProxy_buildIndexBuffer(
     JNIEnv *, jclass, jint dstId, jint type, jint drawMode, jint vertexCount, jint expectedIndexCount) {
+    JniTrace::record(JniTrace::Call::BufferBuildIndexBuffer, dstId, type, drawMode, vertexCount, expectedIndexCount);
     auto buffers = Renderer::instance().buffers();
     if (buffers == nullptr) return;
     buffers->buildIndexBuffer(dstId, type, drawMode, vertexCount, expectedIndexCount);
@@ -31,11 +35,16 @@ JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_BufferProxy_queueUp
                                                                                      jlong ptr,
                                                                                      jint dstId) {
     auto buffers = Renderer::instance().buffers();
+    if (JniTrace::capturing()) {
+        uint32_t size = buffers == nullptr ? 0 : buffers->overlayUploadSize(dstId);
+        JniTrace::record(JniTrace::Call::BufferQueueUpload, JniTrace::Blob{reinterpret_cast<void *>(ptr), size}, dstId);
+    }
     if (buffers == nullptr) return;
     buffers->queueOverlayUpload(reinterpret_cast<uint8_t *>(ptr), dstId);
 }
 
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_BufferProxy_performQueuedUpload(JNIEnv *, jclass) {
+    JniTrace::record(JniTrace::Call::BufferPerformQueuedUpload);
     auto buffers = Renderer::instance().buffers();
     if (buffers == nullptr) return;
     buffers->performQueuedUpload();
@@ -44,6 +53,8 @@ JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_BufferProxy_perform
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_BufferProxy_updateOverlayDrawUniform(JNIEnv *,
                                                                                                   jclass,
                                                                                                   jlong ptr) {
+    JniTrace::record(JniTrace::Call::BufferUpdateOverlayDrawUniform,
+                     JniTrace::Blob{reinterpret_cast<void *>(ptr), sizeof(vk::Data::OverlayUBO)});
     auto buffers = Renderer::instance().buffers();
     if (buffers == nullptr) return;
     vk::Data::OverlayUBO *ubo = reinterpret_cast<vk::Data::OverlayUBO *>(ptr);
@@ -53,6 +64,8 @@ JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_BufferProxy_updateO
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_BufferProxy_updateOverlayPostUniform(JNIEnv *,
                                                                                                   jclass,
                                                                                                   jlong ptr) {
+    JniTrace::record(JniTrace::Call::BufferUpdateOverlayPostUniform,
+                     JniTrace::Blob{reinterpret_cast<void *>(ptr), sizeof(vk::Data::OverlayPostUBO)});
     auto buffers = Renderer::instance().buffers();
     if (buffers == nullptr) return;
     vk::Data::OverlayPostUBO *ubo = reinterpret_cast<vk::Data::OverlayPostUBO *>(ptr);
@@ -87,6 +100,8 @@ JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_BufferProxy_updateO
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_BufferProxy_updateWorldUniform(JNIEnv *,
                                                                                             jclass,
                                                                                             jlong ptr) {
+    JniTrace::record(JniTrace::Call::BufferUpdateWorldUniform,
+                     JniTrace::Blob{reinterpret_cast<void *>(ptr), sizeof(vk::Data::WorldUBO)});
     auto buffers = Renderer::instance().buffers();
     if (buffers == nullptr) return;
     vk::Data::WorldUBO *ubo = reinterpret_cast<vk::Data::WorldUBO *>(ptr);
@@ -94,6 +109,8 @@ JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_BufferProxy_updateW
 }
 
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_BufferProxy_updateSkyUniform(JNIEnv *, jclass, jlong ptr) {
+    JniTrace::record(JniTrace::Call::BufferUpdateSkyUniform,
+                     JniTrace::Blob{reinterpret_cast<void *>(ptr), sizeof(vk::Data::SkyUBO)});
     auto buffers = Renderer::instance().buffers();
     if (buffers == nullptr) return;
     vk::Data::SkyUBO *ubo = reinterpret_cast<vk::Data::SkyUBO *>(ptr);
@@ -101,6 +118,8 @@ JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_BufferProxy_updateS
 }
 
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_BufferProxy_updateMapping(JNIEnv *, jclass, jlong ptr) {
+    JniTrace::record(JniTrace::Call::BufferUpdateMapping,
+                     JniTrace::Blob{reinterpret_cast<void *>(ptr), sizeof(vk::Data::TextureMapping)});
     auto buffers = Renderer::instance().buffers();
     if (buffers == nullptr) return;
     vk::Data::TextureMapping *mapping = reinterpret_cast<vk::Data::TextureMapping *>(ptr);
@@ -110,6 +129,8 @@ JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_BufferProxy_updateM
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_BufferProxy_updateLightMapUniform(JNIEnv *,
                                                                                                jclass,
                                                                                                jlong ptr) {
+    JniTrace::record(JniTrace::Call::BufferUpdateLightMapUniform,
+                     JniTrace::Blob{reinterpret_cast<void *>(ptr), sizeof(vk::Data::LightMapUBO)});
     auto buffers = Renderer::instance().buffers();
     if (buffers == nullptr) return;
     vk::Data::LightMapUBO *lightMapUBO = reinterpret_cast<vk::Data::LightMapUBO *>(ptr);
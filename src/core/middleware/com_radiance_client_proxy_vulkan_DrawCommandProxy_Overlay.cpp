@@ -1,5 +1,6 @@
 #include "com_radiance_client_proxy_vulkan_DrawCommandProxy_Overlay.h"
 
+#include "core/middleware/jni_trace.hpp"
 #include "core/render/modules/ui_module.hpp"
 #include "core/render/pipeline.hpp"
 #include "core/render/render_framework.hpp"
@@ -8,6 +9,7 @@
 extern "C" {
 JNIEXPORT void JNICALL
 Java_com_radiance_client_proxy_vulkan_DrawCommandProxy_00024Overlay_vkCmdClearEntireColorAttachment(JNIEnv *, jclass) {
+    JniTrace::record(JniTrace::Call::OverlayClearEntireColorAttachment);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     auto context = framework->safeAcquireCurrentContext();
@@ -18,6 +20,7 @@ Java_com_radiance_client_proxy_vulkan_DrawCommandProxy_00024Overlay_vkCmdClearEn
 JNIEXPORT void JNICALL
 Java_com_radiance_client_proxy_vulkan_DrawCommandProxy_00024Overlay_vkCmdClearEntireDepthStencilAttachment(
     JNIEnv *, jclass, jint aspectMask) {
+    JniTrace::record(JniTrace::Call::OverlayClearEntireDepthStencilAttachment, aspectMask);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     auto context = framework->safeAcquireCurrentContext();
@@ -1,5 +1,6 @@
 #include "com_radiance_client_proxy_vulkan_PipelineStateProxy_ClearState.h"
 
+#include "core/middleware/jni_trace.hpp"
 #include "core/render/modules/ui_module.hpp"
 #include "core/render/pipeline.hpp"
 #include "core/render/render_framework.hpp"
@@ -9,6 +10,7 @@
 extern "C" {
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024ClearState_setClearColor(
     JNIEnv *, jclass, jfloat red, jfloat green, jfloat blue, jfloat alpha) {
+    JniTrace::record(JniTrace::Call::ClearStateSetClearColor, red, green, blue, alpha);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     auto context = framework->safeAcquireCurrentContext();
@@ -18,6 +20,7 @@ JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_
 
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024ClearState_setClearDepth(
     JNIEnv *, jclass, jdouble depth) {
+    JniTrace::record(JniTrace::Call::ClearStateSetClearDepth, depth);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     auto context = framework->safeAcquireCurrentContext();
@@ -27,6 +30,7 @@ JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_
 
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024ClearState_setClearStencil(
     JNIEnv *, jclass, jint stencil) {
+    JniTrace::record(JniTrace::Call::ClearStateSetClearStencil, stencil);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     auto context = framework->safeAcquireCurrentContext();
@@ -1,5 +1,6 @@
 #include "com_radiance_client_proxy_vulkan_PipelineStateProxy_ColorBlendState.h"
 
+#include "core/middleware/jni_trace.hpp"
 #include "core/render/modules/ui_module.hpp"
 #include "core/render/pipeline.hpp"
 #include "core/render/render_framework.hpp"
@@ -9,6 +10,7 @@ extern "C" {
 
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024ColorBlendState_setBlendEnable(
     JNIEnv *, jclass, jboolean enable) {
+    JniTrace::record(JniTrace::Call::ColorBlendStateSetBlendEnable, enable);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     auto context = framework->safeAcquireCurrentContext();
@@ -19,6 +21,7 @@ JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_
 JNIEXPORT void JNICALL
 Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024ColorBlendState_setColorBlendConstants(
     JNIEnv *, jclass, jfloat const1, jfloat const2, jfloat const3, jfloat const4) {
+    JniTrace::record(JniTrace::Call::ColorBlendStateSetColorBlendConstants, const1, const2, const3, const4);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     auto context = framework->safeAcquireCurrentContext();
@@ -30,6 +33,7 @@ JNIEXPORT void JNICALL
 Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024ColorBlendState_setColorLogicOpEnable(JNIEnv *,
                                                                                                     jclass,
                                                                                                     jboolean enable) {
+    JniTrace::record(JniTrace::Call::ColorBlendStateSetColorLogicOpEnable, enable);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     auto context = framework->safeAcquireCurrentContext();
@@ -45,6 +49,8 @@ Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024ColorBlendState_vk
     jint srcAlphaBlendFactor,
     jint dstColorBlendFactor,
     jint dstAlphaBlendFactor) {
+    JniTrace::record(JniTrace::Call::ColorBlendStateSetBlendFuncSeparate, srcColorBlendFactor, srcAlphaBlendFactor,
+                     dstColorBlendFactor, dstAlphaBlendFactor);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     auto context = framework->safeAcquireCurrentContext();
@@ -58,6 +64,7 @@ Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024ColorBlendState_vk
                                                                                                    jclass,
                                                                                                    jint colorBlendOp,
                                                                                                    jint alphaBlendOp) {
+    JniTrace::record(JniTrace::Call::ColorBlendStateSetBlendOpSeparate, colorBlendOp, alphaBlendOp);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     auto context = framework->safeAcquireCurrentContext();
@@ -69,6 +76,7 @@ JNIEXPORT void JNICALL
 Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024ColorBlendState_vkSetColorWriteMask(JNIEnv *,
                                                                                                   jclass,
                                                                                                   jint colorWriteMask) {
+    JniTrace::record(JniTrace::Call::ColorBlendStateSetColorWriteMask, colorWriteMask);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     auto context = framework->safeAcquireCurrentContext();
@@ -78,6 +86,7 @@ Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024ColorBlendState_vk
 
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024ColorBlendState_vkSetColorLogicOp(
     JNIEnv *, jclass, jint colorLogicOp) {
+    JniTrace::record(JniTrace::Call::ColorBlendStateSetColorLogicOp, colorLogicOp);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     auto context = framework->safeAcquireCurrentContext();
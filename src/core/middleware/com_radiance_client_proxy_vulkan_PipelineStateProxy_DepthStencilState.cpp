@@ -1,5 +1,6 @@
 #include "com_radiance_client_proxy_vulkan_PipelineStateProxy_DepthStencilState.h"
 
+#include "core/middleware/jni_trace.hpp"
 #include "core/render/modules/ui_module.hpp"
 #include "core/render/pipeline.hpp"
 #include "core/render/render_framework.hpp"
@@ -10,6 +11,7 @@ JNIEXPORT void JNICALL
 Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_setDepthTestEnable(JNIEnv *,
                                                                                                    jclass,
                                                                                                    jboolean enable) {
+    JniTrace::record(JniTrace::Call::DepthStencilStateSetDepthTestEnable, enable);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     auto context = framework->safeAcquireCurrentContext();
@@ -21,6 +23,7 @@ JNIEXPORT void JNICALL
 Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_setDepthWriteEnable(JNIEnv *,
                                                                                                     jclass,
                                                                                                     jboolean enable) {
+    JniTrace::record(JniTrace::Call::DepthStencilStateSetDepthWriteEnable, enable);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     auto context = framework->safeAcquireCurrentContext();
@@ -32,6 +35,7 @@ JNIEXPORT void JNICALL
 Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_setStencilTestEnable(JNIEnv *,
                                                                                                      jclass,
                                                                                                      jboolean enable) {
+    JniTrace::record(JniTrace::Call::DepthStencilStateSetStencilTestEnable, enable);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     auto context = framework->safeAcquireCurrentContext();
@@ -42,6 +46,7 @@ Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_
 JNIEXPORT void JNICALL
 Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_vkSetDepthCompareOp(
     JNIEnv *, jclass, jint depthCompareOp) {
+    JniTrace::record(JniTrace::Call::DepthStencilStateSetDepthCompareOp, depthCompareOp);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     auto context = framework->safeAcquireCurrentContext();
@@ -52,6 +57,7 @@ Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_
 JNIEXPORT void JNICALL
 Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_vkSetStencilFrontFunc(
     JNIEnv *, jclass, jint compareOp, jint reference, jint compareMask) {
+    JniTrace::record(JniTrace::Call::DepthStencilStateSetStencilFrontFunc, compareOp, reference, compareMask);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     auto context = framework->safeAcquireCurrentContext();
@@ -62,6 +68,7 @@ Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_
 JNIEXPORT void JNICALL
 Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_vkSetStencilBackFunc(
     JNIEnv *, jclass, jint compareOp, jint reference, jint compareMask) {
+    JniTrace::record(JniTrace::Call::DepthStencilStateSetStencilBackFunc, compareOp, reference, compareMask);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     auto context = framework->safeAcquireCurrentContext();
@@ -72,6 +79,7 @@ Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_
 JNIEXPORT void JNICALL
 Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_vkSetStencilFrontOp(
     JNIEnv *, jclass, jint failOp, jint depthFailOp, jint passOp) {
+    JniTrace::record(JniTrace::Call::DepthStencilStateSetStencilFrontOp, failOp, depthFailOp, passOp);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     auto context = framework->safeAcquireCurrentContext();
@@ -82,6 +90,7 @@ Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_
 JNIEXPORT void JNICALL
 Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_vkSetStencilBackOp(
     JNIEnv *, jclass, jint failOp, jint depthFailOp, jint passOp) {
+    JniTrace::record(JniTrace::Call::DepthStencilStateSetStencilBackOp, failOp, depthFailOp, passOp);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     auto context = framework->safeAcquireCurrentContext();
@@ -92,6 +101,7 @@ Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_
 JNIEXPORT void JNICALL
 Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_vkSetStencilFrontWriteMask(
     JNIEnv *, jclass, jint writeMask) {
+    JniTrace::record(JniTrace::Call::DepthStencilStateSetStencilFrontWriteMask, writeMask);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     auto context = framework->safeAcquireCurrentContext();
@@ -102,6 +112,7 @@ Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_
 JNIEXPORT void JNICALL
 Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_vkSetStencilBackWriteMask(
     JNIEnv *, jclass, jint writeMask) {
+    JniTrace::record(JniTrace::Call::DepthStencilStateSetStencilBackWriteMask, writeMask);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     auto context = framework->safeAcquireCurrentContext();
@@ -1,6 +1,8 @@
 #include "com_radiance_client_proxy_vulkan_RendererProxy.h"
 
 #include "core/all_extern.hpp"
+#include "core/middleware/jni_exports.hpp"
+#include "core/middleware/jni_trace.hpp"
 #include "core/render/buffers.hpp"
 #include "core/render/modules/ui_module.hpp"
 #include "core/render/pipeline.hpp"
@@ -105,6 +107,10 @@ JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_initF
     env->ReleaseStringUTFChars(folderPath, nativeString);
 
     Renderer::folderPath = std::filesystem::path(pathStr);
+
+    // the first call of a session, a capture started here contains everything a replay needs
+    JniTrace::startFromEnvironment();
+    JniTrace::record(JniTrace::Call::RendererInitFolderPath, pathStr);
 }
 
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_initRenderer(JNIEnv *env,
@@ -122,8 +128,23 @@ JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_initR
 
     GLFWwindow *window = (GLFWwindow *)(intptr_t)windowHandle;
     Renderer::init(window);
+    if (JniTrace::capturing()) {
+        VkExtent2D extent = Renderer::instance().framework()->swapchain()->vkExtent();
+        JniTrace::record(JniTrace::Call::RendererInit, extent.width, extent.height);
+    }
+    Renderer::instance().framework()->acquireContext();
+}
+
+extern "C" {
+JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_initHeadlessRenderer(JNIEnv *,
+                                                                                                jclass,
+                                                                                                jint width,
+                                                                                                jint height) {
+    Renderer::init(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+    JniTrace::record(JniTrace::Call::RendererInit, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
     Renderer::instance().framework()->acquireContext();
 }
+}
 
 JNIEXPORT jint JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_maxSupportedTextureSize(JNIEnv *, jclass) {
     auto maxImageSize = Renderer::instance().framework()->physicalDevice()->properties().limits.maxImageDimension2D;
@@ -131,18 +152,21 @@ JNIEXPORT jint JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_maxSu
 }
 
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_acquireContext(JNIEnv *, jclass) {
+    JniTrace::record(JniTrace::Call::RendererAcquireContext);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     framework->acquireContext();
 }
 
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_submitCommand(JNIEnv *, jclass) {
+    JniTrace::record(JniTrace::Call::RendererSubmitCommand);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     framework->submitCommand();
 }
 
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_present(JNIEnv *, jclass) {
+    JniTrace::record(JniTrace::Call::RendererPresent);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     framework->present();
@@ -150,18 +174,27 @@ JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_prese
 
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_drawOverlay(
     JNIEnv *, jclass, jint vertexId, jint indexId, jint pipelineType, jint indexCount, jint indexType) {
+    JniTrace::record(JniTrace::Call::RendererDrawOverlay, vertexId, indexId, pipelineType, indexCount, indexType);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
-    auto vertexBuffer = Renderer::instance().buffers()->getBuffer(vertexId);
-    auto indexBuffer = Renderer::instance().buffers()->getBuffer(indexId);
+    auto buffers = Renderer::instance().buffers();
+    auto vertexRange = buffers->getBuffer(vertexId);
     auto context = framework->safeAcquireCurrentContext();
     auto pipelineContext = framework->pipeline()->acquirePipelineContext(context);
-    pipelineContext->uiModuleContext->drawIndexed(vertexBuffer, indexBuffer,
-                                                  static_cast<OverlayDrawPipelineType>(pipelineType), indexCount,
-                                                  static_cast<VkIndexType>(indexType));
+    if (buffers->isQuadIndexBuffer(indexId)) {
+        pipelineContext->uiModuleContext->drawQuads(vertexRange.buffer, vertexRange.offset,
+                                                    static_cast<OverlayDrawPipelineType>(pipelineType), indexCount);
+    } else {
+        auto indexRange = buffers->getBuffer(indexId);
+        pipelineContext->uiModuleContext->drawIndexed(vertexRange.buffer, vertexRange.offset, indexRange.buffer,
+                                                      indexRange.offset,
+                                                      static_cast<OverlayDrawPipelineType>(pipelineType), indexCount,
+                                                      static_cast<VkIndexType>(indexType));
+    }
 }
 
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_fuseWorld(JNIEnv *, jclass) {
+    JniTrace::record(JniTrace::Call::RendererFuseWorld);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     auto context = framework->safeAcquireCurrentContext();
@@ -170,6 +203,7 @@ JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_fuseW
 }
 
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_postBlur(JNIEnv *, jclass) {
+    JniTrace::record(JniTrace::Call::RendererPostBlur);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     auto world = Renderer::instance().world();
@@ -180,6 +214,8 @@ JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_postB
 }
 
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_close(JNIEnv *, jclass) {
+    JniTrace::record(JniTrace::Call::RendererClose);
+    JniTrace::stop();
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     Renderer::instance().close();
@@ -187,6 +223,7 @@ JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_close
 
 JNIEXPORT void JNICALL
 Java_com_radiance_client_proxy_vulkan_RendererProxy_shouldRenderWorld(JNIEnv *, jclass, jboolean shouldRenderWorld) {
+    JniTrace::record(JniTrace::Call::RendererShouldRenderWorld, shouldRenderWorld);
     auto world = Renderer::instance().world();
     if (world == nullptr) return;
     world->shouldRender() = shouldRenderWorld;
@@ -194,7 +231,113 @@ Java_com_radiance_client_proxy_vulkan_RendererProxy_shouldRenderWorld(JNIEnv *,
 
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_takeScreenshot(
     JNIEnv *, jclass, jboolean withUI, jint width, jint height, jint channel, jlong pointer) {
+    JniTrace::record(JniTrace::Call::RendererTakeScreenshot, withUI, width, height, channel);
     auto framework = Renderer::instance().framework();
     if (framework == nullptr) return;
     framework->takeScreenshot(withUI, width, height, channel, reinterpret_cast<void *>(pointer));
 }
+
+extern "C" {
+// the id is handed back by pollScreenshot once the frame that copies the image completed, 0 for an invalid size
+JNIEXPORT jlong JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_requestScreenshot(
+    JNIEnv *, jclass, jboolean withUI, jint width, jint height, jint channel) {
+    JniTrace::record(JniTrace::Call::RendererRequestScreenshot, withUI, width, height, channel);
+    auto framework = Renderer::instance().framework();
+    if (framework == nullptr) return 0;
+    return framework->readback()->request(withUI, width, height, channel);
+}
+
+JNIEXPORT jlong JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_requestScreenshotFile(JNIEnv *env,
+                                                                                                  jclass,
+                                                                                                  jboolean withUI,
+                                                                                                  jstring path) {
+    auto framework = Renderer::instance().framework();
+    const char *file = env->GetStringUTFChars(path, nullptr);
+    JniTrace::record(JniTrace::Call::RendererRequestScreenshotFile, withUI, std::string(file));
+    jlong id = framework == nullptr ? 0 : framework->readback()->requestFile(withUI, file);
+    env->ReleaseStringUTFChars(path, file);
+    return id;
+}
+
+// copies the oldest completed request into the pointer and returns its id, -id for a dropped request and 0 when none
+// completed yet
+JNIEXPORT jlong JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_pollScreenshot(JNIEnv *,
+                                                                                           jclass,
+                                                                                           jlong pointer) {
+    auto framework = Renderer::instance().framework();
+    if (framework == nullptr) return 0;
+    return framework->readback()->poll(reinterpret_cast<void *>(pointer));
+}
+}
+
+extern "C" {
+JNIEXPORT jobjectArray JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_gpuProfileZones(JNIEnv *env,
+                                                                                                   jclass) {
+    auto framework = Renderer::instance().framework();
+    auto stats = framework == nullptr ? std::vector<GpuProfiler::ZoneStats>{} : framework->gpuProfiler()->stats();
+
+    jobjectArray zones = env->NewObjectArray(stats.size(), env->FindClass("java/lang/String"), nullptr);
+    for (int i = 0; i < stats.size(); i++) {
+        jstring name = env->NewStringUTF(stats[i].name.c_str());
+        env->SetObjectArrayElement(zones, i, name);
+        env->DeleteLocalRef(name);
+    }
+    return zones;
+}
+
+// average, p50, p95, p99 and max in milliseconds for each zone, in the order of gpuProfileZones
+JNIEXPORT jdoubleArray JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_gpuProfileStats(JNIEnv *env,
+                                                                                                   jclass) {
+    auto framework = Renderer::instance().framework();
+    auto stats = framework == nullptr ? std::vector<GpuProfiler::ZoneStats>{} : framework->gpuProfiler()->stats();
+
+    std::vector<jdouble> values;
+    for (auto &zone : stats) {
+        values.insert(values.end(), {zone.averageMs, zone.p50Ms, zone.p95Ms, zone.p99Ms, zone.maxMs});
+    }
+
+    jdoubleArray result = env->NewDoubleArray(values.size());
+    env->SetDoubleArrayRegion(result, 0, values.size(), values.data());
+    return result;
+}
+
+JNIEXPORT jboolean JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_dumpGpuProfile(JNIEnv *env,
+                                                                                              jclass,
+                                                                                              jstring path) {
+    auto framework = Renderer::instance().framework();
+    if (framework == nullptr) return false;
+
+    const char *file = env->GetStringUTFChars(path, nullptr);
+    bool result = framework->gpuProfiler()->dumpCSV(file);
+    env->ReleaseStringUTFChars(path, file);
+    return result;
+}
+}
+
+extern "C" {
+// issued and filtered overlay state commands of the last frame
+JNIEXPORT jintArray JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_overlayStateStats(JNIEnv *env,
+                                                                                                  jclass) {
+    auto framework = Renderer::instance().framework();
+    auto stats = framework == nullptr ? OverlayStateStats{} : framework->pipeline()->uiModule()->overlayStateStats();
+
+    jint values[] = {static_cast<jint>(stats.issued), static_cast<jint>(stats.filtered)};
+    jintArray result = env->NewIntArray(2);
+    env->SetIntArrayRegion(result, 0, 2, values);
+    return result;
+}
+}
+
+extern "C" {
+// overlay draws requested and draws recorded for them in the last frame
+JNIEXPORT jintArray JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_overlayDrawStats(JNIEnv *env,
+                                                                                                 jclass) {
+    auto framework = Renderer::instance().framework();
+    auto stats = framework == nullptr ? OverlayDrawStats{} : framework->pipeline()->uiModule()->overlayDrawStats();
+
+    jint values[] = {static_cast<jint>(stats.requested), static_cast<jint>(stats.recorded)};
+    jintArray result = env->NewIntArray(2);
+    env->SetIntArrayRegion(result, 0, 2, values);
+    return result;
+}
+}
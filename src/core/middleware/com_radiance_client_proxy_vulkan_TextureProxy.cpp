@@ -1,10 +1,14 @@
 #include "com_radiance_client_proxy_vulkan_TextureProxy.h"
 
+#include "core/middleware/jni_trace.hpp"
 #include "core/render/renderer.hpp"
 #include "core/render/textures.hpp"
 
+#include <algorithm>
+
 extern "C" {
 JNIEXPORT jint JNICALL Java_com_radiance_client_proxy_vulkan_TextureProxy_generateTextureId(JNIEnv *, jclass) {
+    JniTrace::record(JniTrace::Call::TextureGenerateId);
     auto textures = Renderer::instance().textures();
     if (textures == nullptr)
         return 0;
@@ -14,6 +18,7 @@ JNIEXPORT jint JNICALL Java_com_radiance_client_proxy_vulkan_TextureProxy_genera
 
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_TextureProxy_prepareImage(
     JNIEnv *, jclass, jint id, jint maxLevel, jint width, jint height, jint format) {
+    JniTrace::record(JniTrace::Call::TexturePrepareImage, id, maxLevel, width, height, format);
     auto textures = Renderer::instance().textures();
     if (textures == nullptr) return;
     auto vkFormat = static_cast<VkFormat>(format);
@@ -22,6 +27,7 @@ JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_TextureProxy_prepar
 
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_TextureProxy_setFilter(
     JNIEnv *, jclass, jint id, jint samplingMode, jint mipmapMode) {
+    JniTrace::record(JniTrace::Call::TextureSetFilter, id, samplingMode, mipmapMode);
     auto textures = Renderer::instance().textures();
     if (textures == nullptr) return;
     auto vkSamplingMode = static_cast<VkFilter>(samplingMode);
@@ -33,6 +39,7 @@ JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_TextureProxy_setCla
                                                                                    jclass,
                                                                                    jint id,
                                                                                    jint addressMode) {
+    JniTrace::record(JniTrace::Call::TextureSetClamp, id, addressMode);
     auto textures = Renderer::instance().textures();
     if (textures == nullptr) return;
     auto vkSamplerAddressMode = static_cast<VkSamplerAddressMode>(addressMode);
@@ -52,6 +59,9 @@ JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_TextureProxy_queueU
                                                                                       jint width,
                                                                                       jint height,
                                                                                       jint level) {
+    JniTrace::Blob src{reinterpret_cast<void *>(srcPointer), static_cast<uint64_t>(std::max(srcSizeInBytes, 0))};
+    JniTrace::record(JniTrace::Call::TextureQueueUpload, src, srcSizeInBytes, srcRowPixels, dstId, srcOffsetX,
+                     srcOffsetY, dstOffsetX, dstOffsetY, width, height, level);
     auto textures = Renderer::instance().textures();
     if (textures == nullptr) return;
     textures->queueUpload(reinterpret_cast<uint8_t *>(srcPointer), srcSizeInBytes, srcRowPixels, dstId, srcOffsetX,
@@ -59,6 +69,7 @@ JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_TextureProxy_queueU
 }
 
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_TextureProxy_performQueuedUpload(JNIEnv *, jclass) {
+    JniTrace::record(JniTrace::Call::TexturePerformQueuedUpload);
     auto textures = Renderer::instance().textures();
     if (textures == nullptr) return;
     textures->performQueuedUpload();
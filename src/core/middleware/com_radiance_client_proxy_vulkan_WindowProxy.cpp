@@ -1,9 +1,11 @@
 #include "com_radiance_client_proxy_vulkan_WindowProxy.h"
 
 #include "core/all_extern.hpp"
+#include "core/middleware/jni_trace.hpp"
 #include "core/vulkan/window.hpp"
 
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_WindowProxy_onFramebufferSizeChanged(JNIEnv *,
                                                                                                             jclass) {
+    JniTrace::record(JniTrace::Call::WindowFramebufferSizeChanged);
     vk::Window::framebufferResized = true;
 }
\ No newline at end of file
@@ -1,11 +1,15 @@
 #include "com_radiance_client_proxy_world_ChunkProxy.h"
 
+#include "core/middleware/jni_exports.hpp"
+#include "core/middleware/jni_trace.hpp"
 #include "core/render/chunks.hpp"
 #include "core/render/renderer.hpp"
 
+#include <algorithm>
 #include <iostream>
 
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_world_ChunkProxy_initNative(JNIEnv *, jclass, jint chunkNum) {
+    JniTrace::record(JniTrace::Call::ChunkInitNative, chunkNum);
     Renderer::instance().world()->chunks()->reset(chunkNum);
 }
 
@@ -22,6 +26,20 @@ JNIEXPORT void JNICALL Java_com_radiance_client_proxy_world_ChunkProxy_rebuildSi
                                                                                      jlong vertexCounts,
                                                                                      jlong vertexAddrs,
                                                                                      jboolean important) {
+    if (JniTrace::capturing()) {
+        JniTrace::Record record(JniTrace::Call::ChunkRebuildSingle);
+        uint64_t arraySize = std::max(geometryCount, 0) * sizeof(int);
+        record << originX << originY << originZ << index << geometryCount << important
+               << JniTrace::Blob{reinterpret_cast<void *>(geometryTypes), arraySize}
+               << JniTrace::Blob{reinterpret_cast<void *>(geometryTextures), arraySize}
+               << JniTrace::Blob{reinterpret_cast<void *>(vertexFormats), arraySize}
+               << JniTrace::Blob{reinterpret_cast<void *>(vertexCounts), arraySize};
+        for (int i = 0; i < geometryCount; i++) {
+            record << JniTrace::Blob{reinterpret_cast<void **>(vertexAddrs)[i],
+                                     reinterpret_cast<int *>(vertexCounts)[i] *
+                                         sizeof(vk::VertexFormat::PBRTriangle)};
+        }
+    }
     auto world = Renderer::instance().world();
     if (world == nullptr) return;
     world->chunks()->queueChunkBuild(ChunkBuildTask{
@@ -48,7 +66,27 @@ JNIEXPORT jboolean JNICALL Java_com_radiance_client_proxy_world_ChunkProxy_isChu
 }
 
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_world_ChunkProxy_invalidateSingle(JNIEnv *, jclass, jlong index) {
+    JniTrace::record(JniTrace::Call::ChunkInvalidateSingle, index);
     auto world = Renderer::instance().world();
     if (world == nullptr) return;
     world->chunks()->invalidateChunk(index);
-}
\ No newline at end of file
+}
+
+extern "C" {
+// host memory held by chunk geometry on its way to the device, plus the spills kept with the option
+JNIEXPORT jlong JNICALL Java_com_radiance_client_proxy_world_ChunkProxy_hostGeometryBytes(JNIEnv *, jclass) {
+    return Chunks::hostGeometryBytes();
+}
+
+// blas bytes of the compacted chunks before and after their compaction, since the chunks were last reset
+JNIEXPORT jlongArray JNICALL Java_com_radiance_client_proxy_world_ChunkProxy_compactionStats(JNIEnv *env, jclass) {
+    auto world = Renderer::instance().world();
+    auto compactor = world == nullptr ? nullptr : world->chunks()->chunkCompactor();
+
+    jlong values[] = {compactor == nullptr ? 0 : static_cast<jlong>(compactor->originalBytes()),
+                      compactor == nullptr ? 0 : static_cast<jlong>(compactor->compactedBytes())};
+    jlongArray result = env->NewLongArray(2);
+    env->SetLongArrayRegion(result, 0, 2, values);
+    return result;
+}
+}
@@ -1,7 +1,11 @@
 #include "com_radiance_client_proxy_world_EntityProxy.h"
 
+#include "core/middleware/jni_trace.hpp"
 #include "core/render/entities.hpp"
 #include "core/render/renderer.hpp"
+#include "core/render/vertex_convert.hpp"
+
+#include <algorithm>
 
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_world_EntityProxy_queueBuild(JNIEnv *,
                                                                                    jclass,
@@ -23,6 +27,35 @@ JNIEXPORT void JNICALL Java_com_radiance_client_proxy_world_EntityProxy_queueBui
                                                                                    jlong indexFormats,
                                                                                    jlong vertexCounts,
                                                                                    jlong vertices) {
+    if (JniTrace::capturing()) {
+        JniTrace::Record record(JniTrace::Call::EntityQueueBuild);
+        record << lineWidth << coordinate << normalOffset << size;
+
+        uint64_t intsSize = std::max(size, 0) * sizeof(int);
+        uint64_t doublesSize = std::max(size, 0) * sizeof(double);
+        record << JniTrace::Blob{reinterpret_cast<void *>(entityHashCodes), intsSize}
+               << JniTrace::Blob{reinterpret_cast<void *>(entityPosXs), doublesSize}
+               << JniTrace::Blob{reinterpret_cast<void *>(entityPosYs), doublesSize}
+               << JniTrace::Blob{reinterpret_cast<void *>(entityPosZs), doublesSize}
+               << JniTrace::Blob{reinterpret_cast<void *>(entityRTFlags), intsSize}
+               << JniTrace::Blob{reinterpret_cast<void *>(entityPrebuiltBLASs), intsSize}
+               << JniTrace::Blob{reinterpret_cast<void *>(entityPosts), intsSize}
+               << JniTrace::Blob{reinterpret_cast<void *>(entityLayerCounts), intsSize};
+
+        int geometryCount = 0;
+        for (int e = 0; e < size; e++) geometryCount += reinterpret_cast<int *>(entityLayerCounts)[e];
+        uint64_t geometriesSize = geometryCount * sizeof(int);
+        record << geometryCount << JniTrace::Blob{reinterpret_cast<void *>(geometryTypes), geometriesSize}
+               << JniTrace::Blob{reinterpret_cast<void *>(geometryTextures), geometriesSize}
+               << JniTrace::Blob{reinterpret_cast<void *>(vertexFormats), geometriesSize}
+               << JniTrace::Blob{reinterpret_cast<void *>(indexFormats), geometriesSize}
+               << JniTrace::Blob{reinterpret_cast<void *>(vertexCounts), geometriesSize};
+        for (int i = 0; i < geometryCount; i++) {
+            auto format = static_cast<World::VertexFormats>(reinterpret_cast<int *>(vertexFormats)[i]);
+            record << JniTrace::Blob{reinterpret_cast<void **>(vertices)[i],
+                                     reinterpret_cast<int *>(vertexCounts)[i] * VertexConvert::vertexSize(format)};
+        }
+    }
     auto world = Renderer::instance().world();
     if (world == nullptr) return;
     world->entities()->queueBuild(EntitiesBuildTask{
@@ -48,6 +81,7 @@ JNIEXPORT void JNICALL Java_com_radiance_client_proxy_world_EntityProxy_queueBui
 }
 
 JNIEXPORT void JNICALL Java_com_radiance_client_proxy_world_EntityProxy_build(JNIEnv *, jclass) {
+    JniTrace::record(JniTrace::Call::EntityBuild);
     auto world = Renderer::instance().world();
     if (world == nullptr) return;
     world->entities()->build();
@@ -1,10 +1,12 @@
 #include "com_radiance_client_proxy_world_PlayerProxy.h"
 
+#include "core/middleware/jni_trace.hpp"
 #include "core/render/chunks.hpp"
 #include "core/render/renderer.hpp"
 
 JNIEXPORT void JNICALL
 Java_com_radiance_client_proxy_world_PlayerProxy_setCameraPos(JNIEnv *, jclass, jdouble x, jdouble y, jdouble z) {
+    JniTrace::record(JniTrace::Call::PlayerSetCameraPos, x, y, z);
     auto world = Renderer::instance().world();
     if (world == nullptr) return;
     Renderer::instance().world()->setCameraPos(glm::dvec3{x, y, z});
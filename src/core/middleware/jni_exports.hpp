@@ -0,0 +1,59 @@
+#pragma once
+
+#include <jni.h>
+
+// entry points whose java natives are newer than the javac headers in GENTOOL_OUTPUT_DIR, declared here with the java
+// declaration they belong to, so the definitions keep c linkage and the replay tool can call them until the headers
+// are regenerated
+extern "C" {
+// com.radiance.client.option.Options: static native void nativeSetGpuProfiler(boolean gpuProfiler, boolean write)
+JNIEXPORT void JNICALL Java_com_radiance_client_option_Options_nativeSetGpuProfiler(JNIEnv *,
+                                                                                    jclass,
+                                                                                    jboolean gpuProfiler,
+                                                                                    jboolean write);
+// com.radiance.client.option.Options: static native void nativeSetChunkGeometrySpill(boolean chunkGeometrySpill,
+// boolean write)
+JNIEXPORT void JNICALL Java_com_radiance_client_option_Options_nativeSetChunkGeometrySpill(JNIEnv *,
+                                                                                           jclass,
+                                                                                           jboolean chunkGeometrySpill,
+                                                                                           jboolean write);
+
+// com.radiance.client.proxy.vulkan.RendererProxy: static native void initHeadlessRenderer(int width, int height)
+JNIEXPORT void JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_initHeadlessRenderer(JNIEnv *,
+                                                                                                jclass,
+                                                                                                jint width,
+                                                                                                jint height);
+
+// com.radiance.client.proxy.vulkan.RendererProxy: static native long requestScreenshot(boolean withUI, int width,
+// int height, int channel)
+JNIEXPORT jlong JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_requestScreenshot(
+    JNIEnv *, jclass, jboolean withUI, jint width, jint height, jint channel);
+// com.radiance.client.proxy.vulkan.RendererProxy: static native long requestScreenshotFile(boolean withUI, String path)
+JNIEXPORT jlong JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_requestScreenshotFile(JNIEnv *,
+                                                                                                  jclass,
+                                                                                                  jboolean withUI,
+                                                                                                  jstring path);
+// com.radiance.client.proxy.vulkan.RendererProxy: static native long pollScreenshot(long pointer)
+JNIEXPORT jlong JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_pollScreenshot(JNIEnv *,
+                                                                                           jclass,
+                                                                                           jlong pointer);
+
+// com.radiance.client.proxy.vulkan.RendererProxy: static native String[] gpuProfileZones()
+JNIEXPORT jobjectArray JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_gpuProfileZones(JNIEnv *, jclass);
+// com.radiance.client.proxy.vulkan.RendererProxy: static native double[] gpuProfileStats()
+JNIEXPORT jdoubleArray JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_gpuProfileStats(JNIEnv *, jclass);
+// com.radiance.client.proxy.vulkan.RendererProxy: static native boolean dumpGpuProfile(String path)
+JNIEXPORT jboolean JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_dumpGpuProfile(JNIEnv *,
+                                                                                              jclass,
+                                                                                              jstring path);
+
+// com.radiance.client.proxy.vulkan.RendererProxy: static native int[] overlayStateStats()
+JNIEXPORT jintArray JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_overlayStateStats(JNIEnv *, jclass);
+// com.radiance.client.proxy.vulkan.RendererProxy: static native int[] overlayDrawStats()
+JNIEXPORT jintArray JNICALL Java_com_radiance_client_proxy_vulkan_RendererProxy_overlayDrawStats(JNIEnv *, jclass);
+
+// com.radiance.client.proxy.world.ChunkProxy: static native long hostGeometryBytes()
+JNIEXPORT jlong JNICALL Java_com_radiance_client_proxy_world_ChunkProxy_hostGeometryBytes(JNIEnv *, jclass);
+// com.radiance.client.proxy.world.ChunkProxy: static native long[] compactionStats()
+JNIEXPORT jlongArray JNICALL Java_com_radiance_client_proxy_world_ChunkProxy_compactionStats(JNIEnv *, jclass);
+}
@@ -0,0 +1,147 @@
+#include "core/middleware/jni_trace.hpp"
+
+#include <cstdlib>
+#include <iostream>
+
+std::ostream &jniTraceCout() {
+    return std::cout << "[JniTrace] ";
+}
+
+std::ostream &jniTraceCerr() {
+    return std::cerr << "[JniTrace] ";
+}
+
+std::atomic<bool> JniTrace::capturing_ = false;
+std::mutex JniTrace::mutex_;
+std::ofstream JniTrace::out_;
+
+JniTrace::Record::Record(Call call) : call_(call) {}
+
+JniTrace::Record::~Record() {
+    JniTrace::write(call_, payload_);
+}
+
+JniTrace::Record &JniTrace::Record::operator<<(const std::string &string) {
+    *this << static_cast<uint32_t>(string.size());
+    payload_.insert(payload_.end(), string.begin(), string.end());
+    return *this;
+}
+
+JniTrace::Record &JniTrace::Record::operator<<(const Blob &blob) {
+    uint64_t size = blob.data == nullptr ? 0 : blob.size;
+    *this << size;
+    payload_.resize((payload_.size() + 7) & ~size_t{7});
+    if (size > 0) {
+        const uint8_t *data = static_cast<const uint8_t *>(blob.data);
+        payload_.insert(payload_.end(), data, data + size);
+    }
+    return *this;
+}
+
+JniTrace::Reader::Reader(const std::filesystem::path &file) : in_(file, std::ios::binary) {
+    uint32_t fileMagic = 0, fileVersion = 0;
+    in_.read(reinterpret_cast<char *>(&fileMagic), sizeof(fileMagic));
+    in_.read(reinterpret_cast<char *>(&fileVersion), sizeof(fileVersion));
+    valid_ = in_ && fileMagic == magic && fileVersion == version;
+    if (!valid_) { jniTraceCerr() << file << " is not a trace of version " << version << std::endl; }
+
+    frames_.emplace_back();
+}
+
+bool JniTrace::Reader::valid() {
+    return valid_;
+}
+
+bool JniTrace::Reader::next(Call &call) {
+    if (!valid_) return false;
+
+    uint16_t rawCall = 0;
+    uint32_t size = 0;
+    in_.read(reinterpret_cast<char *>(&rawCall), sizeof(rawCall));
+    in_.read(reinterpret_cast<char *>(&size), sizeof(size));
+    if (!in_) return false;
+
+    auto &payload = frames_.back().emplace_back((size + 7) / 8);
+    in_.read(reinterpret_cast<char *>(payload.data()), size);
+    if (!in_ || rawCall >= static_cast<uint16_t>(Call::Count)) {
+        jniTraceCerr() << "truncated or corrupt record, stopping" << std::endl;
+        valid_ = false;
+        return false;
+    }
+
+    call = static_cast<Call>(rawCall);
+    payloadSize_ = size;
+    cursor_ = 0;
+    return true;
+}
+
+void JniTrace::Reader::endFrame() {
+    frames_.emplace_back();
+    while (frames_.size() > retainedFrames + 1) frames_.pop_front();
+}
+
+std::string JniTrace::Reader::readString() {
+    uint32_t length = read<uint32_t>();
+    if (cursor_ + length > payloadSize_) return {};
+    std::string string(reinterpret_cast<char *>(bytes() + cursor_), length);
+    cursor_ += length;
+    return string;
+}
+
+void *JniTrace::Reader::readBlob(uint64_t *size) {
+    uint64_t blobSize = read<uint64_t>();
+    cursor_ = (cursor_ + 7) & ~uint64_t{7};
+    if (size != nullptr) *size = blobSize;
+    if (blobSize == 0 || cursor_ + blobSize > payloadSize_) return nullptr;
+
+    void *data = bytes() + cursor_;
+    cursor_ += blobSize;
+    return data;
+}
+
+uint8_t *JniTrace::Reader::bytes() {
+    return reinterpret_cast<uint8_t *>(frames_.back().back().data());
+}
+
+bool JniTrace::start(const std::filesystem::path &file) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (capturing_) return false;
+
+    out_.open(file, std::ios::binary | std::ios::trunc);
+    if (!out_) {
+        jniTraceCerr() << "cannot write " << file << std::endl;
+        return false;
+    }
+    out_.write(reinterpret_cast<const char *>(&magic), sizeof(magic));
+    out_.write(reinterpret_cast<const char *>(&version), sizeof(version));
+
+    capturing_ = true;
+    jniTraceCout() << "capturing into " << file << std::endl;
+    return true;
+}
+
+void JniTrace::startFromEnvironment() {
+    const char *file = std::getenv("MCVR_TRACE");
+    if (file != nullptr && *file != '\0') start(file);
+}
+
+void JniTrace::stop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!capturing_) return;
+
+    capturing_ = false;
+    out_.close();
+    jniTraceCout() << "capture finished" << std::endl;
+}
+
+// the lock orders the records of the render thread and the chunk threads as they arrive
+void JniTrace::write(Call call, const std::vector<uint8_t> &payload) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!capturing_) return;
+
+    uint16_t rawCall = static_cast<uint16_t>(call);
+    uint32_t size = payload.size();
+    out_.write(reinterpret_cast<const char *>(&rawCall), sizeof(rawCall));
+    out_.write(reinterpret_cast<const char *>(&size), sizeof(size));
+    out_.write(reinterpret_cast<const char *>(payload.data()), payload.size());
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// binary capture of the calls arriving through the jni entry points together with the memory behind their pointer
+// arguments, so a session can be replayed without the game. a trace is the magic and the version followed by records
+// of {uint16 call, uint32 payload size, payload}, the payload holds the arguments in declaration order, strings as
+// {uint32 length, chars} and pointer arguments as {uint64 size, padding to 8 bytes, bytes}
+class JniTrace {
+  public:
+    static constexpr uint32_t magic = 0x4352544D; // "MTRC"
+    static constexpr uint32_t version = 1;
+
+    enum class Call : uint16_t {
+        OptionsSetMaxFps,
+        OptionsSetInactivityFpsLimit,
+        OptionsSetVsync,
+        OptionsSetChunkBuildingBatchSize,
+        OptionsSetChunkBuildingTotalBatches,
+        OptionsSetGpuProfiler,
+        PipelineBuildNative,
+        PipelineCollectNativeModules,
+        BufferAllocate,
+        BufferInitialize,
+        BufferBuildIndexBuffer,
+        BufferQueueUpload,
+        BufferPerformQueuedUpload,
+        BufferUpdateOverlayDrawUniform,
+        BufferUpdateOverlayPostUniform,
+        BufferUpdateWorldUniform,
+        BufferUpdateSkyUniform,
+        BufferUpdateMapping,
+        BufferUpdateLightMapUniform,
+        OverlayClearEntireColorAttachment,
+        OverlayClearEntireDepthStencilAttachment,
+        ClearStateSetClearColor,
+        ClearStateSetClearDepth,
+        ClearStateSetClearStencil,
+        ColorBlendStateSetBlendEnable,
+        ColorBlendStateSetColorBlendConstants,
+        ColorBlendStateSetColorLogicOpEnable,
+        ColorBlendStateSetBlendFuncSeparate,
+        ColorBlendStateSetBlendOpSeparate,
+        ColorBlendStateSetColorWriteMask,
+        ColorBlendStateSetColorLogicOp,
+        DepthStencilStateSetDepthTestEnable,
+        DepthStencilStateSetDepthWriteEnable,
+        DepthStencilStateSetStencilTestEnable,
+        DepthStencilStateSetDepthCompareOp,
+        DepthStencilStateSetStencilFrontFunc,
+        DepthStencilStateSetStencilBackFunc,
+        DepthStencilStateSetStencilFrontOp,
+        DepthStencilStateSetStencilBackOp,
+        DepthStencilStateSetStencilFrontWriteMask,
+        DepthStencilStateSetStencilBackWriteMask,
+        RasterizationStateSetLineWidth,
+        RasterizationStateSetPolygonMode,
+        RasterizationStateSetCullMode,
+        RasterizationStateSetFrontFace,
+        RasterizationStateSetDepthBiasEnable,
+        RasterizationStateSetDepthBias,
+        ViewportStateSetScissorEnabled,
+        ViewportStateSetScissor,
+        ViewportStateSetViewport,
+        RendererInitFolderPath,
+        RendererInit, // the swapchain extent, windowed sessions replay on a headless surface of that size
+        RendererAcquireContext,
+        RendererSubmitCommand,
+        RendererPresent,
+        RendererDrawOverlay,
+        RendererFuseWorld,
+        RendererPostBlur,
+        RendererClose,
+        RendererShouldRenderWorld,
+        RendererTakeScreenshot, // without the destination pointer
+        TextureGenerateId,
+        TexturePrepareImage,
+        TextureSetFilter,
+        TextureSetClamp,
+        TextureQueueUpload,
+        TexturePerformQueuedUpload,
+        WindowFramebufferSizeChanged,
+        ChunkInitNative,
+        ChunkRebuildSingle,
+        ChunkInvalidateSingle,
+        EntityQueueBuild,
+        EntityBuild,
+        PlayerSetCameraPos,
+        RendererRequestScreenshot,
+        RendererRequestScreenshotFile,
+        OptionsSetChunkGeometrySpill,
+        Count,
+    };
+
+    struct Blob {
+        const void *data;
+        uint64_t size;
+    };
+
+    // serializes one call, the record is appended to the trace as a whole when it goes out of scope
+    class Record {
+      public:
+        Record(Call call);
+        ~Record();
+
+        template <typename T>
+            requires std::is_arithmetic_v<T>
+        Record &operator<<(T value) {
+            size_t offset = payload_.size();
+            payload_.resize(offset + sizeof(T));
+            std::memcpy(payload_.data() + offset, &value, sizeof(T));
+            return *this;
+        }
+        Record &operator<<(const std::string &string);
+        Record &operator<<(const Blob &blob);
+
+      private:
+        Call call_;
+        std::vector<uint8_t> payload_;
+    };
+
+    // walks a trace record by record, the blobs of a record stay valid for retainedFrames frames after the one they
+    // were read in, long enough for the entry points that keep pointers until the queued work is performed
+    class Reader {
+      public:
+        static constexpr uint32_t retainedFrames = 2;
+
+        Reader(const std::filesystem::path &file);
+
+        bool valid();
+        bool next(Call &call);
+        void endFrame();
+
+        template <typename T>
+            requires std::is_arithmetic_v<T>
+        T read() {
+            T value{};
+            if (cursor_ + sizeof(T) <= payloadSize_) std::memcpy(&value, bytes() + cursor_, sizeof(T));
+            cursor_ += sizeof(T);
+            return value;
+        }
+        std::string readString();
+        void *readBlob(uint64_t *size = nullptr);
+
+      private:
+        uint8_t *bytes();
+
+        std::ifstream in_;
+        bool valid_ = false;
+
+        std::deque<std::vector<std::vector<uint64_t>>> frames_; // payloads, 8 byte aligned for the blobs
+        uint64_t payloadSize_ = 0;
+        uint64_t cursor_ = 0;
+    };
+
+    static bool start(const std::filesystem::path &file);
+    // starts a capture into the file named by MCVR_TRACE, if set
+    static void startFromEnvironment();
+    static void stop();
+
+    static bool capturing() {
+        return capturing_.load(std::memory_order_relaxed);
+    }
+
+    template <typename... Args>
+    static void record(Call call, const Args &...args) {
+        if (!capturing()) return;
+        Record record(call);
+        ((record << args), ...);
+    }
+
+  private:
+    static void write(Call call, const std::vector<uint8_t> &payload);
+
+    static std::atomic<bool> capturing_;
+    static std::mutex mutex_;
+    static std::ofstream out_;
+};
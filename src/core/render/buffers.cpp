@@ -8,6 +8,8 @@
 #include "core/render/renderer.hpp"
 #include "core/render/world.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <random>
 
 std::ostream &buffersCout() {
@@ -22,7 +24,10 @@ Buffers::Buffers(std::shared_ptr<Framework> framework) {
     uint32_t size = framework->swapchain()->imageCount();
 
     validOverlayIndex_.resize(size);
-    overlayIndexVertexBuffer_.resize(size);
+    overlayRanges_.resize(size);
+    overlayPools_.resize(size);
+    overlayQuadIndex_.resize(size);
+    overlayStaging_.resize(size);
 
     overlayDrawUniformBuffer_.resize(size);
     overlayPostUniformBuffer_.resize(size);
@@ -33,6 +38,8 @@ Buffers::Buffers(std::shared_ptr<Framework> framework) {
     textureMappingBuffer_.resize(size);
     exposureDataBuffer_.resize(size);
     lightMapUniformBuffer_.resize(size);
+
+    stagingRing_ = vk::StagingRing::create(framework->vma(), framework->device(), size);
 }
 
 void Buffers::resetFrame() {
@@ -41,6 +48,13 @@ void Buffers::resetFrame() {
     auto &gc = framework->gc();
 
     validOverlayIndex_[context->frameIndex].clear();
+    overlayRanges_[context->frameIndex].clear();
+    overlayPools_[context->frameIndex].head = 0;
+    overlayQuadIndex_[context->frameIndex].clear();
+    overlayStaging_[context->frameIndex].clear();
+
+    // the fence of this context signaled, everything staged by its previous frame has been copied
+    stagingRing_->beginFrame(context->frameIndex);
 
     overlayNextID_ = 0;
 
@@ -50,18 +64,22 @@ void Buffers::resetFrame() {
     gc.collect(overlayPostUniformQueue_);
     overlayPostUniformQueue_ = std::make_shared<std::vector<vk::Data::OverlayPostUBO>>();
 
-    gc.collect(importantIndexVertexBuffer_);
-    importantIndexVertexBuffer_ = std::make_shared<std::vector<std::shared_ptr<vk::DeviceLocalBuffer>>>();
+    gc.collect(importantStagingUploads_);
+    importantStagingUploads_ = std::make_shared<std::vector<StagingUpload>>();
+
+    gc.collect(importantArenaUploads_);
+    importantArenaUploads_ = std::make_shared<std::vector<ArenaUpload>>();
+
+    std::unique_lock<std::mutex> lock(quadIndexMutex_);
+    for (auto buffer : retiredQuadIndexBuffers_) { gc.collect(buffer); }
+    retiredQuadIndexBuffers_.clear();
 }
 
 uint32_t Buffers::allocateBuffer() {
     auto context = Renderer::instance().framework()->safeAcquireCurrentContext();
 
     validOverlayIndex_[context->frameIndex].insert(std::make_pair(overlayNextID_, -1));
-    auto it = overlayIndexVertexBuffer_[context->frameIndex].find(overlayNextID_);
-    if (it == overlayIndexVertexBuffer_[context->frameIndex].end()) {
-        overlayIndexVertexBuffer_[context->frameIndex].emplace(std::make_pair(overlayNextID_, nullptr));
-    }
+    overlayRanges_[context->frameIndex].emplace(std::make_pair(overlayNextID_, OverlayRange{}));
     return overlayNextID_++;
 }
 
@@ -69,60 +87,62 @@ void Buffers::initializeBuffer(uint32_t id, uint32_t size, VkBufferUsageFlags us
     auto framework = Renderer::instance().framework();
     auto context = framework->safeAcquireCurrentContext();
 
-    auto frameIndex = framework->safeAcquireCurrentContext()->frameIndex;
     auto device = framework->device();
     auto vma = framework->vma();
 
-    auto bufferIter = overlayIndexVertexBuffer_[context->frameIndex].find(id);
+    auto rangeIter = overlayRanges_[context->frameIndex].find(id);
     if (!validOverlayIndex_[context->frameIndex].contains(id) ||
-        bufferIter == overlayIndexVertexBuffer_[context->frameIndex].end()) {
+        rangeIter == overlayRanges_[context->frameIndex].end()) {
         buffersCerr() << "The given buffer id: " << id << " is not allocated for buffer" << std::endl;
         exit(EXIT_FAILURE);
     }
 
     validOverlayIndex_[context->frameIndex].at(id) = size;
 
-    auto buffer = overlayIndexVertexBuffer_[context->frameIndex].contains(id) ?
-                      overlayIndexVertexBuffer_[context->frameIndex].at(id) :
-                      nullptr;
-    uint32_t currentSize = buffer == nullptr ? baseBlockSize : buffer->size();
-    while (currentSize < size) currentSize *= 2;
-    if (buffer == nullptr || currentSize != buffer->size()) {
-        framework->gc().collect(buffer);
-        overlayIndexVertexBuffer_[context->frameIndex].at(id) =
-            vk::DeviceLocalBuffer::create(vma, device, currentSize, usageFlags);
+    // consecutive ids end up back to back in the pool, the ui module merges draws over them
+    auto &pool = overlayPools_[context->frameIndex];
+    VkDeviceSize offset = (pool.head + overlayRangeAlignment - 1) & ~(overlayRangeAlignment - 1);
+    if (pool.buffer == nullptr || offset + size > pool.buffer->size() || (usageFlags & ~pool.usage) != 0) {
+        VkDeviceSize poolSize = pool.buffer == nullptr ? baseOverlayPoolSize : pool.buffer->size() * 2;
+        while (poolSize < size) poolSize *= 2;
+        pool.usage |= usageFlags;
+
+        // the ranges handed out earlier in this frame keep referencing the old pool
+        framework->gc().collect(pool.buffer);
+        pool.buffer = vk::DeviceLocalBuffer::create(vma, device, false, poolSize, pool.usage);
+        offset = 0;
     }
+    pool.head = offset + size;
+
+    rangeIter->second = {
+        .buffer = pool.buffer,
+        .offset = offset,
+        .size = size,
+    };
 }
 
 void Buffers::buildIndexBuffer(uint32_t dstId, int type, int drawMode, int vertexCount, int expectedIndexCount) {
-    auto buildQuadIndices = [this, dstId, vertexCount, expectedIndexCount]<typename V>() {
-        int indexCount = vertexCount / 4 * 6;
-        if (indexCount != expectedIndexCount) { throw std::runtime_error("index count not match!"); }
-
-        std::vector<V> indices;
-        for (int i = 0; i < vertexCount; i += 4) {
-            indices.push_back(i + 0);
-            indices.push_back(i + 1);
-            indices.push_back(i + 2);
-            indices.push_back(i + 2);
-            indices.push_back(i + 3);
-            indices.push_back(i + 0);
-        }
-
-        queueOverlayUpload(reinterpret_cast<uint8_t *>(indices.data()), dstId);
-    };
+    auto frameIndex = Renderer::instance().framework()->safeAcquireCurrentContext()->frameIndex;
 
     switch (drawMode) {
         case 7: {
-            switch (type) {
-                case 0: {
-                    buildQuadIndices.template operator()<uint16_t>();
-                    break;
-                }
-                case 1: {
-                    buildQuadIndices.template operator()<uint32_t>();
-                    break;
+            int indexCount = vertexCount / 4 * 6;
+            if (indexCount != expectedIndexCount) { throw std::runtime_error("index count not match!"); }
+
+            // drawn from the shared quad index buffer, nothing to upload for this id
+            quadIndexBuffer(vertexCount / 4);
+            overlayQuadIndex_[frameIndex].insert(dstId);
+            if (validOverlayIndex_[frameIndex].contains(dstId)) { validOverlayIndex_[frameIndex].at(dstId) = 0; }
+
+            // give its pool space back when nothing was placed after it, so the vertex ranges stay back to back
+            auto rangeIter = overlayRanges_[frameIndex].find(dstId);
+            if (rangeIter != overlayRanges_[frameIndex].end()) {
+                auto &range = rangeIter->second;
+                auto &pool = overlayPools_[frameIndex];
+                if (range.buffer != nullptr && range.buffer == pool.buffer && range.offset + range.size == pool.head) {
+                    pool.head = range.offset;
                 }
+                range.size = 0;
             }
             break;
         }
@@ -134,89 +154,109 @@ void Buffers::buildIndexBuffer(uint32_t dstId, int type, int drawMode, int verte
     }
 }
 
+// maybe called async from the chunk building threads
+std::shared_ptr<vk::HostVisibleBuffer> Buffers::quadIndexBuffer(uint32_t quadCount) {
+    std::unique_lock<std::mutex> lock(quadIndexMutex_);
+
+    if (quadIndexBuffer_ != nullptr && quadIndexCapacity_ >= quadCount) { return quadIndexBuffer_; }
+
+    uint32_t capacity = std::max(quadIndexCapacity_, baseQuadIndexCapacity);
+    while (capacity < quadCount) capacity *= 2;
+
+    auto framework = Renderer::instance().framework();
+    auto buffer = vk::HostVisibleBuffer::create(
+        framework->vma(), framework->device(), capacity * 6 * sizeof(uint32_t),
+        VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
+            VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+
+    uint32_t *indexPtr = static_cast<uint32_t *>(buffer->mappedPtr());
+    for (uint32_t i = 0; i < capacity * 4; i += 4) {
+        *indexPtr++ = i + 0;
+        *indexPtr++ = i + 1;
+        *indexPtr++ = i + 2;
+        *indexPtr++ = i + 2;
+        *indexPtr++ = i + 3;
+        *indexPtr++ = i + 0;
+    }
+    buffer->flush();
+
+    // geometry referencing the old buffer keeps it alive, in-flight frames are covered by the gc
+    if (quadIndexBuffer_ != nullptr) { retiredQuadIndexBuffers_.push_back(quadIndexBuffer_); }
+    quadIndexBuffer_ = buffer;
+    quadIndexCapacity_ = capacity;
+
+#ifdef DEBUG
+    buffersCout() << "grew the quad index buffer to " << capacity << " quads" << std::endl;
+#endif
+
+    return quadIndexBuffer_;
+}
+
+bool Buffers::isQuadIndexBuffer(uint32_t id) {
+    auto frameIndex = Renderer::instance().framework()->safeAcquireCurrentContext()->frameIndex;
+    return overlayQuadIndex_[frameIndex].contains(id);
+}
+
 void Buffers::queueOverlayUpload(uint8_t *srcPointer, uint32_t dstId) {
     auto context = Renderer::instance().framework()->safeAcquireCurrentContext();
-    auto buffer = overlayIndexVertexBuffer_[context->frameIndex].at(dstId);
-    if (validOverlayIndex_[context->frameIndex].contains(dstId) && buffer != nullptr) {
+    auto &range = overlayRanges_[context->frameIndex].at(dstId);
+    if (validOverlayIndex_[context->frameIndex].contains(dstId) && range.buffer != nullptr) {
         auto size = validOverlayIndex_[context->frameIndex].at(dstId);
-        if (size > 0) { buffer->uploadToStagingBuffer(srcPointer, size, 0); }
+        if (size > 0) { overlayStaging_[context->frameIndex][dstId] = stagingRing_->upload(srcPointer, size); }
     }
 }
 
-void Buffers::queueImportantWorldUpload(std::shared_ptr<vk::DeviceLocalBuffer> vertexBuffer,
-                                        std::shared_ptr<vk::DeviceLocalBuffer> indexBuffer) {
-    Renderer::instance().framework()->safeAcquireCurrentContext();
+uint32_t Buffers::overlayUploadSize(uint32_t dstId) {
+    auto context = Renderer::instance().framework()->safeAcquireCurrentContext();
+    auto it = validOverlayIndex_[context->frameIndex].find(dstId);
+    return it == validOverlayIndex_[context->frameIndex].end() ? 0 : std::max(it->second, 0);
+}
+
+void Buffers::queueImportantWorldUpload(vk::StagingRing::Allocation staging,
+                                        std::shared_ptr<vk::DeviceLocalBuffer> buffer,
+                                        VkDeviceSize dstOffset) {
     Renderer::instance().framework()->safeAcquireCurrentContext();
-    importantIndexVertexBuffer_->push_back(vertexBuffer);
-    importantIndexVertexBuffer_->push_back(indexBuffer);
+    if (staging.buffer == nullptr || staging.size == 0) return;
+    importantStagingUploads_->push_back({staging, buffer, dstOffset});
+}
+
+void Buffers::queueImportantWorldUpload(std::shared_ptr<vk::HostVisibleBuffer> stagingBuffer,
+                                        VkDeviceSize stagingOffset,
+                                        VkDeviceSize size,
+                                        std::shared_ptr<vk::BufferArenaRange> range) {
+    if (size == 0) return;
+    importantArenaUploads_->push_back({stagingBuffer, stagingOffset, size, range});
 }
 
 void Buffers::performQueuedUpload() {
-    auto frameIndex = Renderer::instance().framework()->safeAcquireCurrentContext()->frameIndex;
-    std::shared_ptr<vk::CommandBuffer> cmdBuffer =
-        Renderer::instance().framework()->safeAcquireCurrentContext()->uploadCommandBuffer;
-
-    auto physicalDevice = Renderer::instance().framework()->physicalDevice();
-    auto mainQueueIndex = physicalDevice->mainQueueIndex();
-
-    std::vector<vk::CommandBuffer::BufferMemoryBarrier> uploadPreBufferBarriers, uploadPostBufferBarriers;
-
-    for (auto [bufferId, size] : validOverlayIndex_[frameIndex]) {
-        auto buffer = overlayIndexVertexBuffer_[frameIndex].at(bufferId);
-        uploadPreBufferBarriers.push_back({
-            .srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-            .srcAccessMask = VK_ACCESS_2_MEMORY_READ_BIT,
-            .dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-            .dstAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT,
-            .srcQueueFamilyIndex = mainQueueIndex,
-            .dstQueueFamilyIndex = mainQueueIndex,
-            .buffer = buffer,
-        });
-        uploadPostBufferBarriers.push_back({
-            .srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-            .srcAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
-            .dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT |
-                            VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT,
-            .dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
-            .srcQueueFamilyIndex = mainQueueIndex,
-            .dstQueueFamilyIndex = mainQueueIndex,
-            .buffer = buffer,
-        });
-    }
+    auto context = Renderer::instance().framework()->safeAcquireCurrentContext();
+    auto frameIndex = context->frameIndex;
+    std::shared_ptr<vk::CommandBuffer> cmdBuffer = context->uploadCommandBuffer;
 
-    for (auto buffer : *importantIndexVertexBuffer_) {
-        uploadPreBufferBarriers.push_back({
-            .srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-            .srcAccessMask = VK_ACCESS_2_MEMORY_READ_BIT,
-            .dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-            .dstAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT,
-            .srcQueueFamilyIndex = mainQueueIndex,
-            .dstQueueFamilyIndex = mainQueueIndex,
-            .buffer = buffer,
-        });
-        uploadPostBufferBarriers.push_back({
-            .srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-            .srcAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
-            .dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT |
-                            VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR |
-                            VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT | VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT,
-            .dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
-            .srcQueueFamilyIndex = mainQueueIndex,
-            .dstQueueFamilyIndex = mainQueueIndex,
-            .buffer = buffer,
-        });
-    }
+    constexpr VkPipelineStageFlags2 overlayStages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT |
+                                                    VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT |
+                                                    VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT;
+    constexpr VkPipelineStageFlags2 worldStages =
+        overlayStages | VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR;
+
+    vk::UploadBatch batch;
 
-    cmdBuffer->barriersBufferImage(uploadPreBufferBarriers, {});
+    for (auto &[bufferId, staging] : overlayStaging_[frameIndex]) {
+        auto &range = overlayRanges_[frameIndex].at(bufferId);
+        batch.add(staging.buffer, staging.offset, range.buffer, range.offset, staging.size, overlayStages);
+    }
 
-    for (auto [bufferId, size] : validOverlayIndex_[frameIndex]) {
-        auto buffer = overlayIndexVertexBuffer_[frameIndex].at(bufferId);
-        if (size > 0) { buffer->uploadToBuffer(cmdBuffer, size, 0, 0); }
+    for (auto &upload : *importantStagingUploads_) {
+        batch.add(upload.staging.buffer, upload.staging.offset, upload.buffer, upload.dstOffset, upload.staging.size,
+                  worldStages);
     }
 
-    for (auto buffer : *importantIndexVertexBuffer_) { buffer->uploadToBuffer(cmdBuffer); }
+    for (auto &upload : *importantArenaUploads_) {
+        batch.add(upload.stagingBuffer, upload.stagingOffset, upload.range->buffer(), upload.range->offset(),
+                  upload.size, worldStages);
+    }
 
-    cmdBuffer->barriersBufferImage(uploadPostBufferBarriers, {});
+    batch.record(cmdBuffer);
 }
 
 void Buffers::appendOverlayDrawUniform(vk::Data::OverlayUBO &ubo) {
@@ -229,6 +269,11 @@ void Buffers::appendOverlayDrawUniform(vk::Data::OverlayUBO &ubo) {
 
     ubo.projectionMat = mapGLToVulkan * ubo.projectionMat;
 
+    // repeated uniforms share the draw id, the ui module only merges draws of the same id
+    if (!overlayDrawUniformQueue_->empty() &&
+        std::memcmp(&overlayDrawUniformQueue_->back(), &ubo, sizeof(vk::Data::OverlayUBO)) == 0) {
+        return;
+    }
     overlayDrawUniformQueue_->push_back(ubo);
 }
 
@@ -447,17 +492,21 @@ int Buffers::getPostID() {
     return overlayPostUniformQueue_->size() - 1;
 }
 
-std::shared_ptr<vk::DeviceLocalBuffer> Buffers::getBuffer(uint32_t id) {
+Buffers::OverlayRange Buffers::getBuffer(uint32_t id) {
     auto context = Renderer::instance().framework()->safeAcquireCurrentContext();
 
-    auto bufferIter = overlayIndexVertexBuffer_[context->frameIndex].find(id);
+    auto rangeIter = overlayRanges_[context->frameIndex].find(id);
     if (!validOverlayIndex_[context->frameIndex].contains(id) ||
-        bufferIter == overlayIndexVertexBuffer_[context->frameIndex].end()) {
+        rangeIter == overlayRanges_[context->frameIndex].end()) {
         buffersCerr() << "The given buffer id: " << id << " is not allocated for buffer" << std::endl;
         exit(EXIT_FAILURE);
     }
 
-    return bufferIter->second;
+    return rangeIter->second;
+}
+
+std::shared_ptr<vk::StagingRing> Buffers::stagingRing() {
+    return stagingRing_;
 }
 
 std::shared_ptr<vk::HostVisibleBuffer> Buffers::overlayDrawUniformBuffer() {
@@ -7,6 +7,7 @@
 #include "core/vulkan/all_core_vulkan.hpp"
 
 #include <map>
+#include <mutex>
 #include <set>
 #include <vector>
 
@@ -14,15 +15,31 @@ class Framework;
 
 class Buffers : public SharedObject<Buffers> {
   public:
+    // the part of the overlay pool behind a buffer id
+    struct OverlayRange {
+        std::shared_ptr<vk::DeviceLocalBuffer> buffer;
+        VkDeviceSize offset = 0;
+        VkDeviceSize size = 0;
+    };
+
     Buffers(std::shared_ptr<Framework> framework);
 
     void resetFrame();
     uint32_t allocateBuffer();
     void initializeBuffer(uint32_t id, uint32_t size, VkBufferUsageFlags usageFlags);
     void buildIndexBuffer(uint32_t dstId, int type, int drawMode, int vertexCount, int expectedIndexCount);
+    std::shared_ptr<vk::HostVisibleBuffer> quadIndexBuffer(uint32_t quadCount);
+    bool isQuadIndexBuffer(uint32_t id);
     void queueOverlayUpload(uint8_t *srcPointer, uint32_t dstId);
-    void queueImportantWorldUpload(std::shared_ptr<vk::DeviceLocalBuffer> vertexBuffer,
-                                   std::shared_ptr<vk::DeviceLocalBuffer> indexBuffer);
+    // bytes queueOverlayUpload reads for the buffer in the current frame, 0 if it is not initialized
+    uint32_t overlayUploadSize(uint32_t dstId);
+    void queueImportantWorldUpload(vk::StagingRing::Allocation staging,
+                                   std::shared_ptr<vk::DeviceLocalBuffer> buffer,
+                                   VkDeviceSize dstOffset = 0);
+    void queueImportantWorldUpload(std::shared_ptr<vk::HostVisibleBuffer> stagingBuffer,
+                                   VkDeviceSize stagingOffset,
+                                   VkDeviceSize size,
+                                   std::shared_ptr<vk::BufferArenaRange> range);
     void performQueuedUpload();
 
     void appendOverlayDrawUniform(vk::Data::OverlayUBO &ubo);
@@ -38,7 +55,8 @@ class Buffers : public SharedObject<Buffers> {
     int getDrawID();
     int getPostID();
 
-    std::shared_ptr<vk::DeviceLocalBuffer> getBuffer(uint32_t id);
+    OverlayRange getBuffer(uint32_t id);
+    std::shared_ptr<vk::StagingRing> stagingRing();
 
     std::shared_ptr<vk::HostVisibleBuffer> overlayDrawUniformBuffer();
     std::shared_ptr<vk::HostVisibleBuffer> overlayPostUniformBuffer();
@@ -54,9 +72,35 @@ class Buffers : public SharedObject<Buffers> {
 
   private:
     static constexpr uint32_t baseBlockSize = 16 * 1024;
+    static constexpr uint32_t baseQuadIndexCapacity = 16 * 1024; // quads
+    static constexpr VkDeviceSize baseOverlayPoolSize = 1024 * 1024;
+    static constexpr VkDeviceSize overlayRangeAlignment = 4; // keeps ranges of whole vertices back to back
+
+    // the vertex and index data of all buffer ids of a frame context, laid out in allocation order
+    struct OverlayPool {
+        std::shared_ptr<vk::DeviceLocalBuffer> buffer;
+        VkBufferUsageFlags usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+        VkDeviceSize head = 0;
+    };
+
+    struct StagingUpload {
+        vk::StagingRing::Allocation staging;
+        std::shared_ptr<vk::DeviceLocalBuffer> buffer;
+        VkDeviceSize dstOffset;
+    };
+
+    struct ArenaUpload {
+        std::shared_ptr<vk::HostVisibleBuffer> stagingBuffer;
+        VkDeviceSize stagingOffset;
+        VkDeviceSize size;
+        std::shared_ptr<vk::BufferArenaRange> range;
+    };
 
     std::vector<std::map<uint32_t, int32_t>> validOverlayIndex_;
-    std::vector<std::map<uint32_t, std::shared_ptr<vk::DeviceLocalBuffer>>> overlayIndexVertexBuffer_;
+    std::vector<std::map<uint32_t, OverlayRange>> overlayRanges_;
+    std::vector<OverlayPool> overlayPools_;
+    std::vector<std::map<uint32_t, vk::StagingRing::Allocation>> overlayStaging_;
+    std::vector<std::set<uint32_t>> overlayQuadIndex_;
     std::vector<std::shared_ptr<vk::HostVisibleBuffer>> overlayDrawUniformBuffer_;
     std::vector<std::shared_ptr<vk::HostVisibleBuffer>> overlayPostUniformBuffer_;
     uint32_t overlayNextID_;
@@ -71,7 +115,16 @@ class Buffers : public SharedObject<Buffers> {
     std::vector<std::shared_ptr<vk::HostVisibleBuffer>> exposureDataBuffer_;
     std::vector<std::shared_ptr<vk::HostVisibleBuffer>> lightMapUniformBuffer_;
 
-    std::shared_ptr<std::vector<std::shared_ptr<vk::DeviceLocalBuffer>>> importantIndexVertexBuffer_;
+    // transient upload space of every frame context, device local buffers filled through it keep no staging copy
+    std::shared_ptr<vk::StagingRing> stagingRing_;
+    std::shared_ptr<std::vector<StagingUpload>> importantStagingUploads_;
+    std::shared_ptr<std::vector<ArenaUpload>> importantArenaUploads_;
+
+    // 0,1,2,2,3,0 pattern shared by all quad geometry, replaced by a larger one on demand
+    std::mutex quadIndexMutex_;
+    std::shared_ptr<vk::HostVisibleBuffer> quadIndexBuffer_;
+    uint32_t quadIndexCapacity_ = 0;
+    std::vector<std::shared_ptr<vk::HostVisibleBuffer>> retiredQuadIndexBuffers_;
 
     bool useJitter_ = true;
 };
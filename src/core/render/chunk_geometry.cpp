@@ -0,0 +1,76 @@
+#include "core/render/chunk_geometry.hpp"
+
+#include "core/render/terrain_encoding.hpp"
+
+#include <cstring>
+
+ChunkHostBytes::~ChunkHostBytes() {
+    total_.fetch_sub(held_, std::memory_order_relaxed);
+}
+
+void ChunkHostBytes::add(int64_t bytes) {
+    held_ += bytes;
+    total_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+int64_t ChunkHostBytes::held() {
+    return held_;
+}
+
+int64_t ChunkHostBytes::total() {
+    return total_.load(std::memory_order_relaxed);
+}
+
+ChunkGeometryLayout ChunkGeometryLayout::plan(const std::vector<std::vector<vk::VertexFormat::PBRTriangle>> &vertices) {
+    ChunkGeometryLayout layout;
+    for (auto &geometryVertices : vertices) {
+        bool encoded = TerrainEncoding::isEncodable(geometryVertices);
+        uint64_t size = encoded ? TerrainEncoding::encodedSize(geometryVertices.size()) :
+                                  geometryVertices.size() * sizeof(vk::VertexFormat::PBRTriangle);
+        layout.terrainEncoded.push_back(encoded);
+        layout.sizes.push_back(size);
+        layout.offsets.push_back(layout.totalSize);
+        layout.totalSize += size;
+    }
+    return layout;
+}
+
+void ChunkGeometryLayout::write(const std::vector<std::vector<vk::VertexFormat::PBRTriangle>> &vertices,
+                                uint8_t *dst) const {
+    for (size_t i = 0; i < vertices.size(); i++) {
+        if (terrainEncoded[i]) {
+            TerrainEncoding::encode(vertices[i], dst + offsets[i]);
+        } else if (sizes[i] > 0) {
+            std::memcpy(dst + offsets[i], vertices[i].data(), sizes[i]);
+        }
+    }
+}
+
+ChunkGeometrySpill::ChunkGeometrySpill(const uint8_t *staging,
+                                       const ChunkGeometryLayout &layout,
+                                       std::vector<uint32_t> vertexCounts)
+    : data(staging, staging + layout.totalSize),
+      offsets(layout.offsets),
+      vertexCounts(std::move(vertexCounts)),
+      terrainEncoded(layout.terrainEncoded) {
+    hostBytes.add(data.size());
+}
+
+std::shared_ptr<ChunkGeometrySpill> ChunkGeometrySpill::capture(bool enabled,
+                                                                const uint8_t *staging,
+                                                                const ChunkGeometryLayout &layout,
+                                                                const std::vector<uint32_t> &vertexCounts) {
+    if (!enabled) return nullptr;
+    return std::make_shared<ChunkGeometrySpill>(staging, layout, vertexCounts);
+}
+
+std::vector<vk::VertexFormat::PBRTriangle> ChunkGeometrySpill::readback(uint32_t geometry) {
+    std::vector<vk::VertexFormat::PBRTriangle> vertices(vertexCounts[geometry]);
+    const uint8_t *encoded = data.data() + offsets[geometry];
+    if (terrainEncoded[geometry]) {
+        TerrainEncoding::decode(encoded, vertices.size(), vertices.data());
+    } else if (!vertices.empty()) {
+        std::memcpy(vertices.data(), encoded, vertices.size() * sizeof(vk::VertexFormat::PBRTriangle));
+    }
+    return vertices;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "common/shared.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// host memory one chunk build holds on its way to the device, every change is mirrored into a process wide total that
+// Chunks::hostGeometryBytes reports. whatever is still held is returned on destruction
+class ChunkHostBytes {
+  public:
+    ChunkHostBytes() = default;
+    ChunkHostBytes(const ChunkHostBytes &) = delete;
+    ChunkHostBytes &operator=(const ChunkHostBytes &) = delete;
+    ~ChunkHostBytes();
+
+    void add(int64_t bytes);
+    int64_t held();
+
+    static int64_t total();
+
+  private:
+    int64_t held_ = 0;
+    inline static std::atomic<int64_t> total_ = 0;
+};
+
+// where the geometries of a chunk land in its staging buffer, back to back, each one terrain encoded when it allows it
+struct ChunkGeometryLayout {
+    std::vector<bool> terrainEncoded;
+    std::vector<uint64_t> sizes;
+    std::vector<uint64_t> offsets;
+    uint64_t totalSize = 0;
+
+    static ChunkGeometryLayout plan(const std::vector<std::vector<vk::VertexFormat::PBRTriangle>> &vertices);
+    // dst must hold totalSize bytes
+    void write(const std::vector<std::vector<vk::VertexFormat::PBRTriangle>> &vertices, uint8_t *dst) const;
+};
+
+// encoded host copy of a chunk's uploaded geometry, only kept with Options::chunkGeometrySpill
+struct ChunkGeometrySpill {
+    std::vector<uint8_t> data;
+    std::vector<uint64_t> offsets;
+    std::vector<uint32_t> vertexCounts;
+    std::vector<bool> terrainEncoded;
+    ChunkHostBytes hostBytes;
+
+    ChunkGeometrySpill(const uint8_t *staging, const ChunkGeometryLayout &layout, std::vector<uint32_t> vertexCounts);
+
+    // copies the staging bytes written with the layout, nullptr while the spill is disabled
+    static std::shared_ptr<ChunkGeometrySpill> capture(bool enabled,
+                                                       const uint8_t *staging,
+                                                       const ChunkGeometryLayout &layout,
+                                                       const std::vector<uint32_t> &vertexCounts);
+
+    std::vector<vk::VertexFormat::PBRTriangle> readback(uint32_t geometry);
+};
@@ -0,0 +1,103 @@
+#include "core/render/chunk_queues.hpp"
+
+#include <utility>
+
+void ChunkBuildQueue::reset(uint32_t numChunks) {
+    heap_.clear();
+    scores_.clear();
+    positions_.assign(numChunks, -1);
+    lastRescoreTime_ = std::chrono::steady_clock::now();
+}
+
+void ChunkBuildQueue::clear() {
+    for (int64_t id : heap_) { positions_[id] = -1; }
+    heap_.clear();
+    scores_.clear();
+}
+
+bool ChunkBuildQueue::empty() {
+    return heap_.empty();
+}
+
+size_t ChunkBuildQueue::size() {
+    return heap_.size();
+}
+
+void ChunkBuildQueue::push(int64_t id, float score) {
+    int64_t position = positions_[id];
+    if (position < 0) {
+        position = heap_.size();
+        heap_.push_back(id);
+        scores_.push_back(score);
+        positions_[id] = position;
+        siftUp(position);
+    } else {
+        float oldScore = scores_[position];
+        scores_[position] = score;
+        if (score > oldScore) {
+            siftUp(position);
+        } else {
+            siftDown(position);
+        }
+    }
+}
+
+int64_t ChunkBuildQueue::pop() {
+    int64_t id = heap_.front();
+    swapEntries(0, heap_.size() - 1);
+    heap_.pop_back();
+    scores_.pop_back();
+    positions_[id] = -1;
+    if (!heap_.empty()) siftDown(0);
+    return id;
+}
+
+void ChunkBuildQueue::swapEntries(size_t a, size_t b) {
+    std::swap(heap_[a], heap_[b]);
+    std::swap(scores_[a], scores_[b]);
+    positions_[heap_[a]] = a;
+    positions_[heap_[b]] = b;
+}
+
+void ChunkBuildQueue::siftUp(size_t i) {
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (scores_[parent] >= scores_[i]) break;
+        swapEntries(parent, i);
+        i = parent;
+    }
+}
+
+void ChunkBuildQueue::siftDown(size_t i) {
+    size_t size = heap_.size();
+    while (true) {
+        size_t largest = i;
+        size_t left = 2 * i + 1, right = 2 * i + 2;
+        if (left < size && scores_[left] > scores_[largest]) largest = left;
+        if (right < size && scores_[right] > scores_[largest]) largest = right;
+        if (largest == i) break;
+        swapEntries(largest, i);
+        i = largest;
+    }
+}
+
+void ChunkChangeQueue::reset(uint32_t numChunks) {
+    ids_.clear();
+    queued_.assign(numChunks, false);
+    generation_++;
+}
+
+void ChunkChangeQueue::push(int64_t id) {
+    if (queued_[id]) return;
+    queued_[id] = true;
+    ids_.push_back(id);
+}
+
+std::vector<int64_t> ChunkChangeQueue::popAll() {
+    for (int64_t id : ids_) { queued_[id] = false; }
+    return std::exchange(ids_, {});
+}
+
+uint64_t ChunkChangeQueue::generation() {
+    return generation_;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <utility>
+#include <vector>
+
+// lock-free multi-producer single-consumer handoff from the ingesting threads to the scheduler
+template <typename T>
+class IngestQueue {
+  public:
+    IngestQueue() = default;
+    IngestQueue(const IngestQueue &) = delete;
+    IngestQueue &operator=(const IngestQueue &) = delete;
+    ~IngestQueue();
+
+    void push(T value);
+    std::vector<T> popAll(); // in push order
+
+  private:
+    struct Node {
+        T value;
+        Node *next;
+    };
+
+    std::atomic<Node *> head_ = nullptr;
+};
+
+// indexed max-heap of queued chunk ids keyed on Chunk1::buildFactor
+// scores are cached and only recomputed in bulk when the camera moved or they got too old
+class ChunkBuildQueue {
+  public:
+    constexpr static float RESCORE_DISTANCE = 8;   // blocks
+    constexpr static float RESCORE_INTERVAL = 250; // ms
+
+    void reset(uint32_t numChunks);
+    void clear();
+    bool empty();
+    size_t size();
+
+    void push(int64_t id, float score); // updates the key if already queued
+    int64_t pop();
+    // score(id, currentTime) is called for every queued id once a rescore is due
+    template <typename Score>
+    void tryRescore(glm::vec3 cameraPos, Score &&score);
+
+  private:
+    void swapEntries(size_t a, size_t b);
+    void siftUp(size_t i);
+    void siftDown(size_t i);
+
+    std::vector<int64_t> heap_;
+    std::vector<float> scores_;
+    std::vector<int64_t> positions_; // heap position of each chunk id, -1 if not queued
+
+    glm::vec3 lastRescoreCameraPos_{0};
+    std::chrono::steady_clock::time_point lastRescoreTime_;
+};
+
+// ids of the chunks whose BLAS was published, swapped for its compacted copy or dropped, each id is queued once until
+// the ray tracing prepare takes them. a reset bumps the generation, the consumer then starts over from all chunks
+class ChunkChangeQueue {
+  public:
+    void reset(uint32_t numChunks);
+    void push(int64_t id);
+    std::vector<int64_t> popAll(); // in push order
+    uint64_t generation();
+
+  private:
+    std::vector<int64_t> ids_;
+    std::vector<bool> queued_;
+    uint64_t generation_ = 0;
+};
+
+template <typename Score>
+void ChunkBuildQueue::tryRescore(glm::vec3 cameraPos, Score &&score) {
+    auto currentTime = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double, std::milli>(currentTime - lastRescoreTime_).count();
+    if (elapsed < RESCORE_INTERVAL && glm::distance(cameraPos, lastRescoreCameraPos_) < RESCORE_DISTANCE) return;
+
+    lastRescoreTime_ = currentTime;
+    lastRescoreCameraPos_ = cameraPos;
+
+    for (size_t i = 0; i < heap_.size(); i++) { scores_[i] = score(heap_[i], currentTime); }
+    // bottom-up heapify, O(n)
+    for (size_t i = heap_.size() / 2; i-- > 0;) { siftDown(i); }
+}
+
+template <typename T>
+IngestQueue<T>::~IngestQueue() {
+    popAll();
+}
+
+template <typename T>
+void IngestQueue<T>::push(T value) {
+    Node *node = new Node{std::move(value), head_.load(std::memory_order_relaxed)};
+    while (!head_.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {}
+}
+
+template <typename T>
+std::vector<T> IngestQueue<T>::popAll() {
+    Node *node = head_.exchange(nullptr, std::memory_order_acquire);
+
+    std::vector<T> values;
+    while (node != nullptr) {
+        Node *next = node->next;
+        values.push_back(std::move(node->value));
+        delete node;
+        node = next;
+    }
+    std::reverse(values.begin(), values.end());
+    return values;
+}
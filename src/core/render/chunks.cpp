@@ -7,6 +7,16 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstring>
+#include <iostream>
+
+std::ostream &chunksCout() {
+    return std::cout << "[Chunks] ";
+}
+
+std::ostream &chunksCerr() {
+    return std::cerr << "[Chunks] ";
+}
 
 ChunkBuildData::ChunkBuildData(int64_t id,
                                int x,
@@ -18,7 +28,7 @@ ChunkBuildData::ChunkBuildData(int64_t id,
                                uint32_t geometryCount,
                                std::vector<World::GeometryTypes> &&geometryTypes,
                                std::vector<std::vector<vk::VertexFormat::PBRTriangle>> &&vertices,
-                               std::vector<std::vector<uint32_t>> &&indices)
+                               std::vector<uint32_t> &&indexCounts)
     : id(id),
       x(x),
       y(y),
@@ -29,73 +39,119 @@ ChunkBuildData::ChunkBuildData(int64_t id,
       geometryCount(geometryCount),
       geometryTypes(std::move(geometryTypes)),
       vertices(std::move(vertices)),
-      indices(std::move(indices)),
+      indexCounts(std::move(indexCounts)),
       blas(nullptr),
-      blasBuilder(nullptr) {}
+      blasBuilder(nullptr) {
+    for (auto &geometryVertices : this->vertices) {
+        vertexCounts.push_back(geometryVertices.size());
+        hostBytes.add(geometryVertices.size() * sizeof(vk::VertexFormat::PBRTriangle));
+    }
+}
 
 void ChunkBuildData::build() {
     auto framework = Renderer::instance().framework();
     auto vma = framework->vma();
     auto device = framework->device();
     auto physicalDevice = framework->physicalDevice();
+    auto geometryArena = Renderer::instance().world()->chunks()->geometryArena();
+
+    uint32_t maxQuadCount = 0;
+    for (int i = 0; i < geometryCount; i++) { maxQuadCount = std::max(maxQuadCount, indexCounts[i] / 6); }
+    quadIndexBuffer = Renderer::instance().buffers()->quadIndexBuffer(maxQuadCount);
+
+    // one transient staging buffer for the whole chunk, released once the upload finished
+    stagingLayout = ChunkGeometryLayout::plan(vertices);
+    stagingBuffer = vk::HostVisibleBuffer::create(vma, device, std::max<VkDeviceSize>(stagingLayout.totalSize, 1),
+                                                  VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+    hostBytes.add(stagingLayout.totalSize);
 
+    uint8_t *stagingPtr = static_cast<uint8_t *>(stagingBuffer->mappedPtr());
+    stagingLayout.write(vertices, stagingPtr);
+    stagingBuffer->flush();
     for (int i = 0; i < geometryCount; i++) {
-        auto vertexBuffer =
-            vk::DeviceLocalBuffer::create(vma, device, vertices[i].size() * sizeof(vk::VertexFormat::PBRTriangle),
-                                          VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
-                                              VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
-                                              VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
-        vertexBuffer->uploadToStagingBuffer(vertices[i].data());
-        vertexBuffers.push_back(vertexBuffer);
-
-        auto indexBuffer =
-            vk::DeviceLocalBuffer::create(vma, device, indices[i].size() * sizeof(uint32_t),
-                                          VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
-                                              VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
-                                              VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
-        indexBuffer->uploadToStagingBuffer(indices[i].data());
-        indexBuffers.push_back(indexBuffer);
+        auto range = geometryArena->allocate(stagingLayout.sizes[i]);
+        vertexBuffers.push_back(range);
+        // terrain encoded geometry is tagged for world_vertex.glsl
+        vertexBufferAddresses.push_back(range->bufferAddress() | (stagingLayout.terrainEncoded[i] ? 1 : 0));
     }
 
+    geometrySpill =
+        ChunkGeometrySpill::capture(Renderer::options.chunkGeometrySpill, stagingPtr, stagingLayout, vertexCounts);
+
+    // the staging buffer holds everything the upload needs from here on
+    int64_t vertexBytes = 0;
+    for (auto &geometryVertices : vertices) {
+        vertexBytes += geometryVertices.size() * sizeof(vk::VertexFormat::PBRTriangle);
+    }
+    std::vector<std::vector<vk::VertexFormat::PBRTriangle>>().swap(vertices);
+    hostBytes.add(-vertexBytes);
+
     blasBuilder = vk::BLASBuilder::create();
     auto blasGeometryBuilder = blasBuilder->beginGeometries();
     for (int i = 0; i < geometryCount; i++) {
-        blasGeometryBuilder->defineTriangleGeomrtry<vk::VertexFormat::PBRTriangle>(
-            vertexBuffers[i], vertices[i].size(), indexBuffers[i], indices[i].size(),
-            geometryTypes[i] == World::WORLD_SOLID);
+        bool isOpaque = geometryTypes[i] == World::WORLD_SOLID;
+        if (stagingLayout.terrainEncoded[i]) {
+            blasGeometryBuilder->defineTriangleGeomrtry<vk::VertexFormat::TerrainVertex>(
+                vertexBuffers[i]->bufferAddress() + sizeof(vk::VertexFormat::TerrainGeometryHeader),
+                vertexCounts[i], quadIndexBuffer->bufferAddress(), indexCounts[i], isOpaque);
+        } else {
+            blasGeometryBuilder->defineTriangleGeomrtry<vk::VertexFormat::PBRTriangle>(
+                vertexBuffers[i]->bufferAddress(), vertexCounts[i], quadIndexBuffer->bufferAddress(), indexCounts[i],
+                isOpaque);
+        }
     }
     blasGeometryBuilder->endGeometries();
-    blas = blasBuilder->defineBuildProperty(VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_BUILD_BIT_KHR)
+    blas = blasBuilder
+               ->defineBuildProperty(VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_BUILD_BIT_KHR |
+                                     VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR)
                ->querySizeInfo(device)
                ->allocateBuffers(physicalDevice, device, vma)
                ->build(device);
 }
 
+void ChunkBuildData::uploadToBuffer(std::shared_ptr<vk::CommandBuffer> commandBuffer) {
+    for (int i = 0; i < geometryCount; i++) {
+        if (stagingLayout.sizes[i] == 0) continue;
+
+        VkBufferCopy copyRegion = {stagingLayout.offsets[i], vertexBuffers[i]->offset(), stagingLayout.sizes[i]};
+        vkCmdCopyBuffer(commandBuffer->vkCommandBuffer(), stagingBuffer->vkBuffer(),
+                        vertexBuffers[i]->buffer()->vkBuffer(), 1, &copyRegion);
+    }
+}
+
+// once the batch that uploaded and built the chunk has completed, only the chunk's own references are needed
+void ChunkBuildData::releaseStaging() {
+    if (stagingBuffer == nullptr) return;
+
+    stagingBuffer = nullptr;
+    hostBytes.add(-static_cast<int64_t>(stagingLayout.totalSize));
+
+    blasBuilder = nullptr;
+    quadIndexBuffer = nullptr;
+}
+
 ChunkBuildDataBatch::ChunkBuildDataBatch(uint32_t maxBatchSize,
-                                         std::set<int64_t> &queuedIndexSet,
+                                         ChunkBuildQueue &queuedIndex,
                                          std::vector<std::shared_ptr<Chunk1>> &chunks,
                                          std::vector<std::shared_ptr<ChunkBuildData>> &chunkBuildDatas,
                                          glm::vec3 cameraPos) {
-    std::vector<int64_t> queuedIndices;
-    std::copy(queuedIndexSet.begin(), queuedIndexSet.end(), std::back_inserter(queuedIndices));
-    auto currentTime = std::chrono::steady_clock::now();
-    std::sort(queuedIndices.begin(), queuedIndices.end(), [&](int64_t a, int64_t b) -> bool {
-        return chunks[a]->buildFactor(currentTime, cameraPos) > chunks[b]->buildFactor(currentTime, cameraPos);
+    queuedIndex.tryRescore(cameraPos, [&](int64_t id, std::chrono::steady_clock::time_point currentTime) {
+        return chunks[id]->buildFactor(currentTime, cameraPos);
     });
 
-    for (int i = 0; i < std::min((size_t)maxBatchSize, queuedIndices.size()); i++) {
-        auto iter = queuedIndexSet.find(queuedIndices[i]);
-        if (iter != queuedIndexSet.end()) { queuedIndexSet.erase(iter); }
-
-        auto data = chunkBuildDatas[queuedIndices[i]];
+    // the batch owns the popped data from here on, a later ingest of the chunk takes the slot again
+    for (int i = 0; i < maxBatchSize && !queuedIndex.empty(); i++) {
+        auto data = std::move(chunkBuildDatas[queuedIndex.pop()]);
         data->build();
         batchData.push_back(data);
     }
 }
 
-ChunkBuildScheduler::ChunkBuildScheduler(std::set<int64_t> &queuedIndex,
+ChunkBuildScheduler::ChunkBuildScheduler(ChunkBuildQueue &queuedIndex,
                                          std::vector<std::shared_ptr<Chunk1>> &chunks,
                                          std::vector<std::shared_ptr<ChunkBuildData>> &chunkBuildDatas,
+                                         ChunkIngestQueue &ingestQueue,
+                                         ChunkChangeQueue &changedChunks,
                                          std::recursive_mutex &mutex,
                                          std::shared_ptr<vk::HostVisibleBuffer> &chunkPackedData,
                                          uint32_t chunkBuildingBatchSize,
@@ -103,101 +159,163 @@ ChunkBuildScheduler::ChunkBuildScheduler(std::set<int64_t> &queuedIndex,
     : queuedIndex_(queuedIndex),
       chunks_(chunks),
       chunkBuildDatas_(chunkBuildDatas),
+      ingestQueue_(ingestQueue),
+      changedChunks_(changedChunks),
       mutex_(mutex),
       chunkPackedData_(chunkPackedData),
       chunkBuildingBatchSize_(chunkBuildingBatchSize),
-      chunkBuildingTotalBatches_(chunkBuildingTotalBatches) {
-    auto framework = Renderer::instance().framework();
-    auto device = framework->device();
+      chunkBuildingTotalBatches_(chunkBuildingTotalBatches) {}
+
+// versions are assigned here, in push order, so a later ingest of the same chunk always wins
+void ChunkBuildScheduler::drainIngestQueue() {
+    std::unique_lock<std::recursive_mutex> lock(mutex_);
+    auto chunkBuildDatas = ingestQueue_.popAll();
+    if (chunkBuildDatas.empty()) return;
 
-    uint32_t numFences = chunkBuildingTotalBatches_;
-    for (int i = 0; i < numFences; i++) { freeFences_.push(vk::Fence::create(device)); }
+    auto currentTime = std::chrono::steady_clock::now();
+    glm::vec3 cameraPos = Renderer::instance().world()->getCameraPos();
+    for (auto &chunkBuildData : chunkBuildDatas) {
+        if (chunkBuildData->id < 0 || chunkBuildData->id >= (int64_t)chunks_.size()) continue;
+
+        auto &chunk = chunks_[chunkBuildData->id];
+        chunkBuildData->version = chunk->latestVersion++;
+        queuedIndex_.push(chunkBuildData->id, chunk->buildFactor(currentTime, cameraPos));
+        chunkBuildDatas_[chunkBuildData->id] = chunkBuildData;
+    }
 }
 
+// batches share the secondary queue, so they complete in submission order and the scan stops at the first one the
+// timeline has not reached yet
 void ChunkBuildScheduler::tryCheckBatchesFinish() {
     auto framework = Renderer::instance().framework();
-    auto device = framework->device();
 
     std::unique_lock<std::recursive_mutex> lock(mutex_);
-    auto iterFence = buildingFences_.begin();
-    auto iterBatch = buildingBatches_.begin();
-    for (; iterFence != buildingFences_.end() && iterBatch != buildingBatches_.end();) {
-        if (vkWaitForFences(device->vkDevice(), 1, &(*iterFence)->vkFence(), true, 0) == VK_SUCCESS) {
-            vkResetFences(device->vkDevice(), 1, &(*iterFence)->vkFence());
-            freeFences_.push(*iterFence);
-
-            for (auto chunkBuildData : (*iterBatch)->batchData) {
-                chunks_[chunkBuildData->id]->enqueue(chunkBuildData);
-
-                ChunkPackedData data = {
-                    .geometryCount = chunkBuildData->geometryCount,
-                };
-
-                chunkPackedData_->uploadToBuffer(&data, sizeof(ChunkPackedData),
-                                                 chunkBuildData->id * sizeof(ChunkPackedData));
-            }
+    if (buildingBatches_.empty()) return;
 
-            iterFence = buildingFences_.erase(iterFence);
-            iterBatch = buildingBatches_.erase(iterBatch);
-        }
+    uint64_t completed = framework->secondaryTimeline()->completed();
+    while (!buildingBatches_.empty() && buildingBatches_.front()->timelineValue <= completed) {
+        retireBatch(buildingBatches_.front());
+        buildingBatches_.pop_front();
     }
 }
 
 void ChunkBuildScheduler::waitAllBatchesFinish() {
     auto framework = Renderer::instance().framework();
-    auto device = framework->device();
 
     std::unique_lock<std::recursive_mutex> lock(mutex_);
-    auto iterFence = buildingFences_.begin();
-    auto iterBatch = buildingBatches_.begin();
-    for (; iterFence != buildingFences_.end() && iterBatch != buildingBatches_.end();) {
-        if (vkWaitForFences(device->vkDevice(), 1, &(*iterFence)->vkFence(), true, UINT64_MAX) == VK_SUCCESS) {
-            vkResetFences(device->vkDevice(), 1, &(*iterFence)->vkFence());
-            freeFences_.push(*iterFence);
-
-            for (auto chunkBuildData : (*iterBatch)->batchData) {
-                chunks_[chunkBuildData->id]->enqueue(chunkBuildData);
-
-                ChunkPackedData data = {
-                    .geometryCount = chunkBuildData->geometryCount,
-                };
-
-                chunkPackedData_->uploadToBuffer(&data, sizeof(ChunkPackedData),
-                                                 chunkBuildData->id * sizeof(ChunkPackedData));
-            }
+    if (buildingBatches_.empty()) return;
+
+    framework->secondaryTimeline()->wait(buildingBatches_.back()->timelineValue);
+    for (auto &batch : buildingBatches_) { retireBatch(batch); }
+    buildingBatches_.clear();
+}
+
+// the chunks take the new BLASes right after the submit, the frame being recorded waits for the batch on the gpu
+void ChunkBuildScheduler::publishBatch(std::shared_ptr<ChunkBuildDataBatch> batch) {
+    for (auto chunkBuildData : batch->batchData) {
+        chunks_[chunkBuildData->id]->enqueue(chunkBuildData);
+        changedChunks_.push(chunkBuildData->id);
 
-            iterFence = buildingFences_.erase(iterFence);
-            iterBatch = buildingBatches_.erase(iterBatch);
+        ChunkPackedData data = {
+            .geometryCount = chunkBuildData->geometryCount,
+        };
+
+        chunkPackedData_->uploadToBuffer(&data, sizeof(ChunkPackedData), chunkBuildData->id * sizeof(ChunkPackedData));
+    }
+
+    Renderer::instance().framework()->waitBackendInFrame(batch->timelineValue);
+}
+
+void ChunkBuildScheduler::retireBatch(std::shared_ptr<ChunkBuildDataBatch> batch) {
+    auto framework = Renderer::instance().framework();
+    framework->gpuProfiler()->resolve(batch->profilerQueries);
+    freeCommandBuffers_.push_back(batch->commandBuffer);
+    batch->commandBuffer = nullptr;
+
+    std::vector<uint64_t> timestamps;
+    if (batch->timestamps != nullptr) {
+        if (batch->timestamps->results(0, 2, timestamps) && timestamps[1] > timestamps[0] &&
+            !batch->batchData.empty()) {
+            double timestampPeriod = framework->physicalDevice()->properties().limits.timestampPeriod;
+            double costMs = (timestamps[1] - timestamps[0]) * timestampPeriod * 1e-6 / batch->batchData.size();
+            chunkBuildCostMs_ = chunkBuildCostMs_ == 0.0 ? costMs : chunkBuildCostMs_ * 0.8 + costMs * 0.2;
         }
+        freeTimestamps_.push_back(batch->timestamps);
+        batch->timestamps = nullptr;
+    }
+
+    for (auto &chunkBuildData : batch->batchData) { chunkBuildData->releaseStaging(); }
+    batch->batchData.clear();
+}
+
+// the batch is given a share of the target frame time and sized from the measured gpu cost per chunk, it shrinks in
+// proportion while frames run over the target. without a measurement the size is halved while frames run over and
+// grown by one chunk while they stay well inside
+uint32_t ChunkBuildScheduler::sliceBatchSize(uint32_t maxBatchSize) {
+    maxBatchSize = std::max(1u, maxBatchSize);
+    if (Renderer::options.chunkBuildFrameBudgetMs <= 0.0f) return maxBatchSize;
+
+    // a cap above 1000 fps, like the uncapped default, sets no reachable target, the option stands in for it then
+    double targetMs = Renderer::options.chunkBuildFrameBudgetMs;
+    uint32_t maxFps = Renderer::options.maxFps;
+    if (maxFps > 0 && maxFps <= 1000) targetMs = 1000.0 / maxFps;
+
+    double frameTimeMs = Renderer::instance().framework()->frameTimeMs();
+    if (chunkBuildCostMs_ > 0.0) {
+        double sliceMs = targetMs * BUILD_FRAME_SHARE;
+        if (frameTimeMs > targetMs) sliceMs *= targetMs / frameTimeMs;
+        sliceSize_ = static_cast<uint32_t>(std::min<double>(sliceMs / chunkBuildCostMs_, maxBatchSize));
+    } else if (frameTimeMs > targetMs) {
+        sliceSize_ = sliceSize_ / 2;
+    } else if (frameTimeMs != 0.0 && frameTimeMs < targetMs * 0.9) {
+        sliceSize_++;
     }
+    sliceSize_ = std::clamp(sliceSize_, 1u, maxBatchSize);
+    return sliceSize_;
 }
 
 void ChunkBuildScheduler::tryScheduleBatches(uint32_t maxBatchSize) {
     if (!Renderer::instance().framework()->isRunning()) return;
     std::unique_lock<std::recursive_mutex> lock(mutex_);
-    if (!freeFences_.empty() && !queuedIndex_.empty()) {
-        auto fence = freeFences_.front();
-
+    drainIngestQueue();
+    if (buildingBatches_.size() < chunkBuildingTotalBatches_ && !queuedIndex_.empty()) {
         glm::vec3 cameraPos = Renderer::instance().world()->getCameraPos();
-        auto chunkBuildDataBatch =
-            ChunkBuildDataBatch::create(maxBatchSize, queuedIndex_, chunks_, chunkBuildDatas_, cameraPos);
+        auto chunkBuildDataBatch = ChunkBuildDataBatch::create(sliceBatchSize(maxBatchSize), queuedIndex_, chunks_,
+                                                               chunkBuildDatas_, cameraPos);
 
         auto framework = Renderer::instance().framework();
-        auto vma = framework->vma();
         auto device = framework->device();
         auto physicalDevice = Renderer::instance().framework()->physicalDevice();
         auto secondaryQueueIndex = physicalDevice->secondaryQueueIndex();
 
-        auto worldAsyncBuffer = framework->worldAsyncCommandBuffer();
-
         if (chunkBuildDataBatch->batchData.size() > 0) {
+            if (freeCommandBuffers_.empty()) {
+                freeCommandBuffers_.push_back(vk::CommandBuffer::create(device, framework->asyncCommandPool()));
+            }
+            auto worldAsyncBuffer = freeCommandBuffers_.back();
+            freeCommandBuffers_.pop_back();
+            chunkBuildDataBatch->commandBuffer = worldAsyncBuffer;
+
             worldAsyncBuffer->begin();
 
-            for (auto chunkBuildData : chunkBuildDataBatch->batchData) {
-                for (int i = 0; i < chunkBuildData->geometryCount; i++) {
-                    chunkBuildData->vertexBuffers[i]->uploadToBuffer(worldAsyncBuffer);
-                    chunkBuildData->indexBuffers[i]->uploadToBuffer(worldAsyncBuffer);
+            // the secondary queue may be a separate compute or transfer family, its own support decides
+            if (physicalDevice->timestampValidBits(secondaryQueueIndex) > 0) {
+                if (freeTimestamps_.empty()) {
+                    freeTimestamps_.push_back(vk::QueryPool::create(device, VK_QUERY_TYPE_TIMESTAMP, 2));
                 }
+                chunkBuildDataBatch->timestamps = freeTimestamps_.back();
+                freeTimestamps_.pop_back();
+                chunkBuildDataBatch->timestamps->reset(worldAsyncBuffer, 0, 2);
+                worldAsyncBuffer->writeTimestamp(chunkBuildDataBatch->timestamps, 0,
+                                                 VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+            }
+
+            chunkBuildDataBatch->profilerQueries = framework->gpuProfiler()->acquire(worldAsyncBuffer, true);
+            uint32_t profilerZone =
+                GpuProfiler::beginZone(chunkBuildDataBatch->profilerQueries, worldAsyncBuffer, "chunk_build");
+
+            for (auto chunkBuildData : chunkBuildDataBatch->batchData) {
+                chunkBuildData->uploadToBuffer(worldAsyncBuffer);
             }
 
             std::vector<vk::CommandBuffer::BufferMemoryBarrier> bufferBarriers;
@@ -210,17 +328,9 @@ void ChunkBuildScheduler::tryScheduleBatches(uint32_t maxBatchSize) {
                         .dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
                         .srcQueueFamilyIndex = secondaryQueueIndex,
                         .dstQueueFamilyIndex = secondaryQueueIndex,
-                        .buffer = chunkBuildData->vertexBuffers[i],
-                    });
-
-                    bufferBarriers.push_back(vk::CommandBuffer::BufferMemoryBarrier{
-                        .srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-                        .srcAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
-                        .dstStageMask = VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
-                        .dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
-                        .srcQueueFamilyIndex = secondaryQueueIndex,
-                        .dstQueueFamilyIndex = secondaryQueueIndex,
-                        .buffer = chunkBuildData->indexBuffers[i],
+                        .buffer = chunkBuildData->vertexBuffers[i]->buffer(),
+                        .offset = chunkBuildData->vertexBuffers[i]->offset(),
+                        .size = chunkBuildData->vertexBuffers[i]->size(),
                     });
                 }
                 worldAsyncBuffer->barriersBufferImage(bufferBarriers, {});
@@ -232,23 +342,16 @@ void ChunkBuildScheduler::tryScheduleBatches(uint32_t maxBatchSize) {
             }
             vk::BLASBuilder::batchSubmit(builders, worldAsyncBuffer);
 
+            GpuProfiler::endZone(chunkBuildDataBatch->profilerQueries, worldAsyncBuffer, profilerZone);
+            if (chunkBuildDataBatch->timestamps != nullptr) {
+                worldAsyncBuffer->writeTimestamp(chunkBuildDataBatch->timestamps, 1,
+                                                 VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+            }
             worldAsyncBuffer->end();
 
-            VkSubmitInfo vkSubmitInfo = {};
-            vkSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-            vkSubmitInfo.waitSemaphoreCount = 0;
-            vkSubmitInfo.pWaitSemaphores = nullptr;
-            vkSubmitInfo.pWaitDstStageMask = nullptr;
-            vkSubmitInfo.commandBufferCount = 1;
-            vkSubmitInfo.pCommandBuffers = &worldAsyncBuffer->vkCommandBuffer();
-            vkSubmitInfo.signalSemaphoreCount = 0;
-            vkSubmitInfo.pSignalSemaphores = nullptr;
-
-            vkQueueSubmit(device->secondaryQueue(), 1, &vkSubmitInfo, fence->vkFence());
-
-            freeFences_.pop();
-            buildingFences_.push_back(fence);
+            chunkBuildDataBatch->timelineValue = framework->submitBackend(worldAsyncBuffer);
             buildingBatches_.push_back(chunkBuildDataBatch);
+            publishBatch(chunkBuildDataBatch);
         }
     }
 }
@@ -261,6 +364,135 @@ uint32_t ChunkBuildScheduler::chunkBuildingTotalBatches() {
     return chunkBuildingTotalBatches_;
 }
 
+ChunkCompactor::ChunkCompactor(std::vector<std::shared_ptr<Chunk1>> &chunks,
+                               ChunkChangeQueue &changedChunks,
+                               std::recursive_mutex &mutex,
+                               uint32_t settleFrames)
+    : chunks_(chunks), changedChunks_(changedChunks), mutex_(mutex), settleFrames_(settleFrames) {
+    auto framework = Renderer::instance().framework();
+    auto device = framework->device();
+
+    queryPool_ = vk::QueryPool::create(device, VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR, MAX_BATCH_SIZE);
+    commandBuffer_ = vk::CommandBuffer::create(device, framework->asyncCommandPool());
+}
+
+// three frames per batch: query the compacted sizes, copy into tight allocations, then swap them in
+void ChunkCompactor::tryCompact(uint64_t frameCount) {
+    if (!Renderer::instance().framework()->isRunning()) return;
+
+    auto framework = Renderer::instance().framework();
+    auto vma = framework->vma();
+    auto device = framework->device();
+    auto &gc = framework->gc();
+
+    std::unique_lock<std::recursive_mutex> lock(mutex_);
+
+    if (stage_ != IDLE && !framework->secondaryTimeline()->reached(timelineValue_)) return;
+
+    switch (stage_) {
+        case IDLE: {
+            candidates_.clear();
+            for (int i = 0; i < MAX_SCAN_PER_FRAME && i < chunks_.size() && candidates_.size() < MAX_BATCH_SIZE; i++) {
+                if (scanCursor_ >= chunks_.size()) scanCursor_ = 0;
+                int64_t id = scanCursor_++;
+
+                auto &chunk = chunks_[id];
+                if (chunk->blas == nullptr || chunk->blasCompacted) continue;
+                if (frameCount - chunk->lastUpdateFrame < settleFrames_) continue;
+
+                candidates_.push_back(Candidate{.id = id, .blas = chunk->blas});
+            }
+            if (candidates_.empty()) return;
+
+            std::vector<std::shared_ptr<vk::BLAS>> blases;
+            for (auto &candidate : candidates_) { blases.push_back(candidate.blas); }
+
+            commandBuffer_->begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+            commandBuffer_->barriersMemory({vk::CommandBuffer::MemoryBarrier{
+                .srcStageMask = VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+                .srcAccessMask = VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR,
+                .dstStageMask = VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+                .dstAccessMask = VK_ACCESS_2_ACCELERATION_STRUCTURE_READ_BIT_KHR,
+            }});
+            vk::BLAS::writeCompactedSizes(blases, queryPool_, commandBuffer_);
+            commandBuffer_->end();
+            submit();
+
+            stage_ = QUERYING;
+            break;
+        }
+        case QUERYING: {
+            std::vector<uint64_t> compactedSizes;
+            queryPool_->results(0, candidates_.size(), compactedSizes, true);
+
+            bool recorded = false;
+            for (int i = 0; i < candidates_.size(); i++) {
+                auto &candidate = candidates_[i];
+                auto &chunk = chunks_[candidate.id];
+                if (chunk->blas != candidate.blas) continue; // rebuilt in the meantime
+
+                if (compactedSizes[i] == 0 || compactedSizes[i] >= candidate.blas->blasBuffer()->size()) {
+                    chunk->blasCompacted = true;
+                    continue;
+                }
+
+                if (!recorded) {
+                    commandBuffer_->begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+                    recorded = true;
+                }
+                candidate.compactedBLAS =
+                    vk::BLAS::compact(device, vma, candidate.blas, compactedSizes[i], commandBuffer_);
+            }
+
+            if (recorded) {
+                commandBuffer_->end();
+                submit();
+                stage_ = COPYING;
+            } else {
+                candidates_.clear();
+                stage_ = IDLE;
+            }
+            break;
+        }
+        case COPYING: {
+            for (auto &candidate : candidates_) {
+                if (candidate.compactedBLAS == nullptr) continue;
+
+                auto &chunk = chunks_[candidate.id];
+                if (chunk->blas != candidate.blas) continue; // rebuilt in the meantime, drop the copy
+
+                originalBytes_ += candidate.blas->blasBuffer()->size();
+                compactedBytes_ += candidate.compactedBLAS->blasBuffer()->size();
+
+                gc.collect(chunk->blas);
+                chunk->blas = candidate.compactedBLAS;
+                chunk->blasCompacted = true;
+                changedChunks_.push(candidate.id);
+            }
+            candidates_.clear();
+            stage_ = IDLE;
+
+#ifdef DEBUG
+            std::cout << "[ChunkCompactor] compacted " << originalBytes_ << " bytes of BLAS into " << compactedBytes_
+                      << " bytes" << std::endl;
+#endif
+            break;
+        }
+    }
+}
+
+void ChunkCompactor::submit() {
+    timelineValue_ = Renderer::instance().framework()->submitBackend(commandBuffer_);
+}
+
+VkDeviceSize ChunkCompactor::originalBytes() {
+    return originalBytes_;
+}
+
+VkDeviceSize ChunkCompactor::compactedBytes() {
+    return compactedBytes_;
+}
+
 float Chunk1::buildFactor(std::chrono::steady_clock::time_point currentTime, glm::vec3 cameraPos) {
     double tDiff = std::chrono::duration<double, std::milli>(currentTime - lastUpdate).count();
     double dDiff = glm::distance(cameraPos, glm::vec3{x, y, z});
@@ -283,34 +515,34 @@ void Chunk1::enqueue(std::shared_ptr<ChunkBuildData> chunkBuildData) {
 
     if (chunkBuildData->version > blasVersion) {
         blasVersion = chunkBuildData->version;
+        blasCompacted = false;
+        lastUpdateFrame = Renderer::instance().world()->chunks()->frameCount();
 
         gc.collect(blas);
         blas = chunkBuildData->blas;
 
         gc.collect(vertexBuffers);
-        vertexBuffers = std::make_shared<std::vector<std::shared_ptr<vk::DeviceLocalBuffer>>>(
+        vertexBuffers = std::make_shared<std::vector<std::shared_ptr<vk::BufferArenaRange>>>(
             std::move(chunkBuildData->vertexBuffers));
+        vertexBufferAddresses =
+            std::make_shared<std::vector<VkDeviceAddress>>(std::move(chunkBuildData->vertexBufferAddresses));
 
-        gc.collect(indexBuffers);
-        indexBuffers = std::make_shared<std::vector<std::shared_ptr<vk::DeviceLocalBuffer>>>(
-            std::move(chunkBuildData->indexBuffers));
+        gc.collect(quadIndexBuffer);
+        quadIndexBuffer = chunkBuildData->quadIndexBuffer;
     } else {
         gc.collect(chunkBuildData->blas);
 
-        gc.collect(std::make_shared<std::vector<std::shared_ptr<vk::DeviceLocalBuffer>>>(
+        gc.collect(std::make_shared<std::vector<std::shared_ptr<vk::BufferArenaRange>>>(
             std::move(chunkBuildData->vertexBuffers)));
-
-        gc.collect(std::make_shared<std::vector<std::shared_ptr<vk::DeviceLocalBuffer>>>(
-            std::move(chunkBuildData->indexBuffers)));
     }
 
     allVertexCount = chunkBuildData->allVertexCount;
     allIndexCount = chunkBuildData->allIndexCount;
     geometryCount = chunkBuildData->geometryCount;
     geometryTypes = std::make_shared<std::vector<World::GeometryTypes>>(std::move(chunkBuildData->geometryTypes));
-    vertices =
-        std::make_shared<std::vector<std::vector<vk::VertexFormat::PBRTriangle>>>(std::move(chunkBuildData->vertices));
-    indices = std::make_shared<std::vector<std::vector<uint32_t>>>(std::move(chunkBuildData->indices));
+    vertexCounts = std::make_shared<std::vector<uint32_t>>(std::move(chunkBuildData->vertexCounts));
+    geometrySpill = chunkBuildData->geometrySpill;
+    indexCounts = std::make_shared<std::vector<uint32_t>>(std::move(chunkBuildData->indexCounts));
 }
 
 void Chunk1::invalidate() {
@@ -326,9 +558,12 @@ void Chunk1::invalidate() {
 
     gc.collect(vertexBuffers);
     vertexBuffers = nullptr;
+    vertexBufferAddresses = nullptr;
 
-    gc.collect(indexBuffers);
-    indexBuffers = nullptr;
+    gc.collect(quadIndexBuffer);
+    quadIndexBuffer = nullptr;
+
+    geometrySpill = nullptr;
 }
 
 std::shared_ptr<ChunkRenderData> Chunk1::tryGetValid() {
@@ -338,13 +573,15 @@ std::shared_ptr<ChunkRenderData> Chunk1::tryGetValid() {
     ret->z = z;
     ret->blas = blas;
     ret->vertexBuffers = vertexBuffers;
-    ret->indexBuffers = indexBuffers;
+    ret->vertexBufferAddresses = vertexBufferAddresses;
+    ret->quadIndexBuffer = quadIndexBuffer;
     ret->allVertexCount = allVertexCount;
     ret->allIndexCount = allIndexCount;
     ret->geometryCount = geometryCount;
     ret->geometryTypes = geometryTypes;
-    ret->vertices = vertices;
-    ret->indices = indices;
+    ret->vertexCounts = vertexCounts;
+    ret->geometrySpill = geometrySpill;
+    ret->indexCounts = indexCounts;
 
     return ret;
 }
@@ -359,8 +596,8 @@ void Chunks::reset(uint32_t numChunks) {
     auto framework = Renderer::instance().framework();
     auto device = framework->device();
     auto vma = framework->vma();
-    vkQueueWaitIdle(device->mainVkQueue());
-    vkQueueWaitIdle(device->secondaryQueue());
+    framework->waitRenderQueueIdle();
+    framework->waitBackendQueueIdle();
 
     int size = Renderer::instance().framework()->swapchain()->imageCount();
 
@@ -371,9 +608,15 @@ void Chunks::reset(uint32_t numChunks) {
     chunkPackedData_ =
         vk::HostVisibleBuffer::create(vma, device, numChunks * sizeof(ChunkPackedData),
                                       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+    geometryArena_ = vk::BufferArena::create(vma, device, GEOMETRY_PAGE_SIZE, GEOMETRY_ALIGNMENT,
+                                             VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
+                                                 VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
+                                                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
     chunkBuildDatas_.clear();
     chunkBuildDatas_.resize(numChunks);
-    queuedIndex_.clear();
+    queuedIndex_.reset(numChunks);
+    changedChunks_.reset(numChunks);
+    ingestQueue_.popAll();
 
     for (int i = 0; i < numChunks; i++) {
         chunks_[i] = Chunk1::create();
@@ -383,8 +626,11 @@ void Chunks::reset(uint32_t numChunks) {
     uint32_t chunkBuildingBatchSize = Renderer::instance().options.chunkBuildingBatchSize;
     uint32_t chunkBuildingTotalBatches = Renderer::instance().options.chunkBuildingTotalBatches;
     chunkBuildScheduler_ =
-        ChunkBuildScheduler::create(queuedIndex_, chunks_, chunkBuildDatas_, mutex_, chunkPackedData_,
-                                    chunkBuildingBatchSize, chunkBuildingTotalBatches);
+        ChunkBuildScheduler::create(queuedIndex_, chunks_, chunkBuildDatas_, ingestQueue_, changedChunks_, mutex_,
+                                    chunkPackedData_, chunkBuildingBatchSize, chunkBuildingTotalBatches);
+    chunkCompactor_ =
+        ChunkCompactor::create(chunks_, changedChunks_, mutex_,
+                               Renderer::instance().options.chunkCompactionSettleFrames);
 }
 
 void Chunks::resetScheduler() {
@@ -397,8 +643,8 @@ void Chunks::resetScheduler() {
     uint32_t chunkBuildingBatchSize = Renderer::instance().options.chunkBuildingBatchSize;
     uint32_t chunkBuildingTotalBatches = Renderer::instance().options.chunkBuildingTotalBatches;
     chunkBuildScheduler_ =
-        ChunkBuildScheduler::create(queuedIndex_, chunks_, chunkBuildDatas_, mutex_, chunkPackedData_,
-                                    chunkBuildingBatchSize, chunkBuildingTotalBatches);
+        ChunkBuildScheduler::create(queuedIndex_, chunks_, chunkBuildDatas_, ingestQueue_, changedChunks_, mutex_,
+                                    chunkPackedData_, chunkBuildingBatchSize, chunkBuildingTotalBatches);
 }
 
 void Chunks::resetFrame() {
@@ -408,11 +654,16 @@ void Chunks::resetFrame() {
 
     gc.collect(importantBLASBuilders_);
     importantBLASBuilders_ = std::make_shared<std::vector<std::shared_ptr<vk::BLASBuilder>>>();
+
+    frameCount_++;
 }
 
 void Chunks::invalidateChunk(int id) {
     std::unique_lock<std::recursive_mutex> lock(mutex_);
+    // builds ingested before the invalidation must get an older version than it
+    if (chunkBuildScheduler_ != nullptr) chunkBuildScheduler_->drainIngestQueue();
     chunks_[id]->invalidate();
+    changedChunks_.push(id);
 
     ChunkPackedData data = {
         .geometryCount = 0,
@@ -421,68 +672,65 @@ void Chunks::invalidateChunk(int id) {
     chunkPackedData_->uploadToBuffer(&data, sizeof(ChunkPackedData), id * sizeof(ChunkPackedData));
 }
 
-// maybe called async
+// maybe called async, from several of the mod's worker threads at once
 void Chunks::queueChunkBuild(ChunkBuildTask task) {
     uint32_t allVertexCount = 0, allIndexCount = 0;
     std::vector<World::GeometryTypes> geometryTypes;
     std::vector<std::vector<vk::VertexFormat::PBRTriangle>> vertices;
-    std::vector<std::vector<uint32_t>> indices;
+    std::vector<uint32_t> indexCounts;
+    geometryTypes.reserve(task.geometryCount);
+    vertices.reserve(task.geometryCount);
+    indexCounts.reserve(task.geometryCount);
 
     for (int i = 0; i < task.geometryCount; i++) {
         World::GeometryTypes geometryType = static_cast<World::GeometryTypes>(task.geometryTypes[i]);
-        int geometryTexture = task.geometryTextures[i];
         geometryTypes.push_back(geometryType);
 
         auto &geometryVertices = vertices.emplace_back();
-        auto &geometryIndices = indices.emplace_back();
 
         geometryVertices.resize(task.vertexCounts[i]);
         std::memcpy(geometryVertices.data(), task.vertices[i],
                     task.vertexCounts[i] * sizeof(vk::VertexFormat::PBRTriangle));
 
-        for (int j = 0; j < task.vertexCounts[i]; j += 4) {
-            geometryIndices.push_back(j + 0);
-            geometryIndices.push_back(j + 1);
-            geometryIndices.push_back(j + 2);
-            geometryIndices.push_back(j + 2);
-            geometryIndices.push_back(j + 3);
-            geometryIndices.push_back(j + 0);
-        }
+        uint32_t indexCount = task.vertexCounts[i] / 4 * 6;
+        indexCounts.push_back(indexCount);
 
         allVertexCount += geometryVertices.size();
-        allIndexCount += geometryIndices.size();
+        allIndexCount += indexCount;
     }
 
-    auto framework = Renderer::instance().framework();
-    auto vma = framework->vma();
-    auto device = framework->device();
-    auto physicalDevice = framework->physicalDevice();
+    // the version is assigned when the data reaches the scheduler
+    std::shared_ptr<ChunkBuildData> chunkBuildData =
+        ChunkBuildData::create(task.id, task.x, task.y, task.z, -1, allVertexCount, allIndexCount, task.geometryCount,
+                               std::move(geometryTypes), std::move(vertices), std::move(indexCounts));
+
+    if (!task.isImportant) {
+        ingestQueue_.push(chunkBuildData);
+        return;
+    }
 
     std::unique_lock<std::recursive_mutex> lock(mutex_);
 
-    std::shared_ptr<ChunkBuildData> chunkBuildData = ChunkBuildData::create(
-        task.id, task.x, task.y, task.z, chunks_[task.id]->latestVersion++, allVertexCount, allIndexCount,
-        task.geometryCount, std::move(geometryTypes), std::move(vertices), std::move(indices));
+    // older non-important builds of this chunk must not overtake the important one
+    if (chunkBuildScheduler_ != nullptr) chunkBuildScheduler_->drainIngestQueue();
+    chunkBuildData->version = chunks_[task.id]->latestVersion++;
 
-    if (task.isImportant) {
-        chunkBuildData->build();
-        for (int i = 0; i < chunkBuildData->geometryCount; i++) {
-            Renderer::instance().buffers()->queueImportantWorldUpload(chunkBuildData->vertexBuffers[i],
-                                                                      chunkBuildData->indexBuffers[i]);
-        }
-        importantBLASBuilders_->push_back(chunkBuildData->blasBuilder);
+    chunkBuildData->build();
+    auto buffers = Renderer::instance().buffers();
+    for (int i = 0; i < chunkBuildData->geometryCount; i++) {
+        buffers->queueImportantWorldUpload(chunkBuildData->stagingBuffer, chunkBuildData->stagingLayout.offsets[i],
+                                           chunkBuildData->stagingLayout.sizes[i], chunkBuildData->vertexBuffers[i]);
+    }
+    importantBLASBuilders_->push_back(chunkBuildData->blasBuilder);
 
-        chunks_[task.id]->enqueue(chunkBuildData);
+    chunks_[task.id]->enqueue(chunkBuildData);
+    changedChunks_.push(task.id);
 
-        ChunkPackedData data = {
-            .geometryCount = chunkBuildData->geometryCount,
-        };
+    ChunkPackedData data = {
+        .geometryCount = chunkBuildData->geometryCount,
+    };
 
-        chunkPackedData_->uploadToBuffer(&data, sizeof(ChunkPackedData), chunkBuildData->id * sizeof(ChunkPackedData));
-    } else {
-        queuedIndex_.insert(task.id);
-        chunkBuildDatas_[task.id] = chunkBuildData;
-    }
+    chunkPackedData_->uploadToBuffer(&data, sizeof(ChunkPackedData), chunkBuildData->id * sizeof(ChunkPackedData));
 }
 
 bool Chunks::isChunkReady(int64_t id) {
@@ -491,8 +739,17 @@ bool Chunks::isChunkReady(int64_t id) {
     return chunkRenderData->blas != nullptr;
 }
 
+int64_t Chunks::hostGeometryBytes() {
+    return ChunkHostBytes::total();
+}
+
+uint64_t Chunks::frameCount() {
+    return frameCount_;
+}
+
 void Chunks::close() {
     std::unique_lock<std::recursive_mutex> lock(mutex_);
+    ingestQueue_.popAll();
     queuedIndex_.clear();
 }
 
@@ -509,10 +766,23 @@ std::shared_ptr<ChunkBuildScheduler> Chunks::chunkBuildScheduler() {
     return chunkBuildScheduler_;
 }
 
+std::shared_ptr<ChunkCompactor> Chunks::chunkCompactor() {
+    std::unique_lock<std::recursive_mutex> lock(mutex_);
+    return chunkCompactor_;
+}
+
+ChunkChangeQueue &Chunks::changedChunks() {
+    return changedChunks_;
+}
+
 std::vector<std::shared_ptr<vk::BLASBuilder>> &Chunks::importantBLASBuilders() {
     return *importantBLASBuilders_;
 }
 
 std::shared_ptr<vk::HostVisibleBuffer> Chunks::chunkPackedData() {
     return chunkPackedData_;
+}
+
+std::shared_ptr<vk::BufferArena> Chunks::geometryArena() {
+    return geometryArena_;
 }
\ No newline at end of file
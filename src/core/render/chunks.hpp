@@ -5,8 +5,12 @@
 #include "core/all_extern.hpp"
 #include "core/vulkan/all_core_vulkan.hpp"
 
+#include "core/render/chunk_geometry.hpp"
+#include "core/render/chunk_queues.hpp"
+#include "core/render/gpu_profiler.hpp"
 #include "core/render/world.hpp"
 
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <deque>
@@ -40,12 +44,18 @@ struct ChunkBuildData : public SharedObject<ChunkBuildData> {
     uint32_t allIndexCount;
     uint32_t geometryCount;
     std::vector<World::GeometryTypes> geometryTypes;
-    std::vector<std::vector<vk::VertexFormat::PBRTriangle>> vertices;
-    std::vector<std::vector<uint32_t>> indices;
-    std::vector<std::shared_ptr<vk::DeviceLocalBuffer>> vertexBuffers;
-    std::vector<std::shared_ptr<vk::DeviceLocalBuffer>> indexBuffers;
+    std::vector<std::vector<vk::VertexFormat::PBRTriangle>> vertices; // released once encoded into staging
+    std::vector<uint32_t> vertexCounts;
+    std::vector<uint32_t> indexCounts; // indices come from the shared quad index buffer
+    std::vector<std::shared_ptr<vk::BufferArenaRange>> vertexBuffers;
+    std::vector<VkDeviceAddress> vertexBufferAddresses; // as seen by the shaders, see world_vertex.glsl
+    std::shared_ptr<vk::HostVisibleBuffer> quadIndexBuffer;
+    std::shared_ptr<vk::HostVisibleBuffer> stagingBuffer;
+    ChunkGeometryLayout stagingLayout;
+    std::shared_ptr<ChunkGeometrySpill> geometrySpill;
     std::shared_ptr<vk::BLAS> blas;
     std::shared_ptr<vk::BLASBuilder> blasBuilder;
+    ChunkHostBytes hostBytes;
 
     ChunkBuildData(int64_t id,
                    int x,
@@ -57,18 +67,26 @@ struct ChunkBuildData : public SharedObject<ChunkBuildData> {
                    uint32_t geometryCount,
                    std::vector<World::GeometryTypes> &&geometryTypes,
                    std::vector<std::vector<vk::VertexFormat::PBRTriangle>> &&vertices,
-                   std::vector<std::vector<uint32_t>> &&indices);
+                   std::vector<uint32_t> &&indexCounts);
 
     void build();
+    void uploadToBuffer(std::shared_ptr<vk::CommandBuffer> commandBuffer);
+    void releaseStaging();
 };
 
 struct Chunk1;
 
+using ChunkIngestQueue = IngestQueue<std::shared_ptr<ChunkBuildData>>;
+
 struct ChunkBuildDataBatch : public SharedObject<ChunkBuildDataBatch> {
     std::vector<std::shared_ptr<ChunkBuildData>> batchData;
+    std::shared_ptr<GpuProfiler::QuerySet> profilerQueries;
+    std::shared_ptr<vk::CommandBuffer> commandBuffer;
+    std::shared_ptr<vk::QueryPool> timestamps; // around the build, nullptr without timestamp support
+    uint64_t timelineValue = 0;                // secondary timeline value signaled once the batch is built
 
     ChunkBuildDataBatch(uint32_t maxBatchSize,
-                        std::set<int64_t> &queuedIndex,
+                        ChunkBuildQueue &queuedIndex,
                         std::vector<std::shared_ptr<Chunk1>> &chunks,
                         std::vector<std::shared_ptr<ChunkBuildData>> &chunkBuildDatas,
                         glm::vec3 cameraPos);
@@ -76,14 +94,20 @@ struct ChunkBuildDataBatch : public SharedObject<ChunkBuildDataBatch> {
 
 class ChunkBuildScheduler : public SharedObject<ChunkBuildScheduler> {
   public:
-    ChunkBuildScheduler(std::set<int64_t> &queuedIndex,
+    // of the target frame time, the rest is left to the frame work the batch overlaps with
+    constexpr static double BUILD_FRAME_SHARE = 0.5;
+
+    ChunkBuildScheduler(ChunkBuildQueue &queuedIndex,
                         std::vector<std::shared_ptr<Chunk1>> &chunks,
                         std::vector<std::shared_ptr<ChunkBuildData>> &chunkBuildDatas,
+                        ChunkIngestQueue &ingestQueue,
+                        ChunkChangeQueue &changedChunks,
                         std::recursive_mutex &mutex,
                         std::shared_ptr<vk::HostVisibleBuffer> &chunkPackedData,
                         uint32_t chunkBuildingBatchSize,
                         uint32_t chunkBuildingTotalBatches);
 
+    void drainIngestQueue();
     void tryCheckBatchesFinish();
     void waitAllBatchesFinish();
     void tryScheduleBatches(uint32_t maxBatchSize);
@@ -92,20 +116,76 @@ class ChunkBuildScheduler : public SharedObject<ChunkBuildScheduler> {
     uint32_t chunkBuildingTotalBatches();
 
   private:
-    std::set<int64_t> &queuedIndex_;
+    ChunkBuildQueue &queuedIndex_;
     std::vector<std::shared_ptr<Chunk1>> &chunks_;
     std::vector<std::shared_ptr<ChunkBuildData>> &chunkBuildDatas_;
+    ChunkIngestQueue &ingestQueue_;
+    ChunkChangeQueue &changedChunks_;
     std::recursive_mutex &mutex_;
     std::shared_ptr<vk::HostVisibleBuffer> &chunkPackedData_;
 
-    std::queue<std::shared_ptr<vk::Fence>> freeFences_;
-    std::list<std::shared_ptr<vk::Fence>> buildingFences_;
-    std::list<std::shared_ptr<ChunkBuildDataBatch>> buildingBatches_;
+    void publishBatch(std::shared_ptr<ChunkBuildDataBatch> batch);
+    void retireBatch(std::shared_ptr<ChunkBuildDataBatch> batch);
+    uint32_t sliceBatchSize(uint32_t maxBatchSize);
+
+    std::list<std::shared_ptr<ChunkBuildDataBatch>> buildingBatches_; // in submission order
+    std::vector<std::shared_ptr<vk::CommandBuffer>> freeCommandBuffers_;
+    std::vector<std::shared_ptr<vk::QueryPool>> freeTimestamps_;
+    double chunkBuildCostMs_ = 0.0; // smoothed gpu time per chunk of the retired batches
+    uint32_t sliceSize_ = 1;
 
     uint32_t chunkBuildingBatchSize_;
     uint32_t chunkBuildingTotalBatches_;
 };
 
+// compacts the BLASes of chunks that have not been rebuilt for a while, on the secondary queue
+class ChunkCompactor : public SharedObject<ChunkCompactor> {
+  public:
+    constexpr static uint32_t MAX_BATCH_SIZE = 64;
+    constexpr static uint32_t MAX_SCAN_PER_FRAME = 2048;
+
+    ChunkCompactor(std::vector<std::shared_ptr<Chunk1>> &chunks,
+                   ChunkChangeQueue &changedChunks,
+                   std::recursive_mutex &mutex,
+                   uint32_t settleFrames);
+
+    void tryCompact(uint64_t frameCount);
+
+    VkDeviceSize originalBytes();
+    VkDeviceSize compactedBytes();
+
+  private:
+    enum Stage {
+        IDLE,
+        QUERYING,
+        COPYING,
+    };
+
+    struct Candidate {
+        int64_t id;
+        std::shared_ptr<vk::BLAS> blas;
+        std::shared_ptr<vk::BLAS> compactedBLAS;
+    };
+
+    void submit();
+
+    std::vector<std::shared_ptr<Chunk1>> &chunks_;
+    ChunkChangeQueue &changedChunks_;
+    std::recursive_mutex &mutex_;
+    uint32_t settleFrames_;
+
+    std::shared_ptr<vk::QueryPool> queryPool_;
+    std::shared_ptr<vk::CommandBuffer> commandBuffer_;
+    uint64_t timelineValue_ = 0;
+
+    Stage stage_ = IDLE;
+    std::vector<Candidate> candidates_;
+    size_t scanCursor_ = 0;
+
+    VkDeviceSize originalBytes_ = 0;
+    VkDeviceSize compactedBytes_ = 0;
+};
+
 struct ChunkRenderData : public SharedObject<ChunkRenderData> {
     int x, y, z;
     std::shared_ptr<vk::BLAS> blas;
@@ -113,10 +193,12 @@ struct ChunkRenderData : public SharedObject<ChunkRenderData> {
     uint32_t allIndexCount;
     uint32_t geometryCount;
     std::shared_ptr<std::vector<World::GeometryTypes>> geometryTypes;
-    std::shared_ptr<std::vector<std::shared_ptr<vk::DeviceLocalBuffer>>> vertexBuffers;
-    std::shared_ptr<std::vector<std::shared_ptr<vk::DeviceLocalBuffer>>> indexBuffers;
-    std::shared_ptr<std::vector<std::vector<vk::VertexFormat::PBRTriangle>>> vertices;
-    std::shared_ptr<std::vector<std::vector<uint32_t>>> indices;
+    std::shared_ptr<std::vector<std::shared_ptr<vk::BufferArenaRange>>> vertexBuffers;
+    std::shared_ptr<std::vector<VkDeviceAddress>> vertexBufferAddresses;
+    std::shared_ptr<vk::HostVisibleBuffer> quadIndexBuffer;
+    std::shared_ptr<std::vector<uint32_t>> vertexCounts;
+    std::shared_ptr<std::vector<uint32_t>> indexCounts;
+    std::shared_ptr<ChunkGeometrySpill> geometrySpill;
 };
 
 struct Chunk1 : public SharedObject<Chunk1> {
@@ -133,15 +215,19 @@ struct Chunk1 : public SharedObject<Chunk1> {
 
     std::shared_ptr<vk::BLAS> blas;
     int64_t blasVersion = -1;
-    std::shared_ptr<std::vector<std::shared_ptr<vk::DeviceLocalBuffer>>> vertexBuffers;
-    std::shared_ptr<std::vector<std::shared_ptr<vk::DeviceLocalBuffer>>> indexBuffers;
+    bool blasCompacted = false;
+    uint64_t lastUpdateFrame = 0;
+    std::shared_ptr<std::vector<std::shared_ptr<vk::BufferArenaRange>>> vertexBuffers;
+    std::shared_ptr<std::vector<VkDeviceAddress>> vertexBufferAddresses;
+    std::shared_ptr<vk::HostVisibleBuffer> quadIndexBuffer;
 
     uint32_t allVertexCount;
     uint32_t allIndexCount;
     uint32_t geometryCount;
     std::shared_ptr<std::vector<World::GeometryTypes>> geometryTypes;
-    std::shared_ptr<std::vector<std::vector<vk::VertexFormat::PBRTriangle>>> vertices;
-    std::shared_ptr<std::vector<std::vector<uint32_t>>> indices;
+    std::shared_ptr<std::vector<uint32_t>> vertexCounts;
+    std::shared_ptr<std::vector<uint32_t>> indexCounts;
+    std::shared_ptr<ChunkGeometrySpill> geometrySpill;
 
     float buildFactor(std::chrono::steady_clock::time_point currentTime, glm::vec3 cameraPos);
 
@@ -158,6 +244,9 @@ class Chunks : public SharedObject<Chunks> {
     friend World;
 
   public:
+    constexpr static VkDeviceSize GEOMETRY_PAGE_SIZE = 64 * 1024 * 1024;
+    constexpr static VkDeviceSize GEOMETRY_ALIGNMENT = 256;
+
     Chunks(std::shared_ptr<Framework> framework);
 
     void reset(uint32_t numChunks);
@@ -167,22 +256,33 @@ class Chunks : public SharedObject<Chunks> {
     void queueChunkBuild(ChunkBuildTask task);
 
     bool isChunkReady(int64_t id);
+    uint64_t frameCount();
+    // host memory held by chunk geometry on its way to the device, plus the optional spills
+    static int64_t hostGeometryBytes();
 
     void close();
 
     std::recursive_mutex &mutex();
     std::vector<std::shared_ptr<Chunk1>> &chunks();
     std::shared_ptr<ChunkBuildScheduler> chunkBuildScheduler();
+    std::shared_ptr<ChunkCompactor> chunkCompactor();
+    ChunkChangeQueue &changedChunks();
     std::vector<std::shared_ptr<vk::BLASBuilder>> &importantBLASBuilders();
     std::shared_ptr<vk::HostVisibleBuffer> chunkPackedData();
+    std::shared_ptr<vk::BufferArena> geometryArena();
 
   private:
     std::recursive_mutex mutex_;
     std::vector<std::shared_ptr<Chunk1>> chunks_;
     std::shared_ptr<vk::HostVisibleBuffer> chunkPackedData_ = nullptr;
+    std::shared_ptr<vk::BufferArena> geometryArena_ = nullptr;
     std::vector<std::shared_ptr<ChunkBuildData>> chunkBuildDatas_;
-    std::set<int64_t> queuedIndex_;
+    ChunkBuildQueue queuedIndex_;
+    ChunkIngestQueue ingestQueue_;
+    ChunkChangeQueue changedChunks_;
     std::shared_ptr<ChunkBuildScheduler> chunkBuildScheduler_;
+    std::shared_ptr<ChunkCompactor> chunkCompactor_;
+    uint64_t frameCount_ = 0;
 
     std::shared_ptr<std::vector<std::shared_ptr<vk::BLASBuilder>>> importantBLASBuilders_;
 };
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "core/render/buffers.hpp"
 #include "core/render/render_framework.hpp"
 #include "core/render/renderer.hpp"
+#include "core/render/vertex_convert.hpp"
 
 #include <algorithm>
 #include <cassert>
@@ -38,7 +39,8 @@ EntityBuildData::EntityBuildData(int hashCode,
                                  uint32_t geometryCount,
                                  std::vector<World::GeometryTypes> &&geometryTypes,
                                  std::vector<std::vector<vk::VertexFormat::PBRTriangle>> &&vertices,
-                                 std::vector<std::vector<uint32_t>> &&indices)
+                                 std::vector<std::vector<uint32_t>> &&indices,
+                                 std::vector<bool> &&quadIndexed)
     : hashCode(hashCode),
       x(x),
       y(y),
@@ -50,14 +52,58 @@ EntityBuildData::EntityBuildData(int hashCode,
       geometryTypes(std::move(geometryTypes)),
       vertices(std::move(vertices)),
       indices(std::move(indices)),
+      quadIndexed(std::move(quadIndexed)),
       vertexBufferAddresses(),
       indexBufferAddresses() {}
 
+uint64_t EntityBuildData::topologySignature() const {
+    std::size_t seed = geometryCount;
+    for (int i = 0; i < geometryCount; i++) {
+        TriangleHash::hash_combine(seed, vertices[i].size());
+        TriangleHash::hash_combine(seed, indices[i].size());
+        TriangleHash::hash_combine(seed, quadIndexed[i]);
+        TriangleHash::hash_combine(seed, geometryTypes[i] == World::WORLD_SOLID);
+        if (quadIndexed[i]) continue;
+        for (uint32_t index : indices[i]) { TriangleHash::hash_combine(seed, index); }
+    }
+    return seed;
+}
+
+void EntityBLASCache::beginFrame() {
+    auto &gc = Renderer::instance().framework()->gc();
+
+    frame_++;
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (frame_ - it->second.lastSeenFrame > Renderer::options.entityBLASCacheEvictFrames) {
+            gc.collect(it->second.blas);
+            it = entries_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+std::shared_ptr<vk::BLAS> EntityBLASCache::refitSource(int hashCode, uint64_t signature) {
+    auto it = entries_.find(hashCode);
+    if (it == entries_.end()) return nullptr;
+    if (it->second.signature != signature) return nullptr;
+    if (it->second.refitCount >= Renderer::options.entityBLASMaxRefits) return nullptr;
+    return it->second.blas;
+}
+
+void EntityBLASCache::store(int hashCode, uint64_t signature, std::shared_ptr<vk::BLAS> blas, bool refitted) {
+    auto &entry = entries_[hashCode];
+    entry.refitCount = refitted ? entry.refitCount + 1 : 0;
+    entry.signature = signature;
+    entry.blas = blas;
+    entry.lastSeenFrame = frame_;
+}
+
 void EntityBuildDataBatch::addData(std::shared_ptr<EntityBuildData> data) {
     datas.push_back(data);
 }
 
-void EntityBuildDataBatch::build() {
+void EntityBuildDataBatch::build(std::shared_ptr<EntityBLASCache> blasCache) {
     auto framework = Renderer::instance().framework();
     auto vma = framework->vma();
     auto device = framework->device();
@@ -69,6 +115,7 @@ void EntityBuildDataBatch::build() {
     uint32_t totalGeometryCount = 0;
     uint32_t totalVertexCount = 0;
     uint32_t totalIndexCount = 0;
+    uint32_t maxQuadCount = 0;
 
     for (auto data : datas) {
         instanceOffsets.push_back(totalGeometryCount);
@@ -77,40 +124,58 @@ void EntityBuildDataBatch::build() {
             geometryIndexOffsets.push_back(totalIndexCount);
 
             totalVertexCount += data->vertices[i].size();
-            totalIndexCount += data->indices[i].size();
+            if (data->quadIndexed[i]) {
+                maxQuadCount = std::max<uint32_t>(maxQuadCount, data->indices[i].size() / 6);
+            } else {
+                totalIndexCount += data->indices[i].size();
+            }
         }
 
         totalGeometryCount += data->geometryCount;
     }
 
     vertexBuffer = vk::DeviceLocalBuffer::create(
-        vma, device, totalVertexCount * sizeof(vk::VertexFormat::PBRTriangle),
+        vma, device, false, totalVertexCount * sizeof(vk::VertexFormat::PBRTriangle),
         VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
             VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    quadIndexBuffer = Renderer::instance().buffers()->quadIndexBuffer(maxQuadCount);
     indexBuffer = vk::DeviceLocalBuffer::create(
-        vma, device, totalIndexCount * sizeof(uint32_t),
+        vma, device, false, std::max<uint32_t>(totalIndexCount, 1) * sizeof(uint32_t),
         VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
             VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
 
-    vk::VertexFormat::PBRTriangle *vertexPtr = static_cast<vk::VertexFormat::PBRTriangle *>(vertexBuffer->mappedPtr());
-    uint32_t *indexPtr = static_cast<uint32_t *>(indexBuffer->mappedPtr());
+    auto stagingRing = Renderer::instance().buffers()->stagingRing();
+    vertexStaging = stagingRing->allocate(totalVertexCount * sizeof(vk::VertexFormat::PBRTriangle));
+    indexStaging = stagingRing->allocate(totalIndexCount * sizeof(uint32_t));
+
+    vk::VertexFormat::PBRTriangle *vertexPtr = static_cast<vk::VertexFormat::PBRTriangle *>(vertexStaging.mappedPtr);
+    uint32_t *indexPtr = static_cast<uint32_t *>(indexStaging.mappedPtr);
     for (auto data : datas) {
         for (int i = 0; i < data->geometryCount; i++) {
             std::memcpy(vertexPtr, data->vertices[i].data(),
                         data->vertices[i].size() * sizeof(vk::VertexFormat::PBRTriangle));
             vertexPtr += data->vertices[i].size();
 
+            if (data->quadIndexed[i]) continue;
             std::memcpy(indexPtr, data->indices[i].data(), data->indices[i].size() * sizeof(uint32_t));
             indexPtr += data->indices[i].size();
         }
 
         totalGeometryCount += data->geometryCount;
     }
-    vertexBuffer->flushStagingBuffer();
-    indexBuffer->flushStagingBuffer();
+    vertexStaging.flush();
+    indexStaging.flush();
+
+    // every entity BLAS allows updates so that it can serve as refit source next frame, updates write into a new
+    // BLAS of this batch, the source may still be traced by frames in flight
+    const VkBuildAccelerationStructureFlagsKHR blasFlags =
+        VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR |
+        VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
 
     blasBatchBuilder = vk::BLASBatchBuilder::create();
     std::vector<uint32_t> nonPrebuildInstances;
+    std::vector<uint64_t> signatures;
+    std::vector<bool> refitted;
     for (int instanceIndex = 0; auto data : datas) {
         auto instanceOffset = instanceOffsets[instanceIndex];
         std::shared_ptr<vk::BLASBuilder> blasBuilder = nullptr;
@@ -125,7 +190,9 @@ void EntityBuildDataBatch::build() {
                 vertexBuffer->bufferAddress() +
                 geometryVertexOffsets[instanceOffset + i] * sizeof(vk::VertexFormat::PBRTriangle);
             VkDeviceAddress indexBufferAddress =
-                indexBuffer->bufferAddress() + geometryIndexOffsets[instanceOffset + i] * sizeof(uint32_t);
+                data->quadIndexed[i] ?
+                    quadIndexBuffer->bufferAddress() :
+                    indexBuffer->bufferAddress() + geometryIndexOffsets[instanceOffset + i] * sizeof(uint32_t);
             data->vertexBufferAddresses.push_back(vertexBufferAddress);
             data->indexBufferAddresses.push_back(indexBufferAddress);
             if (data->prebuiltBLAS < 0) {
@@ -136,15 +203,30 @@ void EntityBuildDataBatch::build() {
         }
         if (data->prebuiltBLAS < 0) {
             blasGeometryBuilder->endGeometries();
-            blasBuilder->defineBuildProperty(VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR)
-                ->querySizeInfo(device);
+
+            uint64_t signature = data->topologySignature();
+            auto refitSource = blasCache->refitSource(data->hashCode, signature);
+            if (refitSource != nullptr) {
+                blasBuilder->defineUpdateProperty(blasFlags, refitSource->blas());
+                refitSources.push_back(refitSource);
+            } else {
+                blasBuilder->defineBuildProperty(blasFlags);
+            }
+            blasBuilder->querySizeInfo(device);
+
+            signatures.push_back(signature);
+            refitted.push_back(refitSource != nullptr);
         }
 
         instanceIndex++;
     }
 
     auto blass = blasBatchBuilder->allocateBuffers(physicalDevice, device, vma)->build(device);
-    for (int i = 0; i < nonPrebuildInstances.size(); i++) { datas[nonPrebuildInstances[i]]->blas = blass[i]; }
+    for (int i = 0; i < nonPrebuildInstances.size(); i++) {
+        auto data = datas[nonPrebuildInstances[i]];
+        data->blas = blass[i];
+        blasCache->store(data->hashCode, signatures[i], blass[i], refitted[i]);
+    }
 }
 
 void EntityPostBuildDataBatch::addData(std::shared_ptr<EntityBuildData> data) {
@@ -178,11 +260,13 @@ EntityBatch::EntityBatch(std::shared_ptr<EntityBuildDataBatch> entityBuildDataBa
         auto entity = Entity::create(data);
         entity->vertexBuffer = entityBuildDataBatch->vertexBuffer;
         entity->indexBuffer = entityBuildDataBatch->indexBuffer;
+        entity->quadIndexBuffer = entityBuildDataBatch->quadIndexBuffer;
         entities.push_back(entity);
     }
 
     vertexBuffer = entityBuildDataBatch->vertexBuffer;
     indexBuffer = entityBuildDataBatch->indexBuffer;
+    quadIndexBuffer = entityBuildDataBatch->quadIndexBuffer;
 }
 
 EntityPost::EntityPost(std::shared_ptr<EntityBuildData> chunkBuildData) {
@@ -199,14 +283,19 @@ EntityPost::EntityPost(std::shared_ptr<EntityBuildData> chunkBuildData) {
     auto device = framework->device();
     auto physicalDevice = framework->physicalDevice();
 
+    auto buffers = Renderer::instance().buffers();
+    auto stagingRing = buffers->stagingRing();
+
     for (int i = 0; i < geometryCount; i++) {
-        auto vertexBuffer = vk::DeviceLocalBuffer::create(
-            vma, device, vertices[i].size() * sizeof(vk::VertexFormat::PBRTriangle), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
-        auto indexBuffer = vk::DeviceLocalBuffer::create(vma, device, indices[i].size() * sizeof(uint32_t),
-                                                         VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+        size_t vertexSize = vertices[i].size() * sizeof(vk::VertexFormat::PBRTriangle);
+        size_t indexSize = indices[i].size() * sizeof(uint32_t);
+        auto vertexBuffer =
+            vk::DeviceLocalBuffer::create(vma, device, false, vertexSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+        auto indexBuffer =
+            vk::DeviceLocalBuffer::create(vma, device, false, indexSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
 
-        vertexBuffer->uploadToStagingBuffer(vertices[i].data());
-        indexBuffer->uploadToStagingBuffer(indices[i].data());
+        buffers->queueImportantWorldUpload(stagingRing->upload(vertices[i].data(), vertexSize), vertexBuffer);
+        buffers->queueImportantWorldUpload(stagingRing->upload(indices[i].data(), indexSize), indexBuffer);
 
         vertexBuffers.push_back(vertexBuffer);
         indexBuffers.push_back(indexBuffer);
@@ -217,7 +306,7 @@ EntityPostBatch::EntityPostBatch(std::shared_ptr<EntityPostBuildDataBatch> entit
     for (auto data : entityPostBuildDataBatch->datas) { entities.push_back(EntityPost::create(data)); }
 }
 
-Entities::Entities(std::shared_ptr<Framework> framework) {}
+Entities::Entities(std::shared_ptr<Framework> framework) : blasCache_(EntityBLASCache::create()) {}
 
 void Entities::resetFrame() {
     auto framework = Renderer::instance().framework();
@@ -259,6 +348,7 @@ void Entities::queueBuild(EntitiesBuildTask task) {
         std::vector<World::GeometryTypes> geometryTypes;
         std::vector<std::vector<vk::VertexFormat::PBRTriangle>> vertices;
         std::vector<std::vector<uint32_t>> indices;
+        std::vector<bool> quadIndexed;
         int hashCode = task.entityHashCodes[e];
         double x = task.entityXs[e];
         double y = task.entityYs[e];
@@ -277,306 +367,13 @@ void Entities::queueBuild(EntitiesBuildTask task) {
 
             auto &geometryVertices = vertices.emplace_back();
             auto &geometryIndices = indices.emplace_back();
+            quadIndexed.push_back(static_cast<World::DrawMode>(task.indexFormats[geometryIndex + i]) ==
+                                  World::DrawMode::QUADS);
 
-            if (task.vertexFormats[geometryIndex + i] == World::PBR_TRIANGLE) {
-                geometryVertices.resize(task.vertexCounts[geometryIndex + i]);
-                std::memcpy(geometryVertices.data(), task.vertices[geometryIndex + i],
-                            task.vertexCounts[geometryIndex + i] * sizeof(vk::VertexFormat::PBRTriangle));
-            } else {
-                for (int j = 0; j < task.vertexCounts[geometryIndex + i]; j++) {
-                    vk::VertexFormat::PBRTriangle vertex{};
-
-                    switch (task.vertexFormats[geometryIndex + i]) {
-                        case World::POSITION_COLOR_TEXTURE_LIGHT_NORMAL: {
-                            vk::VertexFormat::PositionColorTexLightNormal *vertices =
-                                static_cast<vk::VertexFormat::PositionColorTexLightNormal *>(
-                                    task.vertices[geometryIndex + i]);
-
-                            vertex.pos = vertices[j].position;
-
-                            vertex.useColorLayer = 1;
-                            vertex.colorLayer = glm::vec4{
-                                vertices[j].color & 0xFF,
-                                (vertices[j].color >> 8) & 0xFF,
-                                (vertices[j].color >> 16) & 0xFF,
-                                (vertices[j].color >> 24) & 0xFF,
-                            };
-                            vertex.colorLayer /= 255.0;
-
-                            vertex.useTexture = 1;
-                            vertex.textureUV = vertices[j].uv0;
-
-                            vertex.useLight = 1;
-                            vertex.lightUV = glm::ivec2{
-                                vertices[j].uv2 & 0xFFFF,
-                                (vertices[j].uv2 >> 16) & 0xFFFF,
-                            };
-
-                            vertex.useNorm = 1;
-                            vertex.norm = glm::vec3{
-                                (int8_t)(vertices[j].normal & 0xFF),
-                                (int8_t)((vertices[j].normal >> 8) & 0xFF),
-                                (int8_t)((vertices[j].normal >> 16) & 0xFF),
-                            };
-
-                            break;
-                        }
-                        case World::POSITION_COLOR_TEXTURE_OVERLAY_LIGHT_NORMAL: {
-                            vk::VertexFormat::PositionColorTexOverlayLightNormal *vertices =
-                                static_cast<vk::VertexFormat::PositionColorTexOverlayLightNormal *>(
-                                    task.vertices[geometryIndex + i]);
-
-                            vertex.pos = vertices[j].position;
-
-                            vertex.useColorLayer = 1;
-                            vertex.colorLayer = glm::vec4{
-                                vertices[j].color & 0xFF,
-                                (vertices[j].color >> 8) & 0xFF,
-                                (vertices[j].color >> 16) & 0xFF,
-                                (vertices[j].color >> 24) & 0xFF,
-                            };
-                            vertex.colorLayer /= 255.0;
-
-                            vertex.useTexture = 1;
-                            vertex.textureUV = vertices[j].uv0;
-
-                            vertex.useOverlay = 1;
-                            vertex.overlayUV = glm::ivec2{vertices[j].uv1 & 0xFFFF, (vertices[j].uv1 >> 16) & 0xFFFF};
-
-                            vertex.useLight = 1;
-                            vertex.lightUV = glm::vec2{
-                                vertices[j].uv2 & 0xFFFF,
-                                (vertices[j].uv2 >> 16) & 0xFFFF,
-                            };
-
-                            vertex.useNorm = 1;
-                            vertex.norm = glm::vec3{
-                                (int8_t)(vertices[j].normal & 0xFF),
-                                (int8_t)((vertices[j].normal >> 8) & 0xFF),
-                                (int8_t)((vertices[j].normal >> 16) & 0xFF),
-                            };
-
-                            break;
-                        }
-                        case World::POSITION_TEXTURE_COLOR_LIGHT: {
-                            vk::VertexFormat::PositionTexColorLight *vertices =
-                                static_cast<vk::VertexFormat::PositionTexColorLight *>(
-                                    task.vertices[geometryIndex + i]);
-
-                            vertex.pos = vertices[j].position;
-
-                            vertex.useTexture = 1;
-                            vertex.textureUV = vertices[j].uv0;
-
-                            vertex.useColorLayer = 1;
-                            vertex.colorLayer = glm::vec4{
-                                vertices[j].color & 0xFF,
-                                (vertices[j].color >> 8) & 0xFF,
-                                (vertices[j].color >> 16) & 0xFF,
-                                (vertices[j].color >> 24) & 0xFF,
-                            };
-                            vertex.colorLayer /= 255.0;
-
-                            vertex.useLight = 1;
-                            vertex.lightUV = glm::vec2{
-                                vertices[j].uv2 & 0xFFFF,
-                                (vertices[j].uv2 >> 16) & 0xFFFF,
-                            };
-
-                            break;
-                        }
-                        case World::POSITION: {
-                            vk::VertexFormat::PositionOnly *vertices =
-                                static_cast<vk::VertexFormat::PositionOnly *>(task.vertices[geometryIndex + i]);
-
-                            vertex.pos = vertices[j].position;
-
-                            break;
-                        }
-                        case World::POSITION_COLOR: {
-                            vk::VertexFormat::PositionColor *vertices =
-                                static_cast<vk::VertexFormat::PositionColor *>(task.vertices[geometryIndex + i]);
-
-                            vertex.pos = vertices[j].position;
-
-                            vertex.useColorLayer = 1;
-                            vertex.colorLayer = glm::vec4{
-                                vertices[j].color & 0xFF,
-                                (vertices[j].color >> 8) & 0xFF,
-                                (vertices[j].color >> 16) & 0xFF,
-                                (vertices[j].color >> 24) & 0xFF,
-                            };
-                            vertex.colorLayer /= 255.0;
-
-                            break;
-                        }
-                        case World::LINES: {
-                            vk::VertexFormat::PositionColorNormal *vertices =
-                                static_cast<vk::VertexFormat::PositionColorNormal *>(task.vertices[geometryIndex + i]);
-
-                            vertex.pos = vertices[j].position;
-
-                            vertex.useColorLayer = 1;
-                            vertex.colorLayer = glm::vec4{
-                                vertices[j].color & 0xFF,
-                                (vertices[j].color >> 8) & 0xFF,
-                                (vertices[j].color >> 16) & 0xFF,
-                                (vertices[j].color >> 24) & 0xFF,
-                            };
-                            vertex.colorLayer /= 255.0;
-
-                            vertex.useNorm = 1;
-                            vertex.norm = glm::vec3{
-                                (int8_t)(vertices[j].normal & 0xFF),
-                                (int8_t)((vertices[j].normal >> 8) & 0xFF),
-                                (int8_t)((vertices[j].normal >> 16) & 0xFF),
-                            };
-
-                            break;
-                        }
-                        case World::POSITION_COLOR_LIGHT: {
-                            vk::VertexFormat::PositionColorLight *vertices =
-                                static_cast<vk::VertexFormat::PositionColorLight *>(task.vertices[geometryIndex + i]);
-
-                            vertex.pos = vertices[j].position;
-
-                            vertex.useColorLayer = 1;
-                            vertex.colorLayer = glm::vec4{
-                                vertices[j].color & 0xFF,
-                                (vertices[j].color >> 8) & 0xFF,
-                                (vertices[j].color >> 16) & 0xFF,
-                                (vertices[j].color >> 24) & 0xFF,
-                            };
-                            vertex.colorLayer /= 255.0;
-
-                            vertex.useLight = 1;
-                            vertex.lightUV = glm::vec2{
-                                vertices[j].uv2 & 0xFFFF,
-                                (vertices[j].uv2 >> 16) & 0xFFFF,
-                            };
-
-                            break;
-                        }
-                        case World::POSITION_TEXTURE: {
-                            vk::VertexFormat::PositionTex *vertices =
-                                static_cast<vk::VertexFormat::PositionTex *>(task.vertices[geometryIndex + i]);
-
-                            vertex.pos = vertices[j].position;
-
-                            vertex.useTexture = 1;
-                            vertex.textureUV = vertices[j].uv;
-
-                            break;
-                        }
-                        case World::POSITION_TEXTURE_COLOR: {
-                            vk::VertexFormat::PositionTexColor *vertices =
-                                static_cast<vk::VertexFormat::PositionTexColor *>(task.vertices[geometryIndex + i]);
-
-                            vertex.pos = vertices[j].position;
-
-                            vertex.useTexture = 1;
-                            vertex.textureUV = vertices[j].uv;
-
-                            vertex.useColorLayer = 1;
-                            vertex.colorLayer = glm::vec4{
-                                vertices[j].color & 0xFF,
-                                (vertices[j].color >> 8) & 0xFF,
-                                (vertices[j].color >> 16) & 0xFF,
-                                (vertices[j].color >> 24) & 0xFF,
-                            };
-                            vertex.colorLayer /= 255.0;
-
-                            break;
-                        }
-                        case World::POSITION_COLOR_TEXTURE_LIGHT: {
-                            vk::VertexFormat::PositionColorTexLight *vertices =
-                                static_cast<vk::VertexFormat::PositionColorTexLight *>(
-                                    task.vertices[geometryIndex + i]);
-
-                            vertex.pos = vertices[j].position;
-
-                            vertex.useColorLayer = 1;
-                            vertex.colorLayer = glm::vec4{
-                                vertices[j].color & 0xFF,
-                                (vertices[j].color >> 8) & 0xFF,
-                                (vertices[j].color >> 16) & 0xFF,
-                                (vertices[j].color >> 24) & 0xFF,
-                            };
-                            vertex.colorLayer /= 255.0;
-
-                            vertex.useTexture = 1;
-                            vertex.textureUV = vertices[j].uv0;
-
-                            vertex.useLight = 1;
-                            vertex.lightUV = glm::vec2{
-                                vertices[j].uv2 & 0xFFFF,
-                                (vertices[j].uv2 >> 16) & 0xFFFF,
-                            };
-
-                            break;
-                        }
-                        case World::POSITION_TEXTURE_LIGHT_COLOR: {
-                            vk::VertexFormat::PositionTexLightColor *vertices =
-                                static_cast<vk::VertexFormat::PositionTexLightColor *>(
-                                    task.vertices[geometryIndex + i]);
-
-                            vertex.pos = vertices[j].position;
-
-                            vertex.useTexture = 1;
-                            vertex.textureUV = vertices[j].uv0;
-
-                            vertex.useLight = 1;
-                            vertex.lightUV = glm::vec2{
-                                vertices[j].uv2 & 0xFFFF,
-                                (vertices[j].uv2 >> 16) & 0xFFFF,
-                            };
-
-                            vertex.useColorLayer = 1;
-                            vertex.colorLayer = glm::vec4{
-                                vertices[j].color & 0xFF,
-                                (vertices[j].color >> 8) & 0xFF,
-                                (vertices[j].color >> 16) & 0xFF,
-                                (vertices[j].color >> 24) & 0xFF,
-                            };
-                            vertex.colorLayer /= 255.0;
-
-                            break;
-                        }
-                        case World::POSITION_TEXTURE_COLOR_NORMAL: {
-                            vk::VertexFormat::PositionTexColorNormal *vertices =
-                                static_cast<vk::VertexFormat::PositionTexColorNormal *>(
-                                    task.vertices[geometryIndex + i]);
-
-                            vertex.pos = vertices[j].position;
-
-                            vertex.useTexture = 1;
-                            vertex.textureUV = vertices[j].uv0;
-
-                            vertex.useColorLayer = 1;
-                            vertex.colorLayer = glm::vec4{
-                                vertices[j].color & 0xFF,
-                                (vertices[j].color >> 8) & 0xFF,
-                                (vertices[j].color >> 16) & 0xFF,
-                                (vertices[j].color >> 24) & 0xFF,
-                            };
-                            vertex.colorLayer /= 255.0;
-
-                            vertex.useNorm = 1;
-                            vertex.norm = glm::vec3{
-                                (int8_t)(vertices[j].normal & 0xFF),
-                                (int8_t)((vertices[j].normal >> 8) & 0xFF),
-                                (int8_t)((vertices[j].normal >> 16) & 0xFF),
-                            };
-
-                            break;
-                        }
-                    }
-
-                    vertex.textureID = geometryTexture;
-
-                    geometryVertices.push_back(vertex);
-                }
-            }
+            geometryVertices.resize(task.vertexCounts[geometryIndex + i]);
+            VertexConvert::toPBRTriangles(static_cast<World::VertexFormats>(task.vertexFormats[geometryIndex + i]),
+                                          task.vertices[geometryIndex + i], task.vertexCounts[geometryIndex + i],
+                                          geometryTexture, geometryVertices.data());
 
             auto orthonormalBasis = [](const glm::dvec3 &a_unit,
                                        const glm::dvec3 &ref) -> std::pair<glm::dvec3, glm::dvec3> {
@@ -829,6 +626,7 @@ void Entities::queueBuild(EntitiesBuildTask task) {
             if (geometryVertices.empty() || geometryIndices.empty()) {
                 vertices.pop_back();
                 indices.pop_back();
+                quadIndexed.pop_back();
                 geometryTypes.pop_back();
             } else {
                 allVertexCount += geometryVertices.size();
@@ -841,7 +639,8 @@ void Entities::queueBuild(EntitiesBuildTask task) {
 
         std::shared_ptr<EntityBuildData> chunkBuildData =
             EntityBuildData::create(hashCode, x, y, z, rtFlag, prebuiltBLAS, coordinate, geometryCountWithoutGlint,
-                                    std::move(geometryTypes), std::move(vertices), std::move(indices));
+                                    std::move(geometryTypes), std::move(vertices), std::move(indices),
+                                    std::move(quadIndexed));
 
         if (post) {
             entityPostBuildDataBatch_->addData(chunkBuildData);
@@ -862,21 +661,17 @@ void Entities::build() {
     auto device = framework->device();
     auto physicalDevice = framework->physicalDevice();
 
-    entityBuildDataBatch_->build();
+    blasCache_->beginFrame();
+    entityBuildDataBatch_->build(blasCache_);
 
-    Renderer::instance().buffers()->queueImportantWorldUpload(entityBuildDataBatch_->vertexBuffer,
+    Renderer::instance().buffers()->queueImportantWorldUpload(entityBuildDataBatch_->vertexStaging,
+                                                              entityBuildDataBatch_->vertexBuffer);
+    Renderer::instance().buffers()->queueImportantWorldUpload(entityBuildDataBatch_->indexStaging,
                                                               entityBuildDataBatch_->indexBuffer);
     blasBatchBuilder_ = entityBuildDataBatch_->blasBatchBuilder;
 
     entityBatch_ = EntityBatch::create(entityBuildDataBatch_);
     entityPostBatch_ = EntityPostBatch::create(entityPostBuildDataBatch_);
-
-    for (auto entity : entityPostBatch_->entities) {
-        for (int i = 0; i < entity->geometryCount; i++) {
-            Renderer::instance().buffers()->queueImportantWorldUpload(entity->vertexBuffers[i],
-                                                                      entity->indexBuffers[i]);
-        }
-    }
 }
 
 std::shared_ptr<EntityBatch> Entities::entityBatch() {
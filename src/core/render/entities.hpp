@@ -51,10 +51,13 @@ struct EntityBuildData : public SharedObject<EntityBuildData> {
     std::vector<World::GeometryTypes> geometryTypes;
     std::vector<std::vector<vk::VertexFormat::PBRTriangle>> vertices;
     std::vector<std::vector<uint32_t>> indices;
+    std::vector<bool> quadIndexed; // ray traced from the shared quad index buffer
     std::vector<VkDeviceAddress> vertexBufferAddresses;
     std::vector<VkDeviceAddress> indexBufferAddresses;
     std::shared_ptr<vk::BLAS> blas;
 
+    uint64_t topologySignature() const;
+
     EntityBuildData(int hashCode,
                     double x,
                     double y,
@@ -65,7 +68,29 @@ struct EntityBuildData : public SharedObject<EntityBuildData> {
                     uint32_t geometryCount,
                     std::vector<World::GeometryTypes> &&geometryTypes,
                     std::vector<std::vector<vk::VertexFormat::PBRTriangle>> &&vertices,
-                    std::vector<std::vector<uint32_t>> &&indices);
+                    std::vector<std::vector<uint32_t>> &&indices,
+                    std::vector<bool> &&quadIndexed);
+};
+
+// keeps the BLAS of every ray traced entity across frames, so entities whose topology did not change are refit
+// from their previous BLAS instead of being rebuilt from scratch
+class EntityBLASCache : public SharedObject<EntityBLASCache> {
+  public:
+    void beginFrame();
+    // the BLAS to refit from, nullptr if the entity has to be rebuilt
+    std::shared_ptr<vk::BLAS> refitSource(int hashCode, uint64_t signature);
+    void store(int hashCode, uint64_t signature, std::shared_ptr<vk::BLAS> blas, bool refitted);
+
+  private:
+    struct Entry {
+        uint64_t signature;
+        std::shared_ptr<vk::BLAS> blas;
+        uint64_t lastSeenFrame;
+        uint32_t refitCount;
+    };
+
+    std::unordered_map<int, Entry> entries_;
+    uint64_t frame_ = 0;
 };
 
 struct EntityBuildDataBatch : public SharedObject<EntityBuildDataBatch> {
@@ -73,10 +98,14 @@ struct EntityBuildDataBatch : public SharedObject<EntityBuildDataBatch> {
 
     std::shared_ptr<vk::DeviceLocalBuffer> vertexBuffer;
     std::shared_ptr<vk::DeviceLocalBuffer> indexBuffer;
+    vk::StagingRing::Allocation vertexStaging; // copied into the buffers above by this frame's upload pass
+    vk::StagingRing::Allocation indexStaging;
+    std::shared_ptr<vk::HostVisibleBuffer> quadIndexBuffer;
     std::shared_ptr<vk::BLASBatchBuilder> blasBatchBuilder;
+    std::vector<std::shared_ptr<vk::BLAS>> refitSources; // read by this frame's updates
 
     void addData(std::shared_ptr<EntityBuildData> data);
-    void build();
+    void build(std::shared_ptr<EntityBLASCache> blasCache);
 };
 
 struct EntityPostBuildDataBatch : public SharedObject<EntityPostBuildDataBatch> {
@@ -102,6 +131,7 @@ struct Entity : public SharedObject<Entity> {
     std::shared_ptr<std::vector<VkDeviceAddress>> indexBufferAddresses;
     std::shared_ptr<vk::DeviceLocalBuffer> vertexBuffer;
     std::shared_ptr<vk::DeviceLocalBuffer> indexBuffer;
+    std::shared_ptr<vk::HostVisibleBuffer> quadIndexBuffer;
 
     uint32_t geometryCount;
     std::shared_ptr<std::vector<World::GeometryTypes>> geometryTypes;
@@ -116,6 +146,7 @@ struct EntityBatch : public SharedObject<EntityBatch> {
 
     std::shared_ptr<vk::DeviceLocalBuffer> vertexBuffer;
     std::shared_ptr<vk::DeviceLocalBuffer> indexBuffer;
+    std::shared_ptr<vk::HostVisibleBuffer> quadIndexBuffer;
 
     EntityBatch(std::shared_ptr<EntityBuildDataBatch> entityBuildDataBatch);
 };
@@ -159,4 +190,5 @@ class Entities : public SharedObject<Entities> {
     std::shared_ptr<EntityPostBuildDataBatch> entityPostBuildDataBatch_;
 
     std::shared_ptr<vk::BLASBatchBuilder> blasBatchBuilder_;
+    std::shared_ptr<EntityBLASCache> blasCache_;
 };
\ No newline at end of file
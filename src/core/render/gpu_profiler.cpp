@@ -0,0 +1,187 @@
+#include "core/render/gpu_profiler.hpp"
+
+#include "core/render/renderer.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+std::ostream &gpuProfilerCout() {
+    return std::cout << "[GpuProfiler] ";
+}
+
+std::ostream &gpuProfilerCerr() {
+    return std::cerr << "[GpuProfiler] ";
+}
+
+static uint64_t timestampMask(uint32_t validBits) {
+    return validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+}
+
+GpuProfiler::GpuProfiler(std::shared_ptr<vk::PhysicalDevice> physicalDevice, std::shared_ptr<vk::Device> device)
+    : device_(device) {
+    uint32_t validBits = physicalDevice->timestampValidBits(physicalDevice->mainQueueIndex());
+    supported_ = validBits > 0;
+    timestampMask_ = timestampMask(validBits);
+
+    uint32_t secondaryValidBits = physicalDevice->timestampValidBits(physicalDevice->secondaryQueueIndex());
+    secondarySupported_ = secondaryValidBits > 0;
+    secondaryTimestampMask_ = timestampMask(secondaryValidBits);
+
+    timestampPeriod_ = physicalDevice->properties().limits.timestampPeriod;
+
+    if (!supported_) { gpuProfilerCerr() << "main queue has no timestamp support, profiler disabled" << std::endl; }
+    if (supported_ && !secondarySupported_) {
+        gpuProfilerCerr() << "secondary queue has no timestamp support, its zones are skipped" << std::endl;
+    }
+}
+
+std::shared_ptr<GpuProfiler::QuerySet> GpuProfiler::acquire(std::shared_ptr<vk::CommandBuffer> cmdBuffer,
+                                                            bool secondaryQueue) {
+    if (!supported_ || !Renderer::options.gpuProfiler) return nullptr;
+    if (secondaryQueue && !secondarySupported_) return nullptr;
+
+    std::shared_ptr<QuerySet> querySet;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!freeSets_.empty()) {
+            querySet = freeSets_.back();
+            freeSets_.pop_back();
+        }
+    }
+    if (querySet == nullptr) {
+        querySet = std::make_shared<QuerySet>();
+        querySet->queryPool = vk::QueryPool::create(device_, VK_QUERY_TYPE_TIMESTAMP, maxZones * 2);
+    }
+
+    querySet->zoneNames.clear();
+    querySet->secondaryQueue = secondaryQueue;
+    querySet->queryPool->reset(cmdBuffer, 0, maxZones * 2);
+    return querySet;
+}
+
+void GpuProfiler::resolve(std::shared_ptr<QuerySet> querySet) {
+    if (querySet == nullptr) return;
+
+    std::vector<uint64_t> timestamps;
+    bool available = querySet->queryPool->results(0, querySet->zoneNames.size() * 2, timestamps);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (available) {
+        // zones sharing a name within one set, like the overlay split by the world fuse, count as one sample
+        std::unordered_map<std::string, double> durations;
+        uint64_t mask = querySet->secondaryQueue ? secondaryTimestampMask_ : timestampMask_;
+        for (uint32_t i = 0; i < querySet->zoneNames.size(); i++) {
+            uint64_t ticks = (timestamps[2 * i + 1] - timestamps[2 * i]) & mask;
+            durations[querySet->zoneNames[i]] += ticks * timestampPeriod_ * 1e-6;
+        }
+        for (auto &[name, duration] : durations) {
+            auto [it, inserted] = samples_.try_emplace(name);
+            if (inserted) zoneOrder_.push_back(name);
+            it->second.push_back(duration);
+            if (it->second.size() > sampleWindow) it->second.pop_front();
+        }
+    }
+    freeSets_.push_back(querySet);
+}
+
+// called right after the frame context reached its timeline value, the previous set of this context is complete then
+void GpuProfiler::beginFrame(uint32_t frameIndex, std::shared_ptr<vk::CommandBuffer> cmdBuffer) {
+    if (frameIndex >= frameSets_.size()) {
+        frameSets_.resize(frameIndex + 1);
+        frameZones_.resize(frameIndex + 1, invalidZone);
+    }
+
+    resolve(frameSets_[frameIndex]);
+    frameSets_[frameIndex] = acquire(cmdBuffer);
+    frameZones_[frameIndex] = beginZone(frameSets_[frameIndex], cmdBuffer, "frame");
+}
+
+void GpuProfiler::endFrame(uint32_t frameIndex, std::shared_ptr<vk::CommandBuffer> cmdBuffer) {
+    if (frameIndex >= frameSets_.size()) return;
+    endZone(frameSets_[frameIndex], cmdBuffer, frameZones_[frameIndex]);
+    frameZones_[frameIndex] = invalidZone;
+}
+
+std::shared_ptr<GpuProfiler::QuerySet> GpuProfiler::frameQueries(uint32_t frameIndex) {
+    return frameIndex < frameSets_.size() ? frameSets_[frameIndex] : nullptr;
+}
+
+uint32_t GpuProfiler::beginZone(std::shared_ptr<QuerySet> querySet,
+                                std::shared_ptr<vk::CommandBuffer> cmdBuffer,
+                                const std::string &name) {
+    if (querySet == nullptr || querySet->zoneNames.size() >= maxZones) return invalidZone;
+
+    uint32_t zone = querySet->zoneNames.size();
+    querySet->zoneNames.push_back(name);
+    cmdBuffer->writeTimestamp(querySet->queryPool, 2 * zone, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+    return zone;
+}
+
+void GpuProfiler::endZone(std::shared_ptr<QuerySet> querySet,
+                          std::shared_ptr<vk::CommandBuffer> cmdBuffer,
+                          uint32_t zone) {
+    if (querySet == nullptr || zone == invalidZone) return;
+    cmdBuffer->writeTimestamp(querySet->queryPool, 2 * zone + 1, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+}
+
+std::vector<GpuProfiler::ZoneStats> GpuProfiler::stats() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    std::vector<ZoneStats> result;
+    std::vector<double> sorted;
+    for (auto &name : zoneOrder_) {
+        auto &samples = samples_[name];
+        if (samples.empty()) continue;
+
+        sorted.assign(samples.begin(), samples.end());
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&sorted](double p) {
+            return sorted[std::min<size_t>(sorted.size() - 1, static_cast<size_t>(p * sorted.size()))];
+        };
+
+        double sum = 0.0;
+        for (double sample : sorted) sum += sample;
+
+        result.push_back({
+            .name = name,
+            .averageMs = sum / sorted.size(),
+            .p50Ms = percentile(0.50),
+            .p95Ms = percentile(0.95),
+            .p99Ms = percentile(0.99),
+            .maxMs = sorted.back(),
+            .samples = static_cast<uint32_t>(sorted.size()),
+        });
+    }
+    return result;
+}
+
+bool GpuProfiler::dumpCSV(const std::filesystem::path &file) {
+    std::ofstream out(file, std::ios::trunc);
+    if (!out) {
+        gpuProfilerCerr() << "cannot write " << file << std::endl;
+        return false;
+    }
+
+    out << "zone,average_ms,p50_ms,p95_ms,p99_ms,max_ms,samples\n";
+    for (auto &zone : stats()) {
+        out << zone.name << "," << zone.averageMs << "," << zone.p50Ms << "," << zone.p95Ms << "," << zone.p99Ms
+            << "," << zone.maxMs << "," << zone.samples << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+void GpuProfiler::clear() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    zoneOrder_.clear();
+    samples_.clear();
+}
+
+GpuZone::GpuZone(std::shared_ptr<GpuProfiler::QuerySet> querySet,
+                 std::shared_ptr<vk::CommandBuffer> cmdBuffer,
+                 const std::string &name)
+    : querySet_(querySet), cmdBuffer_(cmdBuffer), zone_(GpuProfiler::beginZone(querySet, cmdBuffer, name)) {}
+
+GpuZone::~GpuZone() {
+    GpuProfiler::endZone(querySet_, cmdBuffer_, zone_);
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "core/all_extern.hpp"
+#include "core/vulkan/all_core_vulkan.hpp"
+
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// gpu timestamps around the passes of a submission, a query set is recorded into the command buffers of one
+// submission and read back without waiting once the timeline reached the value of that submission, the query pools are
+// recycled and the per frame zone durations feed rolling statistics
+class GpuProfiler : public SharedObject<GpuProfiler> {
+  public:
+    struct QuerySet {
+        std::shared_ptr<vk::QueryPool> queryPool;
+        std::vector<std::string> zoneNames; // zone i owns the queries 2i and 2i + 1
+        bool secondaryQueue = false;
+    };
+
+    struct ZoneStats {
+        std::string name;
+        double averageMs;
+        double p50Ms;
+        double p95Ms;
+        double p99Ms;
+        double maxMs;
+        uint32_t samples;
+    };
+
+    static constexpr uint32_t invalidZone = ~0u;
+
+    GpuProfiler(std::shared_ptr<vk::PhysicalDevice> physicalDevice, std::shared_ptr<vk::Device> device);
+
+    // nullptr while the profiler is disabled or the queue family cannot write timestamps, the zone functions accept a
+    // nullptr set and record nothing
+    std::shared_ptr<QuerySet> acquire(std::shared_ptr<vk::CommandBuffer> cmdBuffer, bool secondaryQueue = false);
+    // the submission of the set must have completed, a set whose queries never executed is dropped
+    void resolve(std::shared_ptr<QuerySet> querySet);
+
+    // the frame set is reset on the first command buffer of the frame submission and closed on the last one
+    void beginFrame(uint32_t frameIndex, std::shared_ptr<vk::CommandBuffer> cmdBuffer);
+    void endFrame(uint32_t frameIndex, std::shared_ptr<vk::CommandBuffer> cmdBuffer);
+    std::shared_ptr<QuerySet> frameQueries(uint32_t frameIndex);
+
+    static uint32_t beginZone(std::shared_ptr<QuerySet> querySet,
+                              std::shared_ptr<vk::CommandBuffer> cmdBuffer,
+                              const std::string &name);
+    static void
+    endZone(std::shared_ptr<QuerySet> querySet, std::shared_ptr<vk::CommandBuffer> cmdBuffer, uint32_t zone);
+
+    std::vector<ZoneStats> stats();
+    bool dumpCSV(const std::filesystem::path &file);
+    void clear();
+
+  private:
+    static constexpr uint32_t maxZones = 64;
+    static constexpr uint32_t sampleWindow = 240; // per zone, in resolved sets
+
+    std::shared_ptr<vk::Device> device_;
+
+    // the secondary queue may come from a separate compute or transfer family with its own timestamp support
+    bool supported_ = false;
+    bool secondarySupported_ = false;
+    double timestampPeriod_ = 1.0; // nanoseconds per tick
+    uint64_t timestampMask_ = ~0ull;
+    uint64_t secondaryTimestampMask_ = ~0ull;
+
+    std::vector<std::shared_ptr<QuerySet>> frameSets_;
+    std::vector<uint32_t> frameZones_;
+
+    std::vector<std::shared_ptr<QuerySet>> freeSets_;
+    std::vector<std::string> zoneOrder_;
+    std::unordered_map<std::string, std::deque<double>> samples_;
+    std::mutex mutex_;
+};
+
+// records a zone for the lifetime of the scope
+class GpuZone {
+  public:
+    GpuZone(std::shared_ptr<GpuProfiler::QuerySet> querySet,
+            std::shared_ptr<vk::CommandBuffer> cmdBuffer,
+            const std::string &name);
+    ~GpuZone();
+
+  private:
+    std::shared_ptr<GpuProfiler::QuerySet> querySet_;
+    std::shared_ptr<vk::CommandBuffer> cmdBuffer_;
+    uint32_t zone_;
+};
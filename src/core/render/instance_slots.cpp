@@ -0,0 +1,133 @@
+#include "core/render/instance_slots.hpp"
+
+#include <algorithm>
+
+// the records only need offsets, the rows live in the caller's arrays, so the range is never the limit
+static constexpr uint64_t RECORD_RANGE = 1ull << 32;
+
+InstanceSlots::InstanceSlots(uint32_t historyFrames) : historyFrames_(historyFrames), records_(RECORD_RANGE, 1) {}
+
+void InstanceSlots::allocateRecords(Slot &slot, uint32_t recordCount) {
+    slot.recordOffset = static_cast<uint32_t>(records_.allocate(recordCount));
+    slot.recordCount = recordCount;
+    recordCount_ = std::max(recordCount_, slot.recordOffset + recordCount);
+    if (recordMarks_.size() < recordCount_) recordMarks_.resize(recordCount_, 0);
+}
+
+uint32_t InstanceSlots::acquire(uint32_t recordCount) {
+    uint32_t slot;
+    if (!freeSlots_.empty()) {
+        slot = freeSlots_.back();
+        freeSlots_.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(slots_.size());
+        slots_.emplace_back();
+        instanceMarks_.push_back(0);
+    }
+
+    slots_[slot].used = true;
+    allocateRecords(slots_[slot], recordCount);
+    usedCount_++;
+
+    markInstance(slot, true);
+    markRecords(slot);
+    return slot;
+}
+
+bool InstanceSlots::resize(uint32_t slot, uint32_t recordCount) {
+    Slot &entry = slots_[slot];
+    if (entry.recordCount == recordCount) return false;
+
+    records_.free(entry.recordOffset, entry.recordCount);
+    allocateRecords(entry, recordCount);
+
+    markInstance(slot, true);
+    markRecords(slot);
+    return true;
+}
+
+void InstanceSlots::release(uint32_t slot) {
+    Slot &entry = slots_[slot];
+    records_.free(entry.recordOffset, entry.recordCount);
+    entry = Slot{.recordOffset = 0, .recordCount = 0, .used = false};
+    freeSlots_.push_back(slot);
+    usedCount_--;
+
+    markInstance(slot, true);
+}
+
+void InstanceSlots::markInstance(uint32_t slot, bool structural) {
+    current_.structural |= structural;
+    if (instanceMarks_[slot] == frame_) return;
+    instanceMarks_[slot] = frame_;
+    current_.instances.push_back(slot);
+}
+
+void InstanceSlots::markRecords(uint32_t slot) {
+    const Slot &entry = slots_[slot];
+    for (uint32_t i = entry.recordOffset; i < entry.recordOffset + entry.recordCount; i++) {
+        if (recordMarks_[i] == frame_) continue;
+        recordMarks_[i] = frame_;
+        current_.records.push_back(i);
+    }
+}
+
+void InstanceSlots::markAllInstances() {
+    current_.allInstances = true;
+}
+
+uint64_t InstanceSlots::frame() {
+    return frame_;
+}
+
+void InstanceSlots::endFrame() {
+    history_.push_back(std::move(current_));
+    current_ = FrameChanges{};
+    while (history_.size() > historyFrames_) history_.pop_front();
+    frame_++;
+}
+
+InstanceSlots::Changes InstanceSlots::changesSince(uint64_t frame) {
+    Changes changes{};
+    // the frames after the given one, the current frame included
+    uint64_t frameCount = frame < frame_ ? frame_ - frame : 1;
+    if (frame == 0 || frameCount > history_.size() + 1) {
+        changes.full = true;
+        changes.structural = true;
+        changes.allInstances = true;
+        return changes;
+    }
+
+    auto add = [&changes](const FrameChanges &frameChanges) {
+        changes.structural |= frameChanges.structural;
+        changes.allInstances |= frameChanges.allInstances;
+        changes.instances.insert(changes.instances.end(), frameChanges.instances.begin(),
+                                 frameChanges.instances.end());
+        changes.records.insert(changes.records.end(), frameChanges.records.begin(), frameChanges.records.end());
+    };
+    for (size_t i = history_.size() - (frameCount - 1); i < history_.size(); i++) { add(history_[i]); }
+    add(current_);
+
+    for (auto *rows : {&changes.instances, &changes.records}) {
+        std::sort(rows->begin(), rows->end());
+        rows->erase(std::unique(rows->begin(), rows->end()), rows->end());
+    }
+    if (changes.allInstances) changes.instances.clear();
+    return changes;
+}
+
+const InstanceSlots::Slot &InstanceSlots::slot(uint32_t slot) {
+    return slots_[slot];
+}
+
+uint32_t InstanceSlots::instanceCount() {
+    return static_cast<uint32_t>(slots_.size());
+}
+
+uint32_t InstanceSlots::recordCount() {
+    return recordCount_;
+}
+
+uint32_t InstanceSlots::usedCount() {
+    return usedCount_;
+}
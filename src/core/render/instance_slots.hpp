@@ -0,0 +1,76 @@
+#pragma once
+
+#include "core/vulkan/range_allocator.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// fixed slots of the ray traced instances and the geometry records behind them. a chunk or entity keeps its slot, and
+// its records their offset, from the moment it appears until it goes away, free slots stay in the table and are
+// handed out again before it grows. the rows written in a frame are remembered for a few frames, so every frame
+// context can bring its own copies of the rows up to date with what changed since it last rendered
+class InstanceSlots {
+  public:
+    static constexpr uint32_t invalidSlot = ~0u;
+
+    struct Slot {
+        uint32_t recordOffset;
+        uint32_t recordCount;
+        bool used;
+    };
+
+    // rows to write for a frame context, sorted and without duplicates
+    struct Changes {
+        bool full;         // the history does not reach back far enough, every row has to be written
+        bool structural;   // a slot was assigned, freed or changed its blas or records, the tlas has to be rebuilt
+        bool allInstances; // every instance row was rewritten, like after the camera moved
+        std::vector<uint32_t> instances;
+        std::vector<uint32_t> records;
+    };
+
+    explicit InstanceSlots(uint32_t historyFrames);
+
+    // the records of a new slot are marked, the instance row is left to the caller
+    uint32_t acquire(uint32_t recordCount);
+    // moves the records when the count changed, returns whether the slot's records moved
+    bool resize(uint32_t slot, uint32_t recordCount);
+    void release(uint32_t slot);
+
+    void markInstance(uint32_t slot, bool structural);
+    void markRecords(uint32_t slot);
+    void markAllInstances();
+
+    // frames are numbered from 1, a context that never rendered asks for the changes since frame 0
+    uint64_t frame();
+    void endFrame();
+    Changes changesSince(uint64_t frame);
+
+    const Slot &slot(uint32_t slot);
+    uint32_t instanceCount(); // rows in use up to the highest slot ever handed out
+    uint32_t recordCount();
+    uint32_t usedCount();
+
+  private:
+    struct FrameChanges {
+        bool structural = false;
+        bool allInstances = false;
+        std::vector<uint32_t> instances;
+        std::vector<uint32_t> records;
+    };
+
+    void allocateRecords(Slot &slot, uint32_t recordCount);
+
+    uint32_t historyFrames_;
+    uint64_t frame_ = 1;
+    FrameChanges current_;
+    std::deque<FrameChanges> history_; // the frames before the current one, the newest last
+
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> freeSlots_;
+    std::vector<uint64_t> instanceMarks_; // frame the instance row was last marked in
+    std::vector<uint64_t> recordMarks_;
+    vk::RangeAllocator records_;
+    uint32_t recordCount_ = 0;
+    uint32_t usedCount_ = 0;
+};
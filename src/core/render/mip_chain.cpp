@@ -0,0 +1,40 @@
+#include "core/render/mip_chain.hpp"
+
+#include <algorithm>
+
+std::vector<MipBlit> planMipBlits(uint32_t width, uint32_t height, uint32_t mipLevels, MipRect dirty) {
+    std::vector<MipBlit> blits;
+    int32_t minX = dirty.minX, minY = dirty.minY, maxX = dirty.maxX, maxY = dirty.maxY;
+
+    for (uint32_t level = 1; level < mipLevels; level++) {
+        int32_t srcWidth = std::max<int32_t>(width >> (level - 1), 1);
+        int32_t srcHeight = std::max<int32_t>(height >> (level - 1), 1);
+        int32_t dstWidth = std::max<int32_t>(width >> level, 1);
+        int32_t dstHeight = std::max<int32_t>(height >> level, 1);
+
+        bool halvesX = srcWidth == dstWidth * 2;
+        bool halvesY = srcHeight == dstHeight * 2;
+        if (halvesX) {
+            minX = minX / 2;
+            maxX = (maxX + 1) / 2;
+        } else {
+            minX = 0;
+            maxX = dstWidth;
+        }
+        if (halvesY) {
+            minY = minY / 2;
+            maxY = (maxY + 1) / 2;
+        } else {
+            minY = 0;
+            maxY = dstHeight;
+        }
+
+        MipBlit blit;
+        blit.level = level;
+        blit.src = {halvesX ? minX * 2 : 0, halvesY ? minY * 2 : 0, halvesX ? maxX * 2 : srcWidth,
+                    halvesY ? maxY * 2 : srcHeight};
+        blit.dst = {minX, minY, maxX, maxY};
+        blits.push_back(blit);
+    }
+    return blits;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// texel rectangle [min, max) of one mip level
+struct MipRect {
+    int32_t minX;
+    int32_t minY;
+    int32_t maxX;
+    int32_t maxY;
+};
+
+// one blit of the chain, level - 1 src is filtered into level dst
+struct MipBlit {
+    uint32_t level;
+    MipRect src;
+    MipRect dst;
+};
+
+// the blits that regenerate the mip chain below a dirty area of level 0. every texel whose footprint overlaps the
+// dirty area is regenerated, an axis that does not halve exactly is regenerated whole so that the filtering matches a
+// full blit
+std::vector<MipBlit> planMipBlits(uint32_t width, uint32_t height, uint32_t mipLevels, MipRect dirty);
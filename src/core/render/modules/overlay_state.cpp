@@ -0,0 +1,34 @@
+#include "core/render/modules/overlay_state.hpp"
+
+#include <bit>
+
+void OverlayStateTracker::mark(uint32_t state, bool changed) {
+    if (!changed || (dirty_ & state) != 0) stats_.filtered++;
+    if (changed) dirty_ |= state;
+}
+
+void OverlayStateTracker::invalidate(uint32_t state) {
+    dirty_ |= state;
+}
+
+uint32_t OverlayStateTracker::dirty(bool depthBiasEnable) {
+    uint32_t dirty = dirty_;
+    if (!depthBiasEnable) dirty &= ~OVERLAY_STATE_DEPTH_BIAS;
+    return dirty;
+}
+
+uint32_t OverlayStateTracker::flush(bool depthBiasEnable, uint32_t supported) {
+    uint32_t state = dirty(depthBiasEnable);
+    dirty_ &= ~state;
+    state &= supported;
+    stats_.issued += std::popcount(state);
+    return state;
+}
+
+OverlayStateStats OverlayStateTracker::stats() {
+    return stats_;
+}
+
+void OverlayStateTracker::resetStats() {
+    stats_ = {};
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+
+struct OverlayStateStats {
+    uint32_t issued;   // vkCmdSet* recorded over a frame
+    uint32_t filtered; // state changes that recorded nothing, unchanged or merged into a pending one
+};
+
+// one bit per vkCmdSet* call of the overlay dynamic state, in recording order
+enum OverlayDynamicState : uint32_t {
+    OVERLAY_STATE_VIEWPORT = 1u << 0,
+    OVERLAY_STATE_SCISSOR = 1u << 1,
+    OVERLAY_STATE_DEPTH_TEST_ENABLE = 1u << 2,
+    OVERLAY_STATE_DEPTH_WRITE_ENABLE = 1u << 3,
+    OVERLAY_STATE_DEPTH_COMPARE_OP = 1u << 4,
+    OVERLAY_STATE_STENCIL_TEST_ENABLE = 1u << 5,
+    OVERLAY_STATE_STENCIL_FRONT_OP = 1u << 6,
+    OVERLAY_STATE_STENCIL_BACK_OP = 1u << 7,
+    OVERLAY_STATE_STENCIL_FRONT_REFERENCE = 1u << 8,
+    OVERLAY_STATE_STENCIL_BACK_REFERENCE = 1u << 9,
+    OVERLAY_STATE_STENCIL_FRONT_COMPARE_MASK = 1u << 10,
+    OVERLAY_STATE_STENCIL_BACK_COMPARE_MASK = 1u << 11,
+    OVERLAY_STATE_STENCIL_FRONT_WRITE_MASK = 1u << 12,
+    OVERLAY_STATE_STENCIL_BACK_WRITE_MASK = 1u << 13,
+    OVERLAY_STATE_CULL_MODE = 1u << 14,
+    OVERLAY_STATE_FRONT_FACE = 1u << 15,
+    OVERLAY_STATE_POLYGON_MODE = 1u << 16,
+    OVERLAY_STATE_DEPTH_BIAS_ENABLE = 1u << 17,
+    OVERLAY_STATE_DEPTH_BIAS = 1u << 18,
+    OVERLAY_STATE_LINE_WIDTH = 1u << 19,
+    OVERLAY_STATE_COLOR_BLEND_ENABLE = 1u << 20,
+    OVERLAY_STATE_COLOR_BLEND_EQUATION = 1u << 21,
+    OVERLAY_STATE_COLOR_WRITE_MASK = 1u << 22,
+    OVERLAY_STATE_LOGIC_OP = 1u << 23,
+    OVERLAY_STATE_LOGIC_OP_ENABLE = 1u << 24,
+    OVERLAY_STATE_BLEND_CONSTANTS = 1u << 25,
+    OVERLAY_STATE_ALL = (1u << 26) - 1,
+};
+
+// dirty bits of the overlay dynamic state, independent of vulkan so the filtering can be checked on the cpu. the
+// setters mark what changed, flush hands out what has to be recorded before the next draw
+class OverlayStateTracker {
+  public:
+    // unchanged values and changes to state that is already dirty are counted as filtered
+    void mark(uint32_t state, bool changed);
+    // the command buffer lost the state, nothing is counted
+    void invalidate(uint32_t state = OVERLAY_STATE_ALL);
+
+    // the bias values only matter while the bias is enabled, they stay pending until then
+    uint32_t dirty(bool depthBiasEnable);
+    // clears and returns the dirty state, counted as issued. dirty state the device cannot record is dropped
+    uint32_t flush(bool depthBiasEnable, uint32_t supported = OVERLAY_STATE_ALL);
+
+    OverlayStateStats stats();
+    void resetStats();
+
+  private:
+    uint32_t dirty_ = OVERLAY_STATE_ALL;
+    OverlayStateStats stats_{};
+};
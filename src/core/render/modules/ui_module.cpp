@@ -40,6 +40,14 @@ std::vector<std::shared_ptr<vk::DescriptorTable>> &UIModule::overlayDescriptorTa
     return overlayDescriptorTables_;
 }
 
+OverlayStateStats UIModule::overlayStateStats() {
+    return overlayStateStats_;
+}
+
+OverlayDrawStats UIModule::overlayDrawStats() {
+    return overlayDrawStats_;
+}
+
 void UIModule::bindTexture(std::shared_ptr<vk::Sampler> sampler,
                            std::shared_ptr<vk::DeviceLocalImage> image,
                            int index) {
@@ -277,28 +285,34 @@ void UIModule::initOverlayDrawPipelines() {
         switch (type) {
             case POSITION_TEX: {
                 builder.defineVertexInputState<vk::VertexFormat::PositionTex>();
+                overlayDrawVertexStrides_[type] = sizeof(vk::VertexFormat::PositionTex);
                 break;
             }
             case POSITION_TEX_COLOR: {
                 builder.defineVertexInputState<vk::VertexFormat::PositionTexColor>();
+                overlayDrawVertexStrides_[type] = sizeof(vk::VertexFormat::PositionTexColor);
                 break;
             }
             case POSITION_COLOR: {
                 builder.defineVertexInputState<vk::VertexFormat::PositionColor>();
+                overlayDrawVertexStrides_[type] = sizeof(vk::VertexFormat::PositionColor);
                 break;
             }
             case POSITION_COLOR_TEX_LIGHT: {
                 builder.defineVertexInputState<vk::VertexFormat::PositionColorTexLight>();
+                overlayDrawVertexStrides_[type] = sizeof(vk::VertexFormat::PositionColorTexLight);
                 break;
             }
             case POSITION_COLOR_TEXTURE_OVERLAY_LIGHT_NORMAL_NO_OUTLINE:
             case POSITION_COLOR_TEXTURE_OVERLAY_LIGHT_NORMAL: {
                 builder.defineVertexInputState<vk::VertexFormat::PositionColorTexOverlayLightNormal>();
+                overlayDrawVertexStrides_[type] = sizeof(vk::VertexFormat::PositionColorTexOverlayLightNormal);
                 break;
             }
             case POSITION_END_PORTAL:
             case POSITION: {
                 builder.defineVertexInputState<vk::VertexFormat::PositionOnly>();
+                overlayDrawVertexStrides_[type] = sizeof(vk::VertexFormat::PositionOnly);
                 break;
             }
 
@@ -506,100 +520,127 @@ UIModuleContext::UIModuleContext(std::shared_ptr<FrameworkContext> context, std:
     overlayClearStencil = 0xffffffff;
 }
 
-void UIModuleContext::syncToCommandBuffer() {
+void UIModuleContext::markOverlayState(uint32_t state, bool changed) {
+    overlayState.mark(state, changed);
+}
+
+uint32_t UIModuleContext::dirtyOverlayState() {
+    return overlayState.dirty(overlayDepthBiasEnable);
+}
+
+void UIModuleContext::flushOverlayState() {
     auto context = frameworkContext.lock();
     auto framework = context->framework.lock();
 
     if (!framework->isRunning()) return;
 
+    // the logic op is only recorded if the extendedDynamicState2LogicOp feature is enabled, otherwise the bits are
+    // dropped
+    uint32_t supported = OVERLAY_STATE_ALL;
+    if (!context->device->hasExtendedDynamicState2LogicOp())
+        supported &= ~(OVERLAY_STATE_LOGIC_OP | OVERLAY_STATE_LOGIC_OP_ENABLE);
+
+    uint32_t dirty = overlayState.flush(overlayDepthBiasEnable, supported);
+    if (dirty == 0) return;
+
     auto commandBuffer = context->overlayCommandBuffer->vkCommandBuffer();
+    auto issue = [&](uint32_t state) { return (dirty & state) != 0; };
 
     // ------------ VkPipelineViewportStateCreateInfo ------------
     /* VK_DYNAMIC_STATE_VIEWPORT */
-    vkCmdSetViewport(commandBuffer, 0, 1, &overlayViewport);
+    if (issue(OVERLAY_STATE_VIEWPORT)) vkCmdSetViewport(commandBuffer, 0, 1, &overlayViewport);
 
     /* VK_DYNAMIC_STATE_SCISSOR */
-    if (overlayScissorEnabled)
-        vkCmdSetScissor(commandBuffer, 0, 1, &overlayScissor);
-    else {
-        VkRect2D full_scissor = {
-            .offset = {0, 0},
-            .extent = framework->swapchain()->vkExtent(),
-        };
-        vkCmdSetScissor(commandBuffer, 0, 1, &full_scissor);
+    if (issue(OVERLAY_STATE_SCISSOR)) {
+        if (overlayScissorEnabled)
+            vkCmdSetScissor(commandBuffer, 0, 1, &overlayScissor);
+        else {
+            VkRect2D full_scissor = {
+                .offset = {0, 0},
+                .extent = framework->swapchain()->vkExtent(),
+            };
+            vkCmdSetScissor(commandBuffer, 0, 1, &full_scissor);
+        }
     }
 
     // ------------ VkPipelineDepthStencilStateCreateInfo ------------
     /* VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE */
-    vkCmdSetDepthTestEnable(commandBuffer, overlayDepthTestEnable);
+    if (issue(OVERLAY_STATE_DEPTH_TEST_ENABLE)) vkCmdSetDepthTestEnable(commandBuffer, overlayDepthTestEnable);
 
     /* VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE */
-    vkCmdSetDepthWriteEnable(commandBuffer, overlayDepthWriteEnable);
+    if (issue(OVERLAY_STATE_DEPTH_WRITE_ENABLE)) vkCmdSetDepthWriteEnable(commandBuffer, overlayDepthWriteEnable);
 
     /* VK_DYNAMIC_STATE_DEPTH_COMPARE_OP */
-    vkCmdSetDepthCompareOp(commandBuffer, overlayDepthCompareOp);
+    if (issue(OVERLAY_STATE_DEPTH_COMPARE_OP)) vkCmdSetDepthCompareOp(commandBuffer, overlayDepthCompareOp);
 
     /* VK_DYNAMIC_STATE_STENCIL_TEST_ENABLE */
-    vkCmdSetStencilTestEnable(commandBuffer, overlayStencilTestEnable);
+    if (issue(OVERLAY_STATE_STENCIL_TEST_ENABLE)) vkCmdSetStencilTestEnable(commandBuffer, overlayStencilTestEnable);
 
     /* VK_DYNAMIC_STATE_STENCIL_OP */
-    vkCmdSetStencilOp(commandBuffer, VK_STENCIL_FACE_FRONT_BIT, overlayFailOp[0], overlayPassOp[0],
-                      overlayDepthFailOp[0], overlayCompareOp[0]);
-    vkCmdSetStencilOp(commandBuffer, VK_STENCIL_FACE_BACK_BIT, overlayFailOp[1], overlayPassOp[1],
-                      overlayDepthFailOp[1], overlayCompareOp[1]);
+    if (issue(OVERLAY_STATE_STENCIL_FRONT_OP))
+        vkCmdSetStencilOp(commandBuffer, VK_STENCIL_FACE_FRONT_BIT, overlayFailOp[0], overlayPassOp[0],
+                          overlayDepthFailOp[0], overlayCompareOp[0]);
+    if (issue(OVERLAY_STATE_STENCIL_BACK_OP))
+        vkCmdSetStencilOp(commandBuffer, VK_STENCIL_FACE_BACK_BIT, overlayFailOp[1], overlayPassOp[1],
+                          overlayDepthFailOp[1], overlayCompareOp[1]);
 
     /* VK_DYNAMIC_STATE_STENCIL_REFERENCE */
-    vkCmdSetStencilReference(commandBuffer, VK_STENCIL_FACE_FRONT_BIT, overlayReference[0]);
-    vkCmdSetStencilReference(commandBuffer, VK_STENCIL_FACE_BACK_BIT, overlayReference[1]);
+    if (issue(OVERLAY_STATE_STENCIL_FRONT_REFERENCE))
+        vkCmdSetStencilReference(commandBuffer, VK_STENCIL_FACE_FRONT_BIT, overlayReference[0]);
+    if (issue(OVERLAY_STATE_STENCIL_BACK_REFERENCE))
+        vkCmdSetStencilReference(commandBuffer, VK_STENCIL_FACE_BACK_BIT, overlayReference[1]);
 
     /* VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK */
-    vkCmdSetStencilCompareMask(commandBuffer, VK_STENCIL_FACE_FRONT_BIT, overlayCompareMask[0]);
-    vkCmdSetStencilCompareMask(commandBuffer, VK_STENCIL_FACE_BACK_BIT, overlayCompareMask[1]);
+    if (issue(OVERLAY_STATE_STENCIL_FRONT_COMPARE_MASK))
+        vkCmdSetStencilCompareMask(commandBuffer, VK_STENCIL_FACE_FRONT_BIT, overlayCompareMask[0]);
+    if (issue(OVERLAY_STATE_STENCIL_BACK_COMPARE_MASK))
+        vkCmdSetStencilCompareMask(commandBuffer, VK_STENCIL_FACE_BACK_BIT, overlayCompareMask[1]);
 
     /* VK_DYNAMIC_STATE_STENCIL_WRITE_MASK */
-    vkCmdSetStencilWriteMask(commandBuffer, VK_STENCIL_FACE_FRONT_BIT, overlayWriteMask[0]);
-    vkCmdSetStencilWriteMask(commandBuffer, VK_STENCIL_FACE_BACK_BIT, overlayWriteMask[1]);
+    if (issue(OVERLAY_STATE_STENCIL_FRONT_WRITE_MASK))
+        vkCmdSetStencilWriteMask(commandBuffer, VK_STENCIL_FACE_FRONT_BIT, overlayWriteMask[0]);
+    if (issue(OVERLAY_STATE_STENCIL_BACK_WRITE_MASK))
+        vkCmdSetStencilWriteMask(commandBuffer, VK_STENCIL_FACE_BACK_BIT, overlayWriteMask[1]);
 
     // ------------ VkPipelineRasterizationStateCreateInfo ------------
     /* VK_DYNAMIC_STATE_CULL_MODE */
-    vkCmdSetCullMode(commandBuffer, overlayCullMode);
+    if (issue(OVERLAY_STATE_CULL_MODE)) vkCmdSetCullMode(commandBuffer, overlayCullMode);
 
     /* VK_DYNAMIC_STATE_FRONT_FACE */
-    vkCmdSetFrontFace(commandBuffer, overlayFrontFace);
+    if (issue(OVERLAY_STATE_FRONT_FACE)) vkCmdSetFrontFace(commandBuffer, overlayFrontFace);
 
     /* VK_DYNAMIC_STATE_POLYGON_MODE_EXT */
-    vkCmdSetPolygonModeEXT(commandBuffer, overlayPolygonMode);
+    if (issue(OVERLAY_STATE_POLYGON_MODE)) vkCmdSetPolygonModeEXT(commandBuffer, overlayPolygonMode);
 
     /* VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE */
-    vkCmdSetDepthBiasEnable(commandBuffer, overlayDepthBiasEnable);
+    if (issue(OVERLAY_STATE_DEPTH_BIAS_ENABLE)) vkCmdSetDepthBiasEnable(commandBuffer, overlayDepthBiasEnable);
 
     /* VK_DYNAMIC_STATE_DEPTH_BIAS */
-    vkCmdSetDepthBias(commandBuffer, overlayDepthBiasConstantFactor[overlayPolygonMode],
-                      overlayDepthBiasClamp[overlayPolygonMode], overlayDepthBiasSlopeFactor[overlayPolygonMode]);
+    if (issue(OVERLAY_STATE_DEPTH_BIAS))
+        vkCmdSetDepthBias(commandBuffer, overlayDepthBiasConstantFactor[overlayPolygonMode],
+                          overlayDepthBiasClamp[overlayPolygonMode], overlayDepthBiasSlopeFactor[overlayPolygonMode]);
 
     /* VK_DYNAMIC_STATE_LINE_WIDTH */
-    vkCmdSetLineWidth(commandBuffer, overlayLineWidth);
+    if (issue(OVERLAY_STATE_LINE_WIDTH)) vkCmdSetLineWidth(commandBuffer, overlayLineWidth);
 
     // ------------ VkPipelineColorBlendAttachmentState / StateCreateInfo ------------
     /* VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT */
-    vkCmdSetColorBlendEnableEXT(commandBuffer, 0, 1, &overlayBlendEnabled);
+    if (issue(OVERLAY_STATE_COLOR_BLEND_ENABLE)) vkCmdSetColorBlendEnableEXT(commandBuffer, 0, 1, &overlayBlendEnabled);
 
     /* VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT */
-    vkCmdSetColorBlendEquationEXT(commandBuffer, 0, 1, &overlayColorBlendEquation);
+    if (issue(OVERLAY_STATE_COLOR_BLEND_EQUATION))
+        vkCmdSetColorBlendEquationEXT(commandBuffer, 0, 1, &overlayColorBlendEquation);
 
     /* VK_DYNAMIC_STATE_COLOR_WRITE_MASK_EXT */
-    vkCmdSetColorWriteMaskEXT(commandBuffer, 0, 1, &overlayColorWriteMask);
+    if (issue(OVERLAY_STATE_COLOR_WRITE_MASK)) vkCmdSetColorWriteMaskEXT(commandBuffer, 0, 1, &overlayColorWriteMask);
 
     // ------------ VkPipelineColorBlendStateCreateInfo ------------
     /* VK_DYNAMIC_STATE_LOGIC_OP_EXT and VK_DYNAMIC_STATE_LOGIC_OP_ENABLE_EXT */
-    // Only call these if extendedDynamicState2LogicOp feature is enabled
-    if (context->device->hasExtendedDynamicState2LogicOp()) {
-        vkCmdSetLogicOpEXT(commandBuffer, overlayColorLogicOp);
-        vkCmdSetLogicOpEnableEXT(commandBuffer, overlayColorLogicOpEnable);
-    }
+    if (issue(OVERLAY_STATE_LOGIC_OP)) vkCmdSetLogicOpEXT(commandBuffer, overlayColorLogicOp);
+    if (issue(OVERLAY_STATE_LOGIC_OP_ENABLE)) vkCmdSetLogicOpEnableEXT(commandBuffer, overlayColorLogicOpEnable);
 
     /* VK_DYNAMIC_STATE_BLEND_CONSTANTS */
-    vkCmdSetBlendConstants(commandBuffer, overlayBlendConstants.data());
+    if (issue(OVERLAY_STATE_BLEND_CONSTANTS)) vkCmdSetBlendConstants(commandBuffer, overlayBlendConstants.data());
 }
 
 void UIModuleContext::syncFromContext(std::shared_ptr<UIModuleContext> other) {
@@ -644,7 +685,7 @@ void UIModuleContext::syncFromContext(std::shared_ptr<UIModuleContext> other) {
     overlayClearDepth = other->overlayClearDepth;
     overlayClearStencil = other->overlayClearStencil;
 
-    syncToCommandBuffer();
+    overlayState.invalidate();
 }
 
 void UIModuleContext::setOverlayScissorEnabled(bool enabled) {
@@ -653,16 +694,8 @@ void UIModuleContext::setOverlayScissorEnabled(bool enabled) {
 
     if (!framework->isRunning()) return;
 
+    markOverlayState(OVERLAY_STATE_SCISSOR, overlayScissorEnabled != enabled);
     overlayScissorEnabled = enabled;
-    if (overlayScissorEnabled) {
-        vkCmdSetScissor(context->overlayCommandBuffer->vkCommandBuffer(), 0, 1, &overlayScissor);
-    } else {
-        VkRect2D full_scissor = {
-            .offset = {0, 0},
-            .extent = framework->swapchain()->vkExtent(),
-        };
-        vkCmdSetScissor(context->overlayCommandBuffer->vkCommandBuffer(), 0, 1, &full_scissor);
-    }
 }
 
 void UIModuleContext::setOverlayScissor(int x, int y, int width, int height) {
@@ -680,11 +713,14 @@ void UIModuleContext::setOverlayScissor(int x, int y, int width, int height) {
     if (x + width > context->swapchainImage->width()) width = context->swapchainImage->width() - x;
     if (y + height > context->swapchainImage->height()) height = context->swapchainImage->height() - y;
 
+    // the box is only recorded while the scissor is enabled, enabling it marks the scissor itself
+    bool changed = overlayScissor.offset.x != x || overlayScissor.offset.y != y ||
+                   overlayScissor.extent.width != width || overlayScissor.extent.height != height;
+    markOverlayState(OVERLAY_STATE_SCISSOR, changed && overlayScissorEnabled);
     overlayScissor.offset.x = x;
     overlayScissor.offset.y = y;
     overlayScissor.extent.width = width;
     overlayScissor.extent.height = height;
-    setOverlayScissorEnabled(overlayScissorEnabled);
 }
 
 void UIModuleContext::setOverlayViewport(int x, int y, int width, int height) {
@@ -693,11 +729,12 @@ void UIModuleContext::setOverlayViewport(int x, int y, int width, int height) {
 
     if (!framework->isRunning()) return;
 
+    markOverlayState(OVERLAY_STATE_VIEWPORT, overlayViewport.x != x || overlayViewport.y != y ||
+                                                 overlayViewport.width != width || overlayViewport.height != height);
     overlayViewport.x = x;
     overlayViewport.y = y;
     overlayViewport.width = width;
     overlayViewport.height = height;
-    vkCmdSetViewport(context->overlayCommandBuffer->vkCommandBuffer(), 0, 1, &overlayViewport);
 }
 
 void UIModuleContext::setOverlayBlendEnable(bool enable) {
@@ -706,8 +743,8 @@ void UIModuleContext::setOverlayBlendEnable(bool enable) {
 
     if (!framework->isRunning()) return;
 
+    markOverlayState(OVERLAY_STATE_COLOR_BLEND_ENABLE, overlayBlendEnabled != static_cast<VkBool32>(enable));
     overlayBlendEnabled = enable;
-    vkCmdSetColorBlendEnableEXT(context->overlayCommandBuffer->vkCommandBuffer(), 0, 1, &overlayBlendEnabled);
 }
 
 void UIModuleContext::setOverlayColorBlendConstants(float const1, float const2, float const3, float const4) {
@@ -716,11 +753,9 @@ void UIModuleContext::setOverlayColorBlendConstants(float const1, float const2,
 
     if (!framework->isRunning()) return;
 
-    overlayBlendConstants[0] = const1;
-    overlayBlendConstants[1] = const2;
-    overlayBlendConstants[2] = const3;
-    overlayBlendConstants[3] = const4;
-    vkCmdSetBlendConstants(context->overlayCommandBuffer->vkCommandBuffer(), overlayBlendConstants.data());
+    std::array<float, 4> blendConstants = {const1, const2, const3, const4};
+    markOverlayState(OVERLAY_STATE_BLEND_CONSTANTS, overlayBlendConstants != blendConstants);
+    overlayBlendConstants = blendConstants;
 }
 
 void UIModuleContext::setOverlayColorLogicOpEnable(bool enable) {
@@ -729,10 +764,8 @@ void UIModuleContext::setOverlayColorLogicOpEnable(bool enable) {
 
     if (!framework->isRunning()) return;
 
+    markOverlayState(OVERLAY_STATE_LOGIC_OP_ENABLE, overlayColorLogicOpEnable != enable);
     overlayColorLogicOpEnable = enable;
-    if (context->device->hasExtendedDynamicState2LogicOp()) {
-        vkCmdSetLogicOpEnableEXT(context->overlayCommandBuffer->vkCommandBuffer(), overlayColorLogicOpEnable);
-    }
 }
 
 void UIModuleContext::setOverlayBlendFuncSeparate(int srcColorBlendFactor,
@@ -744,11 +777,15 @@ void UIModuleContext::setOverlayBlendFuncSeparate(int srcColorBlendFactor,
 
     if (!framework->isRunning()) return;
 
+    markOverlayState(OVERLAY_STATE_COLOR_BLEND_EQUATION,
+                     overlayColorBlendEquation.srcColorBlendFactor != srcColorBlendFactor ||
+                         overlayColorBlendEquation.srcAlphaBlendFactor != srcAlphaBlendFactor ||
+                         overlayColorBlendEquation.dstColorBlendFactor != dstColorBlendFactor ||
+                         overlayColorBlendEquation.dstAlphaBlendFactor != dstAlphaBlendFactor);
     overlayColorBlendEquation.srcColorBlendFactor = static_cast<VkBlendFactor>(srcColorBlendFactor);
     overlayColorBlendEquation.srcAlphaBlendFactor = static_cast<VkBlendFactor>(srcAlphaBlendFactor);
     overlayColorBlendEquation.dstColorBlendFactor = static_cast<VkBlendFactor>(dstColorBlendFactor);
     overlayColorBlendEquation.dstAlphaBlendFactor = static_cast<VkBlendFactor>(dstAlphaBlendFactor);
-    vkCmdSetColorBlendEquationEXT(context->overlayCommandBuffer->vkCommandBuffer(), 0, 1, &overlayColorBlendEquation);
 }
 
 void UIModuleContext::setOverlayBlendOpSeparate(int colorBlendOp, int alphaBlendOp) {
@@ -757,9 +794,10 @@ void UIModuleContext::setOverlayBlendOpSeparate(int colorBlendOp, int alphaBlend
 
     if (!framework->isRunning()) return;
 
+    markOverlayState(OVERLAY_STATE_COLOR_BLEND_EQUATION, overlayColorBlendEquation.colorBlendOp != colorBlendOp ||
+                                                             overlayColorBlendEquation.alphaBlendOp != alphaBlendOp);
     overlayColorBlendEquation.colorBlendOp = static_cast<VkBlendOp>(colorBlendOp);
     overlayColorBlendEquation.alphaBlendOp = static_cast<VkBlendOp>(alphaBlendOp);
-    vkCmdSetColorBlendEquationEXT(context->overlayCommandBuffer->vkCommandBuffer(), 0, 1, &overlayColorBlendEquation);
 }
 
 void UIModuleContext::setOverlayColorWriteMask(int colorWriteMask) {
@@ -768,8 +806,8 @@ void UIModuleContext::setOverlayColorWriteMask(int colorWriteMask) {
 
     if (!framework->isRunning()) return;
 
+    markOverlayState(OVERLAY_STATE_COLOR_WRITE_MASK, overlayColorWriteMask != colorWriteMask);
     overlayColorWriteMask = colorWriteMask;
-    vkCmdSetColorWriteMaskEXT(context->overlayCommandBuffer->vkCommandBuffer(), 0, 1, &overlayColorWriteMask);
 }
 
 void UIModuleContext::setOverlayColorLogicOp(int colorLogicOp) {
@@ -778,10 +816,8 @@ void UIModuleContext::setOverlayColorLogicOp(int colorLogicOp) {
 
     if (!framework->isRunning()) return;
 
+    markOverlayState(OVERLAY_STATE_LOGIC_OP, overlayColorLogicOp != colorLogicOp);
     overlayColorLogicOp = static_cast<VkLogicOp>(colorLogicOp);
-    if (context->device->hasExtendedDynamicState2LogicOp()) {
-        vkCmdSetLogicOpEXT(context->overlayCommandBuffer->vkCommandBuffer(), overlayColorLogicOp);
-    }
 }
 
 void UIModuleContext::setOverlayDepthTestEnable(bool enable) {
@@ -790,8 +826,8 @@ void UIModuleContext::setOverlayDepthTestEnable(bool enable) {
 
     if (!framework->isRunning()) return;
 
+    markOverlayState(OVERLAY_STATE_DEPTH_TEST_ENABLE, overlayDepthTestEnable != enable);
     overlayDepthTestEnable = enable;
-    vkCmdSetDepthTestEnable(context->overlayCommandBuffer->vkCommandBuffer(), overlayDepthTestEnable);
 }
 
 void UIModuleContext::setOverlayDepthWriteEnable(bool enable) {
@@ -800,8 +836,8 @@ void UIModuleContext::setOverlayDepthWriteEnable(bool enable) {
 
     if (!framework->isRunning()) return;
 
+    markOverlayState(OVERLAY_STATE_DEPTH_WRITE_ENABLE, overlayDepthWriteEnable != enable);
     overlayDepthWriteEnable = enable;
-    vkCmdSetDepthWriteEnable(context->overlayCommandBuffer->vkCommandBuffer(), overlayDepthWriteEnable);
 }
 
 void UIModuleContext::setOverlayStencilTestEnable(bool enable) {
@@ -810,8 +846,8 @@ void UIModuleContext::setOverlayStencilTestEnable(bool enable) {
 
     if (!framework->isRunning()) return;
 
+    markOverlayState(OVERLAY_STATE_STENCIL_TEST_ENABLE, overlayStencilTestEnable != enable);
     overlayStencilTestEnable = enable;
-    vkCmdSetStencilTestEnable(context->overlayCommandBuffer->vkCommandBuffer(), overlayStencilTestEnable);
 }
 
 void UIModuleContext::setOverlayDepthCompareOp(int depthCompareOp) {
@@ -820,8 +856,8 @@ void UIModuleContext::setOverlayDepthCompareOp(int depthCompareOp) {
 
     if (!framework->isRunning()) return;
 
+    markOverlayState(OVERLAY_STATE_DEPTH_COMPARE_OP, overlayDepthCompareOp != depthCompareOp);
     overlayDepthCompareOp = static_cast<VkCompareOp>(depthCompareOp);
-    vkCmdSetDepthCompareOp(context->overlayCommandBuffer->vkCommandBuffer(), overlayDepthCompareOp);
 }
 
 void UIModuleContext::setOverlayStencilFrontFunc(int compareOp, int reference, int compareMask) {
@@ -830,15 +866,13 @@ void UIModuleContext::setOverlayStencilFrontFunc(int compareOp, int reference, i
 
     if (!framework->isRunning()) return;
 
+    markOverlayState(OVERLAY_STATE_STENCIL_FRONT_OP, overlayCompareOp[0] != compareOp);
+    markOverlayState(OVERLAY_STATE_STENCIL_FRONT_REFERENCE, overlayReference[0] != static_cast<uint32_t>(reference));
+    markOverlayState(OVERLAY_STATE_STENCIL_FRONT_COMPARE_MASK,
+                     overlayCompareMask[0] != static_cast<uint32_t>(compareMask));
     overlayCompareOp[0] = static_cast<VkCompareOp>(compareOp);
     overlayReference[0] = reference;
     overlayCompareMask[0] = compareMask;
-    vkCmdSetStencilOp(context->overlayCommandBuffer->vkCommandBuffer(), VK_STENCIL_FACE_FRONT_BIT, overlayFailOp[0],
-                      overlayPassOp[0], overlayDepthFailOp[0], overlayCompareOp[0]);
-    vkCmdSetStencilReference(context->overlayCommandBuffer->vkCommandBuffer(), VK_STENCIL_FACE_FRONT_BIT,
-                             overlayReference[0]);
-    vkCmdSetStencilCompareMask(context->overlayCommandBuffer->vkCommandBuffer(), VK_STENCIL_FACE_FRONT_BIT,
-                               overlayCompareMask[0]);
 }
 
 void UIModuleContext::setOverlayStencilBackFunc(int compareOp, int reference, int compareMask) {
@@ -847,15 +881,13 @@ void UIModuleContext::setOverlayStencilBackFunc(int compareOp, int reference, in
 
     if (!framework->isRunning()) return;
 
+    markOverlayState(OVERLAY_STATE_STENCIL_BACK_OP, overlayCompareOp[1] != compareOp);
+    markOverlayState(OVERLAY_STATE_STENCIL_BACK_REFERENCE, overlayReference[1] != static_cast<uint32_t>(reference));
+    markOverlayState(OVERLAY_STATE_STENCIL_BACK_COMPARE_MASK,
+                     overlayCompareMask[1] != static_cast<uint32_t>(compareMask));
     overlayCompareOp[1] = static_cast<VkCompareOp>(compareOp);
     overlayReference[1] = reference;
     overlayCompareMask[1] = compareMask;
-    vkCmdSetStencilOp(context->overlayCommandBuffer->vkCommandBuffer(), VK_STENCIL_FACE_BACK_BIT, overlayFailOp[1],
-                      overlayPassOp[1], overlayDepthFailOp[1], overlayCompareOp[1]);
-    vkCmdSetStencilReference(context->overlayCommandBuffer->vkCommandBuffer(), VK_STENCIL_FACE_BACK_BIT,
-                             overlayReference[1]);
-    vkCmdSetStencilCompareMask(context->overlayCommandBuffer->vkCommandBuffer(), VK_STENCIL_FACE_BACK_BIT,
-                               overlayCompareMask[1]);
 }
 
 void UIModuleContext::setOverlayStencilFrontOp(int failOp, int depthFailOp, int passOp) {
@@ -864,11 +896,12 @@ void UIModuleContext::setOverlayStencilFrontOp(int failOp, int depthFailOp, int
 
     if (!framework->isRunning()) return;
 
+    markOverlayState(OVERLAY_STATE_STENCIL_FRONT_OP, overlayFailOp[0] != failOp ||
+                                                         overlayDepthFailOp[0] != depthFailOp ||
+                                                         overlayPassOp[0] != passOp);
     overlayFailOp[0] = static_cast<VkStencilOp>(failOp);
     overlayDepthFailOp[0] = static_cast<VkStencilOp>(depthFailOp);
     overlayPassOp[0] = static_cast<VkStencilOp>(passOp);
-    vkCmdSetStencilOp(context->overlayCommandBuffer->vkCommandBuffer(), VK_STENCIL_FACE_FRONT_BIT, overlayFailOp[0],
-                      overlayPassOp[0], overlayDepthFailOp[0], overlayCompareOp[0]);
 }
 
 void UIModuleContext::setOverlayStencilBackOp(int failOp, int depthFailOp, int passOp) {
@@ -877,11 +910,12 @@ void UIModuleContext::setOverlayStencilBackOp(int failOp, int depthFailOp, int p
 
     if (!framework->isRunning()) return;
 
+    markOverlayState(OVERLAY_STATE_STENCIL_BACK_OP, overlayFailOp[1] != failOp ||
+                                                        overlayDepthFailOp[1] != depthFailOp ||
+                                                        overlayPassOp[1] != passOp);
     overlayFailOp[1] = static_cast<VkStencilOp>(failOp);
     overlayDepthFailOp[1] = static_cast<VkStencilOp>(depthFailOp);
     overlayPassOp[1] = static_cast<VkStencilOp>(passOp);
-    vkCmdSetStencilOp(context->overlayCommandBuffer->vkCommandBuffer(), VK_STENCIL_FACE_BACK_BIT, overlayFailOp[1],
-                      overlayPassOp[1], overlayDepthFailOp[1], overlayCompareOp[1]);
 }
 
 void UIModuleContext::setOverlayStencilFrontWriteMask(int writeMask) {
@@ -890,9 +924,8 @@ void UIModuleContext::setOverlayStencilFrontWriteMask(int writeMask) {
 
     if (!framework->isRunning()) return;
 
+    markOverlayState(OVERLAY_STATE_STENCIL_FRONT_WRITE_MASK, overlayWriteMask[0] != static_cast<uint32_t>(writeMask));
     overlayWriteMask[0] = writeMask;
-    vkCmdSetStencilWriteMask(context->overlayCommandBuffer->vkCommandBuffer(), VK_STENCIL_FACE_FRONT_BIT,
-                             overlayWriteMask[0]);
 }
 
 void UIModuleContext::setOverlayStencilBackWriteMask(int writeMask) {
@@ -901,9 +934,8 @@ void UIModuleContext::setOverlayStencilBackWriteMask(int writeMask) {
 
     if (!framework->isRunning()) return;
 
+    markOverlayState(OVERLAY_STATE_STENCIL_BACK_WRITE_MASK, overlayWriteMask[1] != static_cast<uint32_t>(writeMask));
     overlayWriteMask[1] = writeMask;
-    vkCmdSetStencilWriteMask(context->overlayCommandBuffer->vkCommandBuffer(), VK_STENCIL_FACE_BACK_BIT,
-                             overlayWriteMask[1]);
 }
 
 void UIModuleContext::setOverlayLineWidth(float lineWidth) {
@@ -912,8 +944,8 @@ void UIModuleContext::setOverlayLineWidth(float lineWidth) {
 
     if (!framework->isRunning()) return;
 
+    markOverlayState(OVERLAY_STATE_LINE_WIDTH, overlayLineWidth != lineWidth);
     overlayLineWidth = lineWidth;
-    vkCmdSetLineWidth(context->overlayCommandBuffer->vkCommandBuffer(), overlayLineWidth);
 }
 
 void UIModuleContext::setOverlayPolygonMode(int polygonMode) {
@@ -922,9 +954,11 @@ void UIModuleContext::setOverlayPolygonMode(int polygonMode) {
 
     if (!framework->isRunning()) return;
 
+    // the bias values are kept per polygon mode
+    bool changed = overlayPolygonMode != polygonMode;
+    markOverlayState(OVERLAY_STATE_POLYGON_MODE, changed);
+    if (changed) overlayState.invalidate(OVERLAY_STATE_DEPTH_BIAS);
     overlayPolygonMode = static_cast<VkPolygonMode>(polygonMode);
-    vkCmdSetPolygonModeEXT(context->overlayCommandBuffer->vkCommandBuffer(), overlayPolygonMode);
-    setOverlayDepthBiasEnable(overlayPolygonMode, overlayDepthBiasEnable);
 }
 
 void UIModuleContext::setOverlayCullMode(int cullMode) {
@@ -933,8 +967,8 @@ void UIModuleContext::setOverlayCullMode(int cullMode) {
 
     if (!framework->isRunning()) return;
 
+    markOverlayState(OVERLAY_STATE_CULL_MODE, overlayCullMode != static_cast<VkCullModeFlags>(cullMode));
     overlayCullMode = cullMode;
-    vkCmdSetCullMode(context->overlayCommandBuffer->vkCommandBuffer(), overlayCullMode);
 }
 
 void UIModuleContext::setOverlayFrontFace(int frontFace) {
@@ -943,8 +977,8 @@ void UIModuleContext::setOverlayFrontFace(int frontFace) {
 
     if (!framework->isRunning()) return;
 
+    markOverlayState(OVERLAY_STATE_FRONT_FACE, overlayFrontFace != frontFace);
     overlayFrontFace = static_cast<VkFrontFace>(frontFace);
-    vkCmdSetFrontFace(context->overlayCommandBuffer->vkCommandBuffer(), overlayFrontFace);
 }
 
 void UIModuleContext::setOverlayDepthBiasEnable(int polygonMode, bool enable) {
@@ -953,12 +987,8 @@ void UIModuleContext::setOverlayDepthBiasEnable(int polygonMode, bool enable) {
 
     if (!framework->isRunning()) return;
 
+    markOverlayState(OVERLAY_STATE_DEPTH_BIAS_ENABLE, overlayDepthBiasEnable != enable);
     overlayDepthBiasEnable = enable;
-    if (overlayDepthBiasEnable)
-        vkCmdSetDepthBias(context->overlayCommandBuffer->vkCommandBuffer(),
-                          overlayDepthBiasConstantFactor[overlayPolygonMode], overlayDepthBiasClamp[overlayPolygonMode],
-                          overlayDepthBiasSlopeFactor[overlayPolygonMode]);
-    vkCmdSetDepthBiasEnable(context->overlayCommandBuffer->vkCommandBuffer(), overlayDepthBiasEnable);
 }
 
 void UIModuleContext::setOverlayDepthBias(float depthBiasSlopeFactor, float depthBiasConstantFactor) {
@@ -967,9 +997,11 @@ void UIModuleContext::setOverlayDepthBias(float depthBiasSlopeFactor, float dept
 
     if (!framework->isRunning()) return;
 
+    markOverlayState(OVERLAY_STATE_DEPTH_BIAS,
+                     overlayDepthBiasSlopeFactor[overlayPolygonMode] != depthBiasSlopeFactor ||
+                         overlayDepthBiasConstantFactor[overlayPolygonMode] != depthBiasConstantFactor);
     overlayDepthBiasSlopeFactor[overlayPolygonMode] = depthBiasSlopeFactor;
     overlayDepthBiasConstantFactor[overlayPolygonMode] = depthBiasConstantFactor;
-    setOverlayDepthBiasEnable(overlayPolygonMode, overlayDepthBiasEnable);
 }
 
 void UIModuleContext::setOverlayClearColor(float red, float green, float blue, float alpha) {
@@ -1067,7 +1099,6 @@ void UIModuleContext::switchOverlayDraw() {
 
         overlayDrawColorImage->imageLayout() = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
         overlayDrawDepthStencilImage->imageLayout() = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-        syncToCommandBuffer();
     }
 
     overlayMode = DRAW;
@@ -1080,6 +1111,8 @@ void UIModuleContext::switchOverlayPost() {
 
     if (!framework->isRunning()) return;
 
+    flushOverlayDraw();
+
     auto mainQueueIndex = context->physicalDevice->mainQueueIndex();
 
     if (overlayMode == DRAW) {
@@ -1149,6 +1182,7 @@ void UIModuleContext::clearOverlayEntireColorAttachment() {
     if (!framework->isRunning()) return;
 
     switchOverlayDraw();
+    flushOverlayDraw();
 
     VkClearAttachment clearAttachment{};
     clearAttachment.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
@@ -1174,6 +1208,7 @@ void UIModuleContext::clearOverlayEntireDepthStencilAttachment(int aspectMask) {
     if (!framework->isRunning()) return;
 
     switchOverlayDraw();
+    flushOverlayDraw();
 
     VkClearAttachment clearAttachment{};
     clearAttachment.aspectMask = aspectMask;
@@ -1190,29 +1225,109 @@ void UIModuleContext::clearOverlayEntireDepthStencilAttachment(int aspectMask) {
 }
 
 void UIModuleContext::drawIndexed(std::shared_ptr<vk::DeviceLocalBuffer> vertexBuffer,
-                                  std::shared_ptr<vk::DeviceLocalBuffer> indexBuffer,
+                                  VkDeviceSize vertexOffset,
+                                  std::shared_ptr<vk::Buffer> indexBuffer,
+                                  VkDeviceSize indexOffset,
                                   OverlayDrawPipelineType pipelineType,
                                   uint32_t indexCount,
                                   VkIndexType indexType) {
     auto context = frameworkContext.lock();
     auto framework = context->framework.lock();
+
+    if (!framework->isRunning()) return;
+
+    switchOverlayDraw();
+
+    queueOverlayDraw({
+        .pipelineType = pipelineType,
+        .drawID = Renderer::instance().buffers()->getDrawID(),
+        .vertexBuffer = vertexBuffer,
+        .vertexOffset = vertexOffset,
+        .indexBuffer = indexBuffer,
+        .indexOffset = indexOffset,
+        .indexType = indexType,
+        .indexCount = indexCount,
+        .quads = false,
+    });
+}
+
+void UIModuleContext::drawQuads(std::shared_ptr<vk::DeviceLocalBuffer> vertexBuffer,
+                                VkDeviceSize vertexOffset,
+                                OverlayDrawPipelineType pipelineType,
+                                uint32_t indexCount) {
+    auto context = frameworkContext.lock();
+    auto framework = context->framework.lock();
     auto module = uiModule.lock();
 
     if (!framework->isRunning()) return;
 
     switchOverlayDraw();
 
-    vkCmdBindPipeline(context->overlayCommandBuffer->vkCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS,
-                      module->overlayDrawPipelines_[pipelineType]->vkPipeline());
+    auto buffers = Renderer::instance().buffers();
+    int drawID = buffers->getDrawID();
+
+    // the merged draw reads the pattern past the pending quads, which index the vertices right after them
+    if (pendingOverlayDraw.has_value() && dirtyOverlayState() == 0) {
+        OverlayDraw &pending = pendingOverlayDraw.value();
+        VkDeviceSize pendingEnd =
+            pending.vertexOffset + pending.indexCount / 6 * 4 * module->overlayDrawVertexStrides_[pipelineType];
+        if (pending.quads && pending.indexCount % 6 == 0 && pending.pipelineType == pipelineType &&
+            pending.drawID == drawID && pending.vertexBuffer == vertexBuffer && pendingEnd == vertexOffset) {
+            pending.indexCount += indexCount;
+            pending.indexBuffer = buffers->quadIndexBuffer((pending.indexCount + 5) / 6);
+            overlayDrawStats.requested++;
+            return;
+        }
+    }
+
+    queueOverlayDraw({
+        .pipelineType = pipelineType,
+        .drawID = drawID,
+        .vertexBuffer = vertexBuffer,
+        .vertexOffset = vertexOffset,
+        .indexBuffer = buffers->quadIndexBuffer((indexCount + 5) / 6),
+        .indexOffset = 0,
+        .indexType = VK_INDEX_TYPE_UINT32,
+        .indexCount = indexCount,
+        .quads = true,
+    });
+}
+
+// records the previous pending draw and everything the new one needs except the draw itself, so later quads can
+// still be merged into it
+void UIModuleContext::queueOverlayDraw(const OverlayDraw &draw) {
+    auto context = frameworkContext.lock();
+    auto module = uiModule.lock();
+
+    flushOverlayDraw();
+
+    if (overlayBoundPipeline != draw.pipelineType) {
+        vkCmdBindPipeline(context->overlayCommandBuffer->vkCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS,
+                          module->overlayDrawPipelines_[draw.pipelineType]->vkPipeline());
+        overlayBoundPipeline = draw.pipelineType;
+    }
+    flushOverlayState();
 
     auto pipelineLayout = overlayDescriptorTable->vkPipelineLayout();
-    int drawID = Renderer::instance().buffers()->getDrawID();
     vkCmdPushConstants(context->overlayCommandBuffer->vkCommandBuffer(), pipelineLayout, VK_SHADER_STAGE_ALL, 0,
-                       sizeof(int), &drawID);
+                       sizeof(int), &draw.drawID);
 
-    context->overlayCommandBuffer->bindVertexBuffers(vertexBuffer)
-        ->bindIndexBuffer(indexBuffer, indexType)
-        ->drawIndexed(indexCount, 1);
+    pendingOverlayDraw = draw;
+    overlayDrawStats.requested++;
+}
+
+void UIModuleContext::flushOverlayDraw() {
+    auto context = frameworkContext.lock();
+
+    if (!pendingOverlayDraw.has_value()) return;
+
+    OverlayDraw &draw = pendingOverlayDraw.value();
+    context->overlayCommandBuffer->bindVertexBuffers(draw.vertexBuffer, draw.vertexOffset)
+        ->bindIndexBuffer(draw.indexBuffer, draw.indexType, draw.indexOffset)
+        ->drawIndexed(draw.indexCount, 1);
+    overlayDrawStats.recorded++;
+
+    pendingOverlayDraw.reset();
 }
 
 void UIModuleContext::postBlur(int times) {
@@ -1229,6 +1344,9 @@ void UIModuleContext::postBlur(int times) {
 
         vkCmdBindPipeline(context->overlayCommandBuffer->vkCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS,
                           module->overlayPostPipelines_[BLUR]->vkPipeline());
+        // the post pipeline has all its state baked in, binding it overwrites the overlay dynamic state
+        overlayState.invalidate();
+        overlayBoundPipeline.reset();
 
         auto pipelineLayout = overlayDescriptorTable->vkPipelineLayout();
 
@@ -1343,13 +1461,18 @@ void UIModuleContext::begin(std::shared_ptr<UIModuleContext> lastContext) {
     if (!framework->isRunning()) return;
 
     overlayMode = NONE;
+    overlayZone = GpuProfiler::beginZone(framework->gpuProfiler()->frameQueries(context->frameIndex),
+                                         context->overlayCommandBuffer, "overlay");
 
     context->overlayCommandBuffer->bindDescriptorTable(overlayDescriptorTable, VK_PIPELINE_BIND_POINT_GRAPHICS);
 
-    if (lastContext != nullptr)
-        syncFromContext(lastContext);
-    else
-        syncToCommandBuffer();
+    // the command buffer starts without any state, everything is recorded again before the first draw
+    overlayState.invalidate();
+    overlayState.resetStats();
+    pendingOverlayDraw.reset();
+    overlayBoundPipeline.reset();
+    overlayDrawStats = {};
+    if (lastContext != nullptr) syncFromContext(lastContext);
 }
 
 void UIModuleContext::end() {
@@ -1358,6 +1481,8 @@ void UIModuleContext::end() {
 
     if (!framework->isRunning()) return;
 
+    flushOverlayDraw();
+
     if (overlayMode == DRAW) {
         context->overlayCommandBuffer->endRenderPass();
 #ifdef USE_AMD
@@ -1394,4 +1519,11 @@ void UIModuleContext::end() {
     }
 
     overlayMode = NONE;
+    auto module = uiModule.lock();
+    module->overlayStateStats_ = overlayState.stats();
+    module->overlayDrawStats_ = overlayDrawStats;
+
+    GpuProfiler::endZone(framework->gpuProfiler()->frameQueries(context->frameIndex), context->overlayCommandBuffer,
+                         overlayZone);
+    overlayZone = GpuProfiler::invalidZone;
 }
@@ -3,10 +3,13 @@
 #include "common/shared.hpp"
 #include "common/singleton.hpp"
 #include "core/all_extern.hpp"
+#include "core/render/gpu_profiler.hpp"
+#include "core/render/modules/overlay_state.hpp"
 #include "core/vulkan/all_core_vulkan.hpp"
 
 #include <map>
 #include <array>
+#include <optional>
 
 class Framework;
 class FrameworkContext;
@@ -47,6 +50,11 @@ enum OverlayMode {
 
 class UIModuleContext;
 
+struct OverlayDrawStats {
+    uint32_t requested; // draws arriving through drawOverlay over a frame
+    uint32_t recorded;  // vkCmdDrawIndexed recorded for them
+};
+
 class UIModule : public SharedObject<UIModule> {
     friend UIModuleContext;
 
@@ -56,6 +64,9 @@ class UIModule : public SharedObject<UIModule> {
     void init(std::shared_ptr<Framework> framework);
     std::vector<std::shared_ptr<UIModuleContext>> &contexts();
     std::vector<std::shared_ptr<vk::DescriptorTable>> &overlayDescriptorTables();
+    // of the last frame that ended its overlay
+    OverlayStateStats overlayStateStats();
+    OverlayDrawStats overlayDrawStats();
 
     void bindTexture(std::shared_ptr<vk::Sampler> sampler, std::shared_ptr<vk::DeviceLocalImage> image, int index);
 
@@ -85,6 +96,7 @@ class UIModule : public SharedObject<UIModule> {
     std::map<OverlayDrawPipelineType, GraphicsPipelineShaderInfo> overlayDrawPipelineInfos_;
     std::map<OverlayDrawPipelineType, GraphicsPipelineShaders> overlayDrawPipelineShaders_;
     std::map<OverlayDrawPipelineType, std::shared_ptr<vk::DynamicGraphicsPipeline>> overlayDrawPipelines_;
+    std::map<OverlayDrawPipelineType, uint32_t> overlayDrawVertexStrides_;
 
     std::vector<std::shared_ptr<vk::DeviceLocalImage>> overlayPostColorImages_;
     std::vector<std::shared_ptr<vk::Sampler>> overlayDrawColorImageSamplers_;
@@ -95,9 +107,27 @@ class UIModule : public SharedObject<UIModule> {
     std::map<OverlayPostPipelineType, std::shared_ptr<vk::GraphicsPipeline>> overlayPostPipelines_;
 
     std::vector<std::shared_ptr<UIModuleContext>> contexts_;
+    OverlayStateStats overlayStateStats_{};
+    OverlayDrawStats overlayDrawStats_{};
 };
 
+// the setters only update the shadowed state and mark what changed, the dirty state is recorded right before the next
+// draw so redundant and overwritten state never reaches the command buffer. a draw is held back as pending until the
+// next one arrives, quad draws over back to back vertex ranges with the same pipeline, uniform and state are merged
+// into it, anything else recording into the overlay command buffer records the pending draw first
 struct UIModuleContext : public SharedObject<UIModuleContext> {
+    struct OverlayDraw {
+        OverlayDrawPipelineType pipelineType;
+        int drawID;
+        std::shared_ptr<vk::DeviceLocalBuffer> vertexBuffer;
+        VkDeviceSize vertexOffset;
+        std::shared_ptr<vk::Buffer> indexBuffer;
+        VkDeviceSize indexOffset;
+        VkIndexType indexType;
+        uint32_t indexCount;
+        bool quads; // indexed by the shared quad pattern, which keeps indexing the vertices that follow
+    };
+
     std::weak_ptr<FrameworkContext> frameworkContext;
     std::weak_ptr<UIModule> uiModule;
 
@@ -137,7 +167,14 @@ struct UIModuleContext : public SharedObject<UIModuleContext> {
     float overlayClearDepth;
     uint32_t overlayClearStencil;
 
+    OverlayStateTracker overlayState;
+
+    std::optional<OverlayDraw> pendingOverlayDraw;
+    std::optional<OverlayDrawPipelineType> overlayBoundPipeline;
+    OverlayDrawStats overlayDrawStats{};
+
     OverlayMode overlayMode;
+    uint32_t overlayZone = GpuProfiler::invalidZone;
 
     std::shared_ptr<vk::DescriptorTable> overlayDescriptorTable;
     std::shared_ptr<vk::DeviceLocalImage> overlayDrawColorImage;
@@ -149,8 +186,10 @@ struct UIModuleContext : public SharedObject<UIModuleContext> {
 
     UIModuleContext(std::shared_ptr<FrameworkContext> context, std::shared_ptr<UIModule> uiModule);
 
-    void syncToCommandBuffer();
     void syncFromContext(std::shared_ptr<UIModuleContext> other);
+    void markOverlayState(uint32_t state, bool changed);
+    uint32_t dirtyOverlayState();
+    void flushOverlayState();
 
     void setOverlayScissorEnabled(bool enabled);
     void setOverlayScissor(int x, int y, int width, int height);
@@ -196,10 +235,18 @@ struct UIModuleContext : public SharedObject<UIModuleContext> {
     void clearOverlayEntireDepthStencilAttachment(int aspectMask);
 
     void drawIndexed(std::shared_ptr<vk::DeviceLocalBuffer> vertexBuffer,
-                     std::shared_ptr<vk::DeviceLocalBuffer> indexBuffer,
+                     VkDeviceSize vertexOffset,
+                     std::shared_ptr<vk::Buffer> indexBuffer,
+                     VkDeviceSize indexOffset,
                      OverlayDrawPipelineType pipelineType,
                      uint32_t indexCount,
                      VkIndexType indexType);
+    void drawQuads(std::shared_ptr<vk::DeviceLocalBuffer> vertexBuffer,
+                   VkDeviceSize vertexOffset,
+                   OverlayDrawPipelineType pipelineType,
+                   uint32_t indexCount);
+    void queueOverlayDraw(const OverlayDraw &draw);
+    void flushOverlayDraw();
 
     void postBlur(int times = 1);
 
@@ -262,7 +262,7 @@ bool NrdWrapper::init(std::shared_ptr<vk::Device> device,
     }
 
     m_constantBuffer =
-        vk::DeviceLocalBuffer::create(m_vma, m_device, iDesc->constantBufferMaxDataSize,
+        vk::DeviceLocalBuffer::create(m_vma, m_device, false, iDesc->constantBufferMaxDataSize,
                                       VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
 
     if (!createSamplers()) return false;
@@ -447,7 +447,8 @@ void NrdWrapper::createPipelines() {
                                               {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0,
                                                VK_SHADER_STAGE_COMPUTE_BIT, shaderModule, "main", nullptr},
                                               nrdPipeline.pipelineLayout};
-        VK_CHECK(vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &cpInfo, nullptr, &nrdPipeline.pipeline));
+        VK_CHECK(vkCreateComputePipelines(device, m_device->vkPipelineCache(), 1, &cpInfo, nullptr,
+                                          &nrdPipeline.pipeline));
 #ifdef DEBUG
         std::cout << "[NRD] pipeline created " << nrdPipeline.pipeline << " idx=" << i
                   << " shader=" << pDesc.shaderIdentifier << std::endl;
@@ -529,9 +530,22 @@ void NrdWrapper::dispatch(VkCommandBuffer cmd, const nrd::DispatchDesc &dispatch
     }
 
     if (dispatchDesc.constantBufferDataSize > 0) {
-        m_constantBuffer->uploadToStagingBuffer((void *)dispatchDesc.constantBufferData,
-                                                dispatchDesc.constantBufferDataSize, 0);
-        m_constantBuffer->uploadToBuffer(cmd, dispatchDesc.constantBufferDataSize, 0, 0);
+        // every dispatch stages its own constants, the previous dispatch has to finish reading before the copy
+        auto staging = Renderer::instance().buffers()->stagingRing()->upload(dispatchDesc.constantBufferData,
+                                                                             dispatchDesc.constantBufferDataSize);
+        VkBufferMemoryBarrier readBarrier = {VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                                             nullptr,
+                                             VK_ACCESS_UNIFORM_READ_BIT,
+                                             VK_ACCESS_TRANSFER_WRITE_BIT,
+                                             VK_QUEUE_FAMILY_IGNORED,
+                                             VK_QUEUE_FAMILY_IGNORED,
+                                             m_constantBuffer->vkBuffer(),
+                                             0,
+                                             dispatchDesc.constantBufferDataSize};
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr,
+                             1, &readBarrier, 0, nullptr);
+        VkBufferCopy copyRegion = {staging.offset, 0, dispatchDesc.constantBufferDataSize};
+        vkCmdCopyBuffer(cmd, staging.buffer->vkBuffer(), m_constantBuffer->vkBuffer(), 1, &copyRegion);
         VkBufferMemoryBarrier barrier = {VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
                                          nullptr,
                                          VK_ACCESS_TRANSFER_WRITE_BIT,
@@ -294,15 +294,20 @@ void PostRenderModule::initBuffers() {
         verts.push_back(makeStarVertex(p0, color));
     }
 
-    starFieldVertexBuffer = vk::DeviceLocalBuffer::create(
-        vma, device, verts.size() * sizeof(vk::VertexFormat::PBRTriangle), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+    size_t vertexSize = verts.size() * sizeof(vk::VertexFormat::PBRTriangle);
+    starFieldVertexBuffer =
+        vk::DeviceLocalBuffer::create(vma, device, false, vertexSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
 
-    starFieldVertexBuffer->uploadToStagingBuffer(verts.data());
+    // only needed until the one time copy below finished
+    auto stagingBuffer = vk::HostVisibleBuffer::create(vma, device, vertexSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+    stagingBuffer->uploadToBuffer(verts.data());
 
     std::shared_ptr<vk::Fence> fence = vk::Fence::create(device);
     std::shared_ptr<vk::CommandBuffer> oneTimeBuffer = vk::CommandBuffer::create(device, framework->mainCommandPool());
     oneTimeBuffer->begin();
-    starFieldVertexBuffer->uploadToBuffer(oneTimeBuffer);
+    VkBufferCopy copyRegion = {0, 0, vertexSize};
+    vkCmdCopyBuffer(oneTimeBuffer->vkCommandBuffer(), stagingBuffer->vkBuffer(), starFieldVertexBuffer->vkBuffer(), 1,
+                    &copyRegion);
     oneTimeBuffer->end();
 
     VkSubmitInfo vkSubmitInfo = {};
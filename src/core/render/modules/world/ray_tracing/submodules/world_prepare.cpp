@@ -8,6 +8,7 @@
 #include "core/render/renderer.hpp"
 #include "core/render/world.hpp"
 
+#include <algorithm>
 #include <filesystem>
 #include <glm/gtc/type_ptr.hpp>
 
@@ -25,6 +26,23 @@ void WorldPrepare::build() {
 
     contexts_.resize(size);
 
+    // the new contexts start from an empty table, every chunk and entity is assigned a slot again
+    for (auto &blas : instanceBLASes_) { framework->gc().collect(blas); }
+    instances_.clear();
+    instanceBLASes_.clear();
+    blasOffsets_.clear();
+    lastObjToWorldMats_.clear();
+    geometryTypes_.clear();
+    vertexBufferAddrs_.clear();
+    indexBufferAddrs_.clear();
+    lastVertexBufferAddrs_.clear();
+    lastIndexBufferAddrs_.clear();
+    chunkSlots_.clear();
+    chunkGeneration_ = 0;
+    entitySlots_.clear();
+    // a context renders every size frames, it needs the rows of the frames in between
+    slots_ = std::make_unique<InstanceSlots>(size);
+
     for (int i = 0; i < size; i++) {
         contexts_[i] = WorldPrepareContext::create(framework->contexts()[i], shared_from_this());
     }
@@ -34,97 +52,287 @@ WorldPrepareContext::WorldPrepareContext(std::shared_ptr<FrameworkContext> frame
                                          std::shared_ptr<WorldPrepare> worldPrepare)
     : frameworkContext(frameworkContext), worldPrepare(worldPrepare) {}
 
-void WorldPrepareContext::uploadBuffer(std::vector<uint32_t> &blasOffsets,
-                                       std::vector<uint64_t> &vertexBufferAddrs,
-                                       std::vector<uint64_t> &indexBufferAddrs,
-                                       std::vector<uint64_t> &lastVertexBufferAddrs,
-                                       std::vector<uint64_t> &lastIndexBufferAddrs,
-                                       std::vector<glm::mat4> &lastObjToWorldMats) {
-    auto context = frameworkContext.lock();
-    auto framework = context->framework.lock();
-    auto vma = framework->vma();
-    auto device = framework->device();
-    auto physicalDevice = framework->physicalDevice();
-    auto mainQueueIndex = physicalDevice->mainQueueIndex();
-    auto cmdBuffer = context->worldCommandBuffer;
+// writes the rows of the slot table into this context's copy of them, only the changed rows unless the buffer had to
+// grow or the table lost track of what this context last received. the rows are sorted, consecutive ones share one
+// copy region
+template <typename T>
+static void uploadRows(std::shared_ptr<vk::DeviceLocalBuffer> &buffer,
+                       std::vector<T> &rows,
+                       const std::vector<uint32_t> &dirtyRows,
+                       bool all,
+                       vk::UploadBatch &batch) {
+    constexpr size_t minCapacity = 1024;
+    constexpr VkPipelineStageFlags2 dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT |
+                                                   VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR |
+                                                   VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR;
+
+    if (buffer == nullptr || buffer->size() < rows.size() * sizeof(T)) {
+        auto framework = Renderer::instance().framework();
+        size_t capacity = std::max(minCapacity, rows.size() + rows.size() / 2);
+        buffer = vk::DeviceLocalBuffer::create(
+            framework->vma(), framework->device(), false, capacity * sizeof(T),
+            VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
+                VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+        all = true;
+    }
+
+    auto stagingRing = Renderer::instance().buffers()->stagingRing();
+    if (all) {
+        if (rows.empty()) return;
+        auto staging = stagingRing->upload(rows.data(), rows.size() * sizeof(T));
+        batch.add(staging.buffer, staging.offset, buffer, 0, staging.size, dstStageMask);
+        return;
+    }
+    if (dirtyRows.empty()) return;
+
+    auto staging = stagingRing->allocate(dirtyRows.size() * sizeof(T));
+    T *mapped = static_cast<T *>(staging.mappedPtr);
+    for (size_t i = 0; i < dirtyRows.size(); i++) { mapped[i] = rows[dirtyRows[i]]; }
+    staging.flush();
+
+    for (size_t first = 0, last; first < dirtyRows.size(); first = last) {
+        for (last = first + 1; last < dirtyRows.size() && dirtyRows[last] == dirtyRows[last - 1] + 1; last++) {}
+        batch.add(staging.buffer, staging.offset + first * sizeof(T), buffer, dirtyRows[first] * sizeof(T),
+                  (last - first) * sizeof(T), dstStageMask);
+    }
+}
+
+static VkTransformMatrixKHR translation(glm::dvec3 position) {
+    return {
+        1, 0, 0, static_cast<float>(position.x), //
+        0, 1, 0, static_cast<float>(position.y), //
+        0, 0, 1, static_cast<float>(position.z), //
+    };
+}
+
+static glm::mat4 transformMat(VkTransformMatrixKHR &transform) {
+    return glm::transpose(glm::mat4(glm::make_vec4(transform.matrix[0]), //
+                                    glm::make_vec4(transform.matrix[1]), //
+                                    glm::make_vec4(transform.matrix[2]), //
+                                    glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)));
+}
+
+// hands out a slot for the geometry count, or keeps the given one and only moves its records when the count changed.
+// the rows are grown to the table
+uint32_t WorldPrepare::assignSlot(uint32_t slot, uint32_t geometryCount) {
+    uint32_t recordCount = geometryCount + 1; // shadow
+    if (slot == InstanceSlots::invalidSlot) {
+        slot = slots_->acquire(recordCount);
+    } else {
+        slots_->resize(slot, recordCount);
+    }
+
+    uint32_t instanceCount = slots_->instanceCount();
+    if (instances_.size() < instanceCount) {
+        instances_.resize(instanceCount, VkAccelerationStructureInstanceKHR{});
+        instanceBLASes_.resize(instanceCount);
+        blasOffsets_.resize(instanceCount, 0);
+        lastObjToWorldMats_.resize(instanceCount, glm::mat4(1.0f));
+    }
+    uint32_t recordCountAll = slots_->recordCount();
+    if (geometryTypes_.size() < recordCountAll) {
+        geometryTypes_.resize(recordCountAll, World::GeometryTypes::SHADOW);
+        vertexBufferAddrs_.resize(recordCountAll, 0);
+        indexBufferAddrs_.resize(recordCountAll, 0);
+        lastVertexBufferAddrs_.resize(recordCountAll, 0);
+        lastIndexBufferAddrs_.resize(recordCountAll, 0);
+    }
+
+    auto &entry = slots_->slot(slot);
+    blasOffsets_[slot] = entry.recordOffset + 1;
+    geometryTypes_[entry.recordOffset] = World::GeometryTypes::SHADOW;
+    return slot;
+}
+
+// the slot becomes an inactive instance, no BLAS is referenced by it anymore
+void WorldPrepare::releaseSlot(uint32_t slot) {
+    Renderer::instance().framework()->gc().collect(instanceBLASes_[slot]);
+    instanceBLASes_[slot] = nullptr;
+    instances_[slot] = VkAccelerationStructureInstanceKHR{};
+    slots_->release(slot);
+}
 
-    blasOffsetsBuffer = vk::DeviceLocalBuffer::create(
-        vma, device, blasOffsets.size() * sizeof(uint32_t),
-        VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
-            VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
-    blasOffsetsBuffer->uploadToStagingBuffer(blasOffsets.data());
-
-    vertexBufferAddr = vk::DeviceLocalBuffer::create(
-        vma, device, vertexBufferAddrs.size() * sizeof(uint64_t),
-        VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
-            VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
-    vertexBufferAddr->uploadToStagingBuffer(vertexBufferAddrs.data());
-
-    indexBufferAddr = vk::DeviceLocalBuffer::create(
-        vma, device, indexBufferAddrs.size() * sizeof(uint64_t),
-        VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
-            VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
-    indexBufferAddr->uploadToStagingBuffer(indexBufferAddrs.data());
-
-    lastVertexBufferAddr = vk::DeviceLocalBuffer::create(
-        vma, device, lastVertexBufferAddrs.size() * sizeof(uint64_t),
-        VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
-            VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
-    lastVertexBufferAddr->uploadToStagingBuffer(lastVertexBufferAddrs.data());
-
-    lastIndexBufferAddr = vk::DeviceLocalBuffer::create(
-        vma, device, lastIndexBufferAddrs.size() * sizeof(uint64_t),
-        VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
-            VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
-    lastIndexBufferAddr->uploadToStagingBuffer(lastIndexBufferAddrs.data());
-
-    lastObjToWorldMat = vk::DeviceLocalBuffer::create(
-        vma, device, lastObjToWorldMats.size() * sizeof(glm::mat4),
-        VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
-            VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
-    lastObjToWorldMat->uploadToStagingBuffer(lastObjToWorldMats.data());
-
-    std::vector<std::shared_ptr<vk::DeviceLocalBuffer>> rayTracingMetaData{{
-        blasOffsetsBuffer,
-        vertexBufferAddr,
-        indexBufferAddr,
-        lastVertexBufferAddr,
-        lastIndexBufferAddr,
-        lastObjToWorldMat,
-    }};
-
-    std::vector<vk::CommandBuffer::BufferMemoryBarrier> uploadPreBufferBarriers, uploadPostBufferBarriers;
-
-    for (auto buffer : rayTracingMetaData) {
-        if (buffer == nullptr) continue;
-        uploadPreBufferBarriers.push_back({
-            .srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-            .srcAccessMask = VK_ACCESS_2_MEMORY_READ_BIT,
-            .dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-            .dstAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT,
-            .srcQueueFamilyIndex = mainQueueIndex,
-            .dstQueueFamilyIndex = mainQueueIndex,
-            .buffer = buffer,
-        });
-        uploadPostBufferBarriers.push_back({
-            .srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-            .srcAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
-            .dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT |
-                            VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR |
-                            VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR,
-            .dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
-            .srcQueueFamilyIndex = mainQueueIndex,
-            .dstQueueFamilyIndex = mainQueueIndex,
-            .buffer = buffer,
-        });
+// a slot that gets another BLAS counts as a structural change, the TLAS is rebuilt instead of refit over it
+void WorldPrepare::setInstance(uint32_t slot,
+                               VkTransformMatrixKHR transform,
+                               uint32_t mask,
+                               VkGeometryInstanceFlagsKHR flags,
+                               std::shared_ptr<vk::BLAS> &blas) {
+    VkAccelerationStructureInstanceKHR &instance = instances_[slot];
+    bool structural = instanceBLASes_[slot] != blas || instance.mask != mask || instance.flags != flags ||
+                      instance.instanceShaderBindingTableRecordOffset != slots_->slot(slot).recordOffset;
+
+    instance.transform = transform;
+    instance.instanceCustomIndex = slot;
+    instance.mask = mask;
+    instance.instanceShaderBindingTableRecordOffset = slots_->slot(slot).recordOffset;
+    instance.flags = flags;
+    instance.accelerationStructureReference = blas->blasDeviceAddress();
+
+    if (instanceBLASes_[slot] != blas) {
+        Renderer::instance().framework()->gc().collect(instanceBLASes_[slot]);
+        instanceBLASes_[slot] = blas;
     }
+    slots_->markInstance(slot, structural);
+}
+
+// patches the slots of the chunks whose BLAS changed since the last frame. after a reset of the chunks every chunk is
+// taken once, the transforms of all chunk slots are only rewritten once the camera moved
+void WorldPrepare::updateChunkInstances(std::shared_ptr<Chunks> chunks, glm::dvec3 cameraPos) {
+    auto &chunk1s = chunks->chunks();
+    auto &changedChunks = chunks->changedChunks();
+
+    std::vector<int64_t> changed = changedChunks.popAll();
+    if (chunkGeneration_ != changedChunks.generation() || chunkSlots_.size() != chunk1s.size()) {
+        chunkGeneration_ = changedChunks.generation();
+        for (uint32_t slot : chunkSlots_) {
+            if (slot != InstanceSlots::invalidSlot) releaseSlot(slot);
+        }
+        chunkSlots_.assign(chunk1s.size(), InstanceSlots::invalidSlot);
 
-    cmdBuffer->barriersBufferImage(uploadPreBufferBarriers, {});
-    for (auto buffer : rayTracingMetaData) {
-        if (buffer == nullptr) continue;
-        buffer->uploadToBuffer(cmdBuffer);
+        changed.clear();
+        for (int64_t id = 0; id < chunk1s.size(); id++) { changed.push_back(id); }
+    }
+
+    for (int64_t id : changed) {
+        auto &chunk1 = chunk1s[id];
+        uint32_t &slot = chunkSlots_[id];
+        if (chunk1->blas == nullptr) {
+            if (slot != InstanceSlots::invalidSlot) releaseSlot(slot);
+            slot = InstanceSlots::invalidSlot;
+            continue;
+        }
+
+        slot = assignSlot(slot, chunk1->geometryCount);
+        VkTransformMatrixKHR transform = translation(glm::dvec3(chunk1->x, chunk1->y, chunk1->z) - cameraPos);
+        setInstance(slot, transform, 0x01, 0, chunk1->blas);
+        // fake, since chunk is not moving
+        lastObjToWorldMats_[slot] = transformMat(transform);
+
+        uint32_t recordOffset = slots_->slot(slot).recordOffset;
+        for (int j = 0; j < chunk1->geometryCount; j++) {
+            uint32_t record = recordOffset + 1 + j;
+            geometryTypes_[record] = (*chunk1->geometryTypes)[j];
+            vertexBufferAddrs_[record] = (*chunk1->vertexBufferAddresses)[j];
+            indexBufferAddrs_[record] = chunk1->quadIndexBuffer->bufferAddress();
+            lastVertexBufferAddrs_[record] = 0;
+            lastIndexBufferAddrs_[record] = 0;
+        }
+        slots_->markRecords(slot);
     }
-    cmdBuffer->barriersBufferImage(uploadPostBufferBarriers, {});
+
+    if (cameraPos == chunkCameraPos_) return;
+    chunkCameraPos_ = cameraPos;
+    for (int64_t id = 0; id < chunkSlots_.size(); id++) {
+        uint32_t slot = chunkSlots_[id];
+        if (slot == InstanceSlots::invalidSlot) continue;
+
+        auto &chunk1 = chunk1s[id];
+        VkTransformMatrixKHR transform = translation(glm::dvec3(chunk1->x, chunk1->y, chunk1->z) - cameraPos);
+        instances_[slot].transform = transform;
+        lastObjToWorldMats_[slot] = transformMat(transform);
+    }
+    slots_->markAllInstances();
+}
+
+// the entities are sent every frame, each keeps its slot while it is sent and gives it up the first frame it is not
+void WorldPrepare::updateEntityInstances(std::shared_ptr<Entities> entities, glm::dvec3 cameraPos) {
+    uint64_t frame = slots_->frame();
+    auto entityBatch = entities->entityBatch();
+
+    if (entityBatch != nullptr) {
+        auto worldUniformBuffer = Renderer::instance().buffers()->worldUniformBuffer();
+        auto ubo = static_cast<vk::Data::WorldUBO *>(worldUniformBuffer->mappedPtr());
+
+        std::unordered_map<int, uint32_t> repeats;
+        for (auto &entity : entityBatch->entities) {
+            VkGeometryInstanceFlagsKHR flags = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
+            // VkGeometryInstanceFlagsKHR flags = 0;
+            VkTransformMatrixKHR transform;
+
+            if (entity->prebuiltBLAS < 0) {
+                if (entity->coordinate == World::Coordinates::WORLD || !ubo) {
+                    transform = translation(glm::dvec3(entity->x, entity->y, entity->z) - cameraPos);
+                } else if (entity->coordinate == World::Coordinates::CAMERA) {
+                    glm::mat4 viewMat = glm::transpose(ubo->cameraViewMatInv); // column major to row major
+
+                    transform = {
+                        viewMat[0][0], viewMat[0][1], viewMat[0][2], viewMat[0][3], //
+                        viewMat[1][0], viewMat[1][1], viewMat[1][2], viewMat[1][3], //
+                        viewMat[2][0], viewMat[2][1], viewMat[2][2], viewMat[2][3], //
+                    };
+                } else if (entity->coordinate == World::Coordinates::CAMERA_SHIFT) {
+                    transform = translation(glm::dvec3(glm::vec3(ubo->cameraViewMatInv[3])));
+                }
+            } else {
+                // auto &prebuiltBLAS =
+                //     Renderer::instance().framework()->prebuiltBLASs()[entityRenderData->prebuiltBLAS];
+                // transform = prebuiltBLAS.align(*entityRenderData->vertices, *entityRenderData->indices);
+                throw std::runtime_error("prebuilt blas not implemented yet!");
+            }
+
+            uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(entity->hashCode)) << 32) |
+                           repeats[entity->hashCode]++;
+            auto [iter, inserted] = entitySlots_.try_emplace(key, EntitySlot{.slot = InstanceSlots::invalidSlot});
+            EntitySlot &entitySlot = iter->second;
+            // entities without a hash code have no previous render data
+            bool hasPrevious = !inserted && entity->hashCode != 0;
+
+            entitySlot.slot = assignSlot(entitySlot.slot, entity->geometryCount);
+            setInstance(entitySlot.slot, transform, entity->rtFlag, flags, entity->blas);
+            lastObjToWorldMats_[entitySlot.slot] = hasPrevious ? transformMat(entitySlot.transform) : glm::mat4(1.0f);
+
+            auto &previous = entitySlot.entity;
+            bool samePreviousGeometries = hasPrevious && previous->geometryCount == entity->geometryCount;
+            uint32_t recordOffset = slots_->slot(entitySlot.slot).recordOffset;
+            for (int j = 0; j < entity->geometryCount; j++) {
+                uint32_t record = recordOffset + 1 + j;
+                geometryTypes_[record] = (*entity->geometryTypes)[j];
+                vertexBufferAddrs_[record] = (*entity->vertexBufferAddresses)[j];
+                indexBufferAddrs_[record] = (*entity->indexBufferAddresses)[j];
+
+                if (samePreviousGeometries && (*previous->vertices)[j].size() == (*entity->vertices)[j].size() &&
+                    (*previous->indices)[j].size() == (*entity->indices)[j].size()) {
+                    lastVertexBufferAddrs_[record] = (*previous->vertexBufferAddresses)[j];
+                    lastIndexBufferAddrs_[record] = (*previous->indexBufferAddresses)[j];
+                } else {
+                    lastVertexBufferAddrs_[record] = 0;
+                    lastIndexBufferAddrs_[record] = 0;
+                }
+            }
+            slots_->markRecords(entitySlot.slot);
+
+            entitySlot.seenFrame = frame;
+            entitySlot.entity = entity;
+            entitySlot.transform = transform;
+        }
+    }
+
+    for (auto iter = entitySlots_.begin(); iter != entitySlots_.end();) {
+        if (iter->second.seenFrame == frame) {
+            ++iter;
+            continue;
+        }
+        releaseSlot(iter->second.slot);
+        iter = entitySlots_.erase(iter);
+    }
+}
+
+void WorldPrepareContext::uploadBuffer(InstanceSlots::Changes &changes) {
+    auto module = worldPrepare.lock();
+    auto context = frameworkContext.lock();
+    auto cmdBuffer = context->worldCommandBuffer;
+
+    vk::UploadBatch batch;
+    uploadRows(blasOffsetsBuffer, module->blasOffsets_, changes.instances, changes.allInstances, batch);
+    uploadRows(lastObjToWorldMat, module->lastObjToWorldMats_, changes.instances, changes.allInstances, batch);
+    uploadRows(vertexBufferAddr, module->vertexBufferAddrs_, changes.records, changes.full, batch);
+    uploadRows(indexBufferAddr, module->indexBufferAddrs_, changes.records, changes.full, batch);
+    uploadRows(lastVertexBufferAddr, module->lastVertexBufferAddrs_, changes.records, changes.full, batch);
+    uploadRows(lastIndexBufferAddr, module->lastIndexBufferAddrs_, changes.records, changes.full, batch);
+
+    batch.record(cmdBuffer);
 }
 
 void WorldPrepareContext::render() {
@@ -149,6 +357,8 @@ void WorldPrepareContext::render() {
             Renderer::instance().world()->chunks()->chunkBuildScheduler()->chunkBuildingBatchSize());
     }
 
+    if (chunks->chunkCompactor() != nullptr) { chunks->chunkCompactor()->tryCompact(chunks->frameCount()); }
+
     if (chunks->importantBLASBuilders().size() > 0) {
         vk::BLASBuilder::batchSubmit(chunks->importantBLASBuilders(), worldCommandBuffer);
     }
@@ -163,200 +373,27 @@ void WorldPrepareContext::render() {
         .dstAccessMask = VK_ACCESS_2_ACCELERATION_STRUCTURE_READ_BIT_KHR,
     }});
 
-    uint32_t blasAccu = 0, blasGroupAccu = 0;
-    std::vector<uint32_t> blasOffset;
-    std::vector<uint32_t> geometryTypes;
-    std::vector<uint64_t> vertexBufferAddrs, indexBufferAddrs;
-    std::vector<uint64_t> lastVertexBufferAddrs, lastIndexBufferAddrs;
-    std::vector<glm::mat4> lastObjToWorldMats;
-
-    tlasBuilder = vk::TLASBuilder::create();
-    auto &instanceBuilder = tlasBuilder->beginInstanceBuilder();
-    int blasIndex = 0;
-
-    // Entity
-    {
-        auto entityBatch = entities->entityBatch();
-
-        if (entityBatch != nullptr) {
-            static std::queue<std::map<int, std::pair<std::shared_ptr<Entity>, VkTransformMatrixKHR>>>
-                previousEntityRenderDataBatches;
-            static std::map<int, std::pair<std::shared_ptr<Entity>, VkTransformMatrixKHR>> emptyMap;
-
-            std::map<int, std::pair<std::shared_ptr<Entity>, VkTransformMatrixKHR>> &previousEntityRenderDataBatch =
-                previousEntityRenderDataBatches.empty() ? emptyMap : previousEntityRenderDataBatches.back();
-            if (previousEntityRenderDataBatches.size() > Renderer::instance().framework()->swapchain()->imageCount())
-                previousEntityRenderDataBatches.pop();
-            std::map<int, std::pair<std::shared_ptr<Entity>, VkTransformMatrixKHR>> &currentEntityRenderDataBatch =
-                previousEntityRenderDataBatches.emplace();
-
-            auto worldUniformBuffer = Renderer::instance().buffers()->worldUniformBuffer();
-            auto ubo = static_cast<vk::Data::WorldUBO *>(worldUniformBuffer->mappedPtr());
-
-            auto &entities1 = entityBatch->entities;
-            for (int i = 0; i < entities1.size(); i++) {
-                VkGeometryInstanceFlagsKHR flags = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
-                // VkGeometryInstanceFlagsKHR flags = 0;
-                VkTransformMatrixKHR transform;
-
-                if (entities1[i]->prebuiltBLAS < 0) {
-                    if (entities1[i]->coordinate == World::Coordinates::WORLD || !ubo) {
-                        transform = {
-                            1, 0, 0, static_cast<float>(entities1[i]->x - cameraPos.x), //
-                            0, 1, 0, static_cast<float>(entities1[i]->y - cameraPos.y), //
-                            0, 0, 1, static_cast<float>(entities1[i]->z - cameraPos.z), //
-                        };
-                    } else if (entities1[i]->coordinate == World::Coordinates::CAMERA) {
-                        glm::mat4 viewMat = glm::transpose(ubo->cameraViewMatInv); // column major to row major
-
-                        transform = {
-                            viewMat[0][0], viewMat[0][1], viewMat[0][2], viewMat[0][3], //
-                            viewMat[1][0], viewMat[1][1], viewMat[1][2], viewMat[1][3], //
-                            viewMat[2][0], viewMat[2][1], viewMat[2][2], viewMat[2][3], //
-                        };
-                    } else if (entities1[i]->coordinate == World::Coordinates::CAMERA_SHIFT) {
-                        glm::vec3 shift = glm::vec3(ubo->cameraViewMatInv[3]);
-                        transform = {
-                            1, 0, 0, shift.x, //
-                            0, 1, 0, shift.y, //
-                            0, 0, 1, shift.z, //
-                        };
-                    }
-
-                    instanceBuilder.defineInstance(transform, blasIndex, entities1[i]->rtFlag, blasGroupAccu, flags,
-                                                   entities1[i]->blas);
-                } else {
-                    // auto &prebuiltBLAS =
-                    //     Renderer::instance().framework()->prebuiltBLASs()[entityRenderData->prebuiltBLAS];
-                    // transform = prebuiltBLAS.align(*entityRenderData->vertices, *entityRenderData->indices);
-
-                    // instanceBuilder.defineInstance(transform, blasIndex, entityRenderData->rtFlag, blasGroupAccu,
-                    // flags,
-                    //                                prebuiltBLAS.blas);
-                    throw std::runtime_error("prebuilt blas not implemented yet!");
-                }
-
-                geometryTypes.push_back(World::GeometryTypes::SHADOW);
-                geometryTypes.insert(geometryTypes.end(), entities1[i]->geometryTypes->begin(),
-                                     entities1[i]->geometryTypes->end());
+    module->updateChunkInstances(chunks, cameraPos);
+    module->updateEntityInstances(entities, cameraPos);
 
-                for (int j = 0; j < entities1[i]->geometryCount; j++) {
-                    vertexBufferAddrs.push_back((*entities1[i]->vertexBufferAddresses)[j]);
-                    indexBufferAddrs.push_back((*entities1[i]->indexBufferAddresses)[j]);
-                }
-
-                // store current render data
-                {
-                    if (entities1[i]->hashCode) {
-                        currentEntityRenderDataBatch[entities1[i]->hashCode].first = entities1[i];
-                        currentEntityRenderDataBatch[entities1[i]->hashCode].second = transform;
-                    }
-                }
-
-                // read previous render data
-                {
-                    glm::mat4 lastObjToWorldMat(1);
-                    auto iter = previousEntityRenderDataBatch.find(entities1[i]->hashCode);
-                    if (iter != previousEntityRenderDataBatch.end()) {
-                        auto &previousEntityRenderData = (*iter).second.first;
-                        if (previousEntityRenderData->geometryCount == entities1[i]->geometryCount) {
-                            for (int j = 0; j < entities1[i]->geometryCount; j++) {
-                                if ((*previousEntityRenderData->vertices)[j].size() ==
-                                        (*entities1[i]->vertices)[j].size() &&
-                                    (*previousEntityRenderData->indices)[j].size() ==
-                                        (*entities1[i]->indices)[j].size()) {
-                                    lastVertexBufferAddrs.push_back(
-                                        (*previousEntityRenderData->vertexBufferAddresses)[j]);
-                                    lastIndexBufferAddrs.push_back(
-                                        (*previousEntityRenderData->indexBufferAddresses)[j]);
-                                } else {
-                                    lastVertexBufferAddrs.push_back(0);
-                                    lastIndexBufferAddrs.push_back(0);
-                                }
-                            }
-                        } else {
-                            for (int j = 0; j < entities1[i]->geometryCount; j++) {
-                                lastVertexBufferAddrs.push_back(0);
-                                lastIndexBufferAddrs.push_back(0);
-                            }
-                        }
-
-                        VkTransformMatrixKHR lastObjToWorldVkMat = iter->second.second;
-                        lastObjToWorldMat = glm::transpose(glm::mat4(glm::make_vec4(lastObjToWorldVkMat.matrix[0]), //
-                                                                     glm::make_vec4(lastObjToWorldVkMat.matrix[1]), //
-                                                                     glm::make_vec4(lastObjToWorldVkMat.matrix[2]), //
-                                                                     glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)));
-                    } else {
-                        for (int j = 0; j < entities1[i]->geometryCount; j++) {
-                            lastVertexBufferAddrs.push_back(0);
-                            lastIndexBufferAddrs.push_back(0);
-                        }
-                    }
-                    lastObjToWorldMats.push_back(lastObjToWorldMat);
-                }
-
-                blasOffset.push_back(blasAccu);
-                blasAccu += entities1[i]->geometryCount;
-                blasGroupAccu += entities1[i]->geometryCount + 1; // shadow
-
-                blasIndex++;
-            }
-        }
-    }
-
-    // Chunk
-    {
-        auto &chunk1s = chunks->chunks();
-        for (int i = 0; i < chunk1s.size(); i++) {
-            auto &chunk1 = chunk1s[i];
-            if (chunk1->blas == nullptr) continue;
-
-            VkTransformMatrixKHR transform = {
-                1, 0, 0, static_cast<float>(static_cast<double>(chunk1->x) - cameraPos.x), //
-                0, 1, 0, static_cast<float>(static_cast<double>(chunk1->y) - cameraPos.y), //
-                0, 0, 1, static_cast<float>(static_cast<double>(chunk1->z) - cameraPos.z), //
-            };
-
-            instanceBuilder.defineInstance(transform, blasIndex, 0x01, blasGroupAccu, 0, chunk1->blas);
-
-            geometryTypes.push_back(World::GeometryTypes::SHADOW);
-            geometryTypes.insert(geometryTypes.end(), chunk1->geometryTypes->begin(), chunk1->geometryTypes->end());
-
-            for (int j = 0; j < chunk1->geometryCount; j++) {
-                vertexBufferAddrs.push_back((*chunk1->vertexBuffers)[j]->bufferAddress());
-                indexBufferAddrs.push_back((*chunk1->indexBuffers)[j]->bufferAddress());
-                lastVertexBufferAddrs.push_back(0);
-                lastIndexBufferAddrs.push_back(0);
-            }
-
-            // read (fake, since chunk is not moving) previous render data
-            {
-                glm::mat4 lastObjToWorldMat = glm::transpose(glm::mat4(
-                    glm::vec4(1.0f, 0.0f, 0.0f, static_cast<float>(static_cast<double>(chunk1->x) - cameraPos.x)), //
-                    glm::vec4(0.0f, 1.0f, 0.0f, static_cast<float>(static_cast<double>(chunk1->y) - cameraPos.y)), //
-                    glm::vec4(0.0f, 0.0f, 1.0f, static_cast<float>(static_cast<double>(chunk1->z) - cameraPos.z)), //
-                    glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)));
-                lastObjToWorldMats.push_back(lastObjToWorldMat);
-            }
-
-            blasOffset.push_back(blasAccu);
-            blasAccu += chunk1->geometryCount;
-            blasGroupAccu += chunk1->geometryCount + 1; // shadow
-
-            blasIndex++;
-        }
-    }
-
-    if (instanceBuilder.instances.empty()) {
+    auto &slots = *module->slots_;
+    if (slots.usedCount() == 0) {
         tlas = nullptr;
+        slots.endFrame();
         return;
     }
 
-    tlas = instanceBuilder.endInstanceBuilder(device, vma)
-               ->defineBuildProperty(VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR)
-               ->querySizeInfo(device)
-               ->allocateBuffers(physicalDevice, device, vma)
-               ->buildAndSubmit(device, worldCommandBuffer);
+    if (persistentTLAS == nullptr) {
+        persistentTLAS = vk::PersistentTLAS::create(physicalDevice, device, vma,
+                                                    VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR);
+    }
+
+    // refit while every slot keeps its BLAS, rebuild after structural churn or too many refits in a row
+    auto changes = slots.changesSince(syncedFrame);
+    bool allowUpdate = !changes.structural && tlasUpdateCount < Renderer::options.tlasMaxUpdates;
+    persistentTLAS->uploadInstances(module->instances_, changes.instances, changes.allInstances);
+    tlas = persistentTLAS->buildAndSubmit(worldCommandBuffer, allowUpdate);
+    tlasUpdateCount = persistentTLAS->lastBuildUpdated() ? tlasUpdateCount + 1 : 0;
 
     worldCommandBuffer->barriersMemory({vk::CommandBuffer::MemoryBarrier{
         .srcStageMask = VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
@@ -365,8 +402,10 @@ void WorldPrepareContext::render() {
         .dstAccessMask = VK_ACCESS_2_ACCELERATION_STRUCTURE_READ_BIT_KHR,
     }});
 
-    rayTracingModuleContext.lock()->sbt->setupHitSBT(geometryTypes);
+    rayTracingModuleContext.lock()->sbt->setupHitSBT(module->geometryTypes_);
 
-    uploadBuffer(blasOffset, vertexBufferAddrs, indexBufferAddrs, lastVertexBufferAddrs, lastIndexBufferAddrs,
-                 lastObjToWorldMats);
-}
\ No newline at end of file
+    uploadBuffer(changes);
+
+    syncedFrame = slots.frame();
+    slots.endFrame();
+}
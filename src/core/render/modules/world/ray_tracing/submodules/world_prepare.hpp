@@ -3,12 +3,18 @@
 #include "common/shared.hpp"
 #include "common/singleton.hpp"
 #include "core/all_extern.hpp"
+#include "core/render/instance_slots.hpp"
 #include "core/vulkan/all_core_vulkan.hpp"
 
+#include <unordered_map>
+
 class Framework;
 class FrameworkContext;
 class RayTracingModule;
 struct RayTracingModuleContext;
+class Chunks;
+class Entities;
+struct Entity;
 
 struct WorldPrepareContext;
 
@@ -25,10 +31,46 @@ class WorldPrepare : public SharedObject<WorldPrepare> {
     void build();
 
   private:
+    struct EntitySlot {
+        uint32_t slot;
+        uint64_t seenFrame;
+        std::shared_ptr<Entity> entity; // render data of the frame it was last seen in, read by the motion vectors
+        VkTransformMatrixKHR transform;
+    };
+
+    void updateChunkInstances(std::shared_ptr<Chunks> chunks, glm::dvec3 cameraPos);
+    void updateEntityInstances(std::shared_ptr<Entities> entities, glm::dvec3 cameraPos);
+    uint32_t assignSlot(uint32_t slot, uint32_t geometryCount);
+    void releaseSlot(uint32_t slot);
+    void setInstance(uint32_t slot,
+                     VkTransformMatrixKHR transform,
+                     uint32_t mask,
+                     VkGeometryInstanceFlagsKHR flags,
+                     std::shared_ptr<vk::BLAS> &blas);
+
     std::weak_ptr<Framework> framework_;
     std::weak_ptr<RayTracingModule> rayTracingModule_;
 
     std::vector<std::shared_ptr<WorldPrepareContext>> contexts_;
+
+    // rows of every instance slot and geometry record, shared by the frame contexts. they are only written when a
+    // chunk BLAS is published, swapped or dropped, for the entities of the frame and for the chunk transforms once the
+    // camera moved. a free slot stays in the table as an inactive instance
+    std::unique_ptr<InstanceSlots> slots_;
+    std::vector<VkAccelerationStructureInstanceKHR> instances_;
+    std::vector<std::shared_ptr<vk::BLAS>> instanceBLASes_;
+    std::vector<uint32_t> blasOffsets_;
+    std::vector<glm::mat4> lastObjToWorldMats_;
+    std::vector<uint32_t> geometryTypes_; // hit group of every record, the shadow group first in each slot
+    std::vector<uint64_t> vertexBufferAddrs_;
+    std::vector<uint64_t> indexBufferAddrs_;
+    std::vector<uint64_t> lastVertexBufferAddrs_;
+    std::vector<uint64_t> lastIndexBufferAddrs_;
+
+    std::vector<uint32_t> chunkSlots_; // slot of every chunk id, InstanceSlots::invalidSlot without a BLAS
+    uint64_t chunkGeneration_ = 0;
+    glm::dvec3 chunkCameraPos_{0.0};
+    std::unordered_map<uint64_t, EntitySlot> entitySlots_; // keyed on the hash code and its repeat in the frame
 };
 
 struct WorldPrepareContext : public SharedObject<WorldPrepareContext> {
@@ -36,8 +78,12 @@ struct WorldPrepareContext : public SharedObject<WorldPrepareContext> {
     std::weak_ptr<RayTracingModuleContext> rayTracingModuleContext;
     std::weak_ptr<WorldPrepare> worldPrepare;
 
+    // the TLAS and the metadata buffers persist across the frames of this context, they are only written once the
+    // previous frame of this context has finished, with the rows that changed since then
     std::shared_ptr<vk::TLAS> tlas;
-    std::shared_ptr<vk::TLASBuilder> tlasBuilder;
+    std::shared_ptr<vk::PersistentTLAS> persistentTLAS;
+    uint64_t syncedFrame = 0; // frame of the slot table this context last wrote its copies in
+    uint32_t tlasUpdateCount = 0;
 
     std::shared_ptr<vk::DeviceLocalBuffer> blasOffsetsBuffer;
     std::shared_ptr<vk::DeviceLocalBuffer> vertexBufferAddr;
@@ -48,11 +94,6 @@ struct WorldPrepareContext : public SharedObject<WorldPrepareContext> {
 
     WorldPrepareContext(std::shared_ptr<FrameworkContext> frameworkContext, std::shared_ptr<WorldPrepare> worldprepare);
 
-    void uploadBuffer(std::vector<uint32_t> &blasOffsets,
-                      std::vector<uint64_t> &vertexBufferAddrs,
-                      std::vector<uint64_t> &indexBufferAddrs,
-                      std::vector<uint64_t> &lastVertexBufferAddrs,
-                      std::vector<uint64_t> &lastIndexBufferAddrs,
-                      std::vector<glm::mat4> &lastObjToWorldMats);
+    void uploadBuffer(InstanceSlots::Changes &changes);
     void render();
-};
\ No newline at end of file
+};
@@ -1,5 +1,8 @@
 #include "blue_noise.hpp"
 
+#include "core/render/render_framework.hpp"
+#include "core/render/renderer.hpp"
+
 #include <iostream>
 
 // Include the FFX blue noise data
@@ -17,27 +20,31 @@ BlueNoise::BlueNoise(std::shared_ptr<vk::Device> device, std::shared_ptr<vk::VMA
 
     // Create Sobol buffer (256*256 uint32 = 256KB)
     m_sobolBuffer = vk::DeviceLocalBuffer::create(
-        vma, device, SOBOL_SIZE * sizeof(uint32_t),
+        vma, device, false, SOBOL_SIZE * sizeof(uint32_t),
         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT);
 
-    // Upload Sobol data - convert from int to uint32_t
-    std::vector<uint32_t> sobolData(SOBOL_SIZE);
+    // Upload Sobol data - convert from int to uint32_t, staged until the copy is recorded
+    m_sobolStaging =
+        vk::HostVisibleBuffer::create(vma, device, SOBOL_SIZE * sizeof(uint32_t), VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+    uint32_t *sobolData = static_cast<uint32_t *>(m_sobolStaging->mappedPtr());
     for (size_t i = 0; i < SOBOL_SIZE; i++) {
         sobolData[i] = static_cast<uint32_t>(sobol_256spp_256d[i]);
     }
-    m_sobolBuffer->uploadToStagingBuffer(sobolData.data());
+    m_sobolStaging->flush();
 
     // Create scrambling tile buffer (128*128*8 uint32 = 512KB)
     m_scramblingBuffer = vk::DeviceLocalBuffer::create(
-        vma, device, SCRAMBLING_SIZE * sizeof(uint32_t),
+        vma, device, false, SCRAMBLING_SIZE * sizeof(uint32_t),
         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT);
 
-    // Upload scrambling data - convert from int to uint32_t
-    std::vector<uint32_t> scramblingData(SCRAMBLING_SIZE);
+    // Upload scrambling data - convert from int to uint32_t, staged until the copy is recorded
+    m_scramblingStaging = vk::HostVisibleBuffer::create(vma, device, SCRAMBLING_SIZE * sizeof(uint32_t),
+                                                        VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+    uint32_t *scramblingData = static_cast<uint32_t *>(m_scramblingStaging->mappedPtr());
     for (size_t i = 0; i < SCRAMBLING_SIZE; i++) {
         scramblingData[i] = static_cast<uint32_t>(scramblingTile[i]);
     }
-    m_scramblingBuffer->uploadToStagingBuffer(scramblingData.data());
+    m_scramblingStaging->flush();
 
     blueNoiseCout() << "Blue noise buffers created: Sobol(" << SOBOL_SIZE * sizeof(uint32_t) / 1024
                     << "KB), Scrambling(" << SCRAMBLING_SIZE * sizeof(uint32_t) / 1024 << "KB)" << std::endl;
@@ -51,7 +58,20 @@ std::shared_ptr<vk::DeviceLocalBuffer> BlueNoise::scramblingBuffer() {
     return m_scramblingBuffer;
 }
 
+// the tables never change, the staging buffers are released once the frame recording the copies completed
 void BlueNoise::uploadToBuffer(std::shared_ptr<vk::CommandBuffer> cmdBuffer) {
-    m_sobolBuffer->uploadToBuffer(cmdBuffer);
-    m_scramblingBuffer->uploadToBuffer(cmdBuffer);
+    if (m_sobolStaging == nullptr) return;
+
+    VkBufferCopy sobolRegion = {0, 0, SOBOL_SIZE * sizeof(uint32_t)};
+    vkCmdCopyBuffer(cmdBuffer->vkCommandBuffer(), m_sobolStaging->vkBuffer(), m_sobolBuffer->vkBuffer(), 1,
+                    &sobolRegion);
+    VkBufferCopy scramblingRegion = {0, 0, SCRAMBLING_SIZE * sizeof(uint32_t)};
+    vkCmdCopyBuffer(cmdBuffer->vkCommandBuffer(), m_scramblingStaging->vkBuffer(), m_scramblingBuffer->vkBuffer(), 1,
+                    &scramblingRegion);
+
+    auto &gc = Renderer::instance().framework()->gc();
+    gc.collect(m_sobolStaging);
+    gc.collect(m_scramblingStaging);
+    m_sobolStaging = nullptr;
+    m_scramblingStaging = nullptr;
 }
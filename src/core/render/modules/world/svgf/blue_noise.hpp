@@ -23,4 +23,6 @@ class BlueNoise : public SharedObject<BlueNoise> {
   private:
     std::shared_ptr<vk::DeviceLocalBuffer> m_sobolBuffer;
     std::shared_ptr<vk::DeviceLocalBuffer> m_scramblingBuffer;
+    std::shared_ptr<vk::HostVisibleBuffer> m_sobolStaging;
+    std::shared_ptr<vk::HostVisibleBuffer> m_scramblingStaging;
 };
@@ -75,6 +75,7 @@ void WorldPipeline::init(std::shared_ptr<Framework> framework, std::shared_ptr<P
     uint32_t frameNum = framework->swapchain()->imageCount();
 
     worldModules_.resize(blueprint->moduleNames_.size());
+    worldModuleNames_ = blueprint->moduleNames_;
     sharedImages_.resize(frameNum,
                          std::vector<std::shared_ptr<vk::DeviceLocalImage>>(blueprint->imageFormats_.size(), nullptr));
     contexts_.resize(frameNum);
@@ -203,7 +204,8 @@ WorldPipelineContext::WorldPipelineContext(std::shared_ptr<FrameworkContext> fra
                                            std::shared_ptr<WorldPipeline> worldPipeline)
     : frameworkContext(frameworkContext),
       worldPipeline(worldPipeline),
-      outputImage(worldPipeline->sharedImages_[frameworkContext->frameIndex][0]) {
+      outputImage(worldPipeline->sharedImages_[frameworkContext->frameIndex][0]),
+      worldModuleNames(worldPipeline->worldModuleNames_) {
     auto &worldModules = worldPipeline->worldModules();
     for (int i = 0; i < worldModules.size(); i++) {
         worldModuleContexts.push_back(worldModules[i]->contexts()[frameworkContext->frameIndex]);
@@ -251,7 +253,11 @@ void WorldPipelineContext::render() {
         outputImage->imageLayout() = targetLayout;
     }
 
-    for (int i = 0; i < worldModuleContexts.size(); i++) { worldModuleContexts[i]->render(); }
+    auto profilerQueries = framework->gpuProfiler()->frameQueries(context->frameIndex);
+    for (int i = 0; i < worldModuleContexts.size(); i++) {
+        GpuZone zone(profilerQueries, worldCommandBuffer, worldModuleNames[i]);
+        worldModuleContexts[i]->render();
+    }
 
     worldCommandBuffer->barriersBufferImage(
         {}, {{
@@ -382,6 +388,7 @@ Pipeline::~Pipeline() {
 
 void Pipeline::init(std::shared_ptr<Framework> framework) {
     framework_ = framework;
+    vk::ShaderCache::prefetch(Renderer::folderPath / "shaders");
     uiModule_ = UIModule::create(framework);
     contexts_ = std::make_shared<std::vector<std::shared_ptr<PipelineContext>>>();
 
@@ -401,6 +408,9 @@ void Pipeline::buildWorldPipelineBlueprint(WorldPipelineBuildParams *params) {
 void Pipeline::recreate(std::shared_ptr<Framework> framework) {
     auto &gc = framework->gc();
 
+    // only rereads the shaders that changed on disk since the last build
+    vk::ShaderCache::prefetch(Renderer::folderPath / "shaders");
+
     gc.collect(uiModule_);
     uiModule_ = UIModule::create(framework);
 
@@ -409,6 +419,8 @@ void Pipeline::recreate(std::shared_ptr<Framework> framework) {
     gc.collect(worldPipeline_);
     worldPipeline_ =
         worldPipelineBlueprint_ == nullptr ? nullptr : WorldPipeline::create(framework, shared_from_this());
+    // the world modules compile their pipelines once java hands over the blueprint, well after the startup save
+    if (worldPipeline_ != nullptr) framework->device()->savePipelineCache();
 
     gc.collect(contexts_);
     contexts_ = std::make_shared<std::vector<std::shared_ptr<PipelineContext>>>();
@@ -470,6 +482,8 @@ void PipelineContext::fuseWorld() {
 
     auto mainQueueIndex = framework->physicalDevice()->mainQueueIndex();
     auto overlayCommandBuffer = context->overlayCommandBuffer;
+    auto profilerQueries = framework->gpuProfiler()->frameQueries(context->frameIndex);
+    uint32_t fuseZone = GpuProfiler::beginZone(profilerQueries, overlayCommandBuffer, "fuse_world");
 
     overlayCommandBuffer->barriersBufferImage(
         {}, {
@@ -573,4 +587,8 @@ void PipelineContext::fuseWorld() {
 #else
     worldPipelineContext->outputImage->imageLayout() = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 #endif
+
+    // the overlay keeps drawing on top of the fused world until the final end
+    GpuProfiler::endZone(profilerQueries, overlayCommandBuffer, fuseZone);
+    uiModuleContext->overlayZone = GpuProfiler::beginZone(profilerQueries, overlayCommandBuffer, "overlay");
 }
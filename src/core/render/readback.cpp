@@ -0,0 +1,222 @@
+#include "core/render/readback.hpp"
+
+#include "core/render/pipeline.hpp"
+#include "core/render/render_framework.hpp"
+
+#include <cstring>
+#include <iostream>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+std::ostream &readbackCout() {
+    return std::cout << "[Readback] ";
+}
+
+std::ostream &readbackCerr() {
+    return std::cerr << "[Readback] ";
+}
+
+Readback::Readback(std::shared_ptr<Framework> framework)
+    : framework_(framework), encoder_(&Readback::encodeLoop, this) {}
+
+Readback::~Readback() {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    encodeCondition_.notify_all();
+    if (encoder_.joinable()) encoder_.join();
+}
+
+int64_t Readback::request(bool withUI, int width, int height, int channel) {
+    if (width <= 0 || height <= 0 || channel <= 0) return 0;
+    return enqueue(Request{
+        .withUI = withUI,
+        .size = static_cast<uint64_t>(width) * height * channel,
+    });
+}
+
+int64_t Readback::requestFile(bool withUI, const std::filesystem::path &file) {
+    return enqueue(Request{
+        .withUI = withUI,
+        .size = 0,
+        .file = file,
+    });
+}
+
+int64_t Readback::enqueue(Request request) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    request.id = nextId_++;
+    queued_.push_back(std::move(request));
+    return queued_.back().id;
+}
+
+void Readback::record(std::shared_ptr<FrameworkContext> context) {
+    auto framework = framework_.lock();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    retire();
+    if (queued_.empty()) return;
+
+    auto pipelineContext = framework->pipeline()->acquirePipelineContext(context);
+    auto cmdBuffer = context->fuseCommandBuffer;
+    auto mainQueueIndex = context->physicalDevice->mainQueueIndex();
+    uint64_t timelineValue = context->frameValue;
+
+    for (auto &request : queued_) {
+        std::shared_ptr<vk::DeviceLocalImage> srcImage;
+        if (request.withUI) {
+            srcImage = pipelineContext->uiModuleContext->overlayDrawColorImage;
+        } else if (pipelineContext->worldPipelineContext != nullptr) {
+            srcImage = pipelineContext->worldPipelineContext->outputImage;
+        }
+        request.timelineValue = timelineValue;
+
+        uint64_t imageSize =
+            srcImage == nullptr ? 0 : srcImage->width() * srcImage->height() * vk::formatToByte(srcImage->vkFormat());
+        if (imageSize == 0 || (request.size != 0 && request.size != imageSize)) {
+            inFlight_.push_back(std::move(request));
+            continue;
+        }
+
+        request.width = srcImage->width();
+        request.height = srcImage->height();
+        request.format = srcImage->vkFormat();
+        request.buffer = acquireBuffer(imageSize);
+
+        VkImageLayout initialLayout = srcImage->imageLayout();
+        cmdBuffer->barriersBufferImage(
+            {}, {{
+                    .srcStageMask = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT |
+                                    VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR |
+                                    VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                    .srcAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
+                    .dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                    .dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
+                    .oldLayout = initialLayout,
+                    .newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                    .srcQueueFamilyIndex = mainQueueIndex,
+                    .dstQueueFamilyIndex = mainQueueIndex,
+                    .image = srcImage,
+                    .subresourceRange = vk::wholeColorSubresourceRange,
+                }});
+
+        VkBufferImageCopy bufferImageCopy{};
+        bufferImageCopy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        bufferImageCopy.imageSubresource.mipLevel = 0;
+        bufferImageCopy.imageSubresource.baseArrayLayer = 0;
+        bufferImageCopy.imageSubresource.layerCount = 1;
+        bufferImageCopy.imageExtent.width = srcImage->width();
+        bufferImageCopy.imageExtent.height = srcImage->height();
+        bufferImageCopy.imageExtent.depth = 1;
+        vkCmdCopyImageToBuffer(cmdBuffer->vkCommandBuffer(), srcImage->vkImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                               request.buffer->vkBuffer(), 1, &bufferImageCopy);
+
+        cmdBuffer->barriersBufferImage(
+            {}, {{
+                    .srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                    .srcAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
+                    .dstStageMask = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT |
+                                    VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR |
+                                    VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                    .dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
+                    .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                    .newLayout = initialLayout,
+                    .srcQueueFamilyIndex = mainQueueIndex,
+                    .dstQueueFamilyIndex = mainQueueIndex,
+                    .image = srcImage,
+                    .subresourceRange = vk::wholeColorSubresourceRange,
+                }});
+
+        inFlight_.push_back(std::move(request));
+    }
+    queued_.clear();
+}
+
+int64_t Readback::poll(void *dstPointer) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    retire();
+    if (completed_.empty()) return 0;
+
+    Request request = std::move(completed_.front());
+    completed_.pop_front();
+    if (request.buffer == nullptr) return -request.id;
+
+    request.buffer->downloadFromBuffer();
+    std::memcpy(dstPointer, request.buffer->mappedPtr(), request.size);
+    releaseBuffer(request.buffer);
+    return request.id;
+}
+
+// requests complete in submission order, so retiring stops at the first one the main timeline has not reached
+void Readback::retire() {
+    auto framework = framework_.lock();
+    if (inFlight_.empty()) return;
+
+    uint64_t completed = framework->mainTimeline()->completed();
+    while (!inFlight_.empty() && inFlight_.front().timelineValue <= completed) {
+        Request &request = inFlight_.front();
+        if (request.file.empty()) {
+            completed_.push_back(std::move(request));
+        } else if (request.buffer != nullptr) {
+            encoding_.push_back(std::move(request));
+            encodeCondition_.notify_one();
+        } else {
+            readbackCerr() << "cannot read back the image for " << request.file << std::endl;
+        }
+        inFlight_.pop_front();
+    }
+}
+
+std::shared_ptr<vk::HostVisibleBuffer> Readback::acquireBuffer(uint64_t size) {
+    for (auto it = freeBuffers_.begin(); it != freeBuffers_.end(); it++) {
+        if ((*it)->size() != size) continue;
+        auto buffer = *it;
+        freeBuffers_.erase(it);
+        return buffer;
+    }
+
+    auto framework = framework_.lock();
+    return vk::HostVisibleBuffer::create(framework->vma(), framework->device(), size, VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+}
+
+void Readback::releaseBuffer(std::shared_ptr<vk::HostVisibleBuffer> buffer) {
+    if (freeBuffers_.size() >= maxPooledBuffers) freeBuffers_.erase(freeBuffers_.begin());
+    freeBuffers_.push_back(buffer);
+}
+
+void Readback::encodeLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        encodeCondition_.wait(lock, [this] { return stopping_ || !encoding_.empty(); });
+        if (encoding_.empty()) return;
+
+        Request request = std::move(encoding_.front());
+        encoding_.pop_front();
+        lock.unlock();
+
+        bool bgra = request.format == VK_FORMAT_B8G8R8A8_UNORM || request.format == VK_FORMAT_B8G8R8A8_SRGB;
+        bool rgba = request.format == VK_FORMAT_R8G8B8A8_UNORM || request.format == VK_FORMAT_R8G8B8A8_SRGB;
+        if (rgba || bgra) {
+            request.buffer->downloadFromBuffer();
+            uint8_t *pixels = static_cast<uint8_t *>(request.buffer->mappedPtr());
+            std::vector<uint8_t> swizzled;
+            if (bgra) {
+                swizzled.assign(pixels, pixels + request.buffer->size());
+                for (size_t i = 0; i + 3 < swizzled.size(); i += 4) std::swap(swizzled[i], swizzled[i + 2]);
+                pixels = swizzled.data();
+            }
+
+            if (stbi_write_png(request.file.string().c_str(), request.width, request.height, 4, pixels,
+                               request.width * 4) == 0) {
+                readbackCerr() << "cannot write " << request.file << std::endl;
+            }
+        } else {
+            readbackCerr() << "cannot encode format " << request.format << " into " << request.file << std::endl;
+        }
+
+        lock.lock();
+        releaseBuffer(request.buffer);
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "core/all_extern.hpp"
+#include "core/vulkan/all_core_vulkan.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Framework;
+struct FrameworkContext;
+
+// copies of the final frame images into host memory without stalling the render thread. a request is recorded into
+// the fuse command buffer of the next submitted frame, completes with the main timeline value of that frame and is then
+// either handed out by poll or encoded into a png on the encoder thread. the readback buffers are pooled
+class Readback : public SharedObject<Readback> {
+  public:
+    static constexpr uint32_t maxPooledBuffers = 4;
+
+    Readback(std::shared_ptr<Framework> framework);
+    ~Readback();
+
+    // the pixels are polled later into a destination of width * height * channel bytes, the request is dropped when
+    // the image does not have that size, returns 0 for an invalid size
+    int64_t request(bool withUI, int width, int height, int channel);
+    // the pixels are written into a png file instead of being polled, for 8 bit rgba and bgra images
+    int64_t requestFile(bool withUI, const std::filesystem::path &file);
+
+    // called once per frame after the fuse, records the copies of the queued requests
+    void record(std::shared_ptr<FrameworkContext> context);
+    // copies the oldest completed request into dstPointer and returns its id, -id when it was dropped and nothing was
+    // copied, 0 when no request completed yet
+    int64_t poll(void *dstPointer);
+
+  private:
+    struct Request {
+        int64_t id;
+        bool withUI;
+        uint64_t size; // expected byte size, 0 for file requests which take the image as it is
+        std::filesystem::path file;
+
+        uint32_t width = 0;
+        uint32_t height = 0;
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        std::shared_ptr<vk::HostVisibleBuffer> buffer; // nullptr for dropped requests
+        uint64_t timelineValue = 0;
+    };
+
+    int64_t enqueue(Request request);
+    void retire();
+    std::shared_ptr<vk::HostVisibleBuffer> acquireBuffer(uint64_t size);
+    void releaseBuffer(std::shared_ptr<vk::HostVisibleBuffer> buffer);
+    void encodeLoop();
+
+    std::weak_ptr<Framework> framework_;
+
+    std::deque<Request> queued_;   // waiting for the next recorded frame
+    std::deque<Request> inFlight_; // in submission order
+    std::deque<Request> completed_;
+    std::deque<Request> encoding_;
+    std::vector<std::shared_ptr<vk::HostVisibleBuffer>> freeBuffers_;
+    int64_t nextId_ = 1;
+    std::mutex mutex_;
+
+    std::condition_variable encodeCondition_;
+    bool stopping_ = false;
+    std::thread encoder_; // last, it starts running in the constructor
+};
@@ -10,6 +10,7 @@
 #include "core/render/textures.hpp"
 #include "core/render/world.hpp"
 
+#include <chrono>
 #include <iostream>
 #include <random>
 
@@ -33,7 +34,6 @@ FrameworkContext::FrameworkContext(std::shared_ptr<Framework> framework, uint32_
       swapchainImage(framework->swapchain_->swapchainImages()[frameIndex]),
       commandPool(framework->mainCommandPool_),
       commandProcessedSemaphore(framework->commandProcessedSemaphores_[frameIndex]),
-      commandFinishedFence(framework->commandFinishedFences_[frameIndex]),
       uploadCommandBuffer(framework->uploadCommandBuffers_[frameIndex]),
       overlayCommandBuffer(framework->overlayCommandBuffers_[frameIndex]),
       worldCommandBuffer(framework->worldCommandBuffers_[frameIndex]),
@@ -53,6 +53,8 @@ void FrameworkContext::fuseFinal() {
     auto mainQueueIndex = physicalDevice->mainQueueIndex();
     auto pipelineContext = f->pipeline_->acquirePipelineContext(shared_from_this());
 
+    GpuZone zone(f->gpuProfiler_->frameQueries(frameIndex), fuseCommandBuffer, "fuse");
+
     fuseCommandBuffer->barriersBufferImage(
         {}, {
                 {
@@ -144,18 +146,46 @@ void FrameworkContext::fuseFinal() {
     swapchainImage->imageLayout() = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 }
 
+VkResult SwapchainPresentSink::present(std::shared_ptr<FrameworkContext> context) {
+    VkPresentInfoKHR presentInfo = {};
+    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+    presentInfo.waitSemaphoreCount = 1;
+    presentInfo.pWaitSemaphores = &context->commandProcessedSemaphore->vkSemaphore();
+
+    presentInfo.swapchainCount = 1;
+    presentInfo.pSwapchains = &context->swapchain->vkSwapchain();
+    presentInfo.pImageIndices = &context->frameIndex;
+
+    return vkQueuePresentKHR(context->device->mainVkQueue(), &presentInfo);
+}
+
 Framework::Framework() {}
 
 void Framework::init(GLFWwindow *window) {
     instance_ = vk::Instance::create();
     window_ = vk::Window::create(instance_, window);
+    initResources();
+}
+
+void Framework::init(uint32_t width, uint32_t height) {
+    instance_ = vk::Instance::create(true);
+    window_ = vk::Window::create(instance_, VkExtent2D{width, height});
+    initResources();
+}
+
+void Framework::initResources() {
     physicalDevice_ = vk::PhysicalDevice::create(instance_, window_);
     device_ = vk::Device::create(instance_, window_, physicalDevice_);
+    device_->loadPipelineCache(Renderer::folderPath / "pipeline_cache.bin");
     vma_ = vk::VMA::create(instance_, physicalDevice_, device_);
     swapchain_ = vk::Swapchain::create(physicalDevice_, device_, window_);
     mainCommandPool_ = vk::CommandPool::create(physicalDevice_, device_);
     asyncCommandPool_ = vk::CommandPool::create(physicalDevice_, device_, physicalDevice_->secondaryQueueIndex());
+    mainTimeline_ = vk::TimelineSemaphore::create(device_);
+    secondaryTimeline_ = vk::TimelineSemaphore::create(device_);
     gc_ = GarbageCollector::create(shared_from_this());
+    gpuProfiler_ = GpuProfiler::create(physicalDevice_, device_);
+    presentSink_ = SwapchainPresentSink::create();
 
     uint32_t imageCount = swapchain_->imageCount();
 
@@ -166,15 +196,21 @@ void Framework::init(GLFWwindow *window) {
         worldCommandBuffers_.emplace_back(vk::CommandBuffer::create(device_, mainCommandPool_));
         fuseCommandBuffers_.emplace_back(vk::CommandBuffer::create(device_, mainCommandPool_));
     }
-    worldAsyncCommandBuffer_ = vk::CommandBuffer::create(device_, asyncCommandPool_);
-
-    for (int i = 0; i < imageCount; i++) { commandFinishedFences_.push_back(vk::Fence::create(device_, true)); }
 
     for (int i = 0; i < imageCount; i++) { commandProcessedSemaphores_.push_back(vk::Semaphore::create(device_)); }
 
     for (int i = 0; i < imageCount; i++) { contexts_.push_back(FrameworkContext::create(shared_from_this(), i)); }
 
+#ifdef DEBUG
+    auto pipelineStart = std::chrono::steady_clock::now();
+#endif
     pipeline_ = Pipeline::create(shared_from_this());
+    readback_ = Readback::create(shared_from_this());
+#ifdef DEBUG
+    auto pipelineTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - pipelineStart);
+    std::cout << "[Framework] pipelines created in " << pipelineTime.count() << " ms" << std::endl;
+#endif
+    device_->savePipelineCache();
 }
 
 Framework::~Framework() {
@@ -205,15 +241,22 @@ void Framework::acquireContext() {
         exit(EXIT_FAILURE);
     }
 
-    std::shared_ptr<vk::Fence> fence = contexts_[imageIndex]->commandFinishedFence;
-    result = vkWaitForFences(device_->vkDevice(), 1, &fence->vkFence(), true, UINT64_MAX);
-    if (result != VK_SUCCESS) {
-        std::cout << "vkWaitForFences failed with error: " << std::dec << result << std::endl;
+    if (!mainTimeline_->wait(contexts_[imageIndex]->submittedValue)) {
+        std::cout << "vkWaitSemaphores failed for frame " << contexts_[imageIndex]->submittedValue << std::endl;
         waitDeviceIdle();
         exit(EXIT_FAILURE);
     }
+    auto acquireTime = std::chrono::steady_clock::now();
+    if (lastAcquireTime_.time_since_epoch().count() > 0) {
+        double sample = std::chrono::duration<double, std::milli>(acquireTime - lastAcquireTime_).count();
+        frameTimeMs_ = frameTimeMs_ == 0.0 ? sample : frameTimeMs_ * 0.9 + sample * 0.1;
+    }
+    lastAcquireTime_ = acquireTime;
+
     currentContextIndex_ = imageIndex;
     currentContext_ = contexts_[imageIndex];
+    // only frame submissions signal the main timeline, so the value this frame signals is known from here on
+    currentContext_->frameValue = mainTimeline_->submitted() + 1;
     indexHistory_.push(imageIndex);
     if (indexHistory_.size() > swapchain_->imageCount()) indexHistory_.pop();
 
@@ -228,6 +271,8 @@ void Framework::acquireContext() {
     currentContext_->overlayCommandBuffer->begin();
     currentContext_->fuseCommandBuffer->begin();
 
+    gpuProfiler_->beginFrame(currentContext_->frameIndex, currentContext_->uploadCommandBuffer);
+
     auto pipelineContext = pipeline_->acquirePipelineContext(currentContext_);
     std::shared_ptr<UIModuleContext> lastUIContext =
         lastContext == nullptr ? nullptr : pipeline_->acquirePipelineContext(lastContext)->uiModuleContext;
@@ -273,6 +318,8 @@ void Framework::submitCommand() {
     pipelineContext->uiModuleContext->end();
 
     currentContext_->fuseFinal();
+    readback_->record(currentContext_);
+    gpuProfiler_->endFrame(currentContext_->frameIndex, currentContext_->fuseCommandBuffer);
 
     currentContext_->uploadCommandBuffer->end();
     currentContext_->worldCommandBuffer->end();
@@ -281,7 +328,21 @@ void Framework::submitCommand() {
 
     std::vector<VkSemaphore> waitSemaphores = {currentContext_->imageAcquiredSemaphore->vkSemaphore()};
     std::vector<VkPipelineStageFlags> waitStageMasks = {VK_PIPELINE_STAGE_ALL_COMMANDS_BIT};
-    std::vector<VkSemaphore> signalSemaphores = {currentContext_->commandProcessedSemaphore->vkSemaphore()};
+    std::vector<uint64_t> waitValues = {0};
+    // chunk BLASes still building on the secondary queue only hold back the TLAS build and the traces reading them
+    if (frameBackendValue_ > secondaryTimeline_->completed()) {
+        waitSemaphores.push_back(secondaryTimeline_->vkSemaphore());
+        waitStageMasks.push_back(VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR |
+                                 VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR);
+        waitValues.push_back(frameBackendValue_);
+    }
+    frameBackendValue_ = 0;
+
+    // the binary semaphore is kept for the present, which cannot wait on a timeline
+    uint64_t signalValue = mainTimeline_->advance();
+    std::vector<VkSemaphore> signalSemaphores = {currentContext_->commandProcessedSemaphore->vkSemaphore(),
+                                                 mainTimeline_->vkSemaphore()};
+    std::vector<uint64_t> signalValues = {0, signalValue};
     std::vector<VkCommandBuffer> commandbuffers = {
         currentContext_->uploadCommandBuffer->vkCommandBuffer(),
         currentContext_->worldCommandBuffer->vkCommandBuffer(),
@@ -289,8 +350,16 @@ void Framework::submitCommand() {
         currentContext_->fuseCommandBuffer->vkCommandBuffer(),
     };
 
+    VkTimelineSemaphoreSubmitInfo timelineSubmitInfo = {};
+    timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineSubmitInfo.waitSemaphoreValueCount = waitValues.size();
+    timelineSubmitInfo.pWaitSemaphoreValues = waitValues.data();
+    timelineSubmitInfo.signalSemaphoreValueCount = signalValues.size();
+    timelineSubmitInfo.pSignalSemaphoreValues = signalValues.data();
+
     VkSubmitInfo vkSubmitInfo = {};
     vkSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    vkSubmitInfo.pNext = &timelineSubmitInfo;
     vkSubmitInfo.waitSemaphoreCount = waitSemaphores.size();
     vkSubmitInfo.pWaitSemaphores = waitSemaphores.data();
     vkSubmitInfo.pWaitDstStageMask = waitStageMasks.data();
@@ -299,24 +368,14 @@ void Framework::submitCommand() {
     vkSubmitInfo.signalSemaphoreCount = signalSemaphores.size();
     vkSubmitInfo.pSignalSemaphores = signalSemaphores.data();
 
-    std::shared_ptr<vk::Fence> fence = currentContext_->commandFinishedFence;
-    vkResetFences(device_->vkDevice(), 1, &fence->vkFence());
-    vkQueueSubmit(device_->mainVkQueue(), 1, &vkSubmitInfo, fence->vkFence());
+    vkQueueSubmit(device_->mainVkQueue(), 1, &vkSubmitInfo, VK_NULL_HANDLE);
+    currentContext_->submittedValue = signalValue;
 }
 
 void Framework::present() {
     if (!running_) return;
 
-    VkPresentInfoKHR presentInfo = {};
-    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-    presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = &currentContext_->commandProcessedSemaphore->vkSemaphore();
-
-    presentInfo.swapchainCount = 1;
-    presentInfo.pSwapchains = &swapchain_->vkSwapchain();
-    presentInfo.pImageIndices = &currentContext_->frameIndex;
-
-    VkResult result = vkQueuePresentKHR(device_->mainVkQueue(), &presentInfo);
+    VkResult result = presentSink_->present(currentContext_);
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || vk::Window::framebufferResized ||
         Renderer::options.needRecreate || pipeline_->needRecreate) {
@@ -340,11 +399,14 @@ void Framework::recreate() {
 
     waitRenderQueueIdle();
 
-    int width = 0, height = 0;
-    GLFW_GetFramebufferSize(window_->window(), &width, &height);
-    while (width == 0 || height == 0) {
+    // a headless surface keeps its size, there is no window to wait for
+    if (!window_->headless()) {
+        int width = 0, height = 0;
         GLFW_GetFramebufferSize(window_->window(), &width, &height);
-        GLFW_WaitEvents();
+        while (width == 0 || height == 0) {
+            GLFW_GetFramebufferSize(window_->window(), &width, &height);
+            GLFW_WaitEvents();
+        }
     }
 
     currentContextIndex_ = 0;
@@ -355,7 +417,6 @@ void Framework::recreate() {
     overlayCommandBuffers_.clear();
     worldCommandBuffers_.clear();
     fuseCommandBuffers_.clear();
-    commandFinishedFences_.clear();
     commandProcessedSemaphores_.clear();
 
     swapchain_->reconstruct();
@@ -370,15 +431,13 @@ void Framework::recreate() {
         fuseCommandBuffers_.emplace_back(vk::CommandBuffer::create(device_, mainCommandPool_));
     }
 
-    // create fence for each context
-    for (int i = 0; i < size; i++) { commandFinishedFences_.push_back(vk::Fence::create(device_, true)); }
-
     // create semaphore for each context for command procssed
     for (int i = 0; i < size; i++) { commandProcessedSemaphores_.push_back(vk::Semaphore::create(device_)); }
 
     for (int i = 0; i < size; i++) { contexts_.push_back(FrameworkContext::create(shared_from_this(), i)); }
 
     pipeline_->recreate(shared_from_this());
+    device_->savePipelineCache();
 
     Renderer::instance().textures()->bindAllTextures();
 }
@@ -388,11 +447,39 @@ void Framework::waitDeviceIdle() {
 }
 
 void Framework::waitRenderQueueIdle() {
-    vkQueueWaitIdle(device_->mainVkQueue());
+    mainTimeline_->wait(mainTimeline_->submitted());
 }
 
 void Framework::waitBackendQueueIdle() {
-    vkQueueWaitIdle(device_->secondaryQueue());
+    secondaryTimeline_->wait(secondaryTimeline_->submitted());
+}
+
+uint64_t Framework::submitBackend(std::shared_ptr<vk::CommandBuffer> commandBuffer) {
+    uint64_t signalValue = secondaryTimeline_->advance();
+
+    VkTimelineSemaphoreSubmitInfo timelineSubmitInfo = {};
+    timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineSubmitInfo.signalSemaphoreValueCount = 1;
+    timelineSubmitInfo.pSignalSemaphoreValues = &signalValue;
+
+    VkSubmitInfo vkSubmitInfo = {};
+    vkSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    vkSubmitInfo.pNext = &timelineSubmitInfo;
+    vkSubmitInfo.commandBufferCount = 1;
+    vkSubmitInfo.pCommandBuffers = &commandBuffer->vkCommandBuffer();
+    vkSubmitInfo.signalSemaphoreCount = 1;
+    vkSubmitInfo.pSignalSemaphores = &secondaryTimeline_->vkSemaphore();
+
+    vkQueueSubmit(device_->secondaryQueue(), 1, &vkSubmitInfo, VK_NULL_HANDLE);
+    return signalValue;
+}
+
+void Framework::waitBackendInFrame(uint64_t value) {
+    frameBackendValue_ = std::max(frameBackendValue_, value);
+}
+
+double Framework::frameTimeMs() {
+    return frameTimeMs_;
 }
 
 void Framework::close() {
@@ -409,10 +496,8 @@ void Framework::takeScreenshot(bool withUI, int width, int height, int channel,
 
     uint32_t targetIndex = indexHistory_.front();
     auto context = contexts_[targetIndex];
-    std::shared_ptr<vk::Fence> fence = context->commandFinishedFence;
-    VkResult result = vkWaitForFences(device_->vkDevice(), 1, &fence->vkFence(), true, UINT64_MAX);
-    if (result != VK_SUCCESS) {
-        std::cout << "vkWaitForFences failed with error for screenshot: " << std::dec << result << std::endl;
+    if (!mainTimeline_->wait(context->submittedValue)) {
+        std::cout << "vkWaitSemaphores failed for screenshot" << std::endl;
         waitDeviceIdle();
         exit(EXIT_FAILURE);
     }
@@ -491,6 +576,7 @@ void Framework::takeScreenshot(bool withUI, int width, int height, int channel,
                 }})
         ->end();
 
+    // a fence of its own, the main timeline values are reserved for the frame submissions
     VkSubmitInfo vkSubmitInfo = {};
     vkSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
     vkSubmitInfo.waitSemaphoreCount = 0;
@@ -500,7 +586,7 @@ void Framework::takeScreenshot(bool withUI, int width, int height, int channel,
     std::shared_ptr<vk::Fence> oneTimeFence = vk::Fence::create(device_);
 
     vkQueueSubmit(device_->mainVkQueue(), 1, &vkSubmitInfo, oneTimeFence->vkFence());
-    result = vkWaitForFences(device_->vkDevice(), 1, &oneTimeFence->vkFence(), true, UINT64_MAX);
+    VkResult result = vkWaitForFences(device_->vkDevice(), 1, &oneTimeFence->vkFence(), true, UINT64_MAX);
     if (result != VK_SUCCESS) {
         std::cout << "vkWaitForFences failed with error for screenshot: " << std::dec << result << std::endl;
         waitDeviceIdle();
@@ -546,16 +632,16 @@ std::shared_ptr<vk::CommandPool> Framework::asyncCommandPool() {
     return asyncCommandPool_;
 }
 
-std::shared_ptr<vk::CommandBuffer> Framework::worldAsyncCommandBuffer() {
-    return worldAsyncCommandBuffer_;
-}
-
 std::vector<std::shared_ptr<vk::Semaphore>> &Framework::commandProcessedSemaphores() {
     return commandProcessedSemaphores_;
 }
 
-std::vector<std::shared_ptr<vk::Fence>> &Framework::commandFinishedFences() {
-    return commandFinishedFences_;
+std::shared_ptr<vk::TimelineSemaphore> Framework::mainTimeline() {
+    return mainTimeline_;
+}
+
+std::shared_ptr<vk::TimelineSemaphore> Framework::secondaryTimeline() {
+    return secondaryTimeline_;
 }
 
 std::vector<std::shared_ptr<FrameworkContext>> &Framework::contexts() {
@@ -576,6 +662,18 @@ std::shared_ptr<Pipeline> Framework::pipeline() {
     return pipeline_;
 }
 
+std::shared_ptr<GpuProfiler> Framework::gpuProfiler() {
+    return gpuProfiler_;
+}
+
+std::shared_ptr<Readback> Framework::readback() {
+    return readback_;
+}
+
+void Framework::setPresentSink(std::shared_ptr<PresentSink> presentSink) {
+    presentSink_ = presentSink;
+}
+
 GarbageCollector &Framework::gc() {
     return *gc_;
 }
@@ -595,13 +693,34 @@ void Framework::recycleSemaphore(std::shared_ptr<vk::Semaphore> semaphore) {
     recycledImageAcquiredSemaphores_.push(semaphore);
 }
 
-GarbageCollector::GarbageCollector(std::shared_ptr<Framework> framework) : framework_(framework) {
-    collectors_.resize(framework->swapchain_->imageCount());
+GarbageCollector::GarbageCollector(std::shared_ptr<Framework> framework) : framework_(framework) {}
+
+// the main value is the one the frame being recorded will signal, anything collected now may still be referenced by it
+void GarbageCollector::collectTagged(std::shared_ptr<void> garbage) {
+    auto framework = framework_.lock();
+    auto context = framework->currentContext_;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    garbage_.push_back(Garbage{
+        .mainValue = context == nullptr ? framework->mainTimeline_->submitted() : context->frameValue,
+        .secondaryValue = framework->secondaryTimeline_->submitted(),
+        .object = garbage,
+    });
 }
 
+// tags only grow in push order, so the retired objects are always a prefix of the queue
 void GarbageCollector::clear() {
-    index_ = (index_ + 1) % collectors_.size();
-
     auto framework = framework_.lock();
-    collectors_[index_].clear();
+    uint64_t mainCompleted = framework->mainTimeline_->completed();
+    uint64_t secondaryCompleted = framework->secondaryTimeline_->completed();
+
+    std::deque<Garbage> retired; // released after the lock, destructors may collect again
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!garbage_.empty() && garbage_.front().mainValue <= mainCompleted &&
+               garbage_.front().secondaryValue <= secondaryCompleted) {
+            retired.push_back(std::move(garbage_.front()));
+            garbage_.pop_front();
+        }
+    }
 }
@@ -3,10 +3,14 @@
 #include "common/shared.hpp"
 #include "common/singleton.hpp"
 #include "core/all_extern.hpp"
+#include "core/render/gpu_profiler.hpp"
 #include "core/render/pipeline.hpp"
+#include "core/render/readback.hpp"
 #include "core/vulkan/all_core_vulkan.hpp"
 #include "core/render/modules/world/dlss/dlss_wrapper.hpp"
 
+#include <chrono>
+#include <deque>
 #include <map>
 #include <mutex>
 
@@ -14,6 +18,8 @@ class Framework;
 class UIModule;
 struct UIModuleContext;
 
+// keeps released objects alive until the gpu is done with them, an object is tagged with the main timeline value of
+// the frame being recorded and the last secondary timeline value, and dropped once both timelines reached them
 class GarbageCollector : public SharedObject<GarbageCollector> {
   public:
     GarbageCollector(std::shared_ptr<Framework> framework);
@@ -24,9 +30,17 @@ class GarbageCollector : public SharedObject<GarbageCollector> {
     void clear();
 
   private:
+    struct Garbage {
+        uint64_t mainValue;
+        uint64_t secondaryValue;
+        std::shared_ptr<void> object;
+    };
+
+    void collectTagged(std::shared_ptr<void> garbage);
+
     std::weak_ptr<Framework> framework_;
-    std::vector<std::vector<std::shared_ptr<void>>> collectors_;
-    uint32_t index_ = 0;
+    std::deque<Garbage> garbage_;
+    std::mutex mutex_;
 };
 
 struct FrameworkContext : public SharedObject<FrameworkContext> {
@@ -44,7 +58,8 @@ struct FrameworkContext : public SharedObject<FrameworkContext> {
     std::shared_ptr<vk::CommandPool> commandPool;
     std::shared_ptr<vk::Semaphore> imageAcquiredSemaphore = nullptr;
     std::shared_ptr<vk::Semaphore> commandProcessedSemaphore;
-    std::shared_ptr<vk::Fence> commandFinishedFence;
+    uint64_t submittedValue = 0; // main timeline value signaled by the last submission of this context
+    uint64_t frameValue = 0;     // main timeline value the frame recorded into this context signals
 
     std::shared_ptr<vk::CommandBuffer> uploadCommandBuffer;
     std::shared_ptr<vk::CommandBuffer> overlayCommandBuffer;
@@ -57,6 +72,20 @@ struct FrameworkContext : public SharedObject<FrameworkContext> {
     void fuseFinal();
 };
 
+// receives every submitted frame, the sink has to wait on the commandProcessedSemaphore of the context and its result
+// is handled like the one of vkQueuePresentKHR, so out of date and suboptimal still trigger a recreate
+class PresentSink {
+  public:
+    virtual ~PresentSink() = default;
+
+    virtual VkResult present(std::shared_ptr<FrameworkContext> context) = 0;
+};
+
+class SwapchainPresentSink : public PresentSink, public SharedObject<SwapchainPresentSink> {
+  public:
+    VkResult present(std::shared_ptr<FrameworkContext> context) override;
+};
+
 class Framework : public SharedObject<Framework> {
     friend FrameworkContext;
     friend GarbageCollector;
@@ -66,16 +95,27 @@ class Framework : public SharedObject<Framework> {
     ~Framework();
 
     void init(GLFWwindow *window);
+    // offscreen, on a VK_EXT_headless_surface swapchain of a fixed size, for runs without a display
+    void init(uint32_t width, uint32_t height);
     void acquireContext();
     void submitCommand();
     void present();
     void recreate();
     void waitDeviceIdle();
+    // wait for everything submitted so far on the main or the secondary timeline
     void waitRenderQueueIdle();
     void waitBackendQueueIdle();
+    // submits on the secondary queue, the returned secondary timeline value is reached once the work completed
+    uint64_t submitBackend(std::shared_ptr<vk::CommandBuffer> commandBuffer);
+    // the next frame submission waits for the secondary timeline to reach the value before its acceleration structure
+    // builds, so results of the secondary queue can be referenced in the frame they were submitted in
+    void waitBackendInFrame(uint64_t value);
+    // smoothed time between acquired frames
+    double frameTimeMs();
     void close();
     bool isRunning();
 
+    // blocks until the copy landed, Readback delivers the same pixels a few frames later without waiting
     void takeScreenshot(bool withUI, int width, int height, int channel, void *dstPointer);
 
     std::recursive_mutex &recreateMtx();
@@ -89,18 +129,23 @@ class Framework : public SharedObject<Framework> {
     std::shared_ptr<vk::CommandPool> mainCommandPool();
     std::shared_ptr<vk::CommandPool> asyncCommandPool();
 
-    std::shared_ptr<vk::CommandBuffer> worldAsyncCommandBuffer();
+    std::shared_ptr<vk::TimelineSemaphore> mainTimeline();
+    std::shared_ptr<vk::TimelineSemaphore> secondaryTimeline();
 
     std::vector<std::shared_ptr<vk::Semaphore>> &commandProcessedSemaphores();
-    std::vector<std::shared_ptr<vk::Fence>> &commandFinishedFences();
     std::vector<std::shared_ptr<FrameworkContext>> &contexts();
     std::shared_ptr<FrameworkContext> safeAcquireCurrentContext();
 
     std::shared_ptr<Pipeline> pipeline();
+    std::shared_ptr<GpuProfiler> gpuProfiler();
+    std::shared_ptr<Readback> readback();
+
+    void setPresentSink(std::shared_ptr<PresentSink> presentSink);
 
     GarbageCollector &gc();
 
   private:
+    void initResources();
     std::shared_ptr<vk::Semaphore> acquireSemaphore();
     void recycleSemaphore(std::shared_ptr<vk::Semaphore> semaphore);
 
@@ -118,12 +163,19 @@ class Framework : public SharedObject<Framework> {
     std::vector<std::shared_ptr<vk::CommandBuffer>> overlayCommandBuffers_;
     std::vector<std::shared_ptr<vk::CommandBuffer>> worldCommandBuffers_;
     std::vector<std::shared_ptr<vk::CommandBuffer>> fuseCommandBuffers_;
-    std::shared_ptr<vk::CommandBuffer> worldAsyncCommandBuffer_;
 
     std::shared_ptr<Pipeline> pipeline_;
+    std::shared_ptr<GpuProfiler> gpuProfiler_;
+    std::shared_ptr<Readback> readback_;
+    std::shared_ptr<PresentSink> presentSink_;
 
     std::vector<std::shared_ptr<vk::Semaphore>> commandProcessedSemaphores_;
-    std::vector<std::shared_ptr<vk::Fence>> commandFinishedFences_;
+    std::shared_ptr<vk::TimelineSemaphore> mainTimeline_;
+    std::shared_ptr<vk::TimelineSemaphore> secondaryTimeline_;
+    uint64_t frameBackendValue_ = 0;
+
+    std::chrono::steady_clock::time_point lastAcquireTime_;
+    double frameTimeMs_ = 0.0;
 
     std::vector<std::shared_ptr<FrameworkContext>> contexts_;
 
@@ -141,6 +193,5 @@ class Framework : public SharedObject<Framework> {
 
 template <typename T>
 void GarbageCollector::collect(std::shared_ptr<T> garbage) {
-    auto framework = framework_.lock();
-    if (garbage != nullptr) { collectors_[index_].push_back(garbage); }
+    if (garbage != nullptr) { collectTagged(garbage); }
 }
\ No newline at end of file
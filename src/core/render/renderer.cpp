@@ -14,6 +14,12 @@ Renderer::Renderer(GLFWwindow *window)
       buffers_(Buffers::create(framework_)),
       world_(World::create(framework_)) {}
 
+Renderer::Renderer(uint32_t width, uint32_t height)
+    : framework_(Framework::create(width, height)),
+      textures_(Textures::create(framework_)),
+      buffers_(Buffers::create(framework_)),
+      world_(World::create(framework_)) {}
+
 Renderer::~Renderer() {}
 
 std::shared_ptr<Framework> Renderer::framework() {
@@ -29,6 +29,15 @@ struct Options {
 
     uint32_t chunkBuildingBatchSize = 2;
     uint32_t chunkBuildingTotalBatches = 4;
+    uint32_t chunkCompactionSettleFrames = 120;
+    float chunkBuildFrameBudgetMs = 16.6f; // target frame time for chunk batches while maxFps sets none, 0 disables
+    bool chunkGeometrySpill = false; // keep an encoded host copy of chunk geometry for debug readback
+    uint32_t entityBLASCacheEvictFrames = 8; // a cached BLAS pins the batch buffer it was allocated from
+    uint32_t entityBLASMaxRefits = 32;       // rebuild after this many refits to restore trace quality
+    uint32_t tlasMaxUpdates = 16;            // per frame context, rebuild the TLAS after this many refits
+    uint32_t textureStagingLimitMB = 64;     // per frame, texture uploads past it are deferred to the next frames
+    bool textureMipGeneration = true;        // blit the mip chain of textures that only receive level 0 uploads
+    bool gpuProfiler = false;                // timestamp zones around the passes, read through the renderer proxy
 };
 
 class Renderer : public Singleton<Renderer> {
@@ -49,6 +58,7 @@ class Renderer : public Singleton<Renderer> {
 
   private:
     Renderer(GLFWwindow *window);
+    Renderer(uint32_t width, uint32_t height);
 
     std::shared_ptr<Framework> framework_;
     std::shared_ptr<Textures> textures_;
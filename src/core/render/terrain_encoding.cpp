@@ -0,0 +1,110 @@
+#include "core/render/terrain_encoding.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <glm/gtc/packing.hpp>
+
+bool TerrainEncoding::isEncodable(const std::vector<vk::VertexFormat::PBRTriangle> &vertices) {
+    if (vertices.empty()) return false;
+
+    auto &first = vertices[0];
+    if (first.useGlint != 0) return false; // glintUV is not kept
+    for (auto &v : vertices) {
+        if (v.useNorm != first.useNorm || v.useColorLayer != first.useColorLayer ||
+            v.useTexture != first.useTexture || v.useOverlay != first.useOverlay || v.overlayUV != first.overlayUV ||
+            v.useGlint != first.useGlint || v.glintTexture != first.glintTexture ||
+            v.coordinate != first.coordinate) {
+            return false;
+        }
+        if (glm::any(glm::lessThan(v.colorLayer, glm::vec4(0.0f))) ||
+            glm::any(glm::greaterThan(v.colorLayer, glm::vec4(1.0f)))) {
+            return false;
+        }
+        if (!std::isfinite(v.albedoEmission) || std::abs(v.albedoEmission) > 65504.0f) return false;
+        if (first.useNorm) {
+            if (std::abs(glm::length(v.norm) - 1.0f) > 1e-3f) return false;
+        } else if (v.norm != glm::vec3(0.0f)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint64_t TerrainEncoding::encodedSize(uint32_t vertexCount) {
+    return sizeof(vk::VertexFormat::TerrainGeometryHeader) +
+           static_cast<uint64_t>(vertexCount) * sizeof(vk::VertexFormat::TerrainVertex);
+}
+
+void TerrainEncoding::encode(const std::vector<vk::VertexFormat::PBRTriangle> &vertices, uint8_t *dst) {
+    auto &first = vertices[0];
+    vk::VertexFormat::TerrainGeometryHeader header = {
+        .useNorm = first.useNorm,
+        .useColorLayer = first.useColorLayer,
+        .useTexture = first.useTexture,
+        .useOverlay = first.useOverlay,
+        .overlayUV = first.overlayUV,
+        .useGlint = first.useGlint,
+        .glintTexture = first.glintTexture,
+        .coordinate = first.coordinate,
+    };
+    std::memcpy(dst, &header, sizeof(header));
+
+    auto *compact = reinterpret_cast<vk::VertexFormat::TerrainVertex *>(dst + sizeof(header));
+    for (auto &v : vertices) {
+        uint32_t norm = first.useNorm ? encodeOctahedralNormal(v.norm) : 0;
+        *compact++ = {
+            .pos = v.pos,
+            .colorLayer = glm::packUnorm4x8(v.colorLayer),
+            .textureUV = v.textureUV,
+            .textureID = v.textureID,
+            .normEmission = norm | (static_cast<uint32_t>(glm::packHalf1x16(v.albedoEmission)) << 16),
+        };
+    }
+}
+
+void TerrainEncoding::decode(const uint8_t *encoded, uint32_t vertexCount, vk::VertexFormat::PBRTriangle *dst) {
+    vk::VertexFormat::TerrainGeometryHeader header;
+    std::memcpy(&header, encoded, sizeof(header));
+    auto *compact = reinterpret_cast<const vk::VertexFormat::TerrainVertex *>(encoded + sizeof(header));
+    for (uint32_t i = 0; i < vertexCount; i++) { dst[i] = decodeVertex(header, compact[i]); }
+}
+
+vk::VertexFormat::PBRTriangle TerrainEncoding::decodeVertex(const vk::VertexFormat::TerrainGeometryHeader &header,
+                                                            const vk::VertexFormat::TerrainVertex &compact) {
+    return {
+        .pos = compact.pos,
+        .useNorm = header.useNorm,
+        .norm = header.useNorm ? decodeOctahedralNormal(compact.normEmission) : glm::vec3(0.0f),
+        .useColorLayer = header.useColorLayer,
+        .colorLayer = glm::unpackUnorm4x8(compact.colorLayer),
+        .useTexture = header.useTexture,
+        .useOverlay = header.useOverlay,
+        .textureUV = compact.textureUV,
+        .overlayUV = header.overlayUV,
+        .useGlint = header.useGlint,
+        .textureID = compact.textureID,
+        .glintTexture = header.glintTexture,
+        .coordinate = header.coordinate,
+        .albedoEmission = glm::unpackHalf1x16(static_cast<uint16_t>(compact.normEmission >> 16)),
+    };
+}
+
+uint32_t TerrainEncoding::encodeOctahedralNormal(glm::vec3 n) {
+    n /= std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    glm::vec2 e = glm::vec2(n.x, n.y);
+    if (n.z < 0.0f) {
+        e = (1.0f - glm::abs(glm::vec2(n.y, n.x))) *
+            glm::vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+    }
+    return glm::packSnorm4x8(glm::vec4(e, 0.0f, 0.0f)) & 0xFFFF;
+}
+
+glm::vec3 TerrainEncoding::decodeOctahedralNormal(uint32_t packed) {
+    glm::vec2 e = glm::vec2(glm::unpackSnorm4x8(packed & 0xFFFF));
+    glm::vec3 n = glm::vec3(e, 1.0f - std::abs(e.x) - std::abs(e.y));
+    float t = std::max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return glm::normalize(n);
+}
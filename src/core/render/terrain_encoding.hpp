@@ -0,0 +1,24 @@
+#pragma once
+
+#include "common/shared.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// terrain geometry whose per-vertex flags are uniform is stored as a TerrainGeometryHeader followed by
+// 32 byte TerrainVertex entries, world_vertex.glsl decodes it back into a PBRTriangle
+namespace TerrainEncoding {
+bool isEncodable(const std::vector<vk::VertexFormat::PBRTriangle> &vertices);
+uint64_t encodedSize(uint32_t vertexCount);
+
+// dst must hold encodedSize bytes, the vertices must be encodable
+void encode(const std::vector<vk::VertexFormat::PBRTriangle> &vertices, uint8_t *dst);
+void decode(const uint8_t *encoded, uint32_t vertexCount, vk::VertexFormat::PBRTriangle *dst);
+// mirrors fetchWorldVertex in world_vertex.glsl
+vk::VertexFormat::PBRTriangle decodeVertex(const vk::VertexFormat::TerrainGeometryHeader &header,
+                                           const vk::VertexFormat::TerrainVertex &compact);
+
+// unit normal as snorm8x2 in the low 16 bits
+uint32_t encodeOctahedralNormal(glm::vec3 n);
+glm::vec3 decodeOctahedralNormal(uint32_t packed);
+} // namespace TerrainEncoding
@@ -1,10 +1,15 @@
 #include "core/render/textures.hpp"
 
+#include "core/render/mip_chain.hpp"
 #include "core/render/modules/ui_module.hpp"
 #include "core/render/pipeline.hpp"
 #include "core/render/render_framework.hpp"
 #include "core/render/renderer.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
 std::ostream &texturesCout() {
     return std::cout << "[Textures] ";
 }
@@ -13,22 +18,40 @@ std::ostream &texturesCerr() {
     return std::cerr << "[Textures] ";
 }
 
-Textures::Textures(std::shared_ptr<Framework> framework) {}
+Textures::Textures(std::shared_ptr<Framework> framework) {
+    staging_ = vk::StagingRing::create(framework->vma(), framework->device(), framework->swapchain()->imageCount(),
+                                       static_cast<VkDeviceSize>(Renderer::options.textureStagingLimitMB) << 20);
+}
 
 void Textures::reset() {
+    std::unique_lock<std::recursive_mutex> lck(mutex_);
+
     textures_.clear();
     nextID = 0;
+    deferred_.clear();
+    deferredBytes_ = 0;
 }
 
 void Textures::resetFrame() {
     auto framework = Renderer::instance().framework();
+    auto context = framework->safeAcquireCurrentContext();
+
+    std::unique_lock<std::recursive_mutex> lck(mutex_);
 
     framework->gc().collect(uploadQueue_);
-    uploadQueue_ = std::make_shared<std::map<uint32_t, std::vector<VkBufferImageCopy>>>();
+    uploadQueue_ = std::make_shared<std::map<uint32_t, std::vector<Upload>>>();
+
+    staging_->beginFrame(context->frameIndex);
 
-    for (auto &entry : caches_) {
-        auto &cache = entry.second;
-        cache->reset();
+    // deferred uploads go first and in order, a later upload to the same texel must not overtake them
+    while (!deferred_.empty()) {
+        auto &deferred = deferred_.front();
+        auto staging = staging_->upload(deferred.data.data(), deferred.data.size());
+        if (staging.buffer == nullptr) break;
+
+        stageUpload(deferred.dstId, staging, deferred.region);
+        deferredBytes_ -= deferred.data.size();
+        deferred_.pop_front();
     }
 }
 
@@ -52,6 +75,13 @@ void Textures::initializeTexture(uint32_t id, uint32_t maxLevel, uint32_t width,
         exit(EXIT_FAILURE);
     }
 
+    // deferred uploads were meant for the image that is replaced here
+    std::erase_if(deferred_, [&](const DeferredUpload &deferred) {
+        if (deferred.dstId != id) return false;
+        deferredBytes_ -= deferred.data.size();
+        return true;
+    });
+
     auto framework = Renderer::instance().framework();
     framework->gc().collect(textures_[id]);
     textures_[id] = vk::DeviceLocalImage::create(device, vma, false, maxLevel, width, height, 1, format,
@@ -125,10 +155,6 @@ void Textures::queueUpload(uint8_t *srcPointer,
                            uint32_t level) {
     std::unique_lock<std::recursive_mutex> lck(mutex_);
 
-    auto framework = Renderer::instance().framework();
-
-    auto device = Renderer::instance().framework()->device();
-    auto vma = Renderer::instance().framework()->vma();
     auto dstTextureIter = textures_.find(dstId);
     if (dstTextureIter == textures_.end()) {
         texturesCerr() << "The dstID " << dstId << " is not registered yet!" << std::endl;
@@ -136,33 +162,63 @@ void Textures::queueUpload(uint8_t *srcPointer,
     }
     auto dstTexture = (*dstTextureIter).second;
 
-    auto cacheIter = caches_.find(dstId);
-    if (cacheIter == caches_.end()) {
-        cacheIter = caches_
-                        .emplace(std::make_pair(
-                            dstId, ImageBufferCache::create(vma, device, framework->swapchain()->imageCount())))
-                        .first;
-    }
-
-    auto cache = cacheIter->second;
-    size_t offset = cache->append(srcPointer, srcSizeInBytes);
+    if (width == 0 || height == 0) return;
 
     auto format = dstTexture->vkFormat();
-    uint32_t bytePerPixel = vk::formatToByte(format);
+    size_t bytePerPixel = vk::formatToByte(format);
+    size_t srcRowBytes = (srcRowPixels == 0 ? width : srcRowPixels) * bytePerPixel;
+    size_t dstRowBytes = width * bytePerPixel;
+    size_t srcBegin = srcOffsetY * srcRowBytes + srcOffsetX * bytePerPixel;
+    if (srcBegin + (height - 1) * srcRowBytes + dstRowBytes > srcSizeInBytes) {
+        texturesCerr() << "The upload to texture " << dstId << " reads past its source of " << srcSizeInBytes
+                       << " bytes" << std::endl;
+        return;
+    }
 
+    // only the uploaded sub-rect is staged, with the rows packed tightly
     VkBufferImageCopy region = {};
-    region.bufferRowLength = srcRowPixels;
-    region.bufferOffset = offset + srcOffsetY * srcRowPixels * bytePerPixel + srcOffsetX * bytePerPixel;
+    region.bufferRowLength = width;
     region.imageSubresource = vk::wholeColorSubresourceLayers;
     region.imageSubresource.mipLevel = level;
     region.imageExtent = {width, height, 1};
     region.imageOffset = {dstOffsetX, dstOffsetY, 0};
 
-    auto dstTextureUploadQueueIter = uploadQueue_->find(dstId);
-    if (dstTextureUploadQueueIter == uploadQueue_->end()) {
-        dstTextureUploadQueueIter = uploadQueue_->emplace(dstId, std::vector<VkBufferImageCopy>{}).first;
+    auto packRows = [&](uint8_t *dst) {
+        const uint8_t *src = srcPointer + srcBegin;
+        if (srcRowBytes == dstRowBytes) {
+            std::memcpy(dst, src, dstRowBytes * height);
+            return;
+        }
+        for (uint32_t row = 0; row < height; row++) {
+            std::memcpy(dst + row * dstRowBytes, src + row * srcRowBytes, dstRowBytes);
+        }
+    };
+
+    size_t packedSize = dstRowBytes * height;
+    vk::StagingRing::Allocation staging{};
+    if (deferred_.empty()) { staging = staging_->allocate(packedSize); }
+
+    if (staging.buffer != nullptr) {
+        packRows(static_cast<uint8_t *>(staging.mappedPtr));
+        staging.flush();
+        stageUpload(dstId, staging, region);
+    } else {
+        // over the staging limit of this frame, the source pointer is only valid during this call
+        auto &deferred = deferred_.emplace_back(DeferredUpload{dstId, std::vector<uint8_t>(packedSize), region});
+        packRows(deferred.data.data());
+        deferredBytes_ += packedSize;
+
+#ifdef DEBUG
+        if (deferred_.size() == 1) {
+            texturesCout() << "staging limit reached, deferring texture uploads to the next frames" << std::endl;
+        }
+#endif
     }
-    dstTextureUploadQueueIter->second.emplace_back(region);
+}
+
+void Textures::stageUpload(uint32_t dstId, vk::StagingRing::Allocation staging, VkBufferImageCopy region) {
+    region.bufferOffset = staging.offset;
+    (*uploadQueue_)[dstId].push_back({staging, region});
 }
 
 void Textures::performQueuedUpload() {
@@ -216,9 +272,10 @@ void Textures::performQueuedUpload() {
 
     cmdBuffer->barriersBufferImage({}, uploadPreImageBarriers);
 
+    std::vector<VkBufferImageCopy> regions;
     for (auto &entry : *uploadQueue_) {
         auto &textureId = entry.first;
-        auto &regions = entry.second;
+        auto &uploads = entry.second;
 
         auto textureIter = textures_.find(textureId);
         if (textureIter == textures_.end()) {
@@ -227,12 +284,20 @@ void Textures::performQueuedUpload() {
         }
         auto texture = textureIter->second;
 
-        auto cacheIter = caches_.find(textureId);
-        if (cacheIter == caches_.end()) { continue; }
-        auto cache = cacheIter->second;
+        // uploads only leave the main ring region when it overflowed, so this is one copy per texture in practice
+        for (size_t i = 0; i < uploads.size();) {
+            auto stagingBuffer = uploads[i].staging.buffer;
+
+            regions.clear();
+            for (; i < uploads.size() && uploads[i].staging.buffer == stagingBuffer; i++) {
+                regions.push_back(uploads[i].region);
+            }
 
-        vkCmdCopyBufferToImage(cmdBuffer->vkCommandBuffer(), cache->vkBuffer(), texture->vkImage(),
-                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, regions.size(), regions.data());
+            vkCmdCopyBufferToImage(cmdBuffer->vkCommandBuffer(), stagingBuffer->vkBuffer(), texture->vkImage(),
+                                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, regions.size(), regions.data());
+        }
+
+        generateMipmaps(cmdBuffer, texture, uploads);
 
         cmdBuffer->barriersBufferImage(
             {}, {{
@@ -253,70 +318,102 @@ void Textures::performQueuedUpload() {
     cmdBuffer->barriersBufferImage({}, uploadPostImageBarriers);
 }
 
-void Textures::bindAllTextures() {
-    auto device = Renderer::instance().framework()->device();
-
-    std::unique_lock<std::recursive_mutex> lck(mutex_);
+// blits the mip chain below the level 0 area uploaded this frame, textures that receive their own mips from java
+// are left alone, all levels are back in TRANSFER_DST_OPTIMAL afterwards. alpha is filtered like the colour, so
+// cutout textures lose coverage towards the distant levels, keeping it needs a compute downsample instead of blits
+void Textures::generateMipmaps(std::shared_ptr<vk::CommandBuffer> cmdBuffer,
+                               std::shared_ptr<vk::DeviceLocalImage> texture,
+                               std::vector<Upload> &uploads) {
+    uint32_t mipLevels = texture->mipLevels();
+    if (!Renderer::options.textureMipGeneration || mipLevels <= 1 || uploads.empty()) return;
+
+    int32_t minX = INT32_MAX, minY = INT32_MAX, maxX = 0, maxY = 0;
+    for (auto &upload : uploads) {
+        auto &region = upload.region;
+        if (region.imageSubresource.mipLevel != 0) return;
+        minX = std::min(minX, region.imageOffset.x);
+        minY = std::min(minY, region.imageOffset.y);
+        maxX = std::max(maxX, region.imageOffset.x + static_cast<int32_t>(region.imageExtent.width));
+        maxY = std::max(maxY, region.imageOffset.y + static_cast<int32_t>(region.imageExtent.height));
+    }
 
-    for (const auto &[id, texture] : textures_) {
-        if (texture == nullptr) {
-            continue; // only allocated, but not initialized yet
+    auto framework = Renderer::instance().framework();
+    auto mainQueueIndex = framework->physicalDevice()->mainQueueIndex();
+
+    auto filterIter = mipFilters_.find(texture->vkFormat());
+    if (filterIter == mipFilters_.end()) {
+        VkFormatProperties properties;
+        vkGetPhysicalDeviceFormatProperties(framework->physicalDevice()->vkPhysicalDevice(), texture->vkFormat(),
+                                            &properties);
+        VkFormatFeatureFlags features = properties.optimalTilingFeatures;
+
+        VkFilter filter = VK_FILTER_MAX_ENUM;
+        if ((features & VK_FORMAT_FEATURE_BLIT_SRC_BIT) && (features & VK_FORMAT_FEATURE_BLIT_DST_BIT)) {
+            filter = (features & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) ? VK_FILTER_LINEAR :
+                                                                                      VK_FILTER_NEAREST;
         }
-
-        Renderer::instance().framework()->pipeline()->bindTexture(samplers[id], texture, id);
+        filterIter = mipFilters_.emplace(texture->vkFormat(), filter).first;
     }
-}
+    if (filterIter->second == VK_FILTER_MAX_ENUM) return;
+
+    auto levelBarrier = [&](uint32_t baseLevel, uint32_t levelCount, VkImageLayout oldLayout,
+                            VkImageLayout newLayout) {
+        VkImageSubresourceRange range = vk::wholeColorSubresourceRange;
+        range.baseMipLevel = baseLevel;
+        range.levelCount = levelCount;
+
+        cmdBuffer->barriersBufferImage(
+            {}, {{
+                    .srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                    .srcAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                    .dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                    .dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                    .oldLayout = oldLayout,
+                    .newLayout = newLayout,
+                    .srcQueueFamilyIndex = mainQueueIndex,
+                    .dstQueueFamilyIndex = mainQueueIndex,
+                    .image = texture,
+                    .subresourceRange = range,
+                }});
+    };
+
+    for (auto &mip : planMipBlits(texture->width(), texture->height(), mipLevels, {minX, minY, maxX, maxY})) {
+        levelBarrier(mip.level - 1, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
 
-ImageBufferCache::ImageBufferCache(std::shared_ptr<vk::VMA> vma, std::shared_ptr<vk::Device> device, uint32_t frameNum)
-    : vma_(vma), device_(device) {
-    capacities_.resize(frameNum);
-    bases_.resize(frameNum);
-    caches_.resize(frameNum);
+        VkImageBlit blit{};
+        blit.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, mip.level - 1, 0, texture->layer()};
+        blit.srcOffsets[0] = {mip.src.minX, mip.src.minY, 0};
+        blit.srcOffsets[1] = {mip.src.maxX, mip.src.maxY, 1};
+        blit.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, mip.level, 0, texture->layer()};
+        blit.dstOffsets[0] = {mip.dst.minX, mip.dst.minY, 0};
+        blit.dstOffsets[1] = {mip.dst.maxX, mip.dst.maxY, 1};
 
-    for (int i = 0; i < frameNum; i++) {
-        caches_[i] = vk::HostVisibleBuffer::create(vma_, device_, BASE_SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
-        capacities_[i] = BASE_SIZE;
-        bases_[i] = 0;
+        vkCmdBlitImage(cmdBuffer->vkCommandBuffer(), texture->vkImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       texture->vkImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, filterIter->second);
     }
-}
 
-ImageBufferCache::~ImageBufferCache() {
-#ifdef DEBUG
-// std::cout << "ImageBufferCache deconstructed" << std::endl;
-#endif
+    levelBarrier(0, mipLevels - 1, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 }
 
-size_t ImageBufferCache::append(void *src, size_t size) {
-    if (bases_[current_] + size >= capacities_[current_]) {
-        size_t newCapacity = capacities_[current_] * 2;
-
-        while (newCapacity < bases_[current_] + size) { newCapacity *= 2; }
+void Textures::bindAllTextures() {
+    auto device = Renderer::instance().framework()->device();
 
-        auto newCache = vk::HostVisibleBuffer::create(vma_, device_, newCapacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+    std::unique_lock<std::recursive_mutex> lck(mutex_);
 
-        std::memcpy(newCache->mappedPtr(), caches_[current_]->mappedPtr(), bases_[current_]);
+    for (const auto &[id, texture] : textures_) {
+        if (texture == nullptr) {
+            continue; // only allocated, but not initialized yet
+        }
 
-        auto framework = Renderer::instance().framework();
-        framework->gc().collect(caches_[current_]);
-        caches_[current_] = newCache;
-        capacities_[current_] = newCapacity;
+        Renderer::instance().framework()->pipeline()->bindTexture(samplers[id], texture, id);
     }
-
-    size_t ret = bases_[current_];
-    std::memcpy(static_cast<uint8_t *>(caches_[current_]->mappedPtr()) + bases_[current_], src, size);
-    bases_[current_] = (bases_[current_] + size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
-    return ret;
 }
 
-void ImageBufferCache::flush() {
-    caches_[current_]->flush();
+vk::StagingRing::Stats Textures::stagingStats() {
+    return staging_->stats();
 }
 
-VkBuffer &ImageBufferCache::vkBuffer() {
-    return caches_[current_]->vkBuffer();
+size_t Textures::deferredUploadBytes() {
+    std::unique_lock<std::recursive_mutex> lck(mutex_);
+    return deferredBytes_;
 }
-
-void ImageBufferCache::reset() {
-    current_ = (current_ + 1) % caches_.size();
-    bases_[current_] = 0;
-}
\ No newline at end of file
@@ -4,14 +4,14 @@
 #include "core/all_extern.hpp"
 #include "core/vulkan/all_core_vulkan.hpp"
 
+#include <deque>
 #include <functional>
 #include <map>
 #include <mutex>
+#include <vector>
 
 class Framework;
 
-class ImageBufferCache;
-
 class Textures : public SharedObject<Textures> {
   public:
     Textures(std::shared_ptr<Framework> framework);
@@ -36,36 +36,37 @@ class Textures : public SharedObject<Textures> {
     void performQueuedUpload();
     void bindAllTextures();
 
+    vk::StagingRing::Stats stagingStats();
+    size_t deferredUploadBytes();
+
   private:
+    struct Upload {
+        vk::StagingRing::Allocation staging;
+        VkBufferImageCopy region;
+    };
+
+    // an upload that did not fit under the staging limit, kept packed on the host until a later frame has room
+    struct DeferredUpload {
+        uint32_t dstId;
+        std::vector<uint8_t> data;
+        VkBufferImageCopy region;
+    };
+
+    void stageUpload(uint32_t dstId, vk::StagingRing::Allocation staging, VkBufferImageCopy region);
+    void generateMipmaps(std::shared_ptr<vk::CommandBuffer> cmdBuffer,
+                         std::shared_ptr<vk::DeviceLocalImage> texture,
+                         std::vector<Upload> &uploads);
+
     std::map<uint32_t, std::shared_ptr<vk::DeviceLocalImage>> textures_;
     std::map<uint32_t, std::shared_ptr<vk::Sampler>> samplers;
     uint32_t nextID = 0;
     std::recursive_mutex mutex_;
 
-    std::map<uint32_t, std::shared_ptr<ImageBufferCache>> caches_;
-    std::shared_ptr<std::map<uint32_t, std::vector<VkBufferImageCopy>>> uploadQueue_;
-};
-
-class ImageBufferCache : public SharedObject<ImageBufferCache> {
-  public:
-    constexpr static size_t BASE_SIZE = 16 * 1024; // 1KB
-    constexpr static size_t ALIGNMENT = 4;
+    // one ring for the uploads of all textures, the sub-rects are packed tightly instead of staging whole sources
+    std::shared_ptr<vk::StagingRing> staging_;
+    std::deque<DeferredUpload> deferred_;
+    size_t deferredBytes_ = 0;
+    std::shared_ptr<std::map<uint32_t, std::vector<Upload>>> uploadQueue_;
 
-    ImageBufferCache(std::shared_ptr<vk::VMA> vma, std::shared_ptr<vk::Device> device, uint32_t frameNum);
-    ~ImageBufferCache();
-
-    size_t append(void *src, size_t size);
-    void flush();
-    void reset();
-
-    VkBuffer &vkBuffer();
-
-  private:
-    std::shared_ptr<vk::VMA> vma_;
-    std::shared_ptr<vk::Device> device_;
-
-    uint32_t current_ = 0;
-    std::vector<size_t> capacities_;
-    std::vector<size_t> bases_;
-    std::vector<std::shared_ptr<vk::HostVisibleBuffer>> caches_;
-};
\ No newline at end of file
+    std::map<VkFormat, VkFilter> mipFilters_; // VK_FILTER_MAX_ENUM if the format cannot be blitted
+};
@@ -0,0 +1,297 @@
+#include "core/render/vertex_convert.hpp"
+
+#include <cstring>
+
+// the sse4.1 and avx2 paths are built next to the scalar one and picked at runtime, the rest of the library keeps the
+// baseline isa
+#if defined(MCVR_ENABLE_SSE41) && (defined(__x86_64__) || defined(_M_X64))
+#    define VERTEX_CONVERT_SIMD
+#    include <immintrin.h>
+#    if defined(_MSC_VER)
+#        include <intrin.h>
+#    endif
+#    if defined(__GNUC__) || defined(__clang__)
+#        define SSE41_TARGET __attribute__((target("sse4.1")))
+#        define AVX2_TARGET __attribute__((target("avx2")))
+#    else
+#        define SSE41_TARGET
+#        define AVX2_TARGET
+#    endif
+#endif
+
+namespace {
+using PBRTriangle = vk::VertexFormat::PBRTriangle;
+
+template <typename Src>
+concept HasColor = requires(const Src &s) { s.color; };
+template <typename Src>
+concept HasUV0 = requires(const Src &s) { s.uv0; };
+template <typename Src>
+concept HasUV = requires(const Src &s) { s.uv; };
+template <typename Src>
+concept HasOverlay = requires(const Src &s) { s.uv1; };
+template <typename Src>
+concept HasLight = requires(const Src &s) { s.uv2; };
+template <typename Src>
+concept HasNormal = requires(const Src &s) { s.normal; };
+
+struct ScalarUnpack {
+    // rgba8 -> [0, 1]
+    static void color(uint32_t color, glm::vec4 &out) {
+        out = glm::vec4{
+            color & 0xFF,
+            (color >> 8) & 0xFF,
+            (color >> 16) & 0xFF,
+            (color >> 24) & 0xFF,
+        };
+        out /= 255.0f;
+    }
+
+    // snorm8 xyz in the low three bytes, left unnormalized like the original vertex data
+    static void normal(uint32_t normal, glm::vec3 &out) {
+        out = glm::vec3{
+            static_cast<int8_t>(normal & 0xFF),
+            static_cast<int8_t>((normal >> 8) & 0xFF),
+            static_cast<int8_t>((normal >> 16) & 0xFF),
+        };
+    }
+
+    // two unsigned 16 bit halves, as used by the lightmap and overlay coordinates
+    static void short2(uint32_t packed, glm::ivec2 &out) {
+        out = glm::ivec2{packed & 0xFFFF, (packed >> 16) & 0xFFFF};
+    }
+};
+
+#ifdef VERTEX_CONVERT_SIMD
+// bit-identical to ScalarUnpack, the colour is divided rather than multiplied by the reciprocal for that
+struct Sse41Unpack {
+    SSE41_TARGET static void color(uint32_t color, glm::vec4 &out) {
+        __m128 f = _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(static_cast<int>(color))));
+        _mm_storeu_ps(&out.x, _mm_div_ps(f, _mm_set1_ps(255.0f)));
+    }
+
+    SSE41_TARGET static void normal(uint32_t normal, glm::vec3 &out) {
+        __m128 f = _mm_cvtepi32_ps(_mm_cvtepi8_epi32(_mm_cvtsi32_si128(static_cast<int>(normal))));
+        _mm_storel_pi(reinterpret_cast<__m64 *>(&out.x), f);
+        _mm_store_ss(&out.z, _mm_movehl_ps(f, f));
+    }
+
+    SSE41_TARGET static void short2(uint32_t packed, glm::ivec2 &out) {
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(&out.x),
+                         _mm_cvtepu16_epi32(_mm_cvtsi32_si128(static_cast<int>(packed))));
+    }
+};
+
+// the colour and normal of two vertices share one 256 bit register, convertBatchAvx2 unpacks them with the pair
+// functions after the per-vertex fields. still bit-identical to ScalarUnpack
+struct Avx2Unpack {
+    AVX2_TARGET static void color(uint32_t, glm::vec4 &) {}
+    AVX2_TARGET static void normal(uint32_t, glm::vec3 &) {}
+
+    AVX2_TARGET static void short2(uint32_t packed, glm::ivec2 &out) { Sse41Unpack::short2(packed, out); }
+
+    AVX2_TARGET static void colorPair(uint32_t color0, uint32_t color1, glm::vec4 &out0, glm::vec4 &out1) {
+        __m128i packed = _mm_set_epi32(0, 0, static_cast<int>(color1), static_cast<int>(color0));
+        __m256 f = _mm256_div_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(packed)), _mm256_set1_ps(255.0f));
+        _mm_storeu_ps(&out0.x, _mm256_castps256_ps128(f));
+        _mm_storeu_ps(&out1.x, _mm256_extractf128_ps(f, 1));
+    }
+
+    AVX2_TARGET static void normalPair(uint32_t normal0, uint32_t normal1, glm::vec3 &out0, glm::vec3 &out1) {
+        __m128i packed = _mm_set_epi32(0, 0, static_cast<int>(normal1), static_cast<int>(normal0));
+        __m256 f = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(packed));
+        __m128 f0 = _mm256_castps256_ps128(f);
+        __m128 f1 = _mm256_extractf128_ps(f, 1);
+        _mm_storel_pi(reinterpret_cast<__m64 *>(&out0.x), f0);
+        _mm_store_ss(&out0.z, _mm_movehl_ps(f0, f0));
+        _mm_storel_pi(reinterpret_cast<__m64 *>(&out1.x), f1);
+        _mm_store_ss(&out1.z, _mm_movehl_ps(f1, f1));
+    }
+};
+
+// cpuid leaf 1, ecx bit 19
+bool hasSse41() {
+#    if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 19)) != 0;
+#    else
+    return __builtin_cpu_supports("sse4.1") != 0;
+#    endif
+}
+
+// cpuid leaf 7, ebx bit 5, and the os has to save the ymm registers. __builtin_cpu_supports checks both
+bool hasAvx2() {
+#    if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    constexpr int osxsaveAndAvx = (1 << 27) | (1 << 28);
+    if ((info[2] & osxsaveAndAvx) != osxsaveAndAvx || (_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#    else
+    return __builtin_cpu_supports("avx2") != 0;
+#    endif
+}
+#endif
+
+template <typename Unpack, typename Src>
+inline void convertVertex(const Src &src, uint32_t textureID, PBRTriangle &dst) {
+    dst.pos = src.position;
+
+    if constexpr (HasColor<Src>) {
+        dst.useColorLayer = 1;
+        Unpack::color(src.color, dst.colorLayer);
+    }
+
+    if constexpr (HasUV0<Src>) {
+        dst.useTexture = 1;
+        dst.textureUV = src.uv0;
+    } else if constexpr (HasUV<Src>) {
+        dst.useTexture = 1;
+        dst.textureUV = src.uv;
+    }
+
+    if constexpr (HasOverlay<Src>) {
+        dst.useOverlay = 1;
+        Unpack::short2(src.uv1, dst.overlayUV);
+    }
+
+    if constexpr (HasLight<Src>) {
+        dst.useLight = 1;
+        Unpack::short2(src.uv2, dst.lightUV);
+    }
+
+    if constexpr (HasNormal<Src>) {
+        dst.useNorm = 1;
+        Unpack::normal(src.normal, dst.norm);
+    }
+
+    dst.textureID = textureID;
+}
+
+template <typename Src>
+void convertBatchScalar(const Src *vertices, uint32_t count, uint32_t textureID, PBRTriangle *dst) {
+    for (uint32_t i = 0; i < count; i++) { convertVertex<ScalarUnpack>(vertices[i], textureID, dst[i]); }
+}
+
+#ifdef VERTEX_CONVERT_SIMD
+// the whole loop carries the target so the unpacking inlines into it
+template <typename Src>
+SSE41_TARGET void convertBatchSse41(const Src *vertices, uint32_t count, uint32_t textureID, PBRTriangle *dst) {
+    for (uint32_t i = 0; i < count; i++) { convertVertex<Sse41Unpack>(vertices[i], textureID, dst[i]); }
+}
+
+// two vertices per iteration, an odd last one goes through the sse4.1 unpacking
+template <typename Src>
+AVX2_TARGET void convertBatchAvx2(const Src *vertices, uint32_t count, uint32_t textureID, PBRTriangle *dst) {
+    uint32_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        convertVertex<Avx2Unpack>(vertices[i], textureID, dst[i]);
+        convertVertex<Avx2Unpack>(vertices[i + 1], textureID, dst[i + 1]);
+        if constexpr (HasColor<Src>) {
+            Avx2Unpack::colorPair(vertices[i].color, vertices[i + 1].color, dst[i].colorLayer, dst[i + 1].colorLayer);
+        }
+        if constexpr (HasNormal<Src>) {
+            Avx2Unpack::normalPair(vertices[i].normal, vertices[i + 1].normal, dst[i].norm, dst[i + 1].norm);
+        }
+    }
+    for (; i < count; i++) { convertVertex<Sse41Unpack>(vertices[i], textureID, dst[i]); }
+}
+#endif
+
+template <typename Src>
+void convertBatch(VertexConvert::Isa isa, const void *src, uint32_t count, uint32_t textureID, PBRTriangle *dst) {
+    const Src *vertices = static_cast<const Src *>(src);
+
+    switch (isa) {
+#ifdef VERTEX_CONVERT_SIMD
+        case VertexConvert::Isa::AVX2: convertBatchAvx2(vertices, count, textureID, dst); break;
+        case VertexConvert::Isa::SSE41: convertBatchSse41(vertices, count, textureID, dst); break;
+#endif
+        default: convertBatchScalar(vertices, count, textureID, dst); break;
+    }
+}
+} // namespace
+
+VertexConvert::Isa VertexConvert::bestIsa() {
+    static const Isa isa = [] {
+#ifdef VERTEX_CONVERT_SIMD
+        if (hasAvx2()) return Isa::AVX2;
+        if (hasSse41()) return Isa::SSE41;
+#endif
+        return Isa::Scalar;
+    }();
+    return isa;
+}
+
+void VertexConvert::toPBRTriangles(World::VertexFormats format,
+                                   const void *src,
+                                   uint32_t count,
+                                   uint32_t textureID,
+                                   vk::VertexFormat::PBRTriangle *dst) {
+    toPBRTriangles(bestIsa(), format, src, count, textureID, dst);
+}
+
+void VertexConvert::toPBRTriangles(Isa isa,
+                                   World::VertexFormats format,
+                                   const void *src,
+                                   uint32_t count,
+                                   uint32_t textureID,
+                                   vk::VertexFormat::PBRTriangle *dst) {
+    using namespace vk::VertexFormat;
+
+    switch (format) {
+        case World::POSITION_COLOR_TEXTURE_LIGHT_NORMAL:
+            convertBatch<PositionColorTexLightNormal>(isa, src, count, textureID, dst);
+            break;
+        case World::POSITION_COLOR_TEXTURE_OVERLAY_LIGHT_NORMAL:
+            convertBatch<PositionColorTexOverlayLightNormal>(isa, src, count, textureID, dst);
+            break;
+        case World::POSITION_TEXTURE_COLOR_LIGHT:
+            convertBatch<PositionTexColorLight>(isa, src, count, textureID, dst);
+            break;
+        case World::POSITION: convertBatch<PositionOnly>(isa, src, count, textureID, dst); break;
+        case World::POSITION_COLOR: convertBatch<PositionColor>(isa, src, count, textureID, dst); break;
+        case World::LINES: convertBatch<PositionColorNormal>(isa, src, count, textureID, dst); break;
+        case World::POSITION_COLOR_LIGHT: convertBatch<PositionColorLight>(isa, src, count, textureID, dst); break;
+        case World::POSITION_TEXTURE: convertBatch<PositionTex>(isa, src, count, textureID, dst); break;
+        case World::POSITION_TEXTURE_COLOR: convertBatch<PositionTexColor>(isa, src, count, textureID, dst); break;
+        case World::POSITION_COLOR_TEXTURE_LIGHT:
+            convertBatch<PositionColorTexLight>(isa, src, count, textureID, dst);
+            break;
+        case World::POSITION_TEXTURE_LIGHT_COLOR:
+            convertBatch<PositionTexLightColor>(isa, src, count, textureID, dst);
+            break;
+        case World::POSITION_TEXTURE_COLOR_NORMAL:
+            convertBatch<PositionTexColorNormal>(isa, src, count, textureID, dst);
+            break;
+        case World::PBR_TRIANGLE: std::memcpy(dst, src, count * sizeof(PBRTriangle)); break;
+        default:
+            for (uint32_t i = 0; i < count; i++) { dst[i].textureID = textureID; }
+            break;
+    }
+}
+
+uint32_t VertexConvert::vertexSize(World::VertexFormats format) {
+    using namespace vk::VertexFormat;
+
+    switch (format) {
+        case World::POSITION_COLOR_TEXTURE_LIGHT_NORMAL: return sizeof(PositionColorTexLightNormal);
+        case World::POSITION_COLOR_TEXTURE_OVERLAY_LIGHT_NORMAL: return sizeof(PositionColorTexOverlayLightNormal);
+        case World::POSITION_TEXTURE_COLOR_LIGHT: return sizeof(PositionTexColorLight);
+        case World::POSITION: return sizeof(PositionOnly);
+        case World::POSITION_COLOR: return sizeof(PositionColor);
+        case World::LINES: return sizeof(PositionColorNormal);
+        case World::POSITION_COLOR_LIGHT: return sizeof(PositionColorLight);
+        case World::POSITION_TEXTURE: return sizeof(PositionTex);
+        case World::POSITION_TEXTURE_COLOR: return sizeof(PositionTexColor);
+        case World::POSITION_COLOR_TEXTURE_LIGHT: return sizeof(PositionColorTexLight);
+        case World::POSITION_TEXTURE_LIGHT_COLOR: return sizeof(PositionTexLightColor);
+        case World::POSITION_TEXTURE_COLOR_NORMAL: return sizeof(PositionTexColorNormal);
+        case World::PBR_TRIANGLE: return sizeof(PBRTriangle);
+        default: return 0;
+    }
+}
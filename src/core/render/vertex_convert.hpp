@@ -0,0 +1,35 @@
+#pragma once
+
+#include "common/shared.hpp"
+#include "core/render/world.hpp"
+
+#include <cstdint>
+
+namespace VertexConvert {
+// the converter paths, the best one built in and supported by the cpu is picked at runtime
+enum class Isa {
+    Scalar,
+    SSE41,
+    AVX2,
+};
+
+Isa bestIsa();
+
+// converts count vertices of the given minecraft vertex format into PBRTriangle entries,
+// dst must hold count zero-initialized entries
+void toPBRTriangles(World::VertexFormats format,
+                    const void *src,
+                    uint32_t count,
+                    uint32_t textureID,
+                    vk::VertexFormat::PBRTriangle *dst);
+// same on the given path, for the tests and the benchmark. isa must not be above bestIsa()
+void toPBRTriangles(Isa isa,
+                    World::VertexFormats format,
+                    const void *src,
+                    uint32_t count,
+                    uint32_t textureID,
+                    vk::VertexFormat::PBRTriangle *dst);
+
+// size in bytes of one source vertex of the format, 0 for the formats toPBRTriangles does not read
+uint32_t vertexSize(World::VertexFormats format);
+} // namespace VertexConvert
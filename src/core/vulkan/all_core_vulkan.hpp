@@ -1,6 +1,9 @@
 #pragma once
 
 #include "core/vulkan/buffer.hpp"
+#include "core/vulkan/buffer_arena.hpp"
+#include "core/vulkan/staging_ring.hpp"
+#include "core/vulkan/upload_batch.hpp"
 #include "core/vulkan/command.hpp"
 #include "core/vulkan/descriptor.hpp"
 #include "core/vulkan/device.hpp"
@@ -18,4 +21,5 @@
 #include "core/vulkan/framebuffer.hpp"
 #include "core/vulkan/shader.hpp"
 #include "core/vulkan/as.hpp"
-#include "core/vulkan/sbt.hpp"
\ No newline at end of file
+#include "core/vulkan/sbt.hpp"
+#include "core/vulkan/query.hpp"
\ No newline at end of file
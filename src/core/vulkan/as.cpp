@@ -3,8 +3,11 @@
 #include "core/vulkan/command.hpp"
 #include "core/vulkan/device.hpp"
 #include "core/vulkan/physical_device.hpp"
+#include "core/vulkan/query.hpp"
 #include "core/vulkan/vma.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 vk::BLAS::BLAS(std::shared_ptr<Device> device,
@@ -33,6 +36,50 @@ VkDeviceAddress &vk::BLAS::blasDeviceAddress() {
     return blasDeviceAddress_;
 }
 
+void vk::BLAS::writeCompactedSizes(std::vector<std::shared_ptr<BLAS>> &blases,
+                                   std::shared_ptr<QueryPool> queryPool,
+                                   std::shared_ptr<CommandBuffer> commandBuffer) {
+    std::vector<VkAccelerationStructureKHR> vkBLASes;
+    for (auto &blas : blases) { vkBLASes.push_back(blas->blas()); }
+
+    queryPool->reset(commandBuffer, 0, vkBLASes.size());
+    vkCmdWriteAccelerationStructuresPropertiesKHR(commandBuffer->vkCommandBuffer(), vkBLASes.size(), vkBLASes.data(),
+                                                  VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR,
+                                                  queryPool->vkQueryPool(), 0);
+}
+
+std::shared_ptr<vk::BLAS> vk::BLAS::compact(std::shared_ptr<Device> device,
+                                            std::shared_ptr<VMA> vma,
+                                            std::shared_ptr<BLAS> srcBLAS,
+                                            VkDeviceSize compactedSize,
+                                            std::shared_ptr<CommandBuffer> commandBuffer) {
+    auto blasBuffer = DeviceLocalBuffer::create(vma, device, false, compactedSize,
+                                                VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR |
+                                                    VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                                                0, VMA_MEMORY_USAGE_GPU_ONLY, 256);
+
+    VkAccelerationStructureCreateInfoKHR createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
+    createInfo.buffer = blasBuffer->vkBuffer();
+    createInfo.size = compactedSize;
+    createInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+
+    VkAccelerationStructureKHR dstBLAS = VK_NULL_HANDLE;
+    if (vkCreateAccelerationStructureKHR(device->vkDevice(), &createInfo, nullptr, &dstBLAS) != VK_SUCCESS) {
+        std::cout << "Cannot create compacted BLAS" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    VkCopyAccelerationStructureInfoKHR copyInfo{};
+    copyInfo.sType = VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_INFO_KHR;
+    copyInfo.src = srcBLAS->blas();
+    copyInfo.dst = dstBLAS;
+    copyInfo.mode = VK_COPY_ACCELERATION_STRUCTURE_MODE_COMPACT_KHR;
+    vkCmdCopyAccelerationStructureKHR(commandBuffer->vkCommandBuffer(), &copyInfo);
+
+    return BLAS::create(device, dstBLAS, blasBuffer);
+}
+
 vk::TLAS::TLAS(std::shared_ptr<Device> device,
                VkAccelerationStructureKHR tlas,
                std::shared_ptr<DeviceLocalBuffer> tlasBuffer)
@@ -531,3 +578,122 @@ std::shared_ptr<vk::TLAS> vk::TLASBuilder::buildAndSubmit(std::shared_ptr<Device
 
     return TLAS::create(device, dstTLAS_, tlasBuffer_);
 }
+
+vk::PersistentTLAS::PersistentTLAS(std::shared_ptr<PhysicalDevice> physicalDevice,
+                                   std::shared_ptr<Device> device,
+                                   std::shared_ptr<VMA> vma,
+                                   VkBuildAccelerationStructureFlagsKHR flags)
+    : physicalDevice_(physicalDevice),
+      device_(device),
+      vma_(vma),
+      flags_(flags | VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR) {}
+
+void vk::PersistentTLAS::uploadInstances(const std::vector<VkAccelerationStructureInstanceKHR> &instances,
+                                         const std::vector<uint32_t> &dirtyRows,
+                                         bool all) {
+    constexpr uint32_t minInstanceCapacity = 256;
+
+    if (instances.size() > instanceCapacity_) {
+        instanceCapacity_ = std::max<uint32_t>(minInstanceCapacity, instances.size() + instances.size() / 2);
+        instanceBuffer_ =
+            HostVisibleBuffer::create(vma_, device_, sizeof(VkAccelerationStructureInstanceKHR) * instanceCapacity_,
+                                      VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
+                                          VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR);
+        all = true;
+    }
+    instanceCount_ = static_cast<uint32_t>(instances.size());
+
+    auto mapped = static_cast<VkAccelerationStructureInstanceKHR *>(instanceBuffer_->mappedPtr());
+    if (all) {
+        std::copy(instances.begin(), instances.end(), mapped);
+        dirtyInstanceCount_ = instanceCount_;
+        if (instanceCount_ > 0) instanceBuffer_->flush(instanceCount_ * sizeof(VkAccelerationStructureInstanceKHR), 0);
+        return;
+    }
+
+    for (uint32_t row : dirtyRows) { mapped[row] = instances[row]; }
+    dirtyInstanceCount_ = static_cast<uint32_t>(dirtyRows.size());
+    if (!dirtyRows.empty()) {
+        // the rows are sorted, one flush covers them
+        instanceBuffer_->flush((dirtyRows.back() + 1 - dirtyRows.front()) * sizeof(VkAccelerationStructureInstanceKHR),
+                               dirtyRows.front() * sizeof(VkAccelerationStructureInstanceKHR));
+    }
+}
+
+std::shared_ptr<vk::TLAS> vk::PersistentTLAS::buildAndSubmit(std::shared_ptr<CommandBuffer> commandBuffer,
+                                                             bool allowUpdate) {
+    uint32_t instanceCount = instanceCount_;
+    lastBuildUpdated_ = allowUpdate && tlas_ != nullptr && instanceCount == builtInstanceCount_;
+
+    VkAccelerationStructureGeometryKHR geometry{};
+    geometry.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
+    geometry.geometryType = VK_GEOMETRY_TYPE_INSTANCES_KHR;
+    geometry.geometry.instances.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR;
+    geometry.geometry.instances.arrayOfPointers = VK_FALSE;
+    geometry.geometry.instances.data.deviceAddress = instanceBuffer_->bufferAddress();
+
+    VkAccelerationStructureBuildGeometryInfoKHR buildInfo{};
+    buildInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
+    buildInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
+    buildInfo.mode = lastBuildUpdated_ ? VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR :
+                                         VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+    buildInfo.flags = flags_;
+    buildInfo.geometryCount = 1;
+    buildInfo.pGeometries = &geometry;
+
+    // storage and scratch are sized for the whole instance buffer, so rebuilds only reallocate when it grew
+    if (tlas_ == nullptr || tlasCapacity_ < instanceCapacity_) {
+        VkAccelerationStructureBuildSizesInfoKHR sizeInfo{};
+        sizeInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
+        vkGetAccelerationStructureBuildSizesKHR(device_->vkDevice(), VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
+                                                &buildInfo, &instanceCapacity_, &sizeInfo);
+
+        auto tlasBuffer = DeviceLocalBuffer::create(vma_, device_, false, sizeInfo.accelerationStructureSize,
+                                                    VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR |
+                                                        VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                                                    0, VMA_MEMORY_USAGE_GPU_ONLY, 256);
+
+        scratchBuffer_ = DeviceLocalBuffer::create(
+            vma_, device_, false, std::max(sizeInfo.buildScratchSize, sizeInfo.updateScratchSize),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, 0,
+            VMA_MEMORY_USAGE_GPU_ONLY,
+            physicalDevice_->accelerationStructProperties().minAccelerationStructureScratchOffsetAlignment);
+
+        VkAccelerationStructureCreateInfoKHR tlasCreateInfo{};
+        tlasCreateInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
+        tlasCreateInfo.buffer = tlasBuffer->vkBuffer();
+        tlasCreateInfo.size = sizeInfo.accelerationStructureSize;
+        tlasCreateInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
+
+        VkAccelerationStructureKHR tlas = VK_NULL_HANDLE;
+        if (vkCreateAccelerationStructureKHR(device_->vkDevice(), &tlasCreateInfo, nullptr, &tlas) != VK_SUCCESS) {
+            std::cout << "Cannot create TLAS" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        tlas_ = TLAS::create(device_, tlas, tlasBuffer);
+        tlasCapacity_ = instanceCapacity_;
+    }
+
+    buildInfo.srcAccelerationStructure = lastBuildUpdated_ ? tlas_->tlas() : VK_NULL_HANDLE;
+    buildInfo.dstAccelerationStructure = tlas_->tlas();
+    buildInfo.scratchData.deviceAddress = scratchBuffer_->bufferAddress();
+
+    VkAccelerationStructureBuildRangeInfoKHR buildRanges{};
+    buildRanges.primitiveCount = instanceCount;
+    buildRanges.primitiveOffset = 0;
+
+    const VkAccelerationStructureBuildRangeInfoKHR *pBuildRanges = &buildRanges;
+    vkCmdBuildAccelerationStructuresKHR(commandBuffer->vkCommandBuffer(), 1, &buildInfo, &pBuildRanges);
+
+    builtInstanceCount_ = instanceCount;
+    return tlas_;
+}
+
+bool vk::PersistentTLAS::lastBuildUpdated() {
+    return lastBuildUpdated_;
+}
+
+uint32_t vk::PersistentTLAS::dirtyInstanceCount() {
+    return dirtyInstanceCount_;
+}
@@ -14,6 +14,7 @@ class CommandBuffer;
 class PhysicalDevice;
 class Device;
 class VMA;
+class QueryPool;
 
 class BLAS : public SharedObject<BLAS> {
   public:
@@ -26,6 +27,16 @@ class BLAS : public SharedObject<BLAS> {
     VkAccelerationStructureKHR &blas();
     VkDeviceAddress &blasDeviceAddress();
 
+    // sources must have been built with VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR
+    static void writeCompactedSizes(std::vector<std::shared_ptr<BLAS>> &blases,
+                                    std::shared_ptr<QueryPool> queryPool,
+                                    std::shared_ptr<CommandBuffer> commandBuffer);
+    static std::shared_ptr<BLAS> compact(std::shared_ptr<Device> device,
+                                         std::shared_ptr<VMA> vma,
+                                         std::shared_ptr<BLAS> srcBLAS,
+                                         VkDeviceSize compactedSize,
+                                         std::shared_ptr<CommandBuffer> commandBuffer);
+
   private:
     std::shared_ptr<Device> device_;
     std::shared_ptr<DeviceLocalBuffer> blasBuffer_;
@@ -205,6 +216,43 @@ class TLASBuilder : public SharedObject<TLASBuilder> {
     VkAccelerationStructureKHR srcTLAS_ = VK_NULL_HANDLE;
     VkAccelerationStructureKHR dstTLAS_ = VK_NULL_HANDLE;
 };
+
+// a TLAS that keeps its instance buffer, storage and scratch across builds, refit in place while the instance count
+// is unchanged and rebuilt otherwise, storage only grows when the instance buffer does
+// not synchronized against the GPU, the owner must only reuse it once its previous build and traces have finished
+class PersistentTLAS : public SharedObject<PersistentTLAS> {
+  public:
+    PersistentTLAS(std::shared_ptr<PhysicalDevice> physicalDevice,
+                   std::shared_ptr<Device> device,
+                   std::shared_ptr<VMA> vma,
+                   VkBuildAccelerationStructureFlagsKHR flags);
+
+    // writes the given rows of the instances, every row when all is set or the instance buffer had to grow
+    void uploadInstances(const std::vector<VkAccelerationStructureInstanceKHR> &instances,
+                         const std::vector<uint32_t> &dirtyRows,
+                         bool all);
+    std::shared_ptr<TLAS> buildAndSubmit(std::shared_ptr<CommandBuffer> commandBuffer, bool allowUpdate);
+
+    bool lastBuildUpdated();
+    uint32_t dirtyInstanceCount();
+
+  private:
+    std::shared_ptr<PhysicalDevice> physicalDevice_;
+    std::shared_ptr<Device> device_;
+    std::shared_ptr<VMA> vma_;
+    VkBuildAccelerationStructureFlagsKHR flags_;
+
+    uint32_t instanceCount_ = 0;
+    std::shared_ptr<HostVisibleBuffer> instanceBuffer_;
+    uint32_t instanceCapacity_ = 0;
+    uint32_t dirtyInstanceCount_ = 0;
+
+    std::shared_ptr<TLAS> tlas_;
+    std::shared_ptr<DeviceLocalBuffer> scratchBuffer_;
+    uint32_t tlasCapacity_ = 0;
+    uint32_t builtInstanceCount_ = 0;
+    bool lastBuildUpdated_ = false;
+};
 }; // namespace vk
 
 template <typename T>
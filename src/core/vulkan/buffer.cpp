@@ -99,14 +99,18 @@ void vk::HostVisibleBuffer::uploadToBuffer(void *src) {
 }
 
 void vk::HostVisibleBuffer::uploadToBuffer(void *src, size_t size, size_t offset) {
-    std::memcpy(mappedPtr_, src, size);
-    vmaFlushAllocation(vma_->allocator(), allocation_, 0, size);
+    std::memcpy(static_cast<uint8_t *>(mappedPtr_) + offset, src, size);
+    vmaFlushAllocation(vma_->allocator(), allocation_, offset, size);
 }
 
 void vk::HostVisibleBuffer::flush() {
     vmaFlushAllocation(vma_->allocator(), allocation_, 0, size_);
 }
 
+void vk::HostVisibleBuffer::flush(size_t size, size_t offset) {
+    vmaFlushAllocation(vma_->allocator(), allocation_, offset, size);
+}
+
 size_t vk::HostVisibleBuffer::size() {
     return size_;
 }
@@ -303,7 +307,7 @@ void vk::DeviceLocalBuffer::downloadFromStagingBuffer(void *dest, size_t size, s
     }
 
     vmaInvalidateAllocation(vma_->allocator(), stagingAllocation_, offset, size);
-    std::memcpy(dest, mappedPtr_, size);
+    std::memcpy(dest, static_cast<uint8_t *>(mappedPtr_) + offset, size);
 
     if (!persistStaging_) {
         vmaDestroyBuffer(vma_->allocator(), stagingBuffer_, stagingAllocation_);
@@ -341,7 +345,7 @@ void vk::DeviceLocalBuffer::uploadToStagingBuffer(void *src, size_t size, size_t
         mappedPtr_ = stagingAllocationInfo_.pMappedData;
     }
 
-    std::memcpy(mappedPtr_, src, size);
+    std::memcpy(static_cast<uint8_t *>(mappedPtr_) + offset, src, size);
     vmaFlushAllocation(vma_->allocator(), stagingAllocation_, offset, size);
 
     if (!persistStaging_) {
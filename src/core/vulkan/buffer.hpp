@@ -26,6 +26,7 @@ class HostVisibleBuffer : public Buffer, public SharedObject<HostVisibleBuffer>
     void uploadToBuffer(void *src, size_t size, size_t offset);
 
     void flush();
+    void flush(size_t size, size_t offset);
 
     size_t size() override;
     VkBuffer &vkBuffer() override;
@@ -0,0 +1,118 @@
+#include "core/vulkan/buffer_arena.hpp"
+
+#include "core/vulkan/buffer.hpp"
+#include "core/vulkan/device.hpp"
+#include "core/vulkan/vma.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+std::ostream &bufferArenaCout() {
+    return std::cout << "[BufferArena] ";
+}
+
+std::ostream &bufferArenaCerr() {
+    return std::cerr << "[BufferArena] ";
+}
+
+vk::BufferArenaRange::BufferArenaRange(std::shared_ptr<BufferArena> arena,
+                                       std::shared_ptr<DeviceLocalBuffer> buffer,
+                                       uint64_t pageId,
+                                       VkDeviceSize offset,
+                                       VkDeviceSize size)
+    : arena_(arena), buffer_(buffer), pageId_(pageId), offset_(offset), size_(size) {}
+
+vk::BufferArenaRange::~BufferArenaRange() {
+    arena_->free(pageId_, offset_, size_);
+}
+
+std::shared_ptr<vk::DeviceLocalBuffer> vk::BufferArenaRange::buffer() {
+    return buffer_;
+}
+
+VkDeviceSize vk::BufferArenaRange::offset() {
+    return offset_;
+}
+
+VkDeviceSize vk::BufferArenaRange::size() {
+    return size_;
+}
+
+VkDeviceAddress vk::BufferArenaRange::bufferAddress() {
+    return buffer_->bufferAddress() + offset_;
+}
+
+vk::BufferArena::BufferArena(std::shared_ptr<VMA> vma,
+                             std::shared_ptr<Device> device,
+                             VkDeviceSize pageSize,
+                             VkDeviceSize alignment,
+                             VkBufferUsageFlags usageExceptTransfer)
+    : vma_(vma), device_(device), pageSize_(pageSize), alignment_(alignment), usage_(usageExceptTransfer) {}
+
+std::shared_ptr<vk::BufferArenaRange> vk::BufferArena::allocate(VkDeviceSize size) {
+    size = RangeAllocator::alignedSize(size, alignment_);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // best fit over all pages
+    uint64_t bestPageId = 0;
+    VkDeviceSize bestFit = 0;
+    for (auto &[pageId, page] : pages_) {
+        VkDeviceSize fit = page.ranges.bestFit(size);
+        if (fit != 0 && (bestFit == 0 || fit < bestFit)) {
+            bestPageId = pageId;
+            bestFit = fit;
+        }
+    }
+
+    if (bestFit == 0) {
+        bestPageId = nextPageId_++;
+        VkDeviceSize pageSize = std::max(pageSize_, size);
+        auto buffer = DeviceLocalBuffer::create(vma_, device_, false, pageSize, usage_);
+        pages_.emplace(bestPageId, Page{buffer, RangeAllocator(pageSize, alignment_)});
+
+#ifdef DEBUG
+        bufferArenaCout() << "allocated page " << bestPageId << " with size " << pageSize << std::endl;
+#endif
+    }
+
+    Page &page = pages_.at(bestPageId);
+    VkDeviceSize offset = page.ranges.allocate(size);
+
+    return BufferArenaRange::create(shared_from_this(), page.buffer, bestPageId, offset, size);
+}
+
+void vk::BufferArena::free(uint64_t pageId, VkDeviceSize offset, VkDeviceSize size) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    auto pageIter = pages_.find(pageId);
+    if (pageIter == pages_.end()) {
+        bufferArenaCerr() << "freeing a range of an unknown page" << std::endl;
+        return;
+    }
+    Page &page = pageIter->second;
+    page.ranges.free(offset, size);
+
+    // keep one page around, release the other ones once they are empty
+    if (page.ranges.allocationCount() == 0 && pages_.size() > 1) { pages_.erase(pageIter); }
+}
+
+vk::BufferArena::Stats vk::BufferArena::stats() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    Stats stats{};
+    VkDeviceSize freeBytes = 0;
+    for (auto &[pageId, page] : pages_) {
+        auto pageStats = page.ranges.stats();
+        stats.pageCount++;
+        stats.allocationCount += pageStats.allocationCount;
+        stats.freeRangeCount += pageStats.freeRangeCount;
+        stats.reservedBytes += page.ranges.capacity();
+        stats.largestFreeRange = std::max(stats.largestFreeRange, pageStats.largestFreeRange);
+        freeBytes += pageStats.freeBytes;
+    }
+    stats.usedBytes = stats.reservedBytes - freeBytes;
+    stats.fragmentation = RangeAllocator::fragmentation(stats.largestFreeRange, freeBytes);
+
+    return stats;
+}
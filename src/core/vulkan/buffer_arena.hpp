@@ -0,0 +1,81 @@
+#pragma once
+
+#include "core/all_extern.hpp"
+#include "core/vulkan/range_allocator.hpp"
+
+#include <map>
+#include <mutex>
+
+namespace vk {
+class VMA;
+class Device;
+class DeviceLocalBuffer;
+class BufferArena;
+
+// a suballocated range of a BufferArena page, given back to the arena on destruction
+class BufferArenaRange : public SharedObject<BufferArenaRange> {
+  public:
+    BufferArenaRange(std::shared_ptr<BufferArena> arena,
+                     std::shared_ptr<DeviceLocalBuffer> buffer,
+                     uint64_t pageId,
+                     VkDeviceSize offset,
+                     VkDeviceSize size);
+    ~BufferArenaRange();
+
+    std::shared_ptr<DeviceLocalBuffer> buffer();
+    VkDeviceSize offset();
+    VkDeviceSize size();
+    VkDeviceAddress bufferAddress();
+
+  private:
+    std::shared_ptr<BufferArena> arena_;
+    std::shared_ptr<DeviceLocalBuffer> buffer_;
+
+    uint64_t pageId_;
+    VkDeviceSize offset_;
+    VkDeviceSize size_;
+};
+
+// large device local pages with a RangeAllocator each, a range is taken from the page whose best fit is the smallest
+class BufferArena : public SharedObject<BufferArena> {
+    friend BufferArenaRange;
+
+  public:
+    struct Stats {
+        uint32_t pageCount;
+        uint32_t allocationCount;
+        uint32_t freeRangeCount;
+        VkDeviceSize reservedBytes;
+        VkDeviceSize usedBytes;
+        VkDeviceSize largestFreeRange;
+        float fragmentation; // 1 - largest free range / all free bytes
+    };
+
+    BufferArena(std::shared_ptr<VMA> vma,
+                std::shared_ptr<Device> device,
+                VkDeviceSize pageSize,
+                VkDeviceSize alignment,
+                VkBufferUsageFlags usageExceptTransfer);
+
+    std::shared_ptr<BufferArenaRange> allocate(VkDeviceSize size);
+    Stats stats();
+
+  private:
+    struct Page {
+        std::shared_ptr<DeviceLocalBuffer> buffer;
+        RangeAllocator ranges;
+    };
+
+    void free(uint64_t pageId, VkDeviceSize offset, VkDeviceSize size);
+
+    std::shared_ptr<VMA> vma_;
+    std::shared_ptr<Device> device_;
+    VkDeviceSize pageSize_;
+    VkDeviceSize alignment_;
+    VkBufferUsageFlags usage_;
+
+    std::map<uint64_t, Page> pages_;
+    uint64_t nextPageId_ = 0;
+    std::mutex mutex_;
+};
+}; // namespace vk
@@ -7,6 +7,7 @@
 #include "core/vulkan/image.hpp"
 #include "core/vulkan/physical_device.hpp"
 #include "core/vulkan/pipeline.hpp"
+#include "core/vulkan/query.hpp"
 #include "core/vulkan/render_pass.hpp"
 #include "core/vulkan/sbt.hpp"
 #include "core/vulkan/sync.hpp"
@@ -222,19 +223,28 @@ std::shared_ptr<vk::CommandBuffer> vk::CommandBuffer::bindComputePipeline(std::s
 }
 
 std::shared_ptr<vk::CommandBuffer> vk::CommandBuffer::bindVertexBuffers(std::shared_ptr<DeviceLocalBuffer> buffer) {
-    VkDeviceSize offset = 0;
+    return bindVertexBuffers(buffer, 0);
+}
+
+std::shared_ptr<vk::CommandBuffer> vk::CommandBuffer::bindVertexBuffers(std::shared_ptr<DeviceLocalBuffer> buffer,
+                                                                        VkDeviceSize offset) {
     vkCmdBindVertexBuffers(commandBuffer_, 0, 1, &buffer->vkBuffer(), &offset);
     return shared_from_this();
 }
 
-std::shared_ptr<vk::CommandBuffer> vk::CommandBuffer::bindIndexBuffer(std::shared_ptr<DeviceLocalBuffer> buffer) {
+std::shared_ptr<vk::CommandBuffer> vk::CommandBuffer::bindIndexBuffer(std::shared_ptr<Buffer> buffer) {
     vkCmdBindIndexBuffer(commandBuffer_, buffer->vkBuffer(), 0, VK_INDEX_TYPE_UINT32);
     return shared_from_this();
 }
 
-std::shared_ptr<vk::CommandBuffer> vk::CommandBuffer::bindIndexBuffer(std::shared_ptr<DeviceLocalBuffer> buffer,
+std::shared_ptr<vk::CommandBuffer> vk::CommandBuffer::bindIndexBuffer(std::shared_ptr<Buffer> buffer,
                                                                       VkIndexType indexType) {
-    vkCmdBindIndexBuffer(commandBuffer_, buffer->vkBuffer(), 0, indexType);
+    return bindIndexBuffer(buffer, indexType, 0);
+}
+
+std::shared_ptr<vk::CommandBuffer>
+vk::CommandBuffer::bindIndexBuffer(std::shared_ptr<Buffer> buffer, VkIndexType indexType, VkDeviceSize offset) {
+    vkCmdBindIndexBuffer(commandBuffer_, buffer->vkBuffer(), offset, indexType);
     return shared_from_this();
 }
 
@@ -257,6 +267,12 @@ vk::CommandBuffer::raytracing(std::shared_ptr<SBT> sbt, uint32_t width, uint32_t
     return shared_from_this();
 }
 
+std::shared_ptr<vk::CommandBuffer>
+vk::CommandBuffer::writeTimestamp(std::shared_ptr<QueryPool> queryPool, uint32_t query, VkPipelineStageFlags2 stage) {
+    vkCmdWriteTimestamp2(commandBuffer_, stage, queryPool->vkQueryPool(), query);
+    return shared_from_this();
+}
+
 std::shared_ptr<vk::CommandBuffer> vk::CommandBuffer::end() {
     vkEndCommandBuffer(commandBuffer_);
     return shared_from_this();
@@ -20,6 +20,7 @@ class Buffer;
 class Image;
 class SBT;
 class Fence;
+class QueryPool;
 
 class CommandPool : public SharedObject<CommandPool> {
   public:
@@ -102,8 +103,11 @@ class CommandBuffer : public SharedObject<CommandBuffer> {
     std::shared_ptr<CommandBuffer> bindRTPipeline(std::shared_ptr<RayTracingPipeline> pipeline);
     std::shared_ptr<CommandBuffer> bindComputePipeline(std::shared_ptr<ComputePipeline> pipeline);
     std::shared_ptr<CommandBuffer> bindVertexBuffers(std::shared_ptr<DeviceLocalBuffer> buffer);
-    std::shared_ptr<CommandBuffer> bindIndexBuffer(std::shared_ptr<DeviceLocalBuffer> buffer);
-    std::shared_ptr<CommandBuffer> bindIndexBuffer(std::shared_ptr<DeviceLocalBuffer> buffer, VkIndexType indexType);
+    std::shared_ptr<CommandBuffer> bindVertexBuffers(std::shared_ptr<DeviceLocalBuffer> buffer, VkDeviceSize offset);
+    std::shared_ptr<CommandBuffer> bindIndexBuffer(std::shared_ptr<Buffer> buffer);
+    std::shared_ptr<CommandBuffer> bindIndexBuffer(std::shared_ptr<Buffer> buffer, VkIndexType indexType);
+    std::shared_ptr<CommandBuffer>
+    bindIndexBuffer(std::shared_ptr<Buffer> buffer, VkIndexType indexType, VkDeviceSize offset);
     std::shared_ptr<CommandBuffer>
     draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstIndex = 0, uint32_t firstInstance = 0);
     std::shared_ptr<CommandBuffer> drawIndexed(uint32_t indexCount,
@@ -113,6 +117,8 @@ class CommandBuffer : public SharedObject<CommandBuffer> {
                                                uint32_t firstInstance = 0);
     std::shared_ptr<CommandBuffer>
     raytracing(std::shared_ptr<SBT> sbt, uint32_t width, uint32_t height, uint32_t depth);
+    std::shared_ptr<CommandBuffer>
+    writeTimestamp(std::shared_ptr<QueryPool> queryPool, uint32_t query, VkPipelineStageFlags2 stage);
     std::shared_ptr<CommandBuffer> end();
 
     void submitMainQueueIndividual(std::shared_ptr<Device> device);
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace vk {
+// cpu side of UploadBatch, independent of vulkan so it can be checked with a recording command buffer. copies between
+// the same pair of buffers share one copy command, adjacent regions are merged and the whole plan is recorded between a
+// single pre and post barrier. the recorder provides
+//   preBarrier(uint64_t dstStageMask)
+//   copy(Handle src, Handle dst, const std::vector<CopyRegion> &regions)
+//   postBarrier(uint64_t dstStageMask)
+template <typename Handle>
+class CopyPlan {
+  public:
+    struct CopyRegion {
+        uint64_t srcOffset;
+        uint64_t dstOffset;
+        uint64_t size;
+    };
+
+    struct Stats {
+        uint32_t copyCommands;
+        uint32_t regions;
+        uint32_t barriers;
+    };
+
+    void add(Handle src, uint64_t srcOffset, Handle dst, uint64_t dstOffset, uint64_t size, uint64_t dstStageMask);
+    bool empty();
+
+    // clears the plan
+    template <typename Recorder>
+    Stats record(Recorder &recorder);
+
+  private:
+    struct Copy {
+        Handle src;
+        Handle dst;
+        CopyRegion region;
+    };
+
+    std::vector<Copy> copies_;
+    std::vector<CopyRegion> regions_;
+    uint64_t dstStageMask_ = 0;
+};
+
+template <typename Handle>
+void CopyPlan<Handle>::add(
+    Handle src, uint64_t srcOffset, Handle dst, uint64_t dstOffset, uint64_t size, uint64_t dstStageMask) {
+    if (size == 0) return;
+    copies_.push_back({src, dst, {srcOffset, dstOffset, size}});
+    dstStageMask_ |= dstStageMask;
+}
+
+template <typename Handle>
+bool CopyPlan<Handle>::empty() {
+    return copies_.empty();
+}
+
+template <typename Handle>
+template <typename Recorder>
+typename CopyPlan<Handle>::Stats CopyPlan<Handle>::record(Recorder &recorder) {
+    Stats stats{};
+    if (copies_.empty()) return stats;
+
+    std::sort(copies_.begin(), copies_.end(), [](const Copy &a, const Copy &b) {
+        if (a.src != b.src) return a.src < b.src;
+        if (a.dst != b.dst) return a.dst < b.dst;
+        return a.region.srcOffset < b.region.srcOffset;
+    });
+
+    recorder.preBarrier(dstStageMask_);
+
+    for (size_t i = 0; i < copies_.size();) {
+        Handle src = copies_[i].src;
+        Handle dst = copies_[i].dst;
+
+        regions_.clear();
+        for (; i < copies_.size() && copies_[i].src == src && copies_[i].dst == dst; i++) {
+            CopyRegion &region = copies_[i].region;
+            if (!regions_.empty()) {
+                CopyRegion &last = regions_.back();
+                if (last.srcOffset + last.size == region.srcOffset && last.dstOffset + last.size == region.dstOffset) {
+                    last.size += region.size;
+                    continue;
+                }
+            }
+            regions_.push_back(region);
+        }
+
+        recorder.copy(src, dst, regions_);
+        stats.copyCommands++;
+        stats.regions += regions_.size();
+    }
+
+    recorder.postBarrier(dstStageMask_);
+    stats.barriers = 2;
+
+    copies_.clear();
+    dstStageMask_ = 0;
+    return stats;
+}
+} // namespace vk
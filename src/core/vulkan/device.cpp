@@ -5,6 +5,7 @@
 #include "core/vulkan/physical_device.hpp"
 
 #include <cstring>
+#include <fstream>
 #include <iostream>
 #include <unordered_set>
 #include <vector>
@@ -209,6 +210,7 @@ vk::Device::Device(std::shared_ptr<Instance> instance,
     vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind =
         supportedVulkan12.descriptorBindingStorageBufferUpdateAfterBind;
     vulkan12Features.shaderFloat16 = supportedVulkan12.shaderFloat16;
+    vulkan12Features.timelineSemaphore = supportedVulkan12.timelineSemaphore;
 
     VkPhysicalDeviceAccelerationStructureFeaturesKHR accelerationStructureFeatures = {};
     accelerationStructureFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_FEATURES_KHR;
@@ -304,6 +306,10 @@ vk::Device::Device(std::shared_ptr<Instance> instance,
 }
 
 vk::Device::~Device() {
+    if (pipelineCache_ != VK_NULL_HANDLE) {
+        savePipelineCache();
+        vkDestroyPipelineCache(device_, pipelineCache_, nullptr);
+    }
     vkDestroyDevice(device_, nullptr);
 
 #ifdef DEBUG
@@ -322,3 +328,88 @@ VkQueue &vk::Device::mainVkQueue() {
 VkQueue &vk::Device::secondaryQueue() {
     return secondaryQueue_;
 }
+
+void vk::Device::loadPipelineCache(std::filesystem::path file) {
+    pipelineCacheFile_ = file;
+
+    std::vector<char> data;
+    std::ifstream in(file, std::ios::binary | std::ios::ate);
+    if (in) {
+        data.resize(in.tellg());
+        in.seekg(0);
+        in.read(data.data(), data.size());
+        if (!in) data.clear();
+    }
+
+    // the driver validates the header as well, but a stale file from another device or driver is dropped here so
+    // that it is not even handed over
+    if (!data.empty()) {
+        VkPhysicalDeviceProperties properties = physicalDevice_->properties();
+        VkPipelineCacheHeaderVersionOne header{};
+        bool valid = data.size() >= sizeof(header);
+        if (valid) {
+            std::memcpy(&header, data.data(), sizeof(header));
+            valid = header.headerSize >= sizeof(header) &&
+                    header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+                    header.vendorID == properties.vendorID && header.deviceID == properties.deviceID &&
+                    std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+        }
+        if (!valid) {
+#ifdef DEBUG
+            deviceCout() << "pipeline cache " << file << " belongs to another device or driver, discarded" << std::endl;
+#endif
+            data.clear();
+        }
+    }
+
+    VkPipelineCacheCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    createInfo.initialDataSize = data.size();
+    createInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+    if (vkCreatePipelineCache(device_, &createInfo, nullptr, &pipelineCache_) != VK_SUCCESS) {
+        deviceCerr() << "failed to create pipeline cache, pipelines are compiled without one" << std::endl;
+        pipelineCache_ = VK_NULL_HANDLE;
+        return;
+    }
+    pipelineCacheSavedSize_ = data.size();
+
+#ifdef DEBUG
+    deviceCout() << "pipeline cache loaded with " << data.size() << " bytes from " << file << std::endl;
+#endif
+}
+
+void vk::Device::savePipelineCache() {
+    if (pipelineCache_ == VK_NULL_HANDLE || pipelineCacheFile_.empty()) return;
+
+    size_t size = 0;
+    if (vkGetPipelineCacheData(device_, pipelineCache_, &size, nullptr) != VK_SUCCESS || size == 0) return;
+    // nothing was compiled since the file was written, entries are only ever added
+    if (size == pipelineCacheSavedSize_) return;
+    std::vector<char> data(size);
+    if (vkGetPipelineCacheData(device_, pipelineCache_, &size, data.data()) != VK_SUCCESS) return;
+
+    // written next to the target first, an interrupted write must not leave a truncated cache behind
+    std::error_code error;
+    std::filesystem::create_directories(pipelineCacheFile_.parent_path(), error);
+    std::filesystem::path tmpFile = pipelineCacheFile_;
+    tmpFile += ".tmp";
+    {
+        std::ofstream out(tmpFile, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), size);
+        if (!out) {
+            deviceCerr() << "failed to write pipeline cache " << tmpFile << std::endl;
+            return;
+        }
+    }
+    std::filesystem::rename(tmpFile, pipelineCacheFile_, error);
+    if (error) {
+        deviceCerr() << "failed to replace pipeline cache " << pipelineCacheFile_ << std::endl;
+        return;
+    }
+    pipelineCacheSavedSize_ = size;
+}
+
+VkPipelineCache &vk::Device::vkPipelineCache() {
+    return pipelineCache_;
+}
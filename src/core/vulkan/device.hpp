@@ -2,6 +2,8 @@
 
 #include "core/all_extern.hpp"
 
+#include <filesystem>
+
 namespace vk {
 class Instance;
 class Window;
@@ -18,6 +20,12 @@ class Device : public SharedObject<Device> {
     VkQueue &mainVkQueue();
     VkQueue &secondaryQueue();
 
+    // one pipeline cache shared by every pipeline created on this device, persisted to the given file. saving only
+    // writes when the cache grew since it was loaded or last saved
+    void loadPipelineCache(std::filesystem::path file);
+    void savePipelineCache();
+    VkPipelineCache &vkPipelineCache();
+
     bool hasExtendedDynamicState2LogicOp() const { return extendedDynamicState2LogicOp_; }
 
   private:
@@ -28,6 +36,9 @@ class Device : public SharedObject<Device> {
     VkDevice device_ = VK_NULL_HANDLE;
     VkQueue mainQueue_ = VK_NULL_HANDLE;
     VkQueue secondaryQueue_ = VK_NULL_HANDLE;
+    VkPipelineCache pipelineCache_ = VK_NULL_HANDLE;
+    std::filesystem::path pipelineCacheFile_;
+    size_t pipelineCacheSavedSize_ = 0; // of the file on disk
 
     bool extendedDynamicState2LogicOp_ = false;
 };
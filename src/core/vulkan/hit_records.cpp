@@ -0,0 +1,58 @@
+#include "core/vulkan/hit_records.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+vk::HitRecordTable::HitRecordTable(uint32_t handleSize, uint32_t handleAlignment, uint32_t firstHitGroup)
+    : handleSize_(handleSize),
+      stride_(alignedHandleSize(handleSize, handleAlignment)),
+      firstHitGroup_(firstHitGroup) {}
+
+vk::HitRecordTable::Update vk::HitRecordTable::update(const std::vector<uint32_t> &hitGroupIndices,
+                                                      const uint8_t *handleStorage,
+                                                      const Allocate &allocate) {
+    Update result{0, 0, false};
+
+    if (records_ == nullptr || capacity_ < hitGroupIndices.size()) {
+        capacity_ = std::max<uint64_t>(minRecordCapacity, hitGroupIndices.size() + hitGroupIndices.size() / 2);
+        records_ = allocate(capacity_ * stride_);
+        hitGroupIndices_.clear();
+        result.reallocated = true;
+    }
+
+    size_t first = hitGroupIndices.size(), last = 0;
+    for (size_t i = 0; i < hitGroupIndices.size(); ++i) {
+        uint32_t hitGroup = hitGroupIndices[i];
+        if (i < hitGroupIndices_.size() && hitGroupIndices_[i] == hitGroup) continue;
+
+        // the source handles are tightly packed, the records use the aligned stride
+        std::memcpy(records_ + i * stride_, handleStorage + (firstHitGroup_ + hitGroup) * handleSize_, handleSize_);
+
+        first = std::min(first, i);
+        last = i + 1;
+    }
+    hitGroupIndices_.assign(hitGroupIndices.begin(), hitGroupIndices.end());
+
+    if (last > first) {
+        result.dirtyOffset = first * stride_;
+        result.dirtySize = (last - first) * stride_;
+    }
+    return result;
+}
+
+uint32_t vk::HitRecordTable::stride() {
+    return stride_;
+}
+
+uint64_t vk::HitRecordTable::capacity() {
+    return capacity_;
+}
+
+uint64_t vk::HitRecordTable::size() {
+    return hitGroupIndices_.size() * stride_;
+}
+
+uint32_t vk::HitRecordTable::alignedHandleSize(uint32_t handleSize, uint32_t handleAlignment) {
+    if (handleAlignment == 0) return handleSize;
+    return (handleSize + handleAlignment - 1) & ~(handleAlignment - 1);
+}
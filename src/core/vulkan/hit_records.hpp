@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace vk {
+// cpu side of the hit shader binding table. the records are copied from the tightly packed group handles into a
+// persistent buffer with the aligned stride, a record is only rewritten when its hit group changed since the last
+// update. the buffer is only reallocated when the record count outgrows it, allocate hands back its mapped memory
+class HitRecordTable {
+  public:
+    static constexpr uint32_t minRecordCapacity = 1024;
+
+    using Allocate = std::function<uint8_t *(uint64_t size)>;
+
+    struct Update {
+        uint64_t dirtyOffset; // bytes written, to be flushed
+        uint64_t dirtySize;
+        bool reallocated;
+    };
+
+    // firstHitGroup is the group index of hit group 0, the raygen and miss groups come before it
+    HitRecordTable(uint32_t handleSize, uint32_t handleAlignment, uint32_t firstHitGroup);
+
+    Update update(const std::vector<uint32_t> &hitGroupIndices, const uint8_t *handleStorage, const Allocate &allocate);
+
+    uint32_t stride();
+    uint64_t capacity(); // records
+    uint64_t size();     // bytes used by the last update
+
+    static uint32_t alignedHandleSize(uint32_t handleSize, uint32_t handleAlignment);
+
+  private:
+    uint32_t handleSize_;
+    uint32_t stride_;
+    uint32_t firstHitGroup_;
+
+    uint8_t *records_ = nullptr;
+    uint64_t capacity_ = 0;
+    std::vector<uint32_t> hitGroupIndices_; // hit group of every record currently in the buffer
+};
+} // namespace vk
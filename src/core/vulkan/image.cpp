@@ -200,6 +200,7 @@ vk::DeviceLocalImage::DeviceLocalImage(std::shared_ptr<Device> device,
       width_(width),
       height_(height),
       layer_(layer),
+      mipLevels_(mipLevels),
       format_(format),
       persistStaging_(persistStaging),
       usage_(usage),
@@ -364,6 +365,10 @@ uint32_t vk::DeviceLocalImage::layer() {
     return layer_;
 }
 
+uint32_t vk::DeviceLocalImage::mipLevels() {
+    return mipLevels_;
+}
+
 VkFormat &vk::DeviceLocalImage::vkFormat() {
     return format_;
 }
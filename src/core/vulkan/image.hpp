@@ -158,6 +158,7 @@ class DeviceLocalImage : public Image, public SharedObject<DeviceLocalImage> {
     uint32_t width() override;
     uint32_t height() override;
     uint32_t layer() override;
+    uint32_t mipLevels();
     VkFormat &vkFormat() override;
     VkBuffer &vkStagingBuffer();
     VkImage &vkImage() override;
@@ -174,6 +175,7 @@ class DeviceLocalImage : public Image, public SharedObject<DeviceLocalImage> {
     uint32_t width_;
     uint32_t height_;
     uint32_t layer_;
+    uint32_t mipLevels_;
     VkFormat format_;
     bool persistStaging_;
     VkImageUsageFlags usage_;
@@ -40,8 +40,10 @@ VkBool32 debugCallback(VkDebugReportFlagsEXT flags,
     return VK_FALSE;
 }
 
-vk::Instance::Instance() {
-    GLFW_Init();
+vk::Instance::Instance() : Instance(false) {}
+
+vk::Instance::Instance(bool headless) : headless_(headless) {
+    if (!headless_) GLFW_Init();
 
     if (volkInitialize() != VK_SUCCESS) {
         printf("volkInitialize failed!\n");
@@ -58,18 +60,23 @@ vk::Instance::Instance() {
 
     std::set<std::string> extStorage;
 
-    // Get instance extensions required by GLFW to draw to window
-    unsigned int glfwExtensionCount;
-    const char **glfwExtensions;
-    glfwExtensions = GLFW_GetRequiredInstanceExtensions(&glfwExtensionCount);
+    if (headless_) {
+        extStorage.insert(VK_KHR_SURFACE_EXTENSION_NAME);
+        extStorage.insert(VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME);
+    } else {
+        // Get instance extensions required by GLFW to draw to window
+        unsigned int glfwExtensionCount;
+        const char **glfwExtensions;
+        glfwExtensions = GLFW_GetRequiredInstanceExtensions(&glfwExtensionCount);
 #ifdef DEBUG
-    instanceCout() << "glfw extensions:" << std::endl;
+        instanceCout() << "glfw extensions:" << std::endl;
 #endif
-    for (int i = 0; i < glfwExtensionCount; i++) {
+        for (int i = 0; i < glfwExtensionCount; i++) {
 #ifdef DEBUG
-        instanceCout() << "\t" << glfwExtensions[i] << std::endl;
+            instanceCout() << "\t" << glfwExtensions[i] << std::endl;
 #endif
-        extStorage.insert(glfwExtensions[i]);
+            extStorage.insert(glfwExtensions[i]);
+        }
     }
 
     // dlss extensions
@@ -169,4 +176,8 @@ vk::Instance::~Instance() {
 
 VkInstance &vk::Instance::vkInstance() {
     return instance_;
+}
+
+bool vk::Instance::headless() {
+    return headless_;
 }
\ No newline at end of file
@@ -6,12 +6,16 @@ namespace vk {
 class Instance : public SharedObject<Instance> {
   public:
     Instance();
+    // without glfw, surfaces come from VK_EXT_headless_surface
+    Instance(bool headless);
     ~Instance();
 
     VkInstance &vkInstance();
+    bool headless();
 
   private:
     VkInstance instance_;
+    bool headless_ = false;
     // VkDebugReportCallbackEXT callback_ = VK_NULL_HANDLE;
 };
 } // namespace vk
\ No newline at end of file
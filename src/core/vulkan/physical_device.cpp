@@ -73,31 +73,34 @@ void vk::PhysicalDevice::findPhysicalDevice() {
         exit(1);
     }
 
-    // find the first supported physical device
-    for (const auto &device : devices) {
-        if (isDeviceSuitable(device)) {
-            VkPhysicalDeviceProperties properties;
-            vkGetPhysicalDeviceProperties(device, &properties);
+    // find the first supported physical device, a headless run falls back to integrated and cpu implementations
+    // like lavapipe when there is no discrete gpu
+    for (int pass = 0; pass < (window_->headless() ? 2 : 1); pass++) {
+        for (const auto &device : devices) {
+            if (isDeviceSuitable(device)) {
+                VkPhysicalDeviceProperties properties;
+                vkGetPhysicalDeviceProperties(device, &properties);
 
-            if (properties.deviceType != VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) continue;
+                if (pass == 0 && properties.deviceType != VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) continue;
 
-            physicalDevice_ = device;
+                physicalDevice_ = device;
 #ifdef DEBUG
-            physicalDeviceCout() << "found suitable physical device" << std::endl;
+                physicalDeviceCout() << "found suitable physical device" << std::endl;
 #endif
 
-            // output device info
-            uint32_t supportedVersion[] = {VK_VERSION_MAJOR(properties.apiVersion),
-                                           VK_VERSION_MINOR(properties.apiVersion),
-                                           VK_VERSION_PATCH(properties.apiVersion)};
+                // output device info
+                uint32_t supportedVersion[] = {VK_VERSION_MAJOR(properties.apiVersion),
+                                               VK_VERSION_MINOR(properties.apiVersion),
+                                               VK_VERSION_PATCH(properties.apiVersion)};
 
 #ifdef DEBUG
-            physicalDeviceCout() << "selected device name: " << properties.deviceName << std::endl;
-            physicalDeviceCout() << "supports Vulkan version: " << supportedVersion[0] << "." << supportedVersion[1]
-                                 << "." << supportedVersion[2] << std::endl;
+                physicalDeviceCout() << "selected device name: " << properties.deviceName << std::endl;
+                physicalDeviceCout() << "supports Vulkan version: " << supportedVersion[0] << "." << supportedVersion[1]
+                                     << "." << supportedVersion[2] << std::endl;
 #endif
 
-            return;
+                return;
+            }
         }
     }
 
@@ -146,6 +149,10 @@ uint32_t vk::PhysicalDevice::secondaryQueueIndex() {
     return secondaryQueueIndex_;
 }
 
+uint32_t vk::PhysicalDevice::timestampValidBits(uint32_t queueIndex) {
+    return queueIndex < queueFamilies_.size() ? queueFamilies_[queueIndex].timestampValidBits : 0;
+}
+
 void vk::PhysicalDevice::findQueueFamilies() {
     uint32_t queueFamilyCount = 0;
     vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice_, &queueFamilyCount, nullptr);
@@ -225,6 +232,8 @@ void vk::PhysicalDevice::findQueueFamilies() {
         physicalDeviceCerr() << "No queue family that supports graphics, compute and transfer found." << std::endl;
         exit(EXIT_FAILURE);
     }
+
+    queueFamilies_ = std::move(queueFamilies);
 }
 
 VkPhysicalDeviceProperties vk::PhysicalDevice::properties() {
@@ -5,7 +5,10 @@
 #include "core/vulkan/render_pass.hpp"
 #include "core/vulkan/shader.hpp"
 
+#include <algorithm>
+#include <future>
 #include <iostream>
+#include <thread>
 #include <vector>
 
 std::ostream &graphicsPipelineCout() {
@@ -260,8 +263,8 @@ std::shared_ptr<vk::GraphicsPipeline> vk::GraphicsPipelineBuilder::build(std::sh
     pipelineCreateInfo.basePipelineIndex = -1;
 
     VkPipeline pipeline;
-    if (vkCreateGraphicsPipelines(device->vkDevice(), VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &pipeline) !=
-        VK_SUCCESS) {
+    if (vkCreateGraphicsPipelines(device->vkDevice(), device->vkPipelineCache(), 1, &pipelineCreateInfo, nullptr,
+                                  &pipeline) != VK_SUCCESS) {
         graphicsPipelineCerr() << "failed to create graphics pipeline" << std::endl;
         exit(EXIT_FAILURE);
     } else {
@@ -344,9 +347,40 @@ std::shared_ptr<vk::RayTracingPipeline> vk::RayTracingPipelineBuilder::build(std
     pipelineInfo.layout = pipelineLayout_;
     pipelineInfo.maxPipelineRayRecursionDepth = 16;
 
+    // the ray tracing pipeline links every hit and miss shader and dominates the startup time, a deferred operation
+    // lets the driver spread that compilation over worker threads
+    VkDeferredOperationKHR deferredOperation = VK_NULL_HANDLE;
+    if (vkCreateDeferredOperationKHR(device->vkDevice(), nullptr, &deferredOperation) != VK_SUCCESS) {
+        deferredOperation = VK_NULL_HANDLE;
+    }
+
     VkPipeline rtPipeline;
-    if (vkCreateRayTracingPipelinesKHR(device->vkDevice(), VK_NULL_HANDLE, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr,
-                                       &rtPipeline) != VK_SUCCESS) {
+    VkResult result = vkCreateRayTracingPipelinesKHR(device->vkDevice(), deferredOperation, device->vkPipelineCache(),
+                                                     1, &pipelineInfo, nullptr, &rtPipeline);
+    if (result == VK_OPERATION_DEFERRED_KHR) {
+        uint32_t workerCount = std::min(vkGetDeferredOperationMaxConcurrencyKHR(device->vkDevice(), deferredOperation),
+                                        std::max(1u, std::thread::hardware_concurrency()));
+        std::vector<std::future<void>> workers;
+        for (uint32_t i = 0; i < workerCount; i++) {
+            workers.push_back(std::async(std::launch::async, [&device, deferredOperation]() {
+                while (vkDeferredOperationJoinKHR(device->vkDevice(), deferredOperation) == VK_THREAD_IDLE_KHR) {
+                    std::this_thread::yield();
+                }
+            }));
+        }
+        for (auto &worker : workers) { worker.get(); }
+
+        while ((result = vkGetDeferredOperationResultKHR(device->vkDevice(), deferredOperation)) == VK_NOT_READY) {
+            vkDeferredOperationJoinKHR(device->vkDevice(), deferredOperation);
+        }
+    } else if (result == VK_OPERATION_NOT_DEFERRED_KHR) {
+        result = VK_SUCCESS;
+    }
+    if (deferredOperation != VK_NULL_HANDLE) {
+        vkDestroyDeferredOperationKHR(device->vkDevice(), deferredOperation, nullptr);
+    }
+
+    if (result != VK_SUCCESS) {
         std::cerr << "Cannot build ray tracing pipeline" << std::endl;
         exit(EXIT_FAILURE);
     }
@@ -375,7 +409,7 @@ std::shared_ptr<vk::ComputePipeline> vk::ComputePipelineBuilder::build(std::shar
     computePipelineCreateInfo.layout = pipelineLayout_;
 
     VkPipeline compPipeline;
-    if (vkCreateComputePipelines(device->vkDevice(), VK_NULL_HANDLE, 1, &computePipelineCreateInfo, nullptr,
+    if (vkCreateComputePipelines(device->vkDevice(), device->vkPipelineCache(), 1, &computePipelineCreateInfo, nullptr,
                                  &compPipeline) != VK_SUCCESS) {
         std::cerr << "Cannot build compute pipeline" << std::endl;
         exit(EXIT_FAILURE);
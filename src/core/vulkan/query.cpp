@@ -0,0 +1,63 @@
+#include "core/vulkan/query.hpp"
+
+#include "core/vulkan/command.hpp"
+#include "core/vulkan/device.hpp"
+
+#include <iostream>
+
+std::ostream &queryPoolCout() {
+    return std::cout << "[QueryPool] ";
+}
+
+std::ostream &queryPoolCerr() {
+    return std::cerr << "[QueryPool] ";
+}
+
+vk::QueryPool::QueryPool(std::shared_ptr<Device> device, VkQueryType queryType, uint32_t queryCount)
+    : device_(device), queryType_(queryType), queryCount_(queryCount) {
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = queryType_;
+    queryPoolInfo.queryCount = queryCount_;
+
+    if (vkCreateQueryPool(device_->vkDevice(), &queryPoolInfo, nullptr, &queryPool_) != VK_SUCCESS) {
+        queryPoolCerr() << "failed to create query pool" << std::endl;
+        exit(EXIT_FAILURE);
+    } else {
+#ifdef DEBUG
+        queryPoolCout() << "created query pool" << std::endl;
+#endif
+    }
+}
+
+vk::QueryPool::~QueryPool() {
+    vkDestroyQueryPool(device_->vkDevice(), queryPool_, nullptr);
+}
+
+VkQueryPool &vk::QueryPool::vkQueryPool() {
+    return queryPool_;
+}
+
+VkQueryType vk::QueryPool::queryType() {
+    return queryType_;
+}
+
+uint32_t vk::QueryPool::queryCount() {
+    return queryCount_;
+}
+
+void vk::QueryPool::reset(std::shared_ptr<CommandBuffer> commandBuffer, uint32_t firstQuery, uint32_t count) {
+    vkCmdResetQueryPool(commandBuffer->vkCommandBuffer(), queryPool_, firstQuery, count);
+}
+
+bool vk::QueryPool::results(uint32_t firstQuery, uint32_t count, std::vector<uint64_t> &results, bool wait) {
+    results.resize(count);
+    if (count == 0) return true;
+
+    VkQueryResultFlags flags = VK_QUERY_RESULT_64_BIT;
+    if (wait) flags |= VK_QUERY_RESULT_WAIT_BIT;
+
+    VkResult result = vkGetQueryPoolResults(device_->vkDevice(), queryPool_, firstQuery, count,
+                                            count * sizeof(uint64_t), results.data(), sizeof(uint64_t), flags);
+    return result == VK_SUCCESS;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "core/all_extern.hpp"
+
+#include <vector>
+
+namespace vk {
+class Device;
+class CommandBuffer;
+
+class QueryPool : public SharedObject<QueryPool> {
+  public:
+    QueryPool(std::shared_ptr<Device> device, VkQueryType queryType, uint32_t queryCount);
+    ~QueryPool();
+
+    VkQueryPool &vkQueryPool();
+    VkQueryType queryType();
+    uint32_t queryCount();
+
+    void reset(std::shared_ptr<CommandBuffer> commandBuffer, uint32_t firstQuery, uint32_t count);
+    // returns false if any of the queries is not available yet
+    bool results(uint32_t firstQuery, uint32_t count, std::vector<uint64_t> &results, bool wait = false);
+
+  private:
+    std::shared_ptr<Device> device_;
+
+    VkQueryType queryType_;
+    uint32_t queryCount_;
+    VkQueryPool queryPool_ = VK_NULL_HANDLE;
+};
+}; // namespace vk
@@ -0,0 +1,94 @@
+#include "core/vulkan/range_allocator.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+vk::RangeAllocator::RangeAllocator(uint64_t capacity, uint64_t alignment)
+    : capacity_(capacity), alignment_(std::max<uint64_t>(alignment, 1)) {
+    if (capacity_ > 0) insertFreeRange(0, capacity_);
+}
+
+uint64_t vk::RangeAllocator::bestFit(uint64_t size) {
+    auto iter = freeBySize_.lower_bound(alignedSize(size, alignment_));
+    return iter == freeBySize_.end() ? 0 : iter->first;
+}
+
+uint64_t vk::RangeAllocator::allocate(uint64_t size) {
+    size = alignedSize(size, alignment_);
+
+    auto iter = freeBySize_.lower_bound(size);
+    if (iter == freeBySize_.end()) return invalidOffset;
+
+    uint64_t rangeOffset = iter->second;
+    uint64_t rangeSize = iter->first;
+    eraseFreeRange(freeByOffset_.find(rangeOffset));
+    if (rangeSize > size) insertFreeRange(rangeOffset + size, rangeSize - size);
+    allocationCount_++;
+
+    return rangeOffset;
+}
+
+void vk::RangeAllocator::free(uint64_t offset, uint64_t size) {
+    // coalesce with the neighbours
+    auto next = freeByOffset_.lower_bound(offset);
+    if (next != freeByOffset_.end() && next->first == offset + size) {
+        size += next->second;
+        next = std::next(next);
+        eraseFreeRange(std::prev(next));
+    }
+    if (next != freeByOffset_.begin()) {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset) {
+            offset = prev->first;
+            size += prev->second;
+            eraseFreeRange(prev);
+        }
+    }
+    insertFreeRange(offset, size);
+    allocationCount_--;
+}
+
+uint64_t vk::RangeAllocator::capacity() {
+    return capacity_;
+}
+
+uint32_t vk::RangeAllocator::allocationCount() {
+    return allocationCount_;
+}
+
+vk::RangeAllocator::Stats vk::RangeAllocator::stats() {
+    Stats stats{};
+    stats.allocationCount = allocationCount_;
+    stats.freeRangeCount = freeByOffset_.size();
+    for (auto &[offset, size] : freeByOffset_) {
+        stats.freeBytes += size;
+        stats.largestFreeRange = std::max(stats.largestFreeRange, size);
+    }
+    stats.fragmentation = fragmentation(stats.largestFreeRange, stats.freeBytes);
+    return stats;
+}
+
+uint64_t vk::RangeAllocator::alignedSize(uint64_t size, uint64_t alignment) {
+    alignment = std::max<uint64_t>(alignment, 1);
+    return std::max<uint64_t>((size + alignment - 1) / alignment * alignment, alignment);
+}
+
+float vk::RangeAllocator::fragmentation(uint64_t largestFreeRange, uint64_t freeBytes) {
+    return freeBytes == 0 ? 0.0f : 1.0f - static_cast<float>(largestFreeRange) / freeBytes;
+}
+
+void vk::RangeAllocator::insertFreeRange(uint64_t offset, uint64_t size) {
+    freeByOffset_[offset] = size;
+    freeBySize_.emplace(size, offset);
+}
+
+void vk::RangeAllocator::eraseFreeRange(std::map<uint64_t, uint64_t>::iterator iter) {
+    auto [first, last] = freeBySize_.equal_range(iter->second);
+    for (auto bySize = first; bySize != last; bySize++) {
+        if (bySize->second == iter->first) {
+            freeBySize_.erase(bySize);
+            break;
+        }
+    }
+    freeByOffset_.erase(iter);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+
+namespace vk {
+// best-fit free list over [0, capacity), adjacent free ranges are coalesced. sizes are rounded up to the alignment, so
+// every handed out offset stays aligned. it only does the bookkeeping, the memory itself belongs to the caller
+class RangeAllocator {
+  public:
+    static constexpr uint64_t invalidOffset = ~0ull;
+
+    struct Stats {
+        uint32_t allocationCount;
+        uint32_t freeRangeCount;
+        uint64_t freeBytes;
+        uint64_t largestFreeRange;
+        float fragmentation; // 1 - largest free range / all free bytes
+    };
+
+    RangeAllocator(uint64_t capacity, uint64_t alignment);
+
+    // size of the free range allocate would take for the size, 0 when none fits
+    uint64_t bestFit(uint64_t size);
+    // invalidOffset once no free range fits, free takes the aligned size
+    uint64_t allocate(uint64_t size);
+    void free(uint64_t offset, uint64_t size);
+
+    uint64_t capacity();
+    uint32_t allocationCount();
+    Stats stats();
+
+    static uint64_t alignedSize(uint64_t size, uint64_t alignment);
+    static float fragmentation(uint64_t largestFreeRange, uint64_t freeBytes);
+
+  private:
+    void insertFreeRange(uint64_t offset, uint64_t size);
+    void eraseFreeRange(std::map<uint64_t, uint64_t>::iterator iter);
+
+    uint64_t capacity_;
+    uint64_t alignment_;
+    uint32_t allocationCount_ = 0;
+    std::map<uint64_t, uint64_t> freeByOffset_;    // offset -> size
+    std::multimap<uint64_t, uint64_t> freeBySize_; // size -> offset
+};
+}; // namespace vk
@@ -6,20 +6,19 @@
 #include "core/vulkan/pipeline.hpp"
 #include "core/vulkan/vma.hpp"
 
-#include <cstring>
 #include <vector>
 
-uint32_t align(uint32_t addr, uint32_t alignment) {
-    return (addr + alignment - 1) & ~(alignment - 1);
-}
-
 vk::SBT::SBT(std::shared_ptr<PhysicalDevice> physicalDevice,
              std::shared_ptr<Device> device,
              std::shared_ptr<VMA> vma,
              std::shared_ptr<RayTracingPipeline> pipeline,
              uint32_t missCount,
              uint32_t hitCount)
-    : vma_(vma), device_(device), missCount_(missCount) {
+    : vma_(vma),
+      device_(device),
+      hitRecords_(physicalDevice->rayTracingProperties().shaderGroupHandleSize,
+                  physicalDevice->rayTracingProperties().shaderGroupHandleAlignment,
+                  1 + missCount) {
     VkPhysicalDeviceRayTracingPipelinePropertiesKHR rtProperties = physicalDevice->rayTracingProperties();
 
     handleSize_ = rtProperties.shaderGroupHandleSize;
@@ -31,8 +30,7 @@ vk::SBT::SBT(std::shared_ptr<PhysicalDevice> physicalDevice,
               #endif
     uint32_t groupCount = 1 + missCount + hitCount; // RayGen(1) + Miss + HitGroup
 
-    alignedHandleSize_ = handleSize_;
-    if (handleAlignment > 0) { alignedHandleSize_ = align(handleSize_, handleAlignment); }
+    alignedHandleSize_ = HitRecordTable::alignedHandleSize(handleSize_, handleAlignment);
 
     shaderHandleStorage_.resize(groupCount * handleSize_);
     vkGetRayTracingShaderGroupHandlesKHR(device->vkDevice(), pipeline->vkPipeline(), 0, groupCount,
@@ -57,41 +55,28 @@ vk::SBT::SBT(std::shared_ptr<PhysicalDevice> physicalDevice,
 
     missRegion_.deviceAddress = rmissSBT_->bufferAddress(); // 紧接RayGen后
     missRegion_.stride = alignedHandleSize_;
-    missRegion_.size = alignedHandleSize_ * missCount_;
+    missRegion_.size = alignedHandleSize_ * missCount;
 }
 
 vk::SBT::~SBT() {}
 
 void vk::SBT::setupHitSBT(std::vector<uint32_t> &hitGroupIndices) {
-    VkDeviceSize rhitSBTSize = hitGroupIndices.size() * alignedHandleSize_;
-    if (rhitSBTSize == 0) {
+    if (hitGroupIndices.empty()) {
         std::cerr << "Hit group should contains something!" << std::endl;
         exit(1);
     }
 
-    std::vector<uint8_t> cachedRhitSBT(rhitSBTSize, 0);
-    for (uint32_t i = 0; i < hitGroupIndices.size(); ++i) {
-        uint32_t hit_group_id = hitGroupIndices[i];
-
-        // Access source storage using handleSize_ (tightly packed)
-        uint32_t palette_offset = (1 + missCount_ + hit_group_id) * handleSize_;
-        uint8_t *pSourceHandle = shaderHandleStorage_.data() + palette_offset;
-
-        // Write to destination SBT using alignedHandleSize_ (stride requirement)
-        uint8_t *pDest = cachedRhitSBT.data() + i * alignedHandleSize_;
-        memcpy(pDest, pSourceHandle, handleSize_);
-    }
-
-    rhitSBT_ = HostVisibleBuffer::create(
-        vma_, device_, rhitSBTSize,
-        VK_BUFFER_USAGE_SHADER_BINDING_TABLE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, baseAlignment_);
-
-    rhitSBT_->uploadToBuffer(cachedRhitSBT.data());
-    rhitSBT_->flush();
+    auto update = hitRecords_.update(hitGroupIndices, shaderHandleStorage_.data(), [this](uint64_t size) {
+        rhitSBT_ = HostVisibleBuffer::create(
+            vma_, device_, size,
+            VK_BUFFER_USAGE_SHADER_BINDING_TABLE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, baseAlignment_);
+        return static_cast<uint8_t *>(rhitSBT_->mappedPtr());
+    });
+    if (update.dirtySize > 0) { rhitSBT_->flush(update.dirtySize, update.dirtyOffset); }
 
     hitRegion_.deviceAddress = rhitSBT_->bufferAddress();
     hitRegion_.stride = alignedHandleSize_;
-    hitRegion_.size = rhitSBTSize;
+    hitRegion_.size = hitRecords_.size();
 }
 
 VkStridedDeviceAddressRegionKHR &vk::SBT::raygenRegion() {
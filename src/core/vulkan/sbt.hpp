@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/all_extern.hpp"
+#include "core/vulkan/hit_records.hpp"
 
 #include <vector>
 
@@ -21,6 +22,8 @@ class SBT : public SharedObject<SBT> {
         uint32_t hitCount);
     ~SBT();
 
+    // the hit table persists and only grows, records are only rewritten where the hit group changed since the last
+    // call, so callers must not reuse an SBT while a previous trace through it may still be in flight
     void setupHitSBT(std::vector<uint32_t> &hitGroupIndices);
 
     VkStridedDeviceAddressRegionKHR &raygenRegion();
@@ -35,7 +38,6 @@ class SBT : public SharedObject<SBT> {
     uint32_t handleSize_;
     uint32_t alignedHandleSize_;
     uint32_t baseAlignment_;
-    uint32_t missCount_;
 
     std::vector<uint8_t> shaderHandleStorage_;
 
@@ -47,5 +49,6 @@ class SBT : public SharedObject<SBT> {
     std::shared_ptr<HostVisibleBuffer> rgenSBT_;
     std::shared_ptr<HostVisibleBuffer> rmissSBT_;
     std::shared_ptr<HostVisibleBuffer> rhitSBT_;
+    HitRecordTable hitRecords_;
 };
 }; // namespace vk
\ No newline at end of file
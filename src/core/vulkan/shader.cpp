@@ -2,8 +2,12 @@
 
 #include "core/vulkan/device.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <future>
 #include <iostream>
+#include <thread>
 #include <vector>
 
 std::ostream &shaderCout() {
@@ -14,21 +18,84 @@ std::ostream &shaderCerr() {
     return std::cerr << "[Shader] ";
 }
 
-vk::Shader::Shader(std::shared_ptr<Device> device, std::string filePath) : device_(device), filePath_(filePath) {
+std::mutex vk::ShaderCache::mutex_;
+std::unordered_map<std::string, vk::ShaderCache::Entry> vk::ShaderCache::entries_;
+
+vk::ShaderCache::Blob vk::ShaderCache::load(const std::filesystem::path &filePath) {
+    std::error_code error;
+    std::filesystem::file_time_type lastWriteTime = std::filesystem::last_write_time(filePath, error);
+    if (error) { return nullptr; }
+
+    std::string key = filePath.lexically_normal().string();
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it != entries_.end() && it->second.lastWriteTime == lastWriteTime) { return it->second.blob; }
+    }
+
+    // read outside of the lock, two threads racing on the same file both read it and the later one wins
+    Blob blob = read(filePath);
+    if (blob == nullptr) { return nullptr; }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    entries_[key] = {lastWriteTime, blob};
+    return blob;
+}
+
+void vk::ShaderCache::prefetch(const std::filesystem::path &directory) {
+    std::vector<std::filesystem::path> files;
+    std::error_code error;
+    for (auto it = std::filesystem::recursive_directory_iterator(directory, error);
+         !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+        if (it->is_regular_file() && it->path().extension() == ".spv") { files.push_back(it->path()); }
+    }
+    if (files.empty()) return;
+
+    uint32_t workerCount =
+        std::min<uint32_t>(std::max(1u, std::thread::hardware_concurrency()), static_cast<uint32_t>(files.size()));
+    std::atomic<size_t> next = 0;
+    std::vector<std::future<void>> workers;
+    for (uint32_t i = 0; i < workerCount; i++) {
+        workers.push_back(std::async(std::launch::async, [&files, &next]() {
+            for (size_t j = next++; j < files.size(); j = next++) {
+                if (load(files[j]) == nullptr) { shaderCerr() << "invalid spir-v: " << files[j] << std::endl; }
+            }
+        }));
+    }
+    for (auto &worker : workers) { worker.get(); }
+
+#ifdef DEBUG
+    shaderCout() << "prefetched " << files.size() << " shaders on " << workerCount << " threads" << std::endl;
+#endif
+}
+
+vk::ShaderCache::Blob vk::ShaderCache::read(const std::filesystem::path &filePath) {
+    constexpr uint32_t spirvMagicNumber = 0x07230203;
+
     std::ifstream file(filePath, std::ios::ate | std::ios::binary);
-    if (!file.is_open()) {
-        shaderCerr() << "Cannot open file: " << filePath << std::endl;
+    if (!file.is_open()) { return nullptr; }
+    size_t size = file.tellg();
+    if (size == 0 || size % sizeof(uint32_t) != 0) { return nullptr; }
+
+    auto words = std::make_shared<std::vector<uint32_t>>(size / sizeof(uint32_t));
+    file.seekg(0, std::ios::beg);
+    file.read(reinterpret_cast<char *>(words->data()), size);
+    if (!file || words->front() != spirvMagicNumber) { return nullptr; }
+
+    return words;
+}
+
+vk::Shader::Shader(std::shared_ptr<Device> device, std::string filePath) : device_(device), filePath_(filePath) {
+    ShaderCache::Blob code = ShaderCache::load(filePath);
+    if (code == nullptr) {
+        shaderCerr() << "Cannot open file or not spir-v: " << filePath << std::endl;
         exit(EXIT_FAILURE);
     }
-    std::vector<char> fileBytes(file.tellg());
-    file.seekg(0, std::ios::beg);
-    file.read(fileBytes.data(), fileBytes.size());
-    file.close();
 
     VkShaderModuleCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    createInfo.codeSize = fileBytes.size();
-    createInfo.pCode = (uint32_t *)fileBytes.data();
+    createInfo.codeSize = code->size() * sizeof(uint32_t);
+    createInfo.pCode = code->data();
 
     if (vkCreateShaderModule(device->vkDevice(), &createInfo, nullptr, &shader_) != VK_SUCCESS) {
         shaderCerr() << "failed to create shader module for " << filePath << std::endl;
@@ -46,4 +113,4 @@ vk::Shader::~Shader() {
 
 VkShaderModule &vk::Shader::vkShaderModule() {
     return shader_;
-}
\ No newline at end of file
+}
@@ -2,11 +2,39 @@
 
 #include "core/all_extern.hpp"
 
+#include <filesystem>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace vk {
 class Device;
 
+// process wide cache of validated spir-v blobs keyed by path, an entry is reread once the modification time of its
+// file changes, so rebuilding the pipelines after a resize or a shader hot swap only touches the files that changed
+class ShaderCache {
+  public:
+    using Blob = std::shared_ptr<const std::vector<uint32_t>>;
+
+    // nullptr if the file cannot be read or is not spir-v
+    static Blob load(const std::filesystem::path &filePath);
+
+    // reads and validates every .spv file below the directory on worker threads
+    static void prefetch(const std::filesystem::path &directory);
+
+  private:
+    struct Entry {
+        std::filesystem::file_time_type lastWriteTime;
+        Blob blob;
+    };
+
+    static Blob read(const std::filesystem::path &filePath);
+
+    static std::mutex mutex_;
+    static std::unordered_map<std::string, Entry> entries_;
+};
+
 class Shader : public SharedObject<Shader> {
   public:
     Shader(std::shared_ptr<Device> device, std::string filePath);
@@ -20,4 +48,4 @@ class Shader : public SharedObject<Shader> {
     std::string filePath_;
     VkShaderModule shader_;
 };
-}; // namespace vk
\ No newline at end of file
+}; // namespace vk
@@ -0,0 +1,129 @@
+#include "core/vulkan/staging_ring.hpp"
+
+#include "core/vulkan/buffer.hpp"
+#include "core/vulkan/device.hpp"
+#include "core/vulkan/vma.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <iostream>
+
+std::ostream &stagingRingCout() {
+    return std::cout << "[StagingRing] ";
+}
+
+std::ostream &stagingRingCerr() {
+    return std::cerr << "[StagingRing] ";
+}
+
+void vk::StagingRing::Allocation::flush() {
+    if (buffer != nullptr && size > 0) { buffer->flush(size, offset); }
+}
+
+vk::StagingRing::StagingRing(std::shared_ptr<VMA> vma, std::shared_ptr<Device> device, uint32_t frameCount)
+    : StagingRing(vma, device, frameCount, 0) {}
+
+vk::StagingRing::StagingRing(std::shared_ptr<VMA> vma,
+                             std::shared_ptr<Device> device,
+                             uint32_t frameCount,
+                             VkDeviceSize frameLimit)
+    : vma_(vma), device_(device), regions_(frameCount), frameLimit_(frameLimit) {}
+
+// the caller guarantees that the fence of this frame context signaled, so everything the region handed out before
+// has been consumed by the gpu
+void vk::StagingRing::beginFrame(uint32_t frameIndex) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    Region &region = regions_[frameIndex];
+
+    average_ = average_ * 0.95 + static_cast<double>(region.used) * 0.05;
+    windowPeak_ = std::max(windowPeak_, region.used);
+    if (++windowFrames_ >= peakWindow) {
+        peak_ = windowPeak_;
+        windowPeak_ = 0;
+        windowFrames_ = 0;
+    } else {
+        peak_ = std::max(peak_, region.used);
+    }
+
+    VkDeviceSize target = std::max(minRegionSize, std::bit_ceil(peak_ + peak_ / 4));
+    if (frameLimit_ > 0) { target = std::min(target, std::max(minRegionSize, frameLimit_)); }
+    if (region.buffer == nullptr || region.buffer->size() < target || region.buffer->size() > target * 2) {
+        region.buffer = createBuffer(target);
+
+#ifdef DEBUG
+        stagingRingCout() << "resized region " << frameIndex << " to " << target << " bytes (peak " << peak_ << ")"
+                          << std::endl;
+#endif
+    }
+
+    region.head = 0;
+    region.overflow.clear();
+    region.overflowHead = 0;
+    region.used = 0;
+    current_ = frameIndex;
+}
+
+vk::StagingRing::Allocation vk::StagingRing::allocate(VkDeviceSize size, VkDeviceSize alignment) {
+    if (size == 0) { return {}; }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    Region &region = regions_[current_];
+
+    // a single allocation larger than the limit is still served when it is the first one of the frame
+    if (frameLimit_ > 0 && region.used > 0 && region.used + size > frameLimit_) { return {}; }
+
+    Allocation allocation{};
+    allocation.size = size;
+
+    VkDeviceSize offset = (region.head + alignment - 1) & ~(alignment - 1);
+    if (region.buffer != nullptr && offset + size <= region.buffer->size()) {
+        region.used += offset + size - region.head;
+        region.head = offset + size;
+        allocation.buffer = region.buffer;
+        allocation.offset = offset;
+    } else {
+        // the region ran full this frame, spill into a dedicated buffer that lives until the region is rewound,
+        // the recorded usage lets the next beginFrame grow the region instead
+        offset = (region.overflowHead + alignment - 1) & ~(alignment - 1);
+        if (region.overflow.empty() || offset + size > region.overflow.back()->size()) {
+            region.overflow.push_back(createBuffer(std::max(size, minRegionSize)));
+            offset = 0;
+        }
+        region.used += size + alignment;
+        region.overflowHead = offset + size;
+        allocation.buffer = region.overflow.back();
+        allocation.offset = offset;
+    }
+
+    allocation.mappedPtr = static_cast<uint8_t *>(allocation.buffer->mappedPtr()) + allocation.offset;
+    return allocation;
+}
+
+vk::StagingRing::Allocation vk::StagingRing::upload(const void *src, VkDeviceSize size, VkDeviceSize alignment) {
+    Allocation allocation = allocate(size, alignment);
+    if (allocation.buffer == nullptr) { return allocation; }
+
+    std::memcpy(allocation.mappedPtr, src, size);
+    allocation.flush();
+    return allocation;
+}
+
+vk::StagingRing::Stats vk::StagingRing::stats() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    Region &region = regions_[current_];
+    return {
+        .capacity = region.buffer == nullptr ? 0 : region.buffer->size(),
+        .used = region.used,
+        .peak = peak_,
+        .average = static_cast<VkDeviceSize>(average_),
+        .overflowCount = static_cast<uint32_t>(region.overflow.size()),
+    };
+}
+
+std::shared_ptr<vk::HostVisibleBuffer> vk::StagingRing::createBuffer(VkDeviceSize size) {
+    return HostVisibleBuffer::create(vma_, device_, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "core/all_extern.hpp"
+
+#include <mutex>
+#include <vector>
+
+namespace vk {
+class VMA;
+class Device;
+class HostVisibleBuffer;
+
+// host visible upload memory with one linear region per frame context, a region is rewound once the fence of its
+// context signaled and is resized from the peak usage observed over the last frames, with a frame limit set the
+// ring refuses allocations past it and the caller has to retry in a later frame
+class StagingRing : public SharedObject<StagingRing> {
+  public:
+    struct Allocation {
+        std::shared_ptr<HostVisibleBuffer> buffer;
+        VkDeviceSize offset = 0;
+        VkDeviceSize size = 0;
+        void *mappedPtr = nullptr;
+
+        void flush();
+    };
+
+    struct Stats {
+        VkDeviceSize capacity;  // of the current region
+        VkDeviceSize used;      // by the current frame, overflow included
+        VkDeviceSize peak;      // over the observation window
+        VkDeviceSize average;   // moving average of the per frame usage
+        uint32_t overflowCount; // overflow buffers of the current frame
+    };
+
+    StagingRing(std::shared_ptr<VMA> vma, std::shared_ptr<Device> device, uint32_t frameCount);
+    StagingRing(std::shared_ptr<VMA> vma,
+                std::shared_ptr<Device> device,
+                uint32_t frameCount,
+                VkDeviceSize frameLimit);
+
+    void beginFrame(uint32_t frameIndex);
+
+    Allocation allocate(VkDeviceSize size, VkDeviceSize alignment = defaultAlignment);
+    Allocation upload(const void *src, VkDeviceSize size, VkDeviceSize alignment = defaultAlignment);
+
+    Stats stats();
+
+  private:
+    static constexpr VkDeviceSize defaultAlignment = 16;
+    static constexpr VkDeviceSize minRegionSize = 4 * 1024 * 1024;
+    static constexpr uint32_t peakWindow = 120; // frames a peak is remembered before the region may shrink
+
+    struct Region {
+        std::shared_ptr<HostVisibleBuffer> buffer;
+        VkDeviceSize head = 0;
+        std::vector<std::shared_ptr<HostVisibleBuffer>> overflow;
+        VkDeviceSize overflowHead = 0;
+        VkDeviceSize used = 0;
+    };
+
+    std::shared_ptr<HostVisibleBuffer> createBuffer(VkDeviceSize size);
+
+    std::shared_ptr<VMA> vma_;
+    std::shared_ptr<Device> device_;
+
+    std::vector<Region> regions_;
+    uint32_t current_ = 0;
+    VkDeviceSize frameLimit_ = 0; // 0 for no limit
+
+    VkDeviceSize peak_ = 0;
+    double average_ = 0.0;
+    VkDeviceSize windowPeak_ = 0;
+    uint32_t windowFrames_ = 0;
+
+    std::mutex mutex_;
+};
+}; // namespace vk
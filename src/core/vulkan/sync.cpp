@@ -33,4 +33,55 @@ vk::Fence::~Fence() {
 
 VkFence &vk::Fence::vkFence() {
     return fence_;
-}
\ No newline at end of file
+}
+
+vk::TimelineSemaphore::TimelineSemaphore(std::shared_ptr<Device> device) : device_(device) {
+    VkSemaphoreTypeCreateInfo typeInfo{};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &typeInfo;
+
+    vkCreateSemaphore(device_->vkDevice(), &semaphoreInfo, nullptr, &semaphore_);
+}
+
+vk::TimelineSemaphore::~TimelineSemaphore() {
+    vkDestroySemaphore(device_->vkDevice(), semaphore_, nullptr);
+}
+
+uint64_t vk::TimelineSemaphore::advance() {
+    return ++submitted_;
+}
+
+uint64_t vk::TimelineSemaphore::submitted() {
+    return submitted_;
+}
+
+uint64_t vk::TimelineSemaphore::completed() {
+    uint64_t value = 0;
+    vkGetSemaphoreCounterValue(device_->vkDevice(), semaphore_, &value);
+    return value;
+}
+
+bool vk::TimelineSemaphore::reached(uint64_t value) {
+    return value == 0 || completed() >= value;
+}
+
+bool vk::TimelineSemaphore::wait(uint64_t value, uint64_t timeout) {
+    if (value == 0) return true;
+
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &semaphore_;
+    waitInfo.pValues = &value;
+
+    return vkWaitSemaphores(device_->vkDevice(), &waitInfo, timeout) == VK_SUCCESS;
+}
+
+VkSemaphore &vk::TimelineSemaphore::vkSemaphore() {
+    return semaphore_;
+}
@@ -2,6 +2,8 @@
 
 #include "core/all_extern.hpp"
 
+#include <atomic>
+
 namespace vk {
 class Device;
 
@@ -31,4 +33,28 @@ class Fence : public SharedObject<Fence> {
 
     VkFence fence_;
 };
+
+// a counter shared by the host and one queue, every submission on that queue signals the next value so completion is
+// a comparison against the counter instead of a fence per submission
+class TimelineSemaphore : public SharedObject<TimelineSemaphore> {
+  public:
+    TimelineSemaphore(std::shared_ptr<Device> device);
+    ~TimelineSemaphore();
+
+    // reserves the value the next submission signals
+    uint64_t advance();
+    // the last value handed out by advance, reached once all submissions so far completed
+    uint64_t submitted();
+    uint64_t completed();
+    bool reached(uint64_t value);
+    bool wait(uint64_t value, uint64_t timeout = UINT64_MAX);
+
+    VkSemaphore &vkSemaphore();
+
+  private:
+    std::shared_ptr<Device> device_;
+
+    VkSemaphore semaphore_;
+    std::atomic<uint64_t> submitted_ = 0;
+};
 }; // namespace vk
\ No newline at end of file
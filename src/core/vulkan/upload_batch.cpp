@@ -0,0 +1,61 @@
+#include "core/vulkan/upload_batch.hpp"
+
+#include "core/vulkan/buffer.hpp"
+#include "core/vulkan/command.hpp"
+
+#include <vector>
+
+namespace {
+struct CommandBufferRecorder {
+    std::shared_ptr<vk::CommandBuffer> cmdBuffer;
+    std::vector<VkBufferCopy> regions;
+
+    void preBarrier(VkPipelineStageFlags2 dstStageMask) {
+        // the destinations may still be read or written by the previous copies and consumers that used them
+        cmdBuffer->barriersMemory({{
+            .srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT | dstStageMask,
+            .srcAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
+            .dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+            .dstAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT,
+        }});
+    }
+
+    void copy(VkBuffer src, VkBuffer dst, const std::vector<vk::CopyPlan<VkBuffer>::CopyRegion> &planRegions) {
+        regions.clear();
+        for (auto &region : planRegions) { regions.push_back({region.srcOffset, region.dstOffset, region.size}); }
+        vkCmdCopyBuffer(cmdBuffer->vkCommandBuffer(), src, dst, regions.size(), regions.data());
+    }
+
+    void postBarrier(VkPipelineStageFlags2 dstStageMask) {
+        cmdBuffer->barriersMemory({{
+            .srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+            .srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT,
+            .dstStageMask = dstStageMask,
+            .dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
+        }});
+    }
+};
+} // namespace
+
+void vk::UploadBatch::add(std::shared_ptr<Buffer> src,
+                          VkDeviceSize srcOffset,
+                          std::shared_ptr<Buffer> dst,
+                          VkDeviceSize dstOffset,
+                          VkDeviceSize size,
+                          VkPipelineStageFlags2 dstStageMask) {
+    if (size == 0) return;
+    plan_.add(src->vkBuffer(), srcOffset, dst->vkBuffer(), dstOffset, size, dstStageMask);
+    buffers_.push_back(src);
+    buffers_.push_back(dst);
+}
+
+bool vk::UploadBatch::empty() {
+    return plan_.empty();
+}
+
+vk::UploadBatch::Stats vk::UploadBatch::record(std::shared_ptr<CommandBuffer> cmdBuffer) {
+    CommandBufferRecorder recorder{cmdBuffer};
+    Stats stats = plan_.record(recorder);
+    buffers_.clear();
+    return stats;
+}
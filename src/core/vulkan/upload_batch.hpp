@@ -0,0 +1,32 @@
+#pragma once
+
+#include "core/all_extern.hpp"
+#include "core/vulkan/copy_plan.hpp"
+
+#include <vector>
+
+namespace vk {
+class Buffer;
+class CommandBuffer;
+
+// collects the buffer copies of one upload pass and records them between a single global pre and post barrier,
+// copies between the same pair of buffers share one vkCmdCopyBuffer and adjacent regions are merged, see CopyPlan
+class UploadBatch {
+  public:
+    using Stats = CopyPlan<VkBuffer>::Stats;
+
+    void add(std::shared_ptr<Buffer> src,
+             VkDeviceSize srcOffset,
+             std::shared_ptr<Buffer> dst,
+             VkDeviceSize dstOffset,
+             VkDeviceSize size,
+             VkPipelineStageFlags2 dstStageMask);
+    bool empty();
+
+    Stats record(std::shared_ptr<CommandBuffer> cmdBuffer);
+
+  private:
+    CopyPlan<VkBuffer> plan_;
+    std::vector<std::shared_ptr<Buffer>> buffers_; // kept alive until the copies are recorded
+};
+}; // namespace vk
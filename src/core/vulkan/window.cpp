@@ -37,6 +37,17 @@ vk::Window::Window(std::shared_ptr<Instance> instance, GLFWwindow *window_) : in
     }
 }
 
+vk::Window::Window(std::shared_ptr<Instance> instance, VkExtent2D extent)
+    : instance_(instance), width_(extent.width), height_(extent.height) {
+    VkHeadlessSurfaceCreateInfoEXT createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT;
+
+    if (vkCreateHeadlessSurfaceEXT(instance_->vkInstance(), &createInfo, nullptr, &surface_) != VK_SUCCESS) {
+        std::cerr << "Cannot create vulkan headless surface!" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
 vk::Window::~Window() {
     vkDestroySurfaceKHR(instance_->vkInstance(), surface_, nullptr);
 
@@ -53,6 +64,10 @@ uint32_t vk::Window::height() {
     return height_;
 }
 
+bool vk::Window::headless() {
+    return window_ == nullptr;
+}
+
 GLFWwindow *vk::Window::window() {
     return window_;
 }
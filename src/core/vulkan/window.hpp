@@ -11,10 +11,13 @@ class Window : public SharedObject<Window> {
   public:
     Window(std::shared_ptr<Instance> instance, uint32_t width, uint32_t height);
     Window(std::shared_ptr<Instance> instance, GLFWwindow *window_);
+    // offscreen surface of a fixed size, the instance must be headless
+    Window(std::shared_ptr<Instance> instance, VkExtent2D extent);
     ~Window();
 
     uint32_t width();
     uint32_t height();
+    bool headless();
     GLFWwindow *window();
     VkSurfaceKHR &vkSurface();
 
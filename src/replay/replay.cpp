@@ -0,0 +1,618 @@
+#include "com_radiance_client_option_Options.h"
+#include "com_radiance_client_pipeline_Pipeline.h"
+#include "com_radiance_client_proxy_vulkan_BufferProxy.h"
+#include "com_radiance_client_proxy_vulkan_DrawCommandProxy_Overlay.h"
+#include "com_radiance_client_proxy_vulkan_PipelineStateProxy_ClearState.h"
+#include "com_radiance_client_proxy_vulkan_PipelineStateProxy_ColorBlendState.h"
+#include "com_radiance_client_proxy_vulkan_PipelineStateProxy_DepthStencilState.h"
+#include "com_radiance_client_proxy_vulkan_PipelineStateProxy_RasterizationState.h"
+#include "com_radiance_client_proxy_vulkan_PipelineStateProxy_ViewportState.h"
+#include "com_radiance_client_proxy_vulkan_RendererProxy.h"
+#include "com_radiance_client_proxy_vulkan_TextureProxy.h"
+#include "com_radiance_client_proxy_vulkan_WindowProxy.h"
+#include "com_radiance_client_proxy_world_ChunkProxy.h"
+#include "com_radiance_client_proxy_world_EntityProxy.h"
+#include "com_radiance_client_proxy_world_PlayerProxy.h"
+
+#include "core/middleware/jni_exports.hpp"
+#include "core/middleware/jni_trace.hpp"
+#include "core/render/pipeline.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// replays a trace captured with MCVR_TRACE against the core library on a headless surface and reports the frame
+// times and the chunk blas compaction, usage: replay <trace> [--folder <renderer folder>] [--gpu-profile <csv>]. the
+// library is only driven through its jni entry points, like the game does
+
+std::ostream &replayCout() {
+    return std::cout << "[Replay] ";
+}
+
+std::ostream &replayCerr() {
+    return std::cerr << "[Replay] ";
+}
+
+namespace {
+using Call = JniTrace::Call;
+
+// the entry points only use the environment for strings, a jstring handed to them points at a std::string
+const char *JNICALL getStringUTFChars(JNIEnv *, jstring string, jboolean *isCopy) {
+    if (isCopy != nullptr) *isCopy = JNI_FALSE;
+    return reinterpret_cast<std::string *>(string)->c_str();
+}
+
+void JNICALL releaseStringUTFChars(JNIEnv *, jstring, const char *) {}
+
+// a jlongArray handed out by the environment points at one of these, they live until the replay exits
+std::deque<std::vector<jlong>> longArrays;
+
+jlongArray JNICALL newLongArray(JNIEnv *, jsize length) {
+    return reinterpret_cast<jlongArray>(&longArrays.emplace_back(length));
+}
+
+void JNICALL setLongArrayRegion(JNIEnv *, jlongArray array, jsize start, jsize length, const jlong *values) {
+    std::copy_n(values, length, reinterpret_cast<std::vector<jlong> *>(array)->begin() + start);
+}
+
+struct MockEnv {
+    JNINativeInterface_ functions{};
+    JNIEnv env{};
+
+    MockEnv() {
+        functions.GetStringUTFChars = getStringUTFChars;
+        functions.ReleaseStringUTFChars = releaseStringUTFChars;
+        functions.NewLongArray = newLongArray;
+        functions.SetLongArrayRegion = setLongArrayRegion;
+        env.functions = &functions;
+    }
+};
+
+jlong address(void *pointer) {
+    return static_cast<jlong>(reinterpret_cast<intptr_t>(pointer));
+}
+
+// entry points without pointer arguments, the arguments are read in declaration order
+template <typename R, typename... Args>
+void dispatch(JniTrace::Reader &reader, JNIEnv *env, R(JNICALL *function)(JNIEnv *, jclass, Args...)) {
+    std::tuple<Args...> args{reader.read<Args>()...};
+    std::apply([&](Args... unpacked) { function(env, nullptr, unpacked...); }, args);
+}
+
+void replayBufferUniform(JniTrace::Reader &reader, JNIEnv *env, void(JNICALL *function)(JNIEnv *, jclass, jlong)) {
+    function(env, nullptr, address(reader.readBlob()));
+}
+
+void replayBuildNative(JniTrace::Reader &reader, JNIEnv *env) {
+    int moduleCount = reader.read<int>();
+
+    std::vector<std::string> moduleNames(moduleCount);
+    std::vector<char *> moduleNamePtrs(moduleCount);
+    std::vector<int> attributeCounts(moduleCount);
+    std::vector<std::vector<std::string>> attributeKVs(moduleCount);
+    std::vector<std::vector<char *>> attributeKVPtrs(moduleCount);
+    std::vector<char **> attributeKVPtrPtrs(moduleCount);
+    std::vector<std::vector<int>> inputIndices(moduleCount), outputIndices(moduleCount);
+    std::vector<int *> inputIndexPtrs(moduleCount), outputIndexPtrs(moduleCount);
+
+    for (int i = 0; i < moduleCount; i++) {
+        moduleNames[i] = reader.readString();
+        moduleNamePtrs[i] = moduleNames[i].data();
+
+        attributeCounts[i] = reader.read<int>();
+        for (int j = 0; j < 2 * attributeCounts[i]; j++) attributeKVs[i].push_back(reader.readString());
+        for (auto &kv : attributeKVs[i]) attributeKVPtrs[i].push_back(kv.data());
+        attributeKVPtrPtrs[i] = attributeKVPtrs[i].data();
+
+        inputIndices[i].resize(reader.read<uint32_t>());
+        for (auto &index : inputIndices[i]) index = reader.read<int>();
+        outputIndices[i].resize(reader.read<uint32_t>());
+        for (auto &index : outputIndices[i]) index = reader.read<int>();
+        inputIndexPtrs[i] = inputIndices[i].data();
+        outputIndexPtrs[i] = outputIndices[i].data();
+    }
+
+    std::vector<int> imageFormats(reader.read<int>());
+    for (auto &format : imageFormats) format = reader.read<int>();
+
+    WorldPipelineBuildParams params{
+        .moduleCount = moduleCount,
+        .padding = 0,
+        .moduleNames = moduleNamePtrs.data(),
+        .imageFormats = imageFormats.data(),
+        .inputIndices = inputIndexPtrs.data(),
+        .outputIndices = outputIndexPtrs.data(),
+        .attributeCounts = attributeCounts.data(),
+        .attributeKVs = attributeKVPtrPtrs.data(),
+    };
+    Java_com_radiance_client_pipeline_Pipeline_buildNative(env, nullptr, address(&params));
+}
+
+void replayChunkRebuild(JniTrace::Reader &reader, JNIEnv *env) {
+    jint x = reader.read<jint>();
+    jint y = reader.read<jint>();
+    jint z = reader.read<jint>();
+    jlong index = reader.read<jlong>();
+    jint geometryCount = reader.read<jint>();
+    jboolean important = reader.read<jboolean>();
+
+    void *geometryTypes = reader.readBlob();
+    void *geometryTextures = reader.readBlob();
+    void *vertexFormats = reader.readBlob();
+    void *vertexCounts = reader.readBlob();
+    std::vector<void *> vertices(std::max(geometryCount, 0));
+    for (auto &geometryVertices : vertices) geometryVertices = reader.readBlob();
+
+    Java_com_radiance_client_proxy_world_ChunkProxy_rebuildSingle(
+        env, nullptr, x, y, z, index, geometryCount, address(geometryTypes), address(geometryTextures),
+        address(vertexFormats), address(vertexCounts), address(vertices.data()), important);
+}
+
+void replayEntityQueueBuild(JniTrace::Reader &reader, JNIEnv *env) {
+    jfloat lineWidth = reader.read<jfloat>();
+    jint coordinate = reader.read<jint>();
+    jboolean normalOffset = reader.read<jboolean>();
+    jint size = reader.read<jint>();
+
+    void *entityArrays[8];
+    for (auto &array : entityArrays) array = reader.readBlob();
+
+    int geometryCount = reader.read<int>();
+    void *geometryArrays[5];
+    for (auto &array : geometryArrays) array = reader.readBlob();
+    std::vector<void *> vertices(std::max(geometryCount, 0));
+    for (auto &geometryVertices : vertices) geometryVertices = reader.readBlob();
+
+    Java_com_radiance_client_proxy_world_EntityProxy_queueBuild(
+        env, nullptr, lineWidth, coordinate, normalOffset, size, address(entityArrays[0]), address(entityArrays[1]),
+        address(entityArrays[2]), address(entityArrays[3]), address(entityArrays[4]), address(entityArrays[5]),
+        address(entityArrays[6]), address(entityArrays[7]), address(geometryArrays[0]), address(geometryArrays[1]),
+        address(geometryArrays[2]), address(geometryArrays[3]), address(geometryArrays[4]), address(vertices.data()));
+}
+
+void replayTextureUpload(JniTrace::Reader &reader, JNIEnv *env) {
+    void *src = reader.readBlob();
+    jint args[11];
+    for (auto &arg : args) arg = reader.read<jint>();
+
+    Java_com_radiance_client_proxy_vulkan_TextureProxy_queueUpload(env, nullptr, address(src), args[0], args[1],
+                                                                   args[2], args[3], args[4], args[5], args[6],
+                                                                   args[7], args[8], args[9], args[10]);
+}
+
+void replayScreenshot(JniTrace::Reader &reader, JNIEnv *env) {
+    jboolean withUI = reader.read<jboolean>();
+    jint width = reader.read<jint>();
+    jint height = reader.read<jint>();
+    jint channel = reader.read<jint>();
+
+    std::vector<uint8_t> pixels(static_cast<size_t>(std::max(width, 0)) * std::max(height, 0) * std::max(channel, 0));
+    Java_com_radiance_client_proxy_vulkan_RendererProxy_takeScreenshot(env, nullptr, withUI, width, height, channel,
+                                                                       address(pixels.data()));
+}
+
+// destination of the asynchronous screenshots, drained after every present like the game polls them
+std::vector<uint8_t> screenshotPixels;
+
+void replayRequestScreenshot(JniTrace::Reader &reader, JNIEnv *env) {
+    jboolean withUI = reader.read<jboolean>();
+    jint width = reader.read<jint>();
+    jint height = reader.read<jint>();
+    jint channel = reader.read<jint>();
+
+    size_t size = static_cast<size_t>(std::max(width, 0)) * std::max(height, 0) * std::max(channel, 0);
+    if (screenshotPixels.size() < size) screenshotPixels.resize(size);
+    Java_com_radiance_client_proxy_vulkan_RendererProxy_requestScreenshot(env, nullptr, withUI, width, height, channel);
+}
+
+void replayRequestScreenshotFile(JniTrace::Reader &reader, JNIEnv *env) {
+    jboolean withUI = reader.read<jboolean>();
+    std::string path = reader.readString();
+    Java_com_radiance_client_proxy_vulkan_RendererProxy_requestScreenshotFile(env, nullptr, withUI,
+                                                                              reinterpret_cast<jstring>(&path));
+}
+
+void drainScreenshots(JNIEnv *env) {
+    if (screenshotPixels.empty()) return;
+    while (Java_com_radiance_client_proxy_vulkan_RendererProxy_pollScreenshot(env, nullptr,
+                                                                              address(screenshotPixels.data())) != 0) {}
+}
+
+void dumpGpuProfile(JNIEnv *env, const std::string &file) {
+    if (file.empty()) return;
+    std::string path = file;
+    if (Java_com_radiance_client_proxy_vulkan_RendererProxy_dumpGpuProfile(env, nullptr,
+                                                                          reinterpret_cast<jstring>(&path))) {
+        replayCout() << "gpu profile written to " << file << std::endl;
+    }
+}
+
+// the chunk blas compaction totals, read before the renderer closes and drops the chunks
+void printCompaction(JNIEnv *env) {
+    auto &stats = *reinterpret_cast<std::vector<jlong> *>(
+        Java_com_radiance_client_proxy_world_ChunkProxy_compactionStats(env, nullptr));
+    if (stats[0] == 0) {
+        replayCout() << "no chunk blas compacted" << std::endl;
+        return;
+    }
+
+    replayCout() << "compacted " << stats[0] << " bytes of chunk blas into " << stats[1] << " bytes ("
+                 << 100.0 * stats[1] / stats[0] << "%)" << std::endl;
+}
+
+void printFrameTimes(std::vector<double> frameTimes) {
+    if (frameTimes.empty()) {
+        replayCout() << "no frames presented" << std::endl;
+        return;
+    }
+
+    std::sort(frameTimes.begin(), frameTimes.end());
+    auto percentile = [&frameTimes](double p) {
+        return frameTimes[std::min<size_t>(frameTimes.size() - 1, static_cast<size_t>(p * frameTimes.size()))];
+    };
+    double sum = 0.0;
+    for (double frameTime : frameTimes) sum += frameTime;
+
+    replayCout() << frameTimes.size() << " frames, average " << sum / frameTimes.size() << " ms, p50 "
+                 << percentile(0.50) << " ms, p95 " << percentile(0.95) << " ms, p99 " << percentile(0.99)
+                 << " ms, max " << frameTimes.back() << " ms" << std::endl;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        replayCerr() << "usage: " << argv[0] << " <trace> [--folder <renderer folder>] [--gpu-profile <csv>]"
+                     << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::string folder;
+    std::string gpuProfileFile;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--folder") {
+            folder = argv[i + 1];
+        } else if (option == "--gpu-profile") {
+            gpuProfileFile = argv[i + 1];
+        } else {
+            replayCerr() << "unknown option " << option << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    JniTrace::Reader reader(argv[1]);
+    if (!reader.valid()) return EXIT_FAILURE;
+
+    MockEnv mockEnv;
+    JNIEnv *env = &mockEnv.env;
+
+    std::vector<double> frameTimes;
+    auto lastPresent = std::chrono::steady_clock::now();
+    bool initialized = false;
+
+    Call call;
+    while (reader.next(call)) {
+        switch (call) {
+            case Call::OptionsSetMaxFps:
+                dispatch(reader, env, Java_com_radiance_client_option_Options_nativeSetMaxFps);
+                break;
+            case Call::OptionsSetInactivityFpsLimit:
+                dispatch(reader, env, Java_com_radiance_client_option_Options_nativeSetInactivityFpsLimit);
+                break;
+            case Call::OptionsSetVsync:
+                dispatch(reader, env, Java_com_radiance_client_option_Options_nativeSetVsync);
+                break;
+            case Call::OptionsSetChunkBuildingBatchSize:
+                dispatch(reader, env, Java_com_radiance_client_option_Options_nativeSetChunkBuildingBatchSize);
+                break;
+            case Call::OptionsSetChunkBuildingTotalBatches:
+                dispatch(reader, env, Java_com_radiance_client_option_Options_nativeSetChunkBuildingTotalBatches);
+                break;
+            case Call::OptionsSetGpuProfiler:
+                // the command line decides when a profile is requested
+                if (gpuProfileFile.empty()) {
+                    dispatch(reader, env, Java_com_radiance_client_option_Options_nativeSetGpuProfiler);
+                }
+                break;
+            case Call::OptionsSetChunkGeometrySpill:
+                dispatch(reader, env, Java_com_radiance_client_option_Options_nativeSetChunkGeometrySpill);
+                break;
+            case Call::PipelineBuildNative: replayBuildNative(reader, env); break;
+            case Call::PipelineCollectNativeModules:
+                dispatch(reader, env, Java_com_radiance_client_pipeline_Pipeline_collectNativeModules);
+                break;
+            case Call::BufferAllocate:
+                dispatch(reader, env, Java_com_radiance_client_proxy_vulkan_BufferProxy_allocateBuffer);
+                break;
+            case Call::BufferInitialize:
+                dispatch(reader, env, Java_com_radiance_client_proxy_vulkan_BufferProxy_initializeBuffer);
+                break;
+            case Call::BufferBuildIndexBuffer:
+                dispatch(reader, env, Java_com_radiance_client_proxy_vulkan_BufferProxy_buildIndexBuffer);
+                break;
+            case Call::BufferQueueUpload: {
+                void *src = reader.readBlob();
+                jint dstId = reader.read<jint>();
+                Java_com_radiance_client_proxy_vulkan_BufferProxy_queueUpload(env, nullptr, address(src), dstId);
+                break;
+            }
+            case Call::BufferPerformQueuedUpload:
+                dispatch(reader, env, Java_com_radiance_client_proxy_vulkan_BufferProxy_performQueuedUpload);
+                break;
+            case Call::BufferUpdateOverlayDrawUniform:
+                replayBufferUniform(reader, env,
+                                    Java_com_radiance_client_proxy_vulkan_BufferProxy_updateOverlayDrawUniform);
+                break;
+            case Call::BufferUpdateOverlayPostUniform:
+                replayBufferUniform(reader, env,
+                                    Java_com_radiance_client_proxy_vulkan_BufferProxy_updateOverlayPostUniform);
+                break;
+            case Call::BufferUpdateWorldUniform:
+                replayBufferUniform(reader, env, Java_com_radiance_client_proxy_vulkan_BufferProxy_updateWorldUniform);
+                break;
+            case Call::BufferUpdateSkyUniform:
+                replayBufferUniform(reader, env, Java_com_radiance_client_proxy_vulkan_BufferProxy_updateSkyUniform);
+                break;
+            case Call::BufferUpdateMapping:
+                replayBufferUniform(reader, env, Java_com_radiance_client_proxy_vulkan_BufferProxy_updateMapping);
+                break;
+            case Call::BufferUpdateLightMapUniform:
+                replayBufferUniform(reader, env,
+                                    Java_com_radiance_client_proxy_vulkan_BufferProxy_updateLightMapUniform);
+                break;
+            case Call::OverlayClearEntireColorAttachment:
+                dispatch(
+                    reader, env,
+                    Java_com_radiance_client_proxy_vulkan_DrawCommandProxy_00024Overlay_vkCmdClearEntireColorAttachment);
+                break;
+            case Call::OverlayClearEntireDepthStencilAttachment:
+                dispatch(
+                    reader, env,
+                    Java_com_radiance_client_proxy_vulkan_DrawCommandProxy_00024Overlay_vkCmdClearEntireDepthStencilAttachment);
+                break;
+            case Call::ClearStateSetClearColor:
+                dispatch(reader, env,
+                         Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024ClearState_setClearColor);
+                break;
+            case Call::ClearStateSetClearDepth:
+                dispatch(reader, env,
+                         Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024ClearState_setClearDepth);
+                break;
+            case Call::ClearStateSetClearStencil:
+                dispatch(reader, env,
+                         Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024ClearState_setClearStencil);
+                break;
+            case Call::ColorBlendStateSetBlendEnable:
+                dispatch(reader, env,
+                         Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024ColorBlendState_setBlendEnable);
+                break;
+            case Call::ColorBlendStateSetColorBlendConstants:
+                dispatch(
+                    reader, env,
+                    Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024ColorBlendState_setColorBlendConstants);
+                break;
+            case Call::ColorBlendStateSetColorLogicOpEnable:
+                dispatch(
+                    reader, env,
+                    Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024ColorBlendState_setColorLogicOpEnable);
+                break;
+            case Call::ColorBlendStateSetBlendFuncSeparate:
+                dispatch(
+                    reader, env,
+                    Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024ColorBlendState_vkSetBlendFuncSeparate);
+                break;
+            case Call::ColorBlendStateSetBlendOpSeparate:
+                dispatch(
+                    reader, env,
+                    Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024ColorBlendState_vkSetBlendOpSeparate);
+                break;
+            case Call::ColorBlendStateSetColorWriteMask:
+                dispatch(
+                    reader, env,
+                    Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024ColorBlendState_vkSetColorWriteMask);
+                break;
+            case Call::ColorBlendStateSetColorLogicOp:
+                dispatch(
+                    reader, env,
+                    Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024ColorBlendState_vkSetColorLogicOp);
+                break;
+            case Call::DepthStencilStateSetDepthTestEnable:
+                dispatch(
+                    reader, env,
+                    Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_setDepthTestEnable);
+                break;
+            case Call::DepthStencilStateSetDepthWriteEnable:
+                dispatch(
+                    reader, env,
+                    Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_setDepthWriteEnable);
+                break;
+            case Call::DepthStencilStateSetStencilTestEnable:
+                dispatch(
+                    reader, env,
+                    Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_setStencilTestEnable);
+                break;
+            case Call::DepthStencilStateSetDepthCompareOp:
+                dispatch(
+                    reader, env,
+                    Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_vkSetDepthCompareOp);
+                break;
+            case Call::DepthStencilStateSetStencilFrontFunc:
+                dispatch(
+                    reader, env,
+                    Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_vkSetStencilFrontFunc);
+                break;
+            case Call::DepthStencilStateSetStencilBackFunc:
+                dispatch(
+                    reader, env,
+                    Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_vkSetStencilBackFunc);
+                break;
+            case Call::DepthStencilStateSetStencilFrontOp:
+                dispatch(
+                    reader, env,
+                    Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_vkSetStencilFrontOp);
+                break;
+            case Call::DepthStencilStateSetStencilBackOp:
+                dispatch(
+                    reader, env,
+                    Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_vkSetStencilBackOp);
+                break;
+            case Call::DepthStencilStateSetStencilFrontWriteMask:
+                dispatch(
+                    reader, env,
+                    Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_vkSetStencilFrontWriteMask);
+                break;
+            case Call::DepthStencilStateSetStencilBackWriteMask:
+                dispatch(
+                    reader, env,
+                    Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024DepthStencilState_vkSetStencilBackWriteMask);
+                break;
+            case Call::RasterizationStateSetLineWidth:
+                dispatch(reader, env,
+                         Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024RasterizationState_setLineWidth);
+                break;
+            case Call::RasterizationStateSetPolygonMode:
+                dispatch(
+                    reader, env,
+                    Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024RasterizationState_vkSetPolygonMode);
+                break;
+            case Call::RasterizationStateSetCullMode:
+                dispatch(
+                    reader, env,
+                    Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024RasterizationState_vkSetCullMode);
+                break;
+            case Call::RasterizationStateSetFrontFace:
+                dispatch(
+                    reader, env,
+                    Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024RasterizationState_vkSetFrontFace);
+                break;
+            case Call::RasterizationStateSetDepthBiasEnable:
+                dispatch(
+                    reader, env,
+                    Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024RasterizationState_vkSetDepthBiasEnable);
+                break;
+            case Call::RasterizationStateSetDepthBias:
+                dispatch(
+                    reader, env,
+                    Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024RasterizationState_vkSetDepthBias);
+                break;
+            case Call::ViewportStateSetScissorEnabled:
+                dispatch(reader, env,
+                         Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024ViewportState_setScissorEnabled);
+                break;
+            case Call::ViewportStateSetScissor:
+                dispatch(reader, env,
+                         Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024ViewportState_setScissor);
+                break;
+            case Call::ViewportStateSetViewport:
+                dispatch(reader, env,
+                         Java_com_radiance_client_proxy_vulkan_PipelineStateProxy_00024ViewportState_setViewport);
+                break;
+            case Call::RendererInitFolderPath: {
+                std::string path = reader.readString();
+                if (!folder.empty()) path = folder;
+                Java_com_radiance_client_proxy_vulkan_RendererProxy_initFolderPath(env, nullptr,
+                                                                                   reinterpret_cast<jstring>(&path));
+                break;
+            }
+            case Call::RendererInit: {
+                uint32_t width = reader.read<uint32_t>();
+                uint32_t height = reader.read<uint32_t>();
+                replayCout() << "rendering headless at " << width << "x" << height << std::endl;
+                Java_com_radiance_client_proxy_vulkan_RendererProxy_initHeadlessRenderer(env, nullptr, width, height);
+                if (!gpuProfileFile.empty()) {
+                    Java_com_radiance_client_option_Options_nativeSetGpuProfiler(env, nullptr, JNI_TRUE, JNI_FALSE);
+                }
+                initialized = true;
+                break;
+            }
+            case Call::RendererAcquireContext:
+                dispatch(reader, env, Java_com_radiance_client_proxy_vulkan_RendererProxy_acquireContext);
+                break;
+            case Call::RendererSubmitCommand:
+                dispatch(reader, env, Java_com_radiance_client_proxy_vulkan_RendererProxy_submitCommand);
+                break;
+            case Call::RendererPresent: {
+                dispatch(reader, env, Java_com_radiance_client_proxy_vulkan_RendererProxy_present);
+                drainScreenshots(env);
+                reader.endFrame();
+
+                auto now = std::chrono::steady_clock::now();
+                frameTimes.push_back(std::chrono::duration<double, std::milli>(now - lastPresent).count());
+                lastPresent = now;
+                break;
+            }
+            case Call::RendererDrawOverlay:
+                dispatch(reader, env, Java_com_radiance_client_proxy_vulkan_RendererProxy_drawOverlay);
+                break;
+            case Call::RendererFuseWorld:
+                dispatch(reader, env, Java_com_radiance_client_proxy_vulkan_RendererProxy_fuseWorld);
+                break;
+            case Call::RendererPostBlur:
+                dispatch(reader, env, Java_com_radiance_client_proxy_vulkan_RendererProxy_postBlur);
+                break;
+            case Call::RendererClose:
+                if (initialized) {
+                    dumpGpuProfile(env, gpuProfileFile);
+                    printCompaction(env);
+                }
+                dispatch(reader, env, Java_com_radiance_client_proxy_vulkan_RendererProxy_close);
+                initialized = false;
+                break;
+            case Call::RendererShouldRenderWorld:
+                dispatch(reader, env, Java_com_radiance_client_proxy_vulkan_RendererProxy_shouldRenderWorld);
+                break;
+            case Call::RendererTakeScreenshot: replayScreenshot(reader, env); break;
+            case Call::TextureGenerateId:
+                dispatch(reader, env, Java_com_radiance_client_proxy_vulkan_TextureProxy_generateTextureId);
+                break;
+            case Call::TexturePrepareImage:
+                dispatch(reader, env, Java_com_radiance_client_proxy_vulkan_TextureProxy_prepareImage);
+                break;
+            case Call::TextureSetFilter:
+                dispatch(reader, env, Java_com_radiance_client_proxy_vulkan_TextureProxy_setFilter);
+                break;
+            case Call::TextureSetClamp:
+                dispatch(reader, env, Java_com_radiance_client_proxy_vulkan_TextureProxy_setClamp);
+                break;
+            case Call::TextureQueueUpload: replayTextureUpload(reader, env); break;
+            case Call::TexturePerformQueuedUpload:
+                dispatch(reader, env, Java_com_radiance_client_proxy_vulkan_TextureProxy_performQueuedUpload);
+                break;
+            case Call::WindowFramebufferSizeChanged:
+                dispatch(reader, env, Java_com_radiance_client_proxy_vulkan_WindowProxy_onFramebufferSizeChanged);
+                break;
+            case Call::ChunkInitNative:
+                dispatch(reader, env, Java_com_radiance_client_proxy_world_ChunkProxy_initNative);
+                break;
+            case Call::ChunkRebuildSingle: replayChunkRebuild(reader, env); break;
+            case Call::ChunkInvalidateSingle:
+                dispatch(reader, env, Java_com_radiance_client_proxy_world_ChunkProxy_invalidateSingle);
+                break;
+            case Call::EntityQueueBuild: replayEntityQueueBuild(reader, env); break;
+            case Call::EntityBuild:
+                dispatch(reader, env, Java_com_radiance_client_proxy_world_EntityProxy_build);
+                break;
+            case Call::PlayerSetCameraPos:
+                dispatch(reader, env, Java_com_radiance_client_proxy_world_PlayerProxy_setCameraPos);
+                break;
+            case Call::RendererRequestScreenshot: replayRequestScreenshot(reader, env); break;
+            case Call::RendererRequestScreenshotFile: replayRequestScreenshotFile(reader, env); break;
+            default: break;
+        }
+    }
+
+    // a trace cut short by the game leaves the renderer open
+    if (initialized) {
+        dumpGpuProfile(env, gpuProfileFile);
+        printCompaction(env);
+        Java_com_radiance_client_proxy_vulkan_RendererProxy_close(env, nullptr);
+    }
+
+    printFrameTimes(frameTimes);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,57 @@
+#ifndef WORLD_VERTEX_GLSL
+#define WORLD_VERTEX_GLSL
+
+// addresses with the lowest bit set point to a TerrainGeometryHeader followed by TerrainVertex entries,
+// all other addresses point to plain PBRTriangle entries
+
+layout(std430, buffer_reference, buffer_reference_align = 8) readonly buffer WorldPBRVertexBuffer {
+    PBRTriangle vertices[];
+};
+
+layout(std430, buffer_reference, buffer_reference_align = 16) readonly buffer WorldTerrainHeader {
+    TerrainGeometryHeader header;
+};
+
+layout(std430, buffer_reference, buffer_reference_align = 16) readonly buffer WorldTerrainVertexBuffer {
+    TerrainVertex vertices[];
+};
+
+vec3 decodeOctahedralNormal(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+PBRTriangle fetchWorldVertex(uint64_t vertexBufferAddr, uint index) {
+    if ((vertexBufferAddr & uint64_t(1)) == 0) { return WorldPBRVertexBuffer(vertexBufferAddr).vertices[index]; }
+
+    uint64_t headerAddr = vertexBufferAddr & ~uint64_t(1);
+    TerrainGeometryHeader header = WorldTerrainHeader(headerAddr).header;
+    TerrainVertex compact = WorldTerrainVertexBuffer(headerAddr + 48).vertices[index];
+
+    PBRTriangle v;
+    v.pos = compact.pos;
+    v.useNorm = header.useNorm;
+    v.norm = header.useNorm > 0 ? decodeOctahedralNormal(unpackSnorm4x8(compact.normEmission).xy) : vec3(0.0);
+    v.useColorLayer = header.useColorLayer;
+    v.colorLayer = unpackUnorm4x8(compact.colorLayer);
+    v.useTexture = header.useTexture;
+    v.useOverlay = header.useOverlay;
+    v.textureUV = compact.textureUV;
+    v.overlayUV = header.overlayUV;
+    v.useGlint = header.useGlint;
+    v.textureID = compact.textureID;
+    v.glintUV = vec2(0.0);
+    v.glintTexture = header.glintTexture;
+    v.useLight = 0;
+    v.lightUV = ivec2(0);
+    v.coordinate = header.coordinate;
+    v.albedoEmission = unpackHalf2x16(compact.normEmission).y;
+    v.postBase = vec3(0.0);
+    v.pad1 = 0;
+    return v;
+}
+
+#endif
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <iostream>
+
+// the tests are plain executables, a failed check is reported and turns the exit code of main into a failure
+inline int &checkFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition)                                                                                               \
+    do {                                                                                                               \
+        if (!(condition)) {                                                                                            \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition << std::endl;                    \
+            checkFailures()++;                                                                                         \
+        }                                                                                                              \
+    } while (0)
+
+inline int checkResult() {
+    if (checkFailures() > 0) std::cerr << checkFailures() << " checks failed" << std::endl;
+    return checkFailures() == 0 ? 0 : 1;
+}
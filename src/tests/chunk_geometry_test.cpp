@@ -0,0 +1,151 @@
+#include "core/render/chunk_geometry.hpp"
+#include "core/render/terrain_encoding.hpp"
+#include "tests/check.hpp"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+using vk::VertexFormat::PBRTriangle;
+
+constexpr int64_t VERTEX_SIZE = sizeof(PBRTriangle);
+
+static PBRTriangle terrainVertex(std::mt19937 &rng) {
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    return {
+        .pos = glm::vec3(unit(rng) * 16.0f, unit(rng) * 16.0f, unit(rng) * 16.0f),
+        .useNorm = 1,
+        .norm = glm::vec3(0.0f, 1.0f, 0.0f),
+        .useColorLayer = 1,
+        .colorLayer = glm::vec4(unit(rng), unit(rng), unit(rng), 1.0f),
+        .useTexture = 1,
+        .textureUV = glm::vec2(unit(rng), unit(rng)),
+        .textureID = static_cast<uint32_t>(rng() % 4096),
+        .coordinate = 1,
+    };
+}
+
+// a terrain encodable geometry, one that is not and an empty one, like a chunk with solid, glint and no cutout quads
+static std::vector<std::vector<PBRTriangle>> chunkGeometry(std::mt19937 &rng) {
+    std::vector<std::vector<PBRTriangle>> vertices(3);
+    for (int i = 0; i < 64; i++) { vertices[0].push_back(terrainVertex(rng)); }
+    for (int i = 0; i < 12; i++) {
+        vertices[1].push_back(terrainVertex(rng));
+        vertices[1].back().useGlint = 1;
+    }
+    return vertices;
+}
+
+static std::vector<uint32_t> vertexCounts(const std::vector<std::vector<PBRTriangle>> &vertices) {
+    std::vector<uint32_t> counts;
+    for (auto &geometryVertices : vertices) { counts.push_back(geometryVertices.size()); }
+    return counts;
+}
+
+static void testLayout() {
+    std::mt19937 rng(7);
+    auto vertices = chunkGeometry(rng);
+    auto layout = ChunkGeometryLayout::plan(vertices);
+
+    CHECK((layout.terrainEncoded == std::vector<bool>{true, false, false}));
+    CHECK(layout.sizes[0] == TerrainEncoding::encodedSize(64));
+    CHECK(layout.sizes[1] == 12 * VERTEX_SIZE);
+    CHECK(layout.sizes[2] == 0);
+    // back to back in geometry order
+    CHECK(layout.offsets[0] == 0);
+    CHECK(layout.offsets[1] == layout.sizes[0]);
+    CHECK(layout.offsets[2] == layout.sizes[0] + layout.sizes[1]);
+    CHECK(layout.totalSize == layout.sizes[0] + layout.sizes[1]);
+
+    CHECK(ChunkGeometryLayout::plan({}).totalSize == 0);
+}
+
+// the spill reads back what the staging buffer would upload, bit for bit for the raw geometry and through the terrain
+// decode for the encoded one
+static void testSpillReadback() {
+    std::mt19937 rng(9);
+    auto vertices = chunkGeometry(rng);
+    auto layout = ChunkGeometryLayout::plan(vertices);
+    std::vector<uint8_t> staging(layout.totalSize);
+    layout.write(vertices, staging.data());
+
+    auto spill = ChunkGeometrySpill::capture(true, staging.data(), layout, vertexCounts(vertices));
+    CHECK(spill != nullptr);
+    CHECK(spill->data == staging);
+
+    std::vector<PBRTriangle> decoded(vertices[0].size());
+    TerrainEncoding::decode(staging.data(), decoded.size(), decoded.data());
+    auto terrain = spill->readback(0);
+    CHECK(terrain.size() == decoded.size());
+    CHECK(std::memcmp(terrain.data(), decoded.data(), decoded.size() * VERTEX_SIZE) == 0);
+    for (size_t i = 0; i < terrain.size(); i++) {
+        CHECK(terrain[i].pos == vertices[0][i].pos && terrain[i].textureID == vertices[0][i].textureID);
+    }
+
+    auto raw = spill->readback(1);
+    CHECK(raw.size() == vertices[1].size());
+    CHECK(std::memcmp(raw.data(), vertices[1].data(), raw.size() * VERTEX_SIZE) == 0);
+    CHECK(spill->readback(2).empty());
+}
+
+// nothing is copied or counted while the option is off, a kept spill is counted for as long as it lives
+static void testSpillPolicy() {
+    std::mt19937 rng(5);
+    auto vertices = chunkGeometry(rng);
+    auto layout = ChunkGeometryLayout::plan(vertices);
+    std::vector<uint8_t> staging(layout.totalSize);
+    layout.write(vertices, staging.data());
+
+    int64_t baseline = ChunkHostBytes::total();
+    CHECK(ChunkGeometrySpill::capture(false, staging.data(), layout, vertexCounts(vertices)) == nullptr);
+    CHECK(ChunkHostBytes::total() == baseline);
+
+    auto spill = ChunkGeometrySpill::capture(true, staging.data(), layout, vertexCounts(vertices));
+    CHECK(spill->hostBytes.held() == static_cast<int64_t>(layout.totalSize));
+    CHECK(ChunkHostBytes::total() == baseline + static_cast<int64_t>(layout.totalSize));
+    spill = nullptr;
+    CHECK(ChunkHostBytes::total() == baseline);
+}
+
+// the steps ChunkBuildData takes: the ingested copy, the staging buffer, the copy released once it is staged, the
+// staging buffer released once the batch retired
+static void testBuildAccounting() {
+    std::mt19937 rng(3);
+    auto vertices = chunkGeometry(rng);
+    int64_t vertexBytes = (64 + 12) * VERTEX_SIZE;
+    int64_t baseline = ChunkHostBytes::total();
+
+    {
+        ChunkHostBytes hostBytes;
+        hostBytes.add(vertexBytes);
+        CHECK(ChunkHostBytes::total() == baseline + vertexBytes);
+
+        auto layout = ChunkGeometryLayout::plan(vertices);
+        hostBytes.add(layout.totalSize);
+        // the encoded staging copy is smaller than the ingested vertices
+        CHECK(static_cast<int64_t>(layout.totalSize) < vertexBytes);
+
+        hostBytes.add(-vertexBytes);
+        CHECK(hostBytes.held() == static_cast<int64_t>(layout.totalSize));
+        CHECK(ChunkHostBytes::total() == baseline + static_cast<int64_t>(layout.totalSize));
+
+        hostBytes.add(-static_cast<int64_t>(layout.totalSize));
+        CHECK(hostBytes.held() == 0);
+        CHECK(ChunkHostBytes::total() == baseline);
+    }
+
+    // data dropped before it was staged, like a build replaced by a newer ingest, returns what it held
+    {
+        ChunkHostBytes hostBytes;
+        hostBytes.add(vertexBytes);
+    }
+    CHECK(ChunkHostBytes::total() == baseline);
+}
+
+int main() {
+    testLayout();
+    testSpillReadback();
+    testSpillPolicy();
+    testBuildAccounting();
+    return checkResult();
+}
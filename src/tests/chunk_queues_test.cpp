@@ -0,0 +1,170 @@
+#include "core/render/chunk_queues.hpp"
+#include "tests/check.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+static void testIngestOrder() {
+    IngestQueue<int> queue;
+    CHECK(queue.popAll().empty());
+    for (int i = 0; i < 5; i++) { queue.push(i); }
+    CHECK((queue.popAll() == std::vector<int>{0, 1, 2, 3, 4}));
+    CHECK(queue.popAll().empty());
+
+    // whatever is left is released with the queue
+    auto value = std::make_shared<int>(1);
+    {
+        IngestQueue<std::shared_ptr<int>> owning;
+        owning.push(value);
+        CHECK(value.use_count() == 2);
+    }
+    CHECK(value.use_count() == 1);
+}
+
+// producers race a draining consumer, nothing may be lost and every producer's values must arrive in push order
+static void testIngestConcurrent() {
+    constexpr int PRODUCERS = 4;
+    constexpr int VALUES_PER_PRODUCER = 20000;
+    IngestQueue<std::pair<int, int>> queue;
+
+    std::atomic<int> finished = 0;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; p++) {
+        producers.emplace_back([&, p] {
+            for (int i = 0; i < VALUES_PER_PRODUCER; i++) { queue.push({p, i}); }
+            finished++;
+        });
+    }
+
+    std::vector<int> next(PRODUCERS, 0);
+    int received = 0;
+    bool ordered = true;
+    while (true) {
+        bool done = finished.load() == PRODUCERS;
+        for (auto [p, i] : queue.popAll()) {
+            ordered = ordered && i == next[p];
+            next[p] = i + 1;
+            received++;
+        }
+        if (done) break;
+    }
+    for (auto &producer : producers) { producer.join(); }
+
+    CHECK(ordered);
+    CHECK(received == PRODUCERS * VALUES_PER_PRODUCER);
+    CHECK(queue.popAll().empty());
+}
+
+static std::vector<int64_t> popAll(ChunkBuildQueue &queue) {
+    std::vector<int64_t> ids;
+    while (!queue.empty()) { ids.push_back(queue.pop()); }
+    return ids;
+}
+
+static void testPopOrder() {
+    ChunkBuildQueue queue;
+    queue.reset(1000);
+
+    std::mt19937 rng(1);
+    std::vector<float> scores(1000);
+    for (int64_t id = 0; id < 1000; id++) {
+        scores[id] = std::uniform_real_distribution<float>(0.0f, 1.0f)(rng);
+        queue.push(id, scores[id]);
+    }
+    CHECK(queue.size() == 1000);
+
+    auto ids = popAll(queue);
+    CHECK(ids.size() == 1000);
+    for (size_t i = 1; i < ids.size(); i++) { CHECK(scores[ids[i - 1]] >= scores[ids[i]]); }
+    std::sort(ids.begin(), ids.end());
+    CHECK(std::unique(ids.begin(), ids.end()) == ids.end());
+}
+
+// pushing a queued id again moves it instead of adding a second entry
+static void testUpdateKey() {
+    ChunkBuildQueue queue;
+    queue.reset(8);
+    for (int64_t id = 0; id < 8; id++) { queue.push(id, static_cast<float>(id)); }
+
+    queue.push(0, 100.0f);
+    queue.push(7, -1.0f);
+    CHECK(queue.size() == 8);
+    CHECK((popAll(queue) == std::vector<int64_t>{0, 6, 5, 4, 3, 2, 1, 7}));
+}
+
+static void testClear() {
+    ChunkBuildQueue queue;
+    queue.reset(4);
+    for (int64_t id = 0; id < 4; id++) { queue.push(id, 1.0f); }
+    queue.clear();
+    CHECK(queue.empty());
+
+    // cleared ids are not queued anymore, pushing them adds fresh entries
+    queue.push(2, 1.0f);
+    queue.push(3, 2.0f);
+    CHECK(queue.size() == 2);
+    CHECK((popAll(queue) == std::vector<int64_t>{3, 2}));
+}
+
+static void testRescore() {
+    ChunkBuildQueue queue;
+    queue.reset(16);
+    for (int64_t id = 0; id < 16; id++) { queue.push(id, static_cast<float>(id)); }
+
+    // the camera moved far enough, every queued id is rescored and the order flips
+    int calls = 0;
+    auto reversed = [&](int64_t id, std::chrono::steady_clock::time_point) {
+        calls++;
+        return static_cast<float>(-id);
+    };
+    queue.tryRescore(glm::vec3(0.0f, 0.0f, ChunkBuildQueue::RESCORE_DISTANCE), reversed);
+    CHECK(calls == 16);
+
+    // neither moved nor old enough, the cached scores stay
+    queue.tryRescore(glm::vec3(0.0f, 0.0f, ChunkBuildQueue::RESCORE_DISTANCE + 1.0f), [&](int64_t id, auto) {
+        calls++;
+        return static_cast<float>(id);
+    });
+    CHECK(calls == 16);
+
+    auto ids = popAll(queue);
+    for (int64_t i = 0; i < 16; i++) { CHECK(ids[i] == i); }
+}
+
+static void testChanges() {
+    ChunkChangeQueue queue;
+    queue.reset(8);
+    uint64_t generation = queue.generation();
+    CHECK(queue.popAll().empty());
+
+    // an id changed twice before it is taken is handed out once
+    queue.push(5);
+    queue.push(2);
+    queue.push(5);
+    CHECK((queue.popAll() == std::vector<int64_t>{5, 2}));
+    CHECK(queue.popAll().empty());
+
+    queue.push(5);
+    CHECK((queue.popAll() == std::vector<int64_t>{5}));
+
+    // a reset drops what was queued and starts a new generation
+    queue.push(1);
+    queue.reset(4);
+    CHECK(queue.generation() != generation);
+    CHECK(queue.popAll().empty());
+}
+
+int main() {
+    testIngestOrder();
+    testIngestConcurrent();
+    testPopOrder();
+    testUpdateKey();
+    testClear();
+    testRescore();
+    testChanges();
+    return checkResult();
+}
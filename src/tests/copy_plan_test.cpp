@@ -0,0 +1,137 @@
+#include "core/vulkan/copy_plan.hpp"
+#include "tests/check.hpp"
+
+#include <cstdint>
+#include <vector>
+
+using Plan = vk::CopyPlan<int>;
+
+// logs every command in recording order instead of talking to a device
+struct RecordingCommandBuffer {
+    enum class Type { PreBarrier, Copy, PostBarrier };
+
+    struct Command {
+        Type type;
+        uint64_t stageMask;
+        int src;
+        int dst;
+        std::vector<Plan::CopyRegion> regions;
+    };
+
+    std::vector<Command> commands;
+
+    void preBarrier(uint64_t dstStageMask) {
+        commands.push_back({Type::PreBarrier, dstStageMask, 0, 0, {}});
+    }
+
+    void copy(int src, int dst, const std::vector<Plan::CopyRegion> &regions) {
+        commands.push_back({Type::Copy, 0, src, dst, regions});
+    }
+
+    void postBarrier(uint64_t dstStageMask) {
+        commands.push_back({Type::PostBarrier, dstStageMask, 0, 0, {}});
+    }
+
+    uint32_t count(Type type) {
+        uint32_t n = 0;
+        for (auto &command : commands) { n += command.type == type; }
+        return n;
+    }
+};
+
+static bool sameRegion(const Plan::CopyRegion &a, uint64_t srcOffset, uint64_t dstOffset, uint64_t size) {
+    return a.srcOffset == srcOffset && a.dstOffset == dstOffset && a.size == size;
+}
+
+static void testEmpty() {
+    Plan plan;
+    plan.add(1, 0, 2, 0, 0, 0x1); // zero sized copies are dropped
+    CHECK(plan.empty());
+
+    RecordingCommandBuffer cmd;
+    auto stats = plan.record(cmd);
+    CHECK(cmd.commands.empty());
+    CHECK(stats.barriers == 0 && stats.copyCommands == 0);
+}
+
+// a frame of overlay uploads, several staging buffers into a few destinations. one barrier on each side of all copies
+// instead of one pair per buffer
+static void testBarriers() {
+    Plan plan;
+    constexpr int BUFFERS = 200;
+    for (int i = 0; i < BUFFERS; i++) { plan.add(1000 + i, 0, i % 3, i * 256, 256, 1ull << (i % 3)); }
+
+    RecordingCommandBuffer cmd;
+    auto stats = plan.record(cmd);
+    CHECK(stats.barriers == 2);
+    CHECK(cmd.count(RecordingCommandBuffer::Type::PreBarrier) == 1);
+    CHECK(cmd.count(RecordingCommandBuffer::Type::PostBarrier) == 1);
+    CHECK(cmd.commands.front().type == RecordingCommandBuffer::Type::PreBarrier);
+    CHECK(cmd.commands.back().type == RecordingCommandBuffer::Type::PostBarrier);
+
+    // the barriers cover the stages of every consumer
+    CHECK(cmd.commands.front().stageMask == 0x7);
+    CHECK(cmd.commands.back().stageMask == 0x7);
+
+    // distinct sources cannot share a copy command
+    CHECK(stats.copyCommands == BUFFERS);
+    CHECK(cmd.count(RecordingCommandBuffer::Type::Copy) == BUFFERS);
+    CHECK(stats.regions == BUFFERS);
+}
+
+// regions between the same pair of buffers share a command, the contiguous ones are merged whatever order they came in
+static void testMerge() {
+    Plan plan;
+    plan.add(1, 512, 2, 1512, 256, 0x1);
+    plan.add(1, 0, 2, 1000, 256, 0x1);
+    plan.add(1, 256, 2, 1256, 256, 0x1);
+    plan.add(1, 2048, 2, 0, 64, 0x1);   // contiguous in src only
+    plan.add(1, 2112, 2, 128, 64, 0x1); // not contiguous in dst
+    plan.add(1, 4096, 3, 0, 128, 0x2);
+    plan.add(4, 0, 2, 4096, 16, 0x2);
+
+    RecordingCommandBuffer cmd;
+    auto stats = plan.record(cmd);
+    CHECK(stats.copyCommands == 3);
+    CHECK(stats.regions == 5);
+    CHECK(cmd.commands.size() == 5);
+
+    auto &first = cmd.commands[1];
+    CHECK(first.src == 1 && first.dst == 2);
+    CHECK(first.regions.size() == 3);
+    CHECK(sameRegion(first.regions[0], 0, 1000, 768));
+    CHECK(sameRegion(first.regions[1], 2048, 0, 64));
+    CHECK(sameRegion(first.regions[2], 2112, 128, 64));
+
+    auto &second = cmd.commands[2];
+    CHECK(second.src == 1 && second.dst == 3);
+    CHECK(second.regions.size() == 1 && sameRegion(second.regions[0], 4096, 0, 128));
+
+    auto &third = cmd.commands[3];
+    CHECK(third.src == 4 && third.dst == 2);
+    CHECK(third.regions.size() == 1 && sameRegion(third.regions[0], 0, 4096, 16));
+}
+
+// recording clears the plan and its stage mask for the next frame
+static void testReuse() {
+    Plan plan;
+    plan.add(1, 0, 2, 0, 16, 0x4);
+    RecordingCommandBuffer cmd;
+    plan.record(cmd);
+    CHECK(plan.empty());
+
+    plan.add(1, 0, 2, 0, 16, 0x8);
+    RecordingCommandBuffer next;
+    auto stats = plan.record(next);
+    CHECK(stats.copyCommands == 1);
+    CHECK(next.commands.front().stageMask == 0x8);
+    CHECK(next.commands.back().stageMask == 0x8);
+}
+
+int main() {
+    testEmpty();
+    testBarriers();
+    testMerge();
+    testReuse();
+    return checkResult();
+}
@@ -0,0 +1,148 @@
+#include "core/vulkan/hit_records.hpp"
+#include "tests/check.hpp"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using vk::HitRecordTable;
+
+constexpr uint32_t HANDLE_SIZE = 32;
+constexpr uint32_t HANDLE_ALIGNMENT = 64;
+constexpr uint32_t MISS_COUNT = 2;
+constexpr uint32_t HIT_GROUPS = 4;
+
+// stands in for the vma, every allocation is a host vector that stays alive like the replaced buffers do until the gc
+struct MockVMA {
+    std::vector<std::unique_ptr<std::vector<uint8_t>>> allocations;
+
+    HitRecordTable::Allocate allocator() {
+        return [this](uint64_t size) {
+            allocations.push_back(std::make_unique<std::vector<uint8_t>>(size, 0xCD));
+            return allocations.back()->data();
+        };
+    }
+
+    std::vector<uint8_t> &current() {
+        return *allocations.back();
+    }
+};
+
+// every group handle is filled with its group index, raygen and miss groups included
+static std::vector<uint8_t> handleStorage() {
+    std::vector<uint8_t> storage((1 + MISS_COUNT + HIT_GROUPS) * HANDLE_SIZE);
+    for (size_t i = 0; i < storage.size(); i++) { storage[i] = static_cast<uint8_t>(i / HANDLE_SIZE); }
+    return storage;
+}
+
+// every record holds the handle of its hit group at the aligned stride, the padding is left alone
+static bool recordsMatch(MockVMA &vma, uint32_t stride, const std::vector<uint32_t> &hitGroupIndices) {
+    for (size_t i = 0; i < hitGroupIndices.size(); i++) {
+        for (uint32_t b = 0; b < stride; b++) {
+            uint8_t expected = b < HANDLE_SIZE ? static_cast<uint8_t>(1 + MISS_COUNT + hitGroupIndices[i]) : 0xCD;
+            if (vma.current()[i * stride + b] != expected) return false;
+        }
+    }
+    return true;
+}
+
+static void testLayout() {
+    CHECK(HitRecordTable::alignedHandleSize(32, 64) == 64);
+    CHECK(HitRecordTable::alignedHandleSize(32, 32) == 32);
+    CHECK(HitRecordTable::alignedHandleSize(48, 0) == 48);
+
+    MockVMA vma;
+    auto handles = handleStorage();
+    HitRecordTable table(HANDLE_SIZE, HANDLE_ALIGNMENT, 1 + MISS_COUNT);
+    CHECK(table.stride() == 64);
+
+    std::vector<uint32_t> indices = {0, 3, 1, 1, 2};
+    auto update = table.update(indices, handles.data(), vma.allocator());
+    CHECK(update.reallocated);
+    CHECK(vma.allocations.size() == 1);
+    CHECK(vma.current().size() == HitRecordTable::minRecordCapacity * 64);
+    CHECK(update.dirtyOffset == 0 && update.dirtySize == indices.size() * 64);
+    CHECK(table.size() == indices.size() * 64);
+    CHECK(recordsMatch(vma, 64, indices));
+}
+
+// the same geometry every frame neither allocates nor writes a record
+static void testSteadyState() {
+    MockVMA vma;
+    auto handles = handleStorage();
+    HitRecordTable table(HANDLE_SIZE, HANDLE_ALIGNMENT, 1 + MISS_COUNT);
+
+    std::vector<uint32_t> indices(300);
+    for (size_t i = 0; i < indices.size(); i++) { indices[i] = i % HIT_GROUPS; }
+    table.update(indices, handles.data(), vma.allocator());
+
+    std::fill(vma.current().begin(), vma.current().end(), 0xEE); // anything written from here on shows up
+    for (int frame = 0; frame < 10; frame++) {
+        auto update = table.update(indices, handles.data(), vma.allocator());
+        CHECK(!update.reallocated);
+        CHECK(update.dirtySize == 0);
+    }
+    CHECK(vma.allocations.size() == 1);
+    for (uint8_t byte : vma.current()) { CHECK(byte == 0xEE); }
+}
+
+// only the span between the first and the last changed record is dirty, shrinking writes nothing
+static void testPatch() {
+    MockVMA vma;
+    auto handles = handleStorage();
+    HitRecordTable table(HANDLE_SIZE, HANDLE_ALIGNMENT, 1 + MISS_COUNT);
+
+    std::vector<uint32_t> indices(100, 0);
+    table.update(indices, handles.data(), vma.allocator());
+
+    indices[10] = 2;
+    indices[20] = 3;
+    auto update = table.update(indices, handles.data(), vma.allocator());
+    CHECK(!update.reallocated);
+    CHECK(update.dirtyOffset == 10 * 64);
+    CHECK(update.dirtySize == 11 * 64);
+    CHECK(recordsMatch(vma, 64, indices));
+
+    indices.resize(50);
+    update = table.update(indices, handles.data(), vma.allocator());
+    CHECK(update.dirtySize == 0);
+    CHECK(table.size() == 50 * 64);
+
+    // records past the shrunk end are written again when the table grows back
+    indices.resize(60, 0);
+    update = table.update(indices, handles.data(), vma.allocator());
+    CHECK(update.dirtyOffset == 50 * 64 && update.dirtySize == 10 * 64);
+    CHECK(recordsMatch(vma, 64, indices));
+    CHECK(vma.allocations.size() == 1);
+}
+
+// outgrowing the buffer allocates one with headroom and rewrites every record into it
+static void testGrowth() {
+    MockVMA vma;
+    auto handles = handleStorage();
+    HitRecordTable table(HANDLE_SIZE, HANDLE_ALIGNMENT, 1 + MISS_COUNT);
+
+    std::vector<uint32_t> indices(HitRecordTable::minRecordCapacity / 2, 1);
+    table.update(indices, handles.data(), vma.allocator());
+    CHECK(table.capacity() == HitRecordTable::minRecordCapacity);
+
+    indices.resize(HitRecordTable::minRecordCapacity + 1, 2);
+    auto update = table.update(indices, handles.data(), vma.allocator());
+    CHECK(update.reallocated);
+    CHECK(vma.allocations.size() == 2);
+    CHECK(table.capacity() == indices.size() + indices.size() / 2);
+    CHECK(update.dirtyOffset == 0 && update.dirtySize == indices.size() * 64);
+    CHECK(recordsMatch(vma, 64, indices));
+
+    update = table.update(indices, handles.data(), vma.allocator());
+    CHECK(!update.reallocated && update.dirtySize == 0);
+    CHECK(vma.allocations.size() == 2);
+}
+
+int main() {
+    testLayout();
+    testSteadyState();
+    testPatch();
+    testGrowth();
+    return checkResult();
+}
@@ -0,0 +1,95 @@
+#include "core/render/instance_slots.hpp"
+#include "tests/check.hpp"
+
+#include <vector>
+
+constexpr uint32_t HISTORY_FRAMES = 2;
+
+// slots keep their index while others come and go, freed slots are reused before the table grows
+static void testStableSlots() {
+    InstanceSlots slots(HISTORY_FRAMES);
+    uint32_t a = slots.acquire(3);
+    uint32_t b = slots.acquire(2);
+    uint32_t c = slots.acquire(4);
+    CHECK(a == 0 && b == 1 && c == 2);
+    CHECK(slots.slot(a).recordOffset == 0 && slots.slot(b).recordOffset == 3 && slots.slot(c).recordOffset == 5);
+    CHECK(slots.instanceCount() == 3 && slots.recordCount() == 9 && slots.usedCount() == 3);
+
+    slots.release(b);
+    CHECK(!slots.slot(b).used);
+    CHECK(slots.slot(a).recordOffset == 0 && slots.slot(c).recordOffset == 5);
+    CHECK(slots.instanceCount() == 3 && slots.usedCount() == 2);
+
+    // the freed slot and its records are taken again
+    uint32_t d = slots.acquire(2);
+    CHECK(d == b && slots.slot(d).recordOffset == 3);
+    CHECK(slots.instanceCount() == 3 && slots.recordCount() == 9);
+
+    // growing moves the records, the slot stays
+    CHECK(!slots.resize(d, 2));
+    CHECK(slots.resize(d, 5));
+    CHECK(slots.slot(d).recordCount == 5 && slots.slot(d).recordOffset == 9);
+    CHECK(slots.recordCount() == 14);
+
+    // the hole it left is used by a smaller slot
+    uint32_t e = slots.acquire(1);
+    CHECK(e == 3 && slots.slot(e).recordOffset == 3);
+}
+
+// a context only gets the rows written since it last rendered, and everything once the history is gone
+static void testChanges() {
+    InstanceSlots slots(HISTORY_FRAMES);
+    CHECK(slots.changesSince(0).full);
+
+    uint32_t a = slots.acquire(2);
+    uint32_t b = slots.acquire(1);
+    auto first = slots.changesSince(0);
+    CHECK(first.full && first.structural);
+    uint64_t synced = slots.frame();
+    slots.endFrame();
+
+    // nothing written
+    auto idle = slots.changesSince(synced);
+    CHECK(!idle.full && !idle.structural && !idle.allInstances);
+    CHECK(idle.instances.empty() && idle.records.empty());
+    slots.endFrame();
+
+    // a transform and a record of b, marked twice in the frame
+    slots.markInstance(b, false);
+    slots.markInstance(b, false);
+    slots.markRecords(b);
+    slots.markRecords(b);
+    auto patch = slots.changesSince(synced);
+    CHECK(!patch.full && !patch.structural);
+    CHECK((patch.instances == std::vector<uint32_t>{b}));
+    CHECK((patch.records == std::vector<uint32_t>{slots.slot(b).recordOffset}));
+    synced = slots.frame();
+    slots.endFrame();
+
+    // rows of several frames are merged and sorted
+    slots.markRecords(b);
+    slots.endFrame();
+    slots.markRecords(a);
+    slots.release(b);
+    auto merged = slots.changesSince(synced);
+    CHECK(!merged.full && merged.structural);
+    CHECK((merged.instances == std::vector<uint32_t>{b}));
+    CHECK((merged.records == std::vector<uint32_t>{0, 1, 2}));
+
+    slots.markAllInstances();
+    auto moved = slots.changesSince(synced);
+    CHECK(moved.allInstances && moved.instances.empty());
+    slots.endFrame();
+
+    // the history only reaches back HISTORY_FRAMES frames before the current one
+    for (uint32_t i = 0; i < HISTORY_FRAMES; i++) slots.endFrame();
+    CHECK(slots.changesSince(synced).full);
+    CHECK(!slots.changesSince(slots.frame() - HISTORY_FRAMES - 1).full);
+    CHECK(slots.changesSince(slots.frame() - HISTORY_FRAMES - 2).full);
+}
+
+int main() {
+    testStableSlots();
+    testChanges();
+    return checkResult();
+}
@@ -0,0 +1,167 @@
+#include "core/middleware/jni_trace.hpp"
+#include "tests/check.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using Call = JniTrace::Call;
+
+static std::filesystem::path tracePath(const char *name) {
+    return std::filesystem::temp_directory_path() / name;
+}
+
+// records a short session the way the entry points do and reads it back the way the replay tool does
+static void testRoundTrip() {
+    auto path = tracePath("mcvr_jni_trace_test.trace");
+    std::vector<int32_t> geometryTypes = {0, 2, 1};
+    std::vector<uint8_t> vertices(333);
+    for (size_t i = 0; i < vertices.size(); i++) { vertices[i] = static_cast<uint8_t>(i * 7); }
+
+    CHECK(JniTrace::start(path));
+    CHECK(!JniTrace::start(path)); // one capture at a time
+    JniTrace::record(Call::RendererInitFolderPath, std::string("/tmp/radiance"));
+    JniTrace::record(Call::RendererInit, uint32_t{1920}, uint32_t{1080});
+    JniTrace::record(Call::OptionsSetChunkGeometrySpill, uint8_t{1}, uint8_t{0});
+    {
+        // odd sized values in front of the blobs, the blobs still come out 8 byte aligned
+        JniTrace::Record record(Call::ChunkRebuildSingle);
+        record << int32_t{-3} << int32_t{64} << int32_t{7} << int64_t{123456789012} << int32_t{3} << uint8_t{1}
+               << JniTrace::Blob{geometryTypes.data(), geometryTypes.size() * sizeof(int32_t)}
+               << JniTrace::Blob{nullptr, 16} << JniTrace::Blob{vertices.data(), vertices.size()};
+    }
+    JniTrace::record(Call::RendererPresent);
+    JniTrace::record(Call::PlayerSetCameraPos, 1.5, -2.25, 1e9);
+    JniTrace::stop();
+    JniTrace::record(Call::RendererPresent); // after the capture ended, dropped
+
+    JniTrace::Reader reader(path);
+    CHECK(reader.valid());
+    Call call;
+
+    CHECK(reader.next(call) && call == Call::RendererInitFolderPath);
+    CHECK(reader.readString() == "/tmp/radiance");
+
+    CHECK(reader.next(call) && call == Call::RendererInit);
+    CHECK(reader.read<uint32_t>() == 1920);
+    CHECK(reader.read<uint32_t>() == 1080);
+
+    CHECK(reader.next(call) && call == Call::OptionsSetChunkGeometrySpill);
+    CHECK(reader.read<uint8_t>() == 1);
+    CHECK(reader.read<uint8_t>() == 0);
+
+    CHECK(reader.next(call) && call == Call::ChunkRebuildSingle);
+    CHECK(reader.read<int32_t>() == -3);
+    CHECK(reader.read<int32_t>() == 64);
+    CHECK(reader.read<int32_t>() == 7);
+    CHECK(reader.read<int64_t>() == 123456789012);
+    CHECK(reader.read<int32_t>() == 3);
+    CHECK(reader.read<uint8_t>() == 1);
+    uint64_t size = 0;
+    void *types = reader.readBlob(&size);
+    CHECK(size == geometryTypes.size() * sizeof(int32_t));
+    CHECK(reinterpret_cast<uintptr_t>(types) % 8 == 0);
+    CHECK(types != nullptr && std::memcmp(types, geometryTypes.data(), size) == 0);
+    CHECK(reader.readBlob(&size) == nullptr && size == 0); // a null pointer is recorded as empty
+    void *vertexData = reader.readBlob(&size);
+    CHECK(size == vertices.size());
+    CHECK(reinterpret_cast<uintptr_t>(vertexData) % 8 == 0);
+    CHECK(vertexData != nullptr && std::memcmp(vertexData, vertices.data(), size) == 0);
+
+    CHECK(reader.next(call) && call == Call::RendererPresent);
+    reader.endFrame();
+
+    CHECK(reader.next(call) && call == Call::PlayerSetCameraPos);
+    CHECK(reader.read<double>() == 1.5);
+    CHECK(reader.read<double>() == -2.25);
+    CHECK(reader.read<double>() == 1e9);
+    CHECK(reader.read<double>() == 0.0); // reading past the payload yields zeros
+
+    CHECK(!reader.next(call));
+    std::filesystem::remove(path);
+}
+
+// blobs stay valid for the retained frames, entry points keep the pointers until the queued work is performed
+static void testBlobLifetime() {
+    auto path = tracePath("mcvr_jni_trace_lifetime.trace");
+    constexpr uint32_t FRAMES = 6;
+
+    CHECK(JniTrace::start(path));
+    for (uint32_t frame = 0; frame < FRAMES; frame++) {
+        std::vector<uint32_t> data(64, frame);
+        JniTrace::record(Call::TextureQueueUpload, JniTrace::Blob{data.data(), data.size() * sizeof(uint32_t)});
+        JniTrace::record(Call::RendererPresent);
+    }
+    JniTrace::stop();
+
+    JniTrace::Reader reader(path);
+    std::vector<uint32_t *> blobs;
+    Call call;
+    while (reader.next(call)) {
+        if (call == Call::TextureQueueUpload) blobs.push_back(static_cast<uint32_t *>(reader.readBlob()));
+        if (call != Call::RendererPresent) continue;
+        reader.endFrame();
+
+        // read in the frame that just ended and still in use during the retained frames after it, so the blobs of
+        // the frames that ended before it within that window are untouched as well
+        int64_t current = static_cast<int64_t>(blobs.size()) - 1;
+        for (int64_t frame = std::max<int64_t>(current + 1 - JniTrace::Reader::retainedFrames, 0); frame <= current;
+             frame++) {
+            CHECK(blobs[frame][0] == frame && blobs[frame][63] == frame);
+        }
+    }
+    CHECK(blobs.size() == FRAMES);
+    std::filesystem::remove(path);
+}
+
+static void testInvalidTraces() {
+    auto path = tracePath("mcvr_jni_trace_invalid.trace");
+    Call call;
+
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "not a trace";
+    }
+    JniTrace::Reader garbage(path);
+    CHECK(!garbage.valid());
+    CHECK(!garbage.next(call));
+
+    // a record cut short and a call this build does not know both stop the replay
+    CHECK(JniTrace::start(path));
+    JniTrace::record(Call::ChunkInitNative, int32_t{4096});
+    JniTrace::record(Call::ChunkInvalidateSingle, int64_t{9});
+    JniTrace::stop();
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 3);
+
+    JniTrace::Reader truncated(path);
+    CHECK(truncated.valid());
+    CHECK(truncated.next(call) && call == Call::ChunkInitNative);
+    CHECK(truncated.read<int32_t>() == 4096);
+    CHECK(!truncated.next(call));
+
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        uint16_t rawCall = static_cast<uint16_t>(Call::Count);
+        uint32_t size = 0;
+        out.write(reinterpret_cast<const char *>(&JniTrace::magic), sizeof(JniTrace::magic));
+        out.write(reinterpret_cast<const char *>(&JniTrace::version), sizeof(JniTrace::version));
+        out.write(reinterpret_cast<const char *>(&rawCall), sizeof(rawCall));
+        out.write(reinterpret_cast<const char *>(&size), sizeof(size));
+    }
+    JniTrace::Reader unknown(path);
+    CHECK(unknown.valid());
+    CHECK(!unknown.next(call));
+    CHECK(!unknown.valid());
+    std::filesystem::remove(path);
+}
+
+int main() {
+    testRoundTrip();
+    testBlobLifetime();
+    testInvalidTraces();
+    return checkResult();
+}
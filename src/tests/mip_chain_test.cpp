@@ -0,0 +1,161 @@
+#include "core/render/mip_chain.hpp"
+#include "tests/check.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+struct Level {
+    int32_t width;
+    int32_t height;
+    std::vector<float> texels;
+
+    float &at(int32_t x, int32_t y) {
+        return texels[y * width + x];
+    }
+
+    // clamp to edge, like the blit addresses its source
+    float clamped(int32_t x, int32_t y) {
+        return at(std::clamp(x, 0, width - 1), std::clamp(y, 0, height - 1));
+    }
+};
+
+using Chain = std::vector<Level>;
+
+static uint32_t mipLevels(uint32_t width, uint32_t height) {
+    return static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+}
+
+static Chain makeChain(uint32_t width, uint32_t height, std::mt19937 &rng) {
+    Chain chain;
+    for (uint32_t level = 0; level < mipLevels(width, height); level++) {
+        int32_t w = std::max<int32_t>(width >> level, 1);
+        int32_t h = std::max<int32_t>(height >> level, 1);
+        chain.push_back({w, h, std::vector<float>(w * h, 0.0f)});
+    }
+    for (auto &texel : chain[0].texels) { texel = std::uniform_int_distribution<int>(0, 255)(rng) / 255.0f; }
+    return chain;
+}
+
+// vkCmdBlitImage with VK_FILTER_LINEAR, every dst texel center is mapped into the src rect and sampled bilinearly
+static void blit(Level &src, MipRect srcRect, Level &dst, MipRect dstRect) {
+    float scaleX = static_cast<float>(srcRect.maxX - srcRect.minX) / (dstRect.maxX - dstRect.minX);
+    float scaleY = static_cast<float>(srcRect.maxY - srcRect.minY) / (dstRect.maxY - dstRect.minY);
+    for (int32_t y = dstRect.minY; y < dstRect.maxY; y++) {
+        for (int32_t x = dstRect.minX; x < dstRect.maxX; x++) {
+            float u = srcRect.minX + (x - dstRect.minX + 0.5f) * scaleX - 0.5f;
+            float v = srcRect.minY + (y - dstRect.minY + 0.5f) * scaleY - 0.5f;
+            int32_t x0 = static_cast<int32_t>(std::floor(u)), y0 = static_cast<int32_t>(std::floor(v));
+            float fx = u - x0, fy = v - y0;
+            float top = src.clamped(x0, y0) * (1 - fx) + src.clamped(x0 + 1, y0) * fx;
+            float bottom = src.clamped(x0, y0 + 1) * (1 - fx) + src.clamped(x0 + 1, y0 + 1) * fx;
+            dst.at(x, y) = top * (1 - fy) + bottom * fy;
+        }
+    }
+}
+
+// regenerates every level whole, what the texture looked like before only level 0 areas were blitted
+static void blitFullChain(Chain &chain) {
+    for (size_t level = 1; level < chain.size(); level++) {
+        Level &src = chain[level - 1];
+        Level &dst = chain[level];
+        blit(src, {0, 0, src.width, src.height}, dst, {0, 0, dst.width, dst.height});
+    }
+}
+
+static void blitPlanned(Chain &chain, MipRect dirty) {
+    for (auto &mip : planMipBlits(chain[0].width, chain[0].height, chain.size(), dirty)) {
+        blit(chain[mip.level - 1], mip.src, chain[mip.level], mip.dst);
+    }
+}
+
+// on exactly halving levels the linear blit is the 2x2 box filter
+static void testBoxReference() {
+    std::mt19937 rng(3);
+    Chain chain = makeChain(64, 32, rng);
+    blitFullChain(chain);
+
+    for (size_t level = 1; level < chain.size(); level++) {
+        Level &src = chain[level - 1];
+        Level &dst = chain[level];
+        for (int32_t y = 0; y < dst.height; y++) {
+            for (int32_t x = 0; x < dst.width; x++) {
+                if (src.height == 1) {
+                    CHECK(std::abs(dst.at(x, y) - (src.at(2 * x, 0) + src.at(2 * x + 1, 0)) / 2) < 1e-6f);
+                    continue;
+                }
+                float box = (src.at(2 * x, 2 * y) + src.at(2 * x + 1, 2 * y) + src.at(2 * x, 2 * y + 1) +
+                             src.at(2 * x + 1, 2 * y + 1)) /
+                            4;
+                CHECK(std::abs(dst.at(x, y) - box) < 1e-6f);
+            }
+        }
+    }
+}
+
+// patching a level 0 area and blitting only the planned rects ends up with the chain a full regeneration produces
+static void testDirtyRegeneration() {
+    std::mt19937 rng(7);
+    const uint32_t sizes[][2] = {{64, 64}, {48, 20}, {37, 13}, {1, 8}, {100, 1}, {256, 16}};
+    for (auto [width, height] : sizes) {
+        for (int round = 0; round < 20; round++) {
+            Chain chain = makeChain(width, height, rng);
+            blitFullChain(chain);
+
+            MipRect dirty;
+            dirty.minX = std::uniform_int_distribution<int32_t>(0, width - 1)(rng);
+            dirty.minY = std::uniform_int_distribution<int32_t>(0, height - 1)(rng);
+            dirty.maxX = std::uniform_int_distribution<int32_t>(dirty.minX + 1, width)(rng);
+            dirty.maxY = std::uniform_int_distribution<int32_t>(dirty.minY + 1, height)(rng);
+            for (int32_t y = dirty.minY; y < dirty.maxY; y++) {
+                for (int32_t x = dirty.minX; x < dirty.maxX; x++) {
+                    chain[0].at(x, y) = std::uniform_int_distribution<int>(0, 255)(rng) / 255.0f;
+                }
+            }
+
+            Chain expected = chain;
+            blitFullChain(expected);
+            blitPlanned(chain, dirty);
+
+            bool same = true;
+            for (size_t level = 1; level < chain.size(); level++) {
+                same = same && chain[level].texels == expected[level].texels;
+            }
+            CHECK(same);
+        }
+    }
+}
+
+static void testPlan() {
+    auto blits = planMipBlits(16, 16, 5, {2, 3, 5, 7});
+    CHECK(blits.size() == 4);
+    CHECK(blits[0].level == 1);
+    CHECK(blits[0].dst.minX == 1 && blits[0].dst.minY == 1 && blits[0].dst.maxX == 3 && blits[0].dst.maxY == 4);
+    CHECK(blits[0].src.minX == 2 && blits[0].src.minY == 2 && blits[0].src.maxX == 6 && blits[0].src.maxY == 8);
+    CHECK(blits[3].dst.minX == 0 && blits[3].dst.maxX == 1 && blits[3].dst.maxY == 1);
+
+    // an odd axis is regenerated whole from then on, the even one stays narrow
+    blits = planMipBlits(32, 10, 6, {30, 0, 32, 1});
+    CHECK(blits[0].dst.minX == 15 && blits[0].dst.maxX == 16);
+    CHECK(blits[0].dst.minY == 0 && blits[0].dst.maxY == 1);
+    CHECK(blits[1].src.minY == 0 && blits[1].src.maxY == 5);
+    CHECK(blits[1].dst.minY == 0 && blits[1].dst.maxY == 2);
+    CHECK(blits[1].dst.minX == 7 && blits[1].dst.maxX == 8);
+
+    // every rect stays inside its level
+    for (auto &blit : planMipBlits(37, 13, 6, {0, 0, 37, 13})) {
+        int32_t dstWidth = std::max(37 >> blit.level, 1), dstHeight = std::max(13 >> blit.level, 1);
+        CHECK(blit.dst.minX >= 0 && blit.dst.maxX <= dstWidth && blit.dst.maxY <= dstHeight);
+        CHECK(blit.src.maxX <= std::max(37 >> (blit.level - 1), 1));
+        CHECK(blit.src.maxY <= std::max(13 >> (blit.level - 1), 1));
+    }
+}
+
+int main() {
+    testBoxReference();
+    testDirtyRegeneration();
+    testPlan();
+    return checkResult();
+}
@@ -0,0 +1,219 @@
+#include "core/render/modules/overlay_state.hpp"
+#include "tests/check.hpp"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+// counts the vkCmdSet* calls per state bit instead of recording them
+struct CountingCommandBuffer {
+    std::array<uint32_t, 26> calls{};
+    uint32_t draws = 0;
+
+    void record(uint32_t state) {
+        for (uint32_t bit = 0; bit < calls.size(); bit++) {
+            if ((state & (1u << bit)) != 0) calls[bit]++;
+        }
+    }
+
+    uint32_t total() {
+        uint32_t n = 0;
+        for (uint32_t c : calls) { n += c; }
+        return n;
+    }
+
+    uint32_t count(uint32_t state) {
+        return calls[std::countr_zero(state)];
+    }
+};
+
+// a small stand-in for UIModuleContext, the setters compare against the shadowed value like the real ones do
+struct OverlayContext {
+    OverlayStateTracker state;
+    CountingCommandBuffer cmd;
+    uint32_t supported = OVERLAY_STATE_ALL;
+
+    bool blendEnable = false;
+    std::array<int, 4> blendFunc{};
+    bool depthTest = true;
+    std::array<int, 4> scissor{};
+    bool scissorEnabled = false;
+    int polygonMode = 0;
+    bool depthBiasEnable = false;
+    std::array<float, 3> depthBias{};
+
+    void setBlendEnable(bool enable) {
+        state.mark(OVERLAY_STATE_COLOR_BLEND_ENABLE, blendEnable != enable);
+        blendEnable = enable;
+    }
+
+    void setBlendFunc(std::array<int, 4> func) {
+        state.mark(OVERLAY_STATE_COLOR_BLEND_EQUATION, blendFunc != func);
+        blendFunc = func;
+    }
+
+    void setDepthTest(bool enable) {
+        state.mark(OVERLAY_STATE_DEPTH_TEST_ENABLE, depthTest != enable);
+        depthTest = enable;
+    }
+
+    void setScissorEnabled(bool enabled) {
+        state.mark(OVERLAY_STATE_SCISSOR, scissorEnabled != enabled);
+        scissorEnabled = enabled;
+    }
+
+    void setScissor(std::array<int, 4> box) {
+        state.mark(OVERLAY_STATE_SCISSOR, box != scissor && scissorEnabled);
+        scissor = box;
+    }
+
+    void setPolygonMode(int mode) {
+        bool changed = polygonMode != mode;
+        state.mark(OVERLAY_STATE_POLYGON_MODE, changed);
+        if (changed) state.invalidate(OVERLAY_STATE_DEPTH_BIAS);
+        polygonMode = mode;
+    }
+
+    void setDepthBiasEnable(bool enable) {
+        state.mark(OVERLAY_STATE_DEPTH_BIAS_ENABLE, depthBiasEnable != enable);
+        depthBiasEnable = enable;
+    }
+
+    void setDepthBias(float bias) {
+        state.mark(OVERLAY_STATE_DEPTH_BIAS, depthBias[polygonMode] != bias);
+        depthBias[polygonMode] = bias;
+    }
+
+    void drawIndexed() {
+        cmd.record(state.flush(depthBiasEnable, supported));
+        cmd.draws++;
+    }
+
+    // a new overlay command buffer starts without any state
+    void begin() {
+        state.invalidate();
+        state.resetStats();
+        cmd = {};
+    }
+};
+
+// what the gui sends for every element of an inventory screen, the same state over and over
+static void guiFrame(OverlayContext &context, int elements) {
+    for (int i = 0; i < elements; i++) {
+        context.setBlendEnable(true);
+        context.setBlendFunc({770, 1, 771, 0});
+        context.setDepthTest(false);
+        context.setScissorEnabled(false);
+        context.setScissor({0, 0, 100, 100});
+        context.drawIndexed();
+    }
+}
+
+static void testFirstDraw() {
+    OverlayContext context;
+    context.begin();
+    context.drawIndexed();
+
+    // everything but the disabled depth bias
+    CHECK(context.cmd.total() == std::popcount(static_cast<uint32_t>(OVERLAY_STATE_ALL)) - 1);
+    CHECK(context.cmd.count(OVERLAY_STATE_DEPTH_BIAS) == 0);
+    CHECK(context.state.stats().issued == context.cmd.total());
+    CHECK(context.state.dirty(false) == 0);
+}
+
+// the issued counter matches what reached the command buffer, every other setter call is filtered
+static void testRedundantState() {
+    OverlayContext context;
+    context.begin();
+    guiFrame(context, 500);
+
+    CHECK(context.cmd.draws == 500);
+    auto stats = context.state.stats();
+    CHECK(stats.issued == context.cmd.total());
+    CHECK(context.cmd.count(OVERLAY_STATE_COLOR_BLEND_ENABLE) == 1);
+    CHECK(context.cmd.count(OVERLAY_STATE_COLOR_BLEND_EQUATION) == 1);
+    CHECK(context.cmd.count(OVERLAY_STATE_DEPTH_TEST_ENABLE) == 1);
+    CHECK(context.cmd.count(OVERLAY_STATE_SCISSOR) == 1);
+
+    // the first element's changes land on state that begin left dirty, so no setter call records anything itself
+    CHECK(stats.filtered == 500 * 5);
+}
+
+// changes between two draws collapse into one command
+static void testMergedChanges() {
+    OverlayContext context;
+    context.begin();
+    context.drawIndexed();
+    uint32_t before = context.cmd.total();
+
+    context.setScissorEnabled(true);
+    context.setScissor({1, 2, 3, 4});
+    context.setScissor({5, 6, 7, 8});
+    context.setBlendEnable(true);
+    context.setBlendEnable(false);
+    context.drawIndexed();
+
+    // toggling the blend back still records it, the tracker only compares against the last value
+    CHECK(context.cmd.total() - before == 2);
+    CHECK(context.cmd.count(OVERLAY_STATE_SCISSOR) == 2);
+    CHECK(context.cmd.count(OVERLAY_STATE_COLOR_BLEND_ENABLE) == 2);
+    CHECK(context.state.stats().filtered == 3);
+}
+
+// the bias values wait for the bias to be enabled, a polygon mode change marks them again
+static void testDepthBias() {
+    OverlayContext context;
+    context.begin();
+    context.drawIndexed();
+
+    context.setDepthBias(2.0f);
+    context.drawIndexed();
+    CHECK(context.cmd.count(OVERLAY_STATE_DEPTH_BIAS) == 0);
+
+    context.setDepthBiasEnable(true);
+    context.drawIndexed();
+    CHECK(context.cmd.count(OVERLAY_STATE_DEPTH_BIAS) == 1);
+    CHECK(context.cmd.count(OVERLAY_STATE_DEPTH_BIAS_ENABLE) == 2);
+
+    context.setPolygonMode(1);
+    context.drawIndexed();
+    CHECK(context.cmd.count(OVERLAY_STATE_DEPTH_BIAS) == 2);
+    CHECK(context.cmd.count(OVERLAY_STATE_POLYGON_MODE) == 2);
+}
+
+// without the logic op feature the bits are dropped rather than issued or left dirty
+static void testUnsupportedState() {
+    OverlayContext context;
+    context.supported = OVERLAY_STATE_ALL & ~(OVERLAY_STATE_LOGIC_OP | OVERLAY_STATE_LOGIC_OP_ENABLE);
+    context.begin();
+    context.drawIndexed();
+
+    CHECK(context.cmd.count(OVERLAY_STATE_LOGIC_OP) == 0);
+    CHECK(context.cmd.count(OVERLAY_STATE_LOGIC_OP_ENABLE) == 0);
+    CHECK(context.state.stats().issued == context.cmd.total());
+    CHECK(context.state.dirty(false) == 0);
+}
+
+// the next frame's command buffer records everything again, the counters start over
+static void testNextFrame() {
+    OverlayContext context;
+    context.begin();
+    guiFrame(context, 10);
+    uint32_t firstFrame = context.state.stats().issued;
+
+    context.begin();
+    guiFrame(context, 10);
+    CHECK(context.state.stats().issued == firstFrame);
+    CHECK(context.state.stats().issued == context.cmd.total());
+}
+
+int main() {
+    testFirstDraw();
+    testRedundantState();
+    testMergedChanges();
+    testDepthBias();
+    testUnsupportedState();
+    testNextFrame();
+    return checkResult();
+}
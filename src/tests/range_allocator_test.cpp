@@ -0,0 +1,168 @@
+#include "core/vulkan/range_allocator.hpp"
+#include "tests/check.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using vk::RangeAllocator;
+
+static void testSplitAndCoalesce() {
+    RangeAllocator allocator(1024, 16);
+
+    uint64_t a = allocator.allocate(256);
+    uint64_t b = allocator.allocate(256);
+    uint64_t c = allocator.allocate(256);
+    CHECK(a == 0 && b == 256 && c == 512);
+    CHECK(allocator.allocationCount() == 3);
+    CHECK(allocator.stats().freeRangeCount == 1);
+    CHECK(allocator.stats().freeBytes == 256);
+
+    // a hole in the middle stays its own range until a neighbour is freed
+    allocator.free(b, 256);
+    CHECK(allocator.stats().freeRangeCount == 2);
+    allocator.free(a, 256);
+    CHECK(allocator.stats().freeRangeCount == 2);
+    CHECK(allocator.stats().largestFreeRange == 512);
+
+    // freeing the last one merges the previous range, the range behind and itself into the whole capacity
+    allocator.free(c, 256);
+    auto stats = allocator.stats();
+    CHECK(stats.allocationCount == 0);
+    CHECK(stats.freeRangeCount == 1);
+    CHECK(stats.freeBytes == 1024 && stats.largestFreeRange == 1024);
+}
+
+static void testBestFit() {
+    RangeAllocator allocator(1024, 16);
+
+    uint64_t a = allocator.allocate(128);
+    uint64_t gap0 = allocator.allocate(64);
+    uint64_t b = allocator.allocate(128);
+    uint64_t gap1 = allocator.allocate(256);
+    uint64_t c = allocator.allocate(128);
+    allocator.free(gap0, 64);
+    allocator.free(gap1, 256);
+
+    // the 64 byte hole is the smallest that fits, not the first one in address order
+    CHECK(allocator.bestFit(48) == 64);
+    CHECK(allocator.allocate(48) == gap0);
+    CHECK(allocator.bestFit(200) == 256);
+    CHECK(allocator.allocate(200) == gap1);
+
+    for (uint64_t offset : {a, b, c}) { allocator.free(offset, 128); }
+}
+
+static void testAlignment() {
+    RangeAllocator allocator(4096, 64);
+
+    CHECK(RangeAllocator::alignedSize(0, 64) == 64);
+    CHECK(RangeAllocator::alignedSize(1, 64) == 64);
+    CHECK(RangeAllocator::alignedSize(64, 64) == 64);
+    CHECK(RangeAllocator::alignedSize(65, 64) == 128);
+    CHECK(RangeAllocator::alignedSize(100, 48) == 144); // not a power of two
+
+    std::vector<uint64_t> offsets;
+    for (uint64_t size : {1, 63, 64, 65, 200, 7}) {
+        uint64_t offset = allocator.allocate(size);
+        CHECK(offset != RangeAllocator::invalidOffset);
+        CHECK(offset % 64 == 0);
+        offsets.push_back(offset);
+    }
+    // 64 + 64 + 64 + 128 + 256 + 64
+    CHECK(allocator.stats().freeBytes == 4096 - 640);
+}
+
+static void testExhaustion() {
+    RangeAllocator allocator(1024, 16);
+
+    CHECK(allocator.allocate(2048) == RangeAllocator::invalidOffset);
+    CHECK(allocator.bestFit(2048) == 0);
+    CHECK(allocator.allocationCount() == 0);
+
+    std::vector<uint64_t> offsets;
+    for (int i = 0; i < 8; i++) { offsets.push_back(allocator.allocate(128)); }
+    CHECK(std::find(offsets.begin(), offsets.end(), RangeAllocator::invalidOffset) == offsets.end());
+    CHECK(allocator.stats().freeBytes == 0);
+    CHECK(allocator.allocate(1) == RangeAllocator::invalidOffset);
+    CHECK(allocator.allocationCount() == 8);
+
+    // enough free bytes in total, but no single range holds them
+    allocator.free(offsets[1], 128);
+    allocator.free(offsets[3], 128);
+    CHECK(allocator.stats().freeBytes == 256);
+    CHECK(allocator.allocate(256) == RangeAllocator::invalidOffset);
+    CHECK(allocator.allocate(128) != RangeAllocator::invalidOffset);
+}
+
+static void testFragmentationStats() {
+    RangeAllocator allocator(1024, 16);
+    CHECK(allocator.stats().fragmentation == 0.0f);
+
+    std::vector<uint64_t> offsets;
+    for (int i = 0; i < 8; i++) { offsets.push_back(allocator.allocate(128)); }
+    CHECK(allocator.stats().fragmentation == 0.0f); // nothing free
+
+    // four separate 128 byte holes, the largest one is a quarter of the free bytes
+    for (int i = 0; i < 8; i += 2) { allocator.free(offsets[i], 128); }
+    auto stats = allocator.stats();
+    CHECK(stats.freeRangeCount == 4);
+    CHECK(stats.freeBytes == 512);
+    CHECK(stats.largestFreeRange == 128);
+    CHECK(stats.fragmentation == 0.75f);
+
+    // the rest coalesces everything back into one range
+    for (int i = 1; i < 8; i += 2) { allocator.free(offsets[i], 128); }
+    stats = allocator.stats();
+    CHECK(stats.freeRangeCount == 1);
+    CHECK(stats.fragmentation == 0.0f);
+
+    CHECK(RangeAllocator::fragmentation(0, 0) == 0.0f);
+    CHECK(RangeAllocator::fragmentation(256, 1024) == 0.75f);
+}
+
+// random allocations and frees checked against a shadow of the live ranges, no two ranges may overlap and the free
+// bytes always add up
+static void testRandomized() {
+    constexpr uint64_t capacity = 1 << 20;
+    RangeAllocator allocator(capacity, 256);
+
+    std::mt19937 rng(7);
+    std::vector<std::pair<uint64_t, uint64_t>> live;
+    uint64_t liveBytes = 0;
+    for (int i = 0; i < 20000; i++) {
+        if (live.empty() || rng() % 3 != 0) {
+            uint64_t size = RangeAllocator::alignedSize(1 + rng() % 8192, 256);
+            uint64_t offset = allocator.allocate(size);
+            if (offset == RangeAllocator::invalidOffset) continue;
+            CHECK(offset % 256 == 0 && offset + size <= capacity);
+            live.emplace_back(offset, size);
+            liveBytes += size;
+        } else {
+            size_t index = rng() % live.size();
+            allocator.free(live[index].first, live[index].second);
+            liveBytes -= live[index].second;
+            live[index] = live.back();
+            live.pop_back();
+        }
+    }
+
+    std::sort(live.begin(), live.end());
+    for (size_t i = 1; i < live.size(); i++) { CHECK(live[i - 1].first + live[i - 1].second <= live[i].first); }
+    CHECK(allocator.allocationCount() == live.size());
+    CHECK(allocator.stats().freeBytes == capacity - liveBytes);
+
+    for (auto &[offset, size] : live) { allocator.free(offset, size); }
+    CHECK(allocator.stats().freeRangeCount == 1);
+    CHECK(allocator.stats().largestFreeRange == capacity);
+}
+
+int main() {
+    testSplitAndCoalesce();
+    testBestFit();
+    testAlignment();
+    testExhaustion();
+    testFragmentationStats();
+    testRandomized();
+    return checkResult();
+}
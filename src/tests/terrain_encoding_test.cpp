@@ -0,0 +1,170 @@
+#include "core/render/terrain_encoding.hpp"
+#include "tests/check.hpp"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using vk::VertexFormat::PBRTriangle;
+
+// rgba8 unorm rounds to the nearest step
+constexpr float COLOR_TOLERANCE = 0.5f / 255.0f + 1e-6f;
+// snorm8x2 octahedral, the worst case over the sphere is about 0.0166
+constexpr float NORMAL_TOLERANCE = 0.02f;
+
+// one half step, 11 significant bits and a fixed step of 2^-24 once it is denormal below 2^-14
+static float emissionTolerance(float value) {
+    return std::max(std::abs(value) / 1024.0f, std::ldexp(1.0f, -24));
+}
+
+static PBRTriangle terrainVertex(std::mt19937 &rng) {
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::normal_distribution<float> gauss;
+    return {
+        .pos = glm::vec3(unit(rng) * 16.0f, unit(rng) * 384.0f - 64.0f, unit(rng) * 16.0f),
+        .useNorm = 1,
+        .norm = glm::normalize(glm::vec3(gauss(rng), gauss(rng), gauss(rng))),
+        .useColorLayer = 1,
+        .colorLayer = glm::vec4(unit(rng), unit(rng), unit(rng), unit(rng)),
+        .useTexture = 1,
+        .useOverlay = 0,
+        .textureUV = glm::vec2(unit(rng), unit(rng)),
+        .overlayUV = glm::ivec2(0, 10),
+        .textureID = static_cast<uint32_t>(rng() % 4096),
+        .coordinate = 1,
+        .albedoEmission = unit(rng) < 0.5f ? 0.0f : unit(rng) * 16.0f,
+    };
+}
+
+static std::vector<PBRTriangle> roundTrip(const std::vector<PBRTriangle> &vertices) {
+    std::vector<uint8_t> encoded(TerrainEncoding::encodedSize(vertices.size()));
+    TerrainEncoding::encode(vertices, encoded.data());
+    std::vector<PBRTriangle> decoded(vertices.size());
+    TerrainEncoding::decode(encoded.data(), vertices.size(), decoded.data());
+    return decoded;
+}
+
+static void testSize() {
+    CHECK(sizeof(vk::VertexFormat::TerrainVertex) == 32);
+    CHECK(TerrainEncoding::encodedSize(0) == sizeof(vk::VertexFormat::TerrainGeometryHeader));
+    CHECK(TerrainEncoding::encodedSize(6) == sizeof(vk::VertexFormat::TerrainGeometryHeader) + 6 * 32);
+}
+
+// positions, uvs, ids and the header flags must survive exactly, the packed fields within their tolerance
+static void testRoundTrip() {
+    std::mt19937 rng(11);
+    std::vector<PBRTriangle> vertices;
+    for (int i = 0; i < 4096; i++) { vertices.push_back(terrainVertex(rng)); }
+    CHECK(TerrainEncoding::isEncodable(vertices));
+
+    auto decoded = roundTrip(vertices);
+    for (size_t i = 0; i < vertices.size(); i++) {
+        auto &v = vertices[i];
+        auto &d = decoded[i];
+        CHECK(d.pos == v.pos && d.textureUV == v.textureUV && d.textureID == v.textureID);
+        CHECK(d.useNorm == v.useNorm && d.useColorLayer == v.useColorLayer && d.useTexture == v.useTexture &&
+              d.useOverlay == v.useOverlay && d.overlayUV == v.overlayUV && d.coordinate == v.coordinate);
+        CHECK(glm::all(glm::lessThanEqual(glm::abs(d.colorLayer - v.colorLayer), glm::vec4(COLOR_TOLERANCE))));
+        CHECK(std::abs(d.albedoEmission - v.albedoEmission) <= emissionTolerance(v.albedoEmission));
+        CHECK(glm::length(d.norm - v.norm) <= NORMAL_TOLERANCE);
+    }
+}
+
+static void testOctahedralNormal() {
+    // the axes sit on the octahedron corners and decode exactly
+    for (glm::vec3 axis : {glm::vec3(1, 0, 0), glm::vec3(-1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, -1, 0),
+                           glm::vec3(0, 0, 1), glm::vec3(0, 0, -1)}) {
+        CHECK(TerrainEncoding::decodeOctahedralNormal(TerrainEncoding::encodeOctahedralNormal(axis)) == axis);
+    }
+
+    // only the low 16 bits are used, the emission lives above them
+    std::mt19937 rng(3);
+    std::normal_distribution<float> gauss;
+    for (int i = 0; i < 100000; i++) {
+        glm::vec3 n = glm::normalize(glm::vec3(gauss(rng), gauss(rng), gauss(rng)));
+        uint32_t packed = TerrainEncoding::encodeOctahedralNormal(n);
+        CHECK(packed <= 0xFFFF);
+        glm::vec3 d = TerrainEncoding::decodeOctahedralNormal(packed | 0xABCD0000);
+        CHECK(glm::length(d - n) <= NORMAL_TOLERANCE);
+        CHECK(std::abs(glm::length(d) - 1.0f) <= 1e-5f);
+    }
+}
+
+static void testHalfEmission() {
+    std::vector<PBRTriangle> vertices;
+    for (float emission : {0.0f, 1.0f, 0.1f, 3.14159f, 1e-5f, 1e-7f, 15.0f, 1000.5f, 65504.0f, -2.5f}) {
+        PBRTriangle v{.norm = glm::vec3(0.0f), .albedoEmission = emission};
+        vertices.push_back(v);
+    }
+    CHECK(TerrainEncoding::isEncodable(vertices));
+
+    auto decoded = roundTrip(vertices);
+    for (size_t i = 0; i < vertices.size(); i++) {
+        float emission = vertices[i].albedoEmission;
+        CHECK(std::abs(decoded[i].albedoEmission - emission) <= emissionTolerance(emission));
+        CHECK(decoded[i].norm == glm::vec3(0.0f)); // useNorm is off
+    }
+    CHECK(decoded[0].albedoEmission == 0.0f && decoded[1].albedoEmission == 1.0f);
+    CHECK(decoded[8].albedoEmission == 65504.0f);
+}
+
+static void testUnormColor() {
+    std::vector<PBRTriangle> vertices;
+    for (int i = 0; i <= 255; i++) {
+        float step = i / 255.0f;
+        PBRTriangle v{.useColorLayer = 1, .colorLayer = glm::vec4(step, 1.0f - step, step * 0.5f, 1.0f)};
+        vertices.push_back(v);
+    }
+    auto decoded = roundTrip(vertices);
+    for (size_t i = 0; i < vertices.size(); i++) {
+        // exact steps come back unchanged up to the float division
+        CHECK(glm::all(glm::lessThanEqual(glm::abs(decoded[i].colorLayer - vertices[i].colorLayer),
+                                          glm::vec4(COLOR_TOLERANCE))));
+        CHECK(std::abs(decoded[i].colorLayer.x - vertices[i].colorLayer.x) <= 1e-6f);
+        CHECK(decoded[i].colorLayer.w == 1.0f);
+    }
+}
+
+static void testRejection() {
+    std::mt19937 rng(5);
+    std::vector<PBRTriangle> base;
+    for (int i = 0; i < 6; i++) { base.push_back(terrainVertex(rng)); }
+    CHECK(TerrainEncoding::isEncodable(base));
+    CHECK(!TerrainEncoding::isEncodable({}));
+
+    auto rejects = [&](auto &&mutate) {
+        auto vertices = base;
+        mutate(vertices.back());
+        return !TerrainEncoding::isEncodable(vertices);
+    };
+    // header flags must be uniform, overlayUV lives in the header too
+    CHECK(rejects([](PBRTriangle &v) { v.useOverlay = 1; }));
+    CHECK(rejects([](PBRTriangle &v) { v.overlayUV = glm::ivec2(3, 3); }));
+    CHECK(rejects([](PBRTriangle &v) { v.coordinate = 0; }));
+    // values outside unorm, outside half or a normal that is not unit length
+    CHECK(rejects([](PBRTriangle &v) { v.colorLayer.x = 1.5f; }));
+    CHECK(rejects([](PBRTriangle &v) { v.colorLayer.y = -0.1f; }));
+    CHECK(rejects([](PBRTriangle &v) { v.albedoEmission = 70000.0f; }));
+    CHECK(rejects([](PBRTriangle &v) { v.albedoEmission = NAN; }));
+    CHECK(rejects([](PBRTriangle &v) { v.norm *= 2.0f; }));
+
+    auto glint = base;
+    for (auto &v : glint) { v.useGlint = 1; }
+    CHECK(!TerrainEncoding::isEncodable(glint)); // glintUV is not kept
+
+    auto noNorm = base;
+    for (auto &v : noNorm) { v.useNorm = 0; }
+    CHECK(!TerrainEncoding::isEncodable(noNorm)); // an unused normal has to be zero to drop it
+    for (auto &v : noNorm) { v.norm = glm::vec3(0.0f); }
+    CHECK(TerrainEncoding::isEncodable(noNorm));
+}
+
+int main() {
+    testSize();
+    testRoundTrip();
+    testOctahedralNormal();
+    testHalfEmission();
+    testUnormColor();
+    testRejection();
+    return checkResult();
+}
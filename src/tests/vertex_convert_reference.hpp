@@ -0,0 +1,170 @@
+#pragma once
+
+#include "core/render/vertex_convert.hpp"
+
+#include <cstring>
+
+// the per-vertex switch entities.cpp used before the batch converters, the arithmetic is kept as it was so the
+// converters can be checked bit for bit against it and benchmarked next to it
+namespace VertexConvertReference {
+using namespace vk::VertexFormat;
+
+inline glm::vec4 unpackColor(uint32_t color) {
+    glm::vec4 colorLayer = glm::vec4{
+        color & 0xFF,
+        (color >> 8) & 0xFF,
+        (color >> 16) & 0xFF,
+        (color >> 24) & 0xFF,
+    };
+    colorLayer /= 255.0;
+    return colorLayer;
+}
+
+inline glm::vec3 unpackNormal(uint32_t normal) {
+    return glm::vec3{
+        (int8_t)(normal & 0xFF),
+        (int8_t)((normal >> 8) & 0xFF),
+        (int8_t)((normal >> 16) & 0xFF),
+    };
+}
+
+inline glm::ivec2 unpackShort2(uint32_t packed) {
+    return glm::vec2{
+        packed & 0xFFFF,
+        (packed >> 16) & 0xFFFF,
+    };
+}
+
+inline PBRTriangle convertVertex(World::VertexFormats format, const void *src, uint32_t j, uint32_t textureID) {
+    PBRTriangle vertex{};
+
+    switch (format) {
+        case World::POSITION_COLOR_TEXTURE_LIGHT_NORMAL: {
+            auto *vertices = static_cast<const PositionColorTexLightNormal *>(src);
+            vertex.pos = vertices[j].position;
+            vertex.useColorLayer = 1;
+            vertex.colorLayer = unpackColor(vertices[j].color);
+            vertex.useTexture = 1;
+            vertex.textureUV = vertices[j].uv0;
+            vertex.useLight = 1;
+            vertex.lightUV = unpackShort2(vertices[j].uv2);
+            vertex.useNorm = 1;
+            vertex.norm = unpackNormal(vertices[j].normal);
+            break;
+        }
+        case World::POSITION_COLOR_TEXTURE_OVERLAY_LIGHT_NORMAL: {
+            auto *vertices = static_cast<const PositionColorTexOverlayLightNormal *>(src);
+            vertex.pos = vertices[j].position;
+            vertex.useColorLayer = 1;
+            vertex.colorLayer = unpackColor(vertices[j].color);
+            vertex.useTexture = 1;
+            vertex.textureUV = vertices[j].uv0;
+            vertex.useOverlay = 1;
+            vertex.overlayUV = glm::ivec2{vertices[j].uv1 & 0xFFFF, (vertices[j].uv1 >> 16) & 0xFFFF};
+            vertex.useLight = 1;
+            vertex.lightUV = unpackShort2(vertices[j].uv2);
+            vertex.useNorm = 1;
+            vertex.norm = unpackNormal(vertices[j].normal);
+            break;
+        }
+        case World::POSITION_TEXTURE_COLOR_LIGHT: {
+            auto *vertices = static_cast<const PositionTexColorLight *>(src);
+            vertex.pos = vertices[j].position;
+            vertex.useTexture = 1;
+            vertex.textureUV = vertices[j].uv0;
+            vertex.useColorLayer = 1;
+            vertex.colorLayer = unpackColor(vertices[j].color);
+            vertex.useLight = 1;
+            vertex.lightUV = unpackShort2(vertices[j].uv2);
+            break;
+        }
+        case World::POSITION: {
+            auto *vertices = static_cast<const PositionOnly *>(src);
+            vertex.pos = vertices[j].position;
+            break;
+        }
+        case World::POSITION_COLOR: {
+            auto *vertices = static_cast<const PositionColor *>(src);
+            vertex.pos = vertices[j].position;
+            vertex.useColorLayer = 1;
+            vertex.colorLayer = unpackColor(vertices[j].color);
+            break;
+        }
+        case World::LINES: {
+            auto *vertices = static_cast<const PositionColorNormal *>(src);
+            vertex.pos = vertices[j].position;
+            vertex.useColorLayer = 1;
+            vertex.colorLayer = unpackColor(vertices[j].color);
+            vertex.useNorm = 1;
+            vertex.norm = unpackNormal(vertices[j].normal);
+            break;
+        }
+        case World::POSITION_COLOR_LIGHT: {
+            auto *vertices = static_cast<const PositionColorLight *>(src);
+            vertex.pos = vertices[j].position;
+            vertex.useColorLayer = 1;
+            vertex.colorLayer = unpackColor(vertices[j].color);
+            vertex.useLight = 1;
+            vertex.lightUV = unpackShort2(vertices[j].uv2);
+            break;
+        }
+        case World::POSITION_TEXTURE: {
+            auto *vertices = static_cast<const PositionTex *>(src);
+            vertex.pos = vertices[j].position;
+            vertex.useTexture = 1;
+            vertex.textureUV = vertices[j].uv;
+            break;
+        }
+        case World::POSITION_TEXTURE_COLOR: {
+            auto *vertices = static_cast<const PositionTexColor *>(src);
+            vertex.pos = vertices[j].position;
+            vertex.useTexture = 1;
+            vertex.textureUV = vertices[j].uv;
+            vertex.useColorLayer = 1;
+            vertex.colorLayer = unpackColor(vertices[j].color);
+            break;
+        }
+        case World::POSITION_COLOR_TEXTURE_LIGHT: {
+            auto *vertices = static_cast<const PositionColorTexLight *>(src);
+            vertex.pos = vertices[j].position;
+            vertex.useColorLayer = 1;
+            vertex.colorLayer = unpackColor(vertices[j].color);
+            vertex.useTexture = 1;
+            vertex.textureUV = vertices[j].uv0;
+            vertex.useLight = 1;
+            vertex.lightUV = unpackShort2(vertices[j].uv2);
+            break;
+        }
+        case World::POSITION_TEXTURE_LIGHT_COLOR: {
+            auto *vertices = static_cast<const PositionTexLightColor *>(src);
+            vertex.pos = vertices[j].position;
+            vertex.useTexture = 1;
+            vertex.textureUV = vertices[j].uv0;
+            vertex.useLight = 1;
+            vertex.lightUV = unpackShort2(vertices[j].uv2);
+            vertex.useColorLayer = 1;
+            vertex.colorLayer = unpackColor(vertices[j].color);
+            break;
+        }
+        case World::POSITION_TEXTURE_COLOR_NORMAL: {
+            auto *vertices = static_cast<const PositionTexColorNormal *>(src);
+            vertex.pos = vertices[j].position;
+            vertex.useTexture = 1;
+            vertex.textureUV = vertices[j].uv0;
+            vertex.useColorLayer = 1;
+            vertex.colorLayer = unpackColor(vertices[j].color);
+            vertex.useNorm = 1;
+            vertex.norm = unpackNormal(vertices[j].normal);
+            break;
+        }
+        case World::PBR_TRIANGLE: {
+            std::memcpy(&vertex, static_cast<const PBRTriangle *>(src) + j, sizeof(vertex));
+            break;
+        }
+        default: break;
+    }
+
+    if (format != World::PBR_TRIANGLE) vertex.textureID = textureID;
+    return vertex;
+}
+} // namespace VertexConvertReference
@@ -0,0 +1,92 @@
+#include "core/render/vertex_convert.hpp"
+#include "tests/check.hpp"
+#include "tests/vertex_convert_reference.hpp"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+using vk::VertexFormat::PBRTriangle;
+using vk::VertexFormat::PositionColorTexOverlayLightNormal;
+
+// random source bytes, positions and uvs may come out as nan or denormals and still have to be copied bit for bit
+static std::vector<uint8_t> randomVertices(std::mt19937 &rng, uint32_t vertexSize, uint32_t count) {
+    std::vector<uint8_t> data(static_cast<size_t>(vertexSize) * count);
+    for (auto &byte : data) { byte = static_cast<uint8_t>(rng()); }
+    return data;
+}
+
+// every path this cpu can run, the scalar one is always there
+static std::vector<VertexConvert::Isa> availableIsas() {
+    std::vector<VertexConvert::Isa> isas;
+    for (auto isa : {VertexConvert::Isa::Scalar, VertexConvert::Isa::SSE41, VertexConvert::Isa::AVX2}) {
+        if (isa <= VertexConvert::bestIsa()) isas.push_back(isa);
+    }
+    return isas;
+}
+
+static void testFormat(VertexConvert::Isa isa, World::VertexFormats format, std::mt19937 &rng) {
+    uint32_t vertexSize = VertexConvert::vertexSize(format);
+    CHECK(vertexSize > 0);
+
+    // odd counts and the empty batch, the converters must not depend on the count being a multiple of anything
+    for (uint32_t count : {0u, 1u, 2u, 3u, 7u, 1000u}) {
+        auto src = randomVertices(rng, vertexSize, count);
+        uint32_t textureID = rng();
+
+        std::vector<PBRTriangle> converted(count);
+        VertexConvert::toPBRTriangles(isa, format, src.data(), count, textureID, converted.data());
+
+        uint32_t mismatches = 0;
+        for (uint32_t j = 0; j < count; j++) {
+            PBRTriangle expected = VertexConvertReference::convertVertex(format, src.data(), j, textureID);
+            if (std::memcmp(&expected, &converted[j], sizeof(PBRTriangle)) != 0) mismatches++;
+        }
+        CHECK(mismatches == 0);
+        if (mismatches > 0) {
+            std::cerr << "isa " << static_cast<int>(isa) << ", format " << format << ", count " << count << std::endl;
+        }
+    }
+}
+
+// every byte value of the packed fields, random data alone does not hit all of them reliably
+static void testPackedFieldsExhaustive(VertexConvert::Isa isa) {
+    constexpr auto format = World::POSITION_COLOR_TEXTURE_OVERLAY_LIGHT_NORMAL;
+    std::vector<PositionColorTexOverlayLightNormal> src(256);
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t b = i * 0x01010101u;
+        src[i] = {.position = glm::vec3(i), .color = b, .uv0 = glm::vec2(i), .uv1 = b, .uv2 = ~b, .normal = b};
+    }
+    std::vector<PBRTriangle> converted(src.size());
+    VertexConvert::toPBRTriangles(isa, format, src.data(), src.size(), 7, converted.data());
+    for (uint32_t i = 0; i < 256; i++) {
+        PBRTriangle expected = VertexConvertReference::convertVertex(format, src.data(), i, 7);
+        CHECK(std::memcmp(&expected, &converted[i], sizeof(PBRTriangle)) == 0);
+    }
+    CHECK(converted[255].colorLayer == glm::vec4(1.0f));
+    CHECK(converted[128].norm == glm::vec3(-128.0f));
+    CHECK(converted[1].lightUV == glm::ivec2(0xFEFE));
+}
+
+static void testUnknownFormat() {
+    std::vector<PBRTriangle> converted(4);
+    VertexConvert::toPBRTriangles(World::NUM_VERTEX_FORMATS, nullptr, converted.size(), 42, converted.data());
+    for (auto &vertex : converted) {
+        PBRTriangle expected{};
+        expected.textureID = 42;
+        CHECK(std::memcmp(&expected, &vertex, sizeof(PBRTriangle)) == 0);
+    }
+    CHECK(VertexConvert::vertexSize(World::NUM_VERTEX_FORMATS) == 0);
+}
+
+int main() {
+    for (auto isa : availableIsas()) {
+        std::mt19937 rng(13);
+        for (int format = 0; format < World::NUM_VERTEX_FORMATS; format++) {
+            testFormat(isa, static_cast<World::VertexFormats>(format), rng);
+        }
+        testPackedFieldsExhaustive(isa);
+    }
+    testUnknownFormat();
+    return checkResult();
+}